@@ -24,8 +24,6 @@ const float F0_NON_METAL = 0.04;
 const float MIN_ROUGHNESS = 0.045;
 
 #define MAX_DIR_LIGHTS 4
-#define MAX_POINT_LIGHTS 16
-#define MAX_SPOT_LIGHTS 16
 
 // 优化的数学函数
 float pow5(float x) {
@@ -45,39 +43,68 @@ vec3 saturate(vec3 x) {
     return clamp(x, 0.0, 1.0);
 }
 
-struct DirectionalLight {
-    vec3 direction;
-    vec3 color;
-    float intensity;
-};
-
+// Clustered point and spot lights (SSBO bindings 1-4), cone angles stored as cosines.
+// Each fragment only loops over the lights assigned to its view-space cluster.
 struct PointLight {
     vec3 position;
+    float range;
     vec3 color;
     float intensity;
-    float range;
 };
 
 struct SpotLight {
     vec3 position;
+    float range;
     vec3 direction;
-
+    float innerConeAngle;
     vec3 color;
     float intensity;
-
-    float range;
-    float innerConeAngle;
     float outerConeAngle;
 };
 
-uniform int u_DirLightCount;
-uniform DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
+struct LightCluster {
+    uint offset;
+    uint pointCount;
+    uint spotCount;
+    uint _padding0;
+};
+
+layout(std430, binding = 1) readonly buffer PointLightBuffer
+{
+	PointLight u_PointLights[];
+};
+
+layout(std430, binding = 2) readonly buffer SpotLightBuffer
+{
+	SpotLight u_SpotLights[];
+};
+
+layout(std430, binding = 3) readonly buffer LightClusterBuffer
+{
+	LightCluster u_LightClusters[];
+};
 
-uniform int u_PointLightCount;
-uniform PointLight u_PointLights[MAX_POINT_LIGHTS];
+layout(std430, binding = 4) readonly buffer LightIndexBuffer
+{
+	uint u_LightIndices[];
+};
 
-uniform int u_SpotLightCount;
-uniform SpotLight u_SpotLights[MAX_SPOT_LIGHTS];
+// Light cluster grid uniform buffer (binding = 6)
+layout(std140, binding = 6) uniform LightClusterGrid
+{
+	vec2 u_ClusterTileSize;
+	float u_ClusterSliceScale;
+	float u_ClusterSliceBias;
+	uvec3 u_ClusterGridSize;
+	int u_ClusterLogSlices;
+};
+
+uint getClusterIndex(vec2 fragCoord, float viewDepth) {
+    float d = u_ClusterLogSlices != 0 ? log(max(viewDepth, 1e-4)) : viewDepth;
+    uint slice = uint(clamp(floor(d * u_ClusterSliceScale + u_ClusterSliceBias), 0.0, float(u_ClusterGridSize.z - 1u)));
+    uvec2 tile = min(uvec2(fragCoord / u_ClusterTileSize), u_ClusterGridSize.xy - 1u);
+    return (slice * u_ClusterGridSize.y + tile.y) * u_ClusterGridSize.x + tile.x;
+}
 
 // Camera uniform buffer (binding = 0)
 layout(std140, binding = 0) uniform CameraData
@@ -88,10 +115,16 @@ layout(std140, binding = 0) uniform CameraData
 	vec3 u_CameraPosition;
 };
 
+struct DirectionalLight {
+    vec3 direction;
+    float intensity;
+    vec3 color;
+    float _padding0;
+};
+
 // Light uniform buffer (binding = 2)
 layout(std140, binding = 2) uniform LightData
 {
-	mat4 u_LightSpaceMatrix;
 	vec3 u_DirLightDirection;
 	float u_DirLightIntensity;
 	vec3 u_DirLightColor;
@@ -103,6 +136,8 @@ layout(std140, binding = 2) uniform LightData
 	float u_AmbientIntensity;
 	int u_NumPointLights;
 	int u_NumSpotLights;
+	float _lightPadding2;
+	DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
 };
 
 uniform sampler2D u_GBufferAlbedo;
@@ -114,7 +149,18 @@ uniform sampler2D u_GBufferDepth;
 uniform mat4 u_InverseViewProjection;
 
 // Shadow mapping
-uniform sampler2D u_ShadowMap;
+#define MAX_SHADOW_CASCADES 4
+
+// Shadow cascades (binding = 7); cascade i covers view depths up to u_CascadeSplits[i]
+layout(std140, binding = 7) uniform ShadowData
+{
+	mat4 u_CascadeViewProjections[MAX_SHADOW_CASCADES];
+	vec4 u_CascadeSplits;
+	vec4 u_CascadeBiasScales;
+	int u_CascadeCount;
+	int u_ShadowCascade;
+};
+uniform sampler2DArray u_ShadowMap;
 
 // IBL
 uniform bool u_UseIBL;
@@ -175,7 +221,15 @@ float computeSpecularOcclusion(float NoV, float ao, float roughness) {
     return clamp(pow(NoV + ao, exp2(-16.0 * roughness - 1.0)) - 1.0 + ao, 0.0, 1.0);
 }
 
-float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
+float calculateShadow(vec3 worldPos, float viewDepth, vec3 normal, vec3 lightDir) {
+    // Pick the first cascade that reaches this depth; nothing past the last one is shadowed
+    int cascade = 0;
+    while (cascade < u_CascadeCount - 1 && viewDepth > u_CascadeSplits[cascade])
+        ++cascade;
+    if (viewDepth > u_CascadeSplits[cascade])
+        return 0.0;
+
+    vec4 fragPosLightSpace = u_CascadeViewProjections[cascade] * vec4(worldPos, 1.0);
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
 
@@ -184,15 +238,16 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
         return 0.0;
 
     float bias = max(u_ShadowBias * (1.0 - dot(normal, lightDir)), u_ShadowBias * 0.1);
+    bias *= u_CascadeBiasScales[cascade];
 
     float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(u_ShadowMap, 0);
+    vec2 texelSize = 1.0 / textureSize(u_ShadowMap, 0).xy;
     int pcfRange = int(u_ShadowSoftness);
     int sampleCount = 0;
 
     for (int x = -pcfRange; x <= pcfRange; ++x) {
         for (int y = -pcfRange; y <= pcfRange; ++y) {
-            float pcfDepth = texture(u_ShadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            float pcfDepth = texture(u_ShadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, cascade)).r;
             shadow += projCoords.z - bias > pcfDepth ? 1.0 : 0.0;
             sampleCount++;
         }
@@ -266,24 +321,27 @@ void main() {
 
         float shadow = 0.0;
         if (u_EnableShadows != 0) {
-            vec4 fragPosLightSpace = u_LightSpaceMatrix * vec4(worldPos, 1.0);
-            shadow = calculateShadow(fragPosLightSpace, N, L);
+            shadow = calculateShadow(worldPos, -(u_View * vec4(worldPos, 1.0)).z, N, L);
         }
 
         Lo += evaluateLighting(N, V, L, albedo, roughness, metallic, F0, NoV, radiance, 1.0 - shadow);
     }
 
     // Additional directional lights
-    for (int i = 0; i < u_DirLightCount; i++) {
+    for (int i = 0; i < u_NumDirLights; i++) {
         DirectionalLight light = u_DirLights[i];
         vec3 L = normalize(-light.direction);
         vec3 radiance = light.color * light.intensity;
         Lo += evaluateLighting(N, V, L, albedo, roughness, metallic, F0, NoV, radiance, 1.0);
     }
 
+    // Lights touching this fragment's cluster
+    float viewDepth = -(u_View * vec4(worldPos, 1.0)).z;
+    LightCluster cluster = u_LightClusters[getClusterIndex(gl_FragCoord.xy, viewDepth)];
+
     // Point lights
-    for (int i = 0; i < u_PointLightCount; i++) {
-        PointLight light = u_PointLights[i];
+    for (uint i = 0u; i < cluster.pointCount; i++) {
+        PointLight light = u_PointLights[u_LightIndices[cluster.offset + i]];
         vec3 L = light.position - worldPos;
         float dist = length(L);
         if (dist > light.range)
@@ -299,8 +357,8 @@ void main() {
     }
 
     // Spot lights
-    for (int i = 0; i < u_SpotLightCount; i++) {
-        SpotLight light = u_SpotLights[i];
+    for (uint i = 0u; i < cluster.spotCount; i++) {
+        SpotLight light = u_SpotLights[u_LightIndices[cluster.offset + cluster.pointCount + i]];
         vec3 L = light.position - worldPos;
         float dist = length(L);
         if (dist > light.range)
@@ -1,5 +1,8 @@
+#pragma multi_compile FM_ALBEDO_MAP
+
 #type vertex
 #version 450 core
+#extension GL_ARB_shader_draw_parameters : enable
 
 layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec3 a_Normal;
@@ -15,13 +18,30 @@ layout(std140, binding = 0) uniform CameraData
 	vec3 u_CameraPosition;
 };
 
-// Model uniform buffer (binding = 1)
-layout(std140, binding = 1) uniform ModelData
+// Per-instance model data (SSBO binding = 0), indexed from the draw's base instance
+struct InstanceData
+{
+	mat4 model;
+	mat4 normalMatrix;
+	int objectID;
+};
+
+layout(std430, binding = 0) readonly buffer InstanceBuffer
+{
+	InstanceData u_Instances[];
+};
+
+// Where the draw's instances start: straight from the draw where the driver has shader draw parameters,
+// otherwise written by the renderer before each draw (binding = 5)
+#ifdef GL_ARB_shader_draw_parameters
+#define FM_BASE_INSTANCE gl_BaseInstanceARB
+#else
+layout(std140, binding = 5) uniform DrawParameters
 {
-	mat4 u_Model;
-	mat4 u_NormalMatrix;
-	int u_ObjectID;
+	int u_BaseInstance;
 };
+#define FM_BASE_INSTANCE u_BaseInstance
+#endif
 
 out vec3 v_Normal;
 out vec2 v_TexCoords;
@@ -29,10 +49,11 @@ flat out int v_ObjectID;
 
 void main()
 {
-    vec4 worldPos = u_Model * vec4(a_Position, 1.0);
-    v_Normal = mat3(u_NormalMatrix) * a_Normal;
+    InstanceData instance = u_Instances[FM_BASE_INSTANCE + gl_InstanceID];
+    vec4 worldPos = instance.model * vec4(a_Position, 1.0);
+    v_Normal = mat3(instance.normalMatrix) * a_Normal;
     v_TexCoords = a_TexCoords;
-    v_ObjectID = u_ObjectID;
+    v_ObjectID = instance.objectID;
 
     gl_Position = u_ViewProjection * worldPos;
 }
@@ -50,9 +71,30 @@ in vec3 v_Normal;
 in vec2 v_TexCoords;
 flat in int v_ObjectID;
 
-uniform bool u_UseTexture;
-uniform sampler2D u_Texture;
-uniform vec4 u_Kd;
+// Material uniform buffer (binding = 3)
+layout(std140, binding = 3) uniform MaterialData
+{
+    vec4 albedo;
+    vec4 ambient;
+    float metallic;
+    float roughness;
+    float ao;
+    float _padding0;
+    int hasAlbedoMap;
+    int hasNormalMap;
+    int hasMetallicMap;
+    int hasRoughnessMap;
+    int hasAOMap;
+} u_Material;
+
+// Compile-time per variant, so the texture fetches of absent maps are compiled out
+#ifdef FM_ALBEDO_MAP
+const bool HAS_ALBEDO_MAP = true;
+#else
+const bool HAS_ALBEDO_MAP = false;
+#endif
+
+layout(binding = 0) uniform sampler2D u_Texture;
 uniform bool u_FlipUV;
 
 void main()
@@ -61,7 +103,7 @@ void main()
     if (u_FlipUV)
         uv.y = 1.0 - uv.y;
 
-    vec4 baseColor = u_UseTexture ? texture(u_Texture, uv) : u_Kd;
+    vec4 baseColor = HAS_ALBEDO_MAP ? texture(u_Texture, uv) : u_Material.albedo;
 
     o_Albedo = vec4(baseColor.rgb, baseColor.a);
     o_Normal = vec4(normalize(v_Normal), 1.0);
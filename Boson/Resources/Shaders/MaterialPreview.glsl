@@ -1,3 +1,5 @@
+#pragma multi_compile FM_ALBEDO_MAP FM_NORMAL_MAP FM_METALLIC_MAP FM_ROUGHNESS_MAP FM_AO_MAP
+
 #type vertex
 #version 450 core
 
@@ -48,31 +50,55 @@ uniform vec3 u_LightColor;
 uniform float u_LightIntensity;
 uniform float u_AmbientIntensity;
 
-// PBR Material
-struct Material {
-    vec3 albedo;
+// Material uniform buffer (binding = 3)
+layout(std140, binding = 3) uniform MaterialData
+{
+    vec4 albedo;
+    vec4 ambient;
     float metallic;
     float roughness;
     float ao;
-};
-
-uniform Material u_Material;
+    float _padding0;
+    int hasAlbedoMap;
+    int hasNormalMap;
+    int hasMetallicMap;
+    int hasRoughnessMap;
+    int hasAOMap;
+} u_Material;
+
+// Compile-time per variant, so the texture fetches of absent maps are compiled out
+#ifdef FM_ALBEDO_MAP
+const bool HAS_ALBEDO_MAP = true;
+#else
+const bool HAS_ALBEDO_MAP = false;
+#endif
+#ifdef FM_NORMAL_MAP
+const bool HAS_NORMAL_MAP = true;
+#else
+const bool HAS_NORMAL_MAP = false;
+#endif
+#ifdef FM_METALLIC_MAP
+const bool HAS_METALLIC_MAP = true;
+#else
+const bool HAS_METALLIC_MAP = false;
+#endif
+#ifdef FM_ROUGHNESS_MAP
+const bool HAS_ROUGHNESS_MAP = true;
+#else
+const bool HAS_ROUGHNESS_MAP = false;
+#endif
+#ifdef FM_AO_MAP
+const bool HAS_AO_MAP = true;
+#else
+const bool HAS_AO_MAP = false;
+#endif
 
 // Textures
-uniform bool u_UseAlbedoMap;
-uniform sampler2D u_AlbedoMap;
-
-uniform bool u_UseNormalMap;
-uniform sampler2D u_NormalMap;
-
-uniform bool u_UseMetallicMap;
-uniform sampler2D u_MetallicMap;
-
-uniform bool u_UseRoughnessMap;
-uniform sampler2D u_RoughnessMap;
-
-uniform bool u_UseAOMap;
-uniform sampler2D u_AOMap;
+layout(binding = 0) uniform sampler2D u_AlbedoMap;
+layout(binding = 1) uniform sampler2D u_NormalMap;
+layout(binding = 2) uniform sampler2D u_MetallicMap;
+layout(binding = 3) uniform sampler2D u_RoughnessMap;
+layout(binding = 4) uniform sampler2D u_AOMap;
 
 // ============================================================================
 // Utility Functions
@@ -132,7 +158,7 @@ float Fd_Burley(float roughness, float NoV, float NoL, float LoH) {
 
 // Get normal from normal map using screen-space derivatives
 vec3 getNormalFromMap() {
-    if (!u_UseNormalMap) {
+    if (!HAS_NORMAL_MAP) {
         return normalize(v_Normal);
     }
 
@@ -163,13 +189,13 @@ vec3 ACESFilm(vec3 x) {
 
 void main() {
     // Get material properties
-    vec3 baseColorLinear = pow(u_Material.albedo, vec3(2.2));
-    vec3 texColorLinear = u_UseAlbedoMap ? pow(texture(u_AlbedoMap, v_TexCoords).rgb, vec3(2.2)) : vec3(1.0);
+    vec3 baseColorLinear = pow(u_Material.albedo.rgb, vec3(2.2));
+    vec3 texColorLinear = HAS_ALBEDO_MAP ? pow(texture(u_AlbedoMap, v_TexCoords).rgb, vec3(2.2)) : vec3(1.0);
     vec3 albedo = texColorLinear * baseColorLinear;
 
-    float metallic = u_UseMetallicMap ? texture(u_MetallicMap, v_TexCoords).r : u_Material.metallic;
-    float roughness = u_UseRoughnessMap ? texture(u_RoughnessMap, v_TexCoords).r : u_Material.roughness;
-    float ao = u_UseAOMap ? texture(u_AOMap, v_TexCoords).r : u_Material.ao;
+    float metallic = HAS_METALLIC_MAP ? texture(u_MetallicMap, v_TexCoords).r : u_Material.metallic;
+    float roughness = HAS_ROUGHNESS_MAP ? texture(u_RoughnessMap, v_TexCoords).r : u_Material.roughness;
+    float ao = HAS_AO_MAP ? texture(u_AOMap, v_TexCoords).r : u_Material.ao;
 
     // Clamp roughness
     roughness = max(roughness, MIN_ROUGHNESS);
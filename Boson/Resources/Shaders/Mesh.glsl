@@ -1,5 +1,8 @@
+#pragma multi_compile FM_ALBEDO_MAP
+
 #type vertex
 #version 450 core
+#extension GL_ARB_shader_draw_parameters : enable
 
 layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec3 a_Normal;
@@ -15,18 +18,43 @@ layout(std140, binding = 0) uniform CameraData
 	vec3 u_CameraPosition;
 };
 
-// Model uniform buffer (binding = 1)
-layout(std140, binding = 1) uniform ModelData
+// Per-instance model data (SSBO binding = 0), indexed from the draw's base instance
+struct InstanceData
 {
-	mat4 u_Model;
-	mat4 u_NormalMatrix;
-	int u_ObjectID;
+	mat4 model;
+	mat4 normalMatrix;
+	int objectID;
+};
+
+layout(std430, binding = 0) readonly buffer InstanceBuffer
+{
+	InstanceData u_Instances[];
+};
+
+// Where the draw's instances start: straight from the draw where the driver has shader draw parameters,
+// otherwise written by the renderer before each draw (binding = 5)
+#ifdef GL_ARB_shader_draw_parameters
+#define FM_BASE_INSTANCE gl_BaseInstanceARB
+#else
+layout(std140, binding = 5) uniform DrawParameters
+{
+	int u_BaseInstance;
+};
+#define FM_BASE_INSTANCE u_BaseInstance
+#endif
+
+#define MAX_DIR_LIGHTS 4
+
+struct DirectionalLight {
+    vec3 direction;
+    float intensity;
+    vec3 color;
+    float _padding0;
 };
 
 // Light uniform buffer (binding = 2)
 layout(std140, binding = 2) uniform LightData
 {
-	mat4 u_LightSpaceMatrix;
 	vec3 u_DirLightDirection;
 	float u_DirLightIntensity;
 	vec3 u_DirLightColor;
@@ -38,25 +66,26 @@ layout(std140, binding = 2) uniform LightData
 	float u_AmbientIntensity;
 	int u_NumPointLights;
 	int u_NumSpotLights;
+	float _lightPadding2;
+	DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
 };
 
 out vec3 v_WorldPos;
 out vec3 v_Normal;
 out vec4 v_Color;
 out vec2 v_TexCoords;
-out vec4 v_FragPosLightSpace;
 flat out int v_ObjectID;
 
 void main() {
-    vec4 worldPos = u_Model * vec4(a_Position, 1.0);
+    InstanceData instance = u_Instances[FM_BASE_INSTANCE + gl_InstanceID];
+    vec4 worldPos = instance.model * vec4(a_Position, 1.0);
     v_WorldPos = worldPos.xyz;
 
-    // Use precomputed normal matrix from UBO
-    v_Normal = mat3(u_NormalMatrix) * a_Normal;
+    // Use precomputed normal matrix from the instance data
+    v_Normal = mat3(instance.normalMatrix) * a_Normal;
     v_Color = a_Color;
     v_TexCoords = a_TexCoords;
-    v_FragPosLightSpace = u_LightSpaceMatrix * worldPos;
-    v_ObjectID = u_ObjectID;
+    v_ObjectID = instance.objectID;
 
     gl_Position = u_ViewProjection * worldPos;
 }
@@ -71,17 +100,20 @@ in vec3 v_WorldPos;
 in vec3 v_Normal;
 in vec4 v_Color;
 in vec2 v_TexCoords;
-in vec4 v_FragPosLightSpace;
 flat in int v_ObjectID;
 
 #define MAX_DIR_LIGHTS 4
-#define MAX_POINT_LIGHTS 16
-#define MAX_SPOT_LIGHTS 16
+
+struct DirectionalLight {
+    vec3 direction;
+    float intensity;
+    vec3 color;
+    float _padding0;
+};
 
 // Light uniform buffer (binding = 2)
 layout(std140, binding = 2) uniform LightData
 {
-	mat4 u_LightSpaceMatrix;
 	vec3 u_DirLightDirection;
 	float u_DirLightIntensity;
 	vec3 u_DirLightColor;
@@ -93,54 +125,134 @@ layout(std140, binding = 2) uniform LightData
 	float u_AmbientIntensity;
 	int u_NumPointLights;
 	int u_NumSpotLights;
-};
+	float _lightPadding2;
+	DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
+};
 
-struct DirectionalLight {
-    vec3 direction;
-    vec3 color;
-    float intensity;
+// Camera uniform buffer (binding = 0)
+layout(std140, binding = 0) uniform CameraData
+{
+	mat4 u_ViewProjection;
+	mat4 u_View;
+	mat4 u_Projection;
+	vec3 u_CameraPosition;
 };
 
+// Clustered point and spot lights (SSBO bindings 1-4), cone angles stored as cosines.
+// Each fragment only loops over the lights assigned to its view-space cluster.
 struct PointLight {
     vec3 position;
+    float range;
     vec3 color;
     float intensity;
-    float range;
 };
 
 struct SpotLight {
     vec3 position;
+    float range;
     vec3 direction;
-
+    float innerConeAngle;
     vec3 color;
     float intensity;
-
-    float range;
-    float innerConeAngle;
     float outerConeAngle;
 };
 
-uniform int u_DirLightCount;
-uniform DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
+struct LightCluster {
+    uint offset;
+    uint pointCount;
+    uint spotCount;
+    uint _padding0;
+};
+
+layout(std430, binding = 1) readonly buffer PointLightBuffer
+{
+	PointLight u_PointLights[];
+};
+
+layout(std430, binding = 2) readonly buffer SpotLightBuffer
+{
+	SpotLight u_SpotLights[];
+};
+
+layout(std430, binding = 3) readonly buffer LightClusterBuffer
+{
+	LightCluster u_LightClusters[];
+};
+
+layout(std430, binding = 4) readonly buffer LightIndexBuffer
+{
+	uint u_LightIndices[];
+};
 
-uniform int u_PointLightCount;
-uniform PointLight u_PointLights[MAX_POINT_LIGHTS];
+// Light cluster grid uniform buffer (binding = 6)
+layout(std140, binding = 6) uniform LightClusterGrid
+{
+	vec2 u_ClusterTileSize;
+	float u_ClusterSliceScale;
+	float u_ClusterSliceBias;
+	uvec3 u_ClusterGridSize;
+	int u_ClusterLogSlices;
+};
 
-uniform int u_SpotLightCount;
-uniform SpotLight u_SpotLights[MAX_SPOT_LIGHTS];
+uint getClusterIndex(vec2 fragCoord, float viewDepth) {
+    float d = u_ClusterLogSlices != 0 ? log(max(viewDepth, 1e-4)) : viewDepth;
+    uint slice = uint(clamp(floor(d * u_ClusterSliceScale + u_ClusterSliceBias), 0.0, float(u_ClusterGridSize.z - 1u)));
+    uvec2 tile = min(uvec2(fragCoord / u_ClusterTileSize), u_ClusterGridSize.xy - 1u);
+    return (slice * u_ClusterGridSize.y + tile.y) * u_ClusterGridSize.x + tile.x;
+}
 
-uniform bool u_UseTexture;
-uniform sampler2D u_Texture;
+// Material uniform buffer (binding = 3)
+layout(std140, binding = 3) uniform MaterialData
+{
+    vec4 albedo;
+    vec4 ambient;
+    float metallic;
+    float roughness;
+    float ao;
+    float _padding0;
+    int hasAlbedoMap;
+    int hasNormalMap;
+    int hasMetallicMap;
+    int hasRoughnessMap;
+    int hasAOMap;
+} u_Material;
+
+// Compile-time per variant, so the texture fetches of absent maps are compiled out
+#ifdef FM_ALBEDO_MAP
+const bool HAS_ALBEDO_MAP = true;
+#else
+const bool HAS_ALBEDO_MAP = false;
+#endif
+
+layout(binding = 0) uniform sampler2D u_Texture;
 
-uniform vec4 u_Kd; // diffuse
-uniform vec4 u_Ka; // ambient
 uniform bool u_FlipUV;
 
 // Shadow mapping
-uniform sampler2D u_ShadowMap;
+#define MAX_SHADOW_CASCADES 4
+
+// Shadow cascades (binding = 7); cascade i covers view depths up to u_CascadeSplits[i]
+layout(std140, binding = 7) uniform ShadowData
+{
+	mat4 u_CascadeViewProjections[MAX_SHADOW_CASCADES];
+	vec4 u_CascadeSplits;
+	vec4 u_CascadeBiasScales;
+	int u_CascadeCount;
+	int u_ShadowCascade;
+};
+uniform sampler2DArray u_ShadowMap;
 
-float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
+float calculateShadow(vec3 worldPos, float viewDepth, vec3 normal, vec3 lightDir)
 {
+    // Pick the first cascade that reaches this depth; nothing past the last one is shadowed
+    int cascade = 0;
+    while(cascade < u_CascadeCount - 1 && viewDepth > u_CascadeSplits[cascade])
+        ++cascade;
+    if(viewDepth > u_CascadeSplits[cascade])
+        return 0.0;
+
+    vec4 fragPosLightSpace = u_CascadeViewProjections[cascade] * vec4(worldPos, 1.0);
+
     // Perspective divide
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     
@@ -152,15 +264,16 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
         return 0.0;
     
     // Get closest depth value from light's perspective
-    float closestDepth = texture(u_ShadowMap, projCoords.xy).r;
+    float closestDepth = texture(u_ShadowMap, vec3(projCoords.xy, cascade)).r;
     float currentDepth = projCoords.z;
     
     // Calculate bias based on surface angle
     float bias = max(u_ShadowBias * (1.0 - dot(normal, lightDir)), u_ShadowBias * 0.1);
+    bias *= u_CascadeBiasScales[cascade];
     
     // PCF (Percentage Closer Filtering) for soft shadows
     float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(u_ShadowMap, 0);
+    vec2 texelSize = 1.0 / textureSize(u_ShadowMap, 0).xy;
     int pcfRange = int(u_ShadowSoftness);
     int sampleCount = 0;
     
@@ -168,7 +281,7 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
     {
         for(int y = -pcfRange; y <= pcfRange; ++y)
         {
-            float pcfDepth = texture(u_ShadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            float pcfDepth = texture(u_ShadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, cascade)).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
             sampleCount++;
         }
@@ -187,25 +300,25 @@ void main()
         uv.y = 1.0 - uv.y;
 
     vec3 baseColor;
-    if(u_UseTexture)
+    if(HAS_ALBEDO_MAP)
         baseColor = texture(u_Texture, uv).rgb;
     else
-        baseColor = u_Kd.rgb;
+        baseColor = u_Material.albedo.rgb;
 
     // Ambient
-    vec3 result = u_Ka.rgb * baseColor;
+    vec3 result = u_Material.ambient.rgb * baseColor;
 
     // Main directional light with shadow
     vec3 dirLightDir = normalize(-u_DirLightDirection);
     float NdotL = max(dot(normal, dirLightDir), 0.0);
     float shadow = 0.0;
     if (u_EnableShadows != 0) {
-        shadow = calculateShadow(v_FragPosLightSpace, normal, dirLightDir);
+        shadow = calculateShadow(v_WorldPos, -(u_View * vec4(v_WorldPos, 1.0)).z, normal, dirLightDir);
     }
     result += u_DirLightColor * u_DirLightIntensity * NdotL * (1.0 - shadow) * baseColor;
 
     // Additional directional lights (without shadow)
-    for(int i = 0; i < u_DirLightCount; i++)
+    for(int i = 0; i < u_NumDirLights; i++)
     {
         DirectionalLight light = u_DirLights[i];
         vec3 lightDir = normalize(-light.direction);
@@ -213,10 +326,14 @@ void main()
         result += light.color * light.intensity * NdotL * baseColor;
     }
 
+    // Lights touching this fragment's cluster
+    float viewDepth = -(u_View * vec4(v_WorldPos, 1.0)).z;
+    LightCluster cluster = u_LightClusters[getClusterIndex(gl_FragCoord.xy, viewDepth)];
+
     // Point lights
-    for(int i = 0; i < u_PointLightCount; i++)
+    for(uint i = 0u; i < cluster.pointCount; i++)
     {
-        PointLight light = u_PointLights[i];
+        PointLight light = u_PointLights[u_LightIndices[cluster.offset + i]];
 
         vec3 L = light.position - v_WorldPos;
         float distance = length(L);
@@ -236,9 +353,9 @@ void main()
     }
 
     // Spot lights
-    for(int i = 0; i < u_SpotLightCount; i++)
+    for(uint i = 0u; i < cluster.spotCount; i++)
     {
-        SpotLight light = u_SpotLights[i];
+        SpotLight light = u_SpotLights[u_LightIndices[cluster.offset + cluster.pointCount + i]];
 
         vec3 L = light.position - v_WorldPos;
         float distance = length(L);
@@ -267,6 +384,6 @@ void main()
                   baseColor;
     }
 
-    o_Color = vec4(result, u_Kd.a);
+    o_Color = vec4(result, u_Material.albedo.a);
     o_ObjectID = v_ObjectID;
 }
@@ -13,21 +13,16 @@ layout(std140, binding = 1) uniform ModelData
 	int u_ObjectID;
 };
 
-// Light uniform buffer (binding = 2)
-layout(std140, binding = 2) uniform LightData
+#define MAX_SHADOW_CASCADES 4
+
+// Shadow cascades (binding = 7); cascade i covers view depths up to u_CascadeSplits[i]
+layout(std140, binding = 7) uniform ShadowData
 {
-	mat4 u_LightSpaceMatrix;
-	vec3 u_DirLightDirection;
-	float u_DirLightIntensity;
-	vec3 u_DirLightColor;
-	float _lightPadding0;
-	float u_ShadowBias;
-	float u_ShadowSoftness;
-	int u_EnableShadows;
-	float _lightPadding1;
-	float u_AmbientIntensity;
-	int u_NumPointLights;
-	int u_NumSpotLights;
+	mat4 u_CascadeViewProjections[MAX_SHADOW_CASCADES];
+	vec4 u_CascadeSplits;
+	vec4 u_CascadeBiasScales;
+	int u_CascadeCount;
+	int u_ShadowCascade;
 };
 
 // Bone uniform buffer (binding = 4)
@@ -52,7 +47,7 @@ void main() {
     }
 
     vec4 skinnedPos = skinMatrix * vec4(a_Position, 1.0);
-    gl_Position = u_LightSpaceMatrix * u_Model * skinnedPos;
+    gl_Position = u_CascadeViewProjections[u_ShadowCascade] * u_Model * skinnedPos;
 }
 
 #type fragment
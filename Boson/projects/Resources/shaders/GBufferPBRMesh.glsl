@@ -1,5 +1,8 @@
+#pragma multi_compile FM_ALBEDO_MAP FM_NORMAL_MAP FM_METALLIC_MAP FM_ROUGHNESS_MAP FM_AO_MAP
+
 #type vertex
 #version 450 core
+#extension GL_ARB_shader_draw_parameters : enable
 
 layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec3 a_Normal;
@@ -17,13 +20,30 @@ layout(std140, binding = 0) uniform CameraData
 	vec3 u_CameraPosition;
 };
 
-// Model uniform buffer (binding = 1)
-layout(std140, binding = 1) uniform ModelData
+// Per-instance model data (SSBO binding = 0), indexed from the draw's base instance
+struct InstanceData
+{
+	mat4 model;
+	mat4 normalMatrix;
+	int objectID;
+};
+
+layout(std430, binding = 0) readonly buffer InstanceBuffer
+{
+	InstanceData u_Instances[];
+};
+
+// Where the draw's instances start: straight from the draw where the driver has shader draw parameters,
+// otherwise written by the renderer before each draw (binding = 5)
+#ifdef GL_ARB_shader_draw_parameters
+#define FM_BASE_INSTANCE gl_BaseInstanceARB
+#else
+layout(std140, binding = 5) uniform DrawParameters
 {
-	mat4 u_Model;
-	mat4 u_NormalMatrix;
-	int u_ObjectID;
+	int u_BaseInstance;
 };
+#define FM_BASE_INSTANCE u_BaseInstance
+#endif
 
 out vec3 v_WorldPos;
 out vec3 v_Normal;
@@ -32,15 +52,16 @@ flat out int v_ObjectID;
 
 void main()
 {
-    vec4 worldPos = u_Model * vec4(a_Position, 1.0);
+    InstanceData instance = u_Instances[FM_BASE_INSTANCE + gl_InstanceID];
+    vec4 worldPos = instance.model * vec4(a_Position, 1.0);
     v_WorldPos = worldPos.xyz;
 
-    // Use precomputed normal matrix from UBO
-    mat3 normalMatrix = mat3(u_NormalMatrix);
+    // Use precomputed normal matrix from the instance data
+    mat3 normalMatrix = mat3(instance.normalMatrix);
     v_Normal = normalize(normalMatrix * a_Normal);
 
     v_TexCoords = a_TexCoords;
-    v_ObjectID = u_ObjectID;
+    v_ObjectID = instance.objectID;
 
     gl_Position = u_ViewProjection * worldPos;
 }
@@ -59,32 +80,57 @@ in vec3 v_Normal;
 in vec2 v_TexCoords;
 flat in int v_ObjectID;
 
-struct Material
+// Material uniform buffer (binding = 3)
+layout(std140, binding = 3) uniform MaterialData
 {
-    vec3 albedo;
+    vec4 albedo;
+    vec4 ambient;
     float metallic;
     float roughness;
     float ao;
-};
-
-uniform Material u_Material;
-
-uniform bool u_UseAlbedoMap;
-uniform sampler2D u_AlbedoMap;
-
-uniform bool u_UseNormalMap;
-uniform sampler2D u_NormalMap;
+    float _padding0;
+    int hasAlbedoMap;
+    int hasNormalMap;
+    int hasMetallicMap;
+    int hasRoughnessMap;
+    int hasAOMap;
+} u_Material;
+
+// Compile-time per variant, so the texture fetches of absent maps are compiled out
+#ifdef FM_ALBEDO_MAP
+const bool HAS_ALBEDO_MAP = true;
+#else
+const bool HAS_ALBEDO_MAP = false;
+#endif
+#ifdef FM_NORMAL_MAP
+const bool HAS_NORMAL_MAP = true;
+#else
+const bool HAS_NORMAL_MAP = false;
+#endif
+#ifdef FM_METALLIC_MAP
+const bool HAS_METALLIC_MAP = true;
+#else
+const bool HAS_METALLIC_MAP = false;
+#endif
+#ifdef FM_ROUGHNESS_MAP
+const bool HAS_ROUGHNESS_MAP = true;
+#else
+const bool HAS_ROUGHNESS_MAP = false;
+#endif
+#ifdef FM_AO_MAP
+const bool HAS_AO_MAP = true;
+#else
+const bool HAS_AO_MAP = false;
+#endif
+
+layout(binding = 0) uniform sampler2D u_AlbedoMap;
+layout(binding = 1) uniform sampler2D u_NormalMap;
 uniform float u_NormalStrength;
 uniform float u_ToksvigStrength;
 
-uniform bool u_UseMetallicMap;
-uniform sampler2D u_MetallicMap;
-
-uniform bool u_UseRoughnessMap;
-uniform sampler2D u_RoughnessMap;
-
-uniform bool u_UseAOMap;
-uniform sampler2D u_AOMap;
+layout(binding = 2) uniform sampler2D u_MetallicMap;
+layout(binding = 3) uniform sampler2D u_RoughnessMap;
+layout(binding = 4) uniform sampler2D u_AOMap;
 
 uniform bool u_FlipUV;
 
@@ -93,7 +139,7 @@ vec3 getNormalFromMap(vec2 uv, out float normalVariance, out float normalLength)
     normalVariance = 0.0;
     normalLength = 1.0;
 
-    if (!u_UseNormalMap)
+    if (!HAS_NORMAL_MAP)
         return normalize(v_Normal);
 
     vec3 tangentNormal = texture(u_NormalMap, uv).xyz * 2.0 - 1.0;
@@ -124,20 +170,20 @@ void main()
     if (u_FlipUV)
         uv.y = 1.0 - uv.y;
 
-    vec3 baseColorLinear = pow(u_Material.albedo, vec3(2.2));
-    vec3 texColorLinear = u_UseAlbedoMap ? pow(texture(u_AlbedoMap, uv).rgb, vec3(2.2)) : vec3(1.0);
+    vec3 baseColorLinear = pow(u_Material.albedo.rgb, vec3(2.2));
+    vec3 texColorLinear = HAS_ALBEDO_MAP ? pow(texture(u_AlbedoMap, uv).rgb, vec3(2.2)) : vec3(1.0);
     vec3 albedo = texColorLinear * baseColorLinear;
 
-    float metallic = u_UseMetallicMap ? texture(u_MetallicMap, uv).r : u_Material.metallic;
-    float roughness = u_UseRoughnessMap ? texture(u_RoughnessMap, uv).r : u_Material.roughness;
-    float ao = u_UseAOMap ? texture(u_AOMap, uv).r : u_Material.ao;
+    float metallic = HAS_METALLIC_MAP ? texture(u_MetallicMap, uv).r : u_Material.metallic;
+    float roughness = HAS_ROUGHNESS_MAP ? texture(u_RoughnessMap, uv).r : u_Material.roughness;
+    float ao = HAS_AO_MAP ? texture(u_AOMap, uv).r : u_Material.ao;
 
     float normalVariance;
     float normalLength;
     vec3 normal = getNormalFromMap(uv, normalVariance, normalLength);
 
     float roughnessAA = clamp(roughness, 0.04, 1.0);
-    if (u_UseNormalMap)
+    if (HAS_NORMAL_MAP)
     {
         float kernelRoughness = min(2.0 * normalVariance, 1.0);
         float tokvsig = clamp(1.0 - normalLength, 0.0, 1.0);
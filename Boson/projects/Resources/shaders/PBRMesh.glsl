@@ -1,5 +1,8 @@
+#pragma multi_compile FM_ALBEDO_MAP FM_NORMAL_MAP FM_METALLIC_MAP FM_ROUGHNESS_MAP FM_AO_MAP
+
 #type vertex
 #version 450 core
+#extension GL_ARB_shader_draw_parameters : enable
 
 layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec3 a_Normal;
@@ -17,18 +20,43 @@ layout(std140, binding = 0) uniform CameraData
 	vec3 u_CameraPosition;
 };
 
-// Model uniform buffer (binding = 1)
-layout(std140, binding = 1) uniform ModelData
+// Per-instance model data (SSBO binding = 0), indexed from the draw's base instance
+struct InstanceData
 {
-	mat4 u_Model;
-	mat4 u_NormalMatrix;
-	int u_ObjectID;
+	mat4 model;
+	mat4 normalMatrix;
+	int objectID;
+};
+
+layout(std430, binding = 0) readonly buffer InstanceBuffer
+{
+	InstanceData u_Instances[];
+};
+
+// Where the draw's instances start: straight from the draw where the driver has shader draw parameters,
+// otherwise written by the renderer before each draw (binding = 5)
+#ifdef GL_ARB_shader_draw_parameters
+#define FM_BASE_INSTANCE gl_BaseInstanceARB
+#else
+layout(std140, binding = 5) uniform DrawParameters
+{
+	int u_BaseInstance;
+};
+#define FM_BASE_INSTANCE u_BaseInstance
+#endif
+
+#define MAX_DIR_LIGHTS 4
+
+struct DirectionalLight {
+    vec3 direction;
+    float intensity;
+    vec3 color;
+    float _padding0;
 };
 
 // Light uniform buffer (binding = 2)
 layout(std140, binding = 2) uniform LightData
 {
-	mat4 u_LightSpaceMatrix;
 	vec3 u_DirLightDirection;
 	float u_DirLightIntensity;
 	vec3 u_DirLightColor;
@@ -40,22 +68,24 @@ layout(std140, binding = 2) uniform LightData
 	float u_AmbientIntensity;
 	int u_NumPointLights;
 	int u_NumSpotLights;
+	float _lightPadding2;
+	DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
 };
 
 out vec3 v_WorldPos;
 out vec3 v_Normal;
 out vec4 v_Color;
 out vec2 v_TexCoords;
-out vec4 v_FragPosLightSpace;
 out mat3 v_TBN;
 flat out int v_ObjectID;
 
 void main() {
-    vec4 worldPos = u_Model * vec4(a_Position, 1.0);
+    InstanceData instance = u_Instances[FM_BASE_INSTANCE + gl_InstanceID];
+    vec4 worldPos = instance.model * vec4(a_Position, 1.0);
     v_WorldPos = worldPos.xyz;
 
-    // Use precomputed normal matrix from UBO
-    mat3 normalMatrix = mat3(u_NormalMatrix);
+    // Use precomputed normal matrix from the instance data
+    mat3 normalMatrix = mat3(instance.normalMatrix);
     v_Normal = normalize(normalMatrix * a_Normal);
 
     // Build TBN matrix for normal mapping
@@ -68,8 +98,7 @@ void main() {
 
     v_Color = a_Color;
     v_TexCoords = a_TexCoords;
-    v_FragPosLightSpace = u_LightSpaceMatrix * worldPos;
-    v_ObjectID = u_ObjectID;
+    v_ObjectID = instance.objectID;
 
     gl_Position = u_ViewProjection * worldPos;
 }
@@ -84,7 +113,6 @@ in vec3 v_WorldPos;
 in vec3 v_Normal;
 in vec4 v_Color;
 in vec2 v_TexCoords;
-in vec4 v_FragPosLightSpace;
 in mat3 v_TBN;
 flat in int v_ObjectID;
 
@@ -94,8 +122,6 @@ const float F0_NON_METAL = 0.04;
 const float MIN_ROUGHNESS = 0.045;  // 避免高光过于尖锐
 
 #define MAX_DIR_LIGHTS 4
-#define MAX_POINT_LIGHTS 16
-#define MAX_SPOT_LIGHTS 16
 
 // 优化的数学函数
 float pow5(float x) {
@@ -125,10 +151,16 @@ layout(std140, binding = 0) uniform CameraData
 	vec3 u_CameraPosition;
 };
 
+struct DirectionalLight {
+    vec3 direction;
+    float intensity;
+    vec3 color;
+    float _padding0;
+};
+
 // Light uniform buffer (binding = 2)
 layout(std140, binding = 2) uniform LightData
 {
-	mat4 u_LightSpaceMatrix;
 	vec3 u_DirLightDirection;
 	float u_DirLightIntensity;
 	vec3 u_DirLightColor;
@@ -140,42 +172,74 @@ layout(std140, binding = 2) uniform LightData
 	float u_AmbientIntensity;
 	int u_NumPointLights;
 	int u_NumSpotLights;
+	float _lightPadding2;
+	DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
 };
 
 // 光源结构
-struct DirectionalLight {
-    vec3 direction;
-    vec3 color;
-    float intensity;
-};
-
+// Clustered point and spot lights (SSBO bindings 1-4), cone angles stored as cosines.
+// Each fragment only loops over the lights assigned to its view-space cluster.
 struct PointLight {
     vec3 position;
+    float range;
     vec3 color;
     float intensity;
-    float range;
 };
 
 struct SpotLight {
     vec3 position;
+    float range;
     vec3 direction;
-
+    float innerConeAngle;
     vec3 color;
     float intensity;
-
-    float range;
-    float innerConeAngle;
     float outerConeAngle;
 };
 
-// PBR材质参数
-struct Material {
-    vec3 albedo;
-    float metallic;
-    float roughness;
-    float ao;
+struct LightCluster {
+    uint offset;
+    uint pointCount;
+    uint spotCount;
+    uint _padding0;
+};
+
+layout(std430, binding = 1) readonly buffer PointLightBuffer
+{
+	PointLight u_PointLights[];
+};
+
+layout(std430, binding = 2) readonly buffer SpotLightBuffer
+{
+	SpotLight u_SpotLights[];
+};
+
+layout(std430, binding = 3) readonly buffer LightClusterBuffer
+{
+	LightCluster u_LightClusters[];
+};
+
+layout(std430, binding = 4) readonly buffer LightIndexBuffer
+{
+	uint u_LightIndices[];
 };
 
+// Light cluster grid uniform buffer (binding = 6)
+layout(std140, binding = 6) uniform LightClusterGrid
+{
+	vec2 u_ClusterTileSize;
+	float u_ClusterSliceScale;
+	float u_ClusterSliceBias;
+	uvec3 u_ClusterGridSize;
+	int u_ClusterLogSlices;
+};
+
+uint getClusterIndex(vec2 fragCoord, float viewDepth) {
+    float d = u_ClusterLogSlices != 0 ? log(max(viewDepth, 1e-4)) : viewDepth;
+    uint slice = uint(clamp(floor(d * u_ClusterSliceScale + u_ClusterSliceBias), 0.0, float(u_ClusterGridSize.z - 1u)));
+    uvec2 tile = min(uvec2(fragCoord / u_ClusterTileSize), u_ClusterGridSize.xy - 1u);
+    return (slice * u_ClusterGridSize.y + tile.y) * u_ClusterGridSize.x + tile.x;
+}
+
 // ============================================================================
 // 高级材质参数
 // ============================================================================
@@ -196,40 +260,74 @@ uniform vec3 u_SubsurfaceColor;      // 次表面散射颜色
 uniform float u_SubsurfacePower;     // 散射指数
 uniform float u_Thickness;           // 材质厚度 [0, 1]，0=完全不透光
 
-// Uniforms
-uniform int u_DirLightCount;
-uniform DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
-
-uniform int u_PointLightCount;
-uniform PointLight u_PointLights[MAX_POINT_LIGHTS];
-
-uniform int u_SpotLightCount;
-uniform SpotLight u_SpotLights[MAX_SPOT_LIGHTS];
-
-uniform Material u_Material;
+// Material uniform buffer (binding = 3)
+layout(std140, binding = 3) uniform MaterialData
+{
+    vec4 albedo;
+    vec4 ambient;
+    float metallic;
+    float roughness;
+    float ao;
+    float _padding0;
+    int hasAlbedoMap;
+    int hasNormalMap;
+    int hasMetallicMap;
+    int hasRoughnessMap;
+    int hasAOMap;
+} u_Material;
+
+// Compile-time per variant, so the texture fetches of absent maps are compiled out
+#ifdef FM_ALBEDO_MAP
+const bool HAS_ALBEDO_MAP = true;
+#else
+const bool HAS_ALBEDO_MAP = false;
+#endif
+#ifdef FM_NORMAL_MAP
+const bool HAS_NORMAL_MAP = true;
+#else
+const bool HAS_NORMAL_MAP = false;
+#endif
+#ifdef FM_METALLIC_MAP
+const bool HAS_METALLIC_MAP = true;
+#else
+const bool HAS_METALLIC_MAP = false;
+#endif
+#ifdef FM_ROUGHNESS_MAP
+const bool HAS_ROUGHNESS_MAP = true;
+#else
+const bool HAS_ROUGHNESS_MAP = false;
+#endif
+#ifdef FM_AO_MAP
+const bool HAS_AO_MAP = true;
+#else
+const bool HAS_AO_MAP = false;
+#endif
 
 // 纹理
-uniform bool u_UseAlbedoMap;
-uniform sampler2D u_AlbedoMap;
-
-uniform bool u_UseNormalMap;
-uniform sampler2D u_NormalMap;
+layout(binding = 0) uniform sampler2D u_AlbedoMap;
+layout(binding = 1) uniform sampler2D u_NormalMap;
 uniform float u_NormalStrength;
 uniform float u_ToksvigStrength;
 
-uniform bool u_UseMetallicMap;
-uniform sampler2D u_MetallicMap;
-
-uniform bool u_UseRoughnessMap;
-uniform sampler2D u_RoughnessMap;
-
-uniform bool u_UseAOMap;
-uniform sampler2D u_AOMap;
+layout(binding = 2) uniform sampler2D u_MetallicMap;
+layout(binding = 3) uniform sampler2D u_RoughnessMap;
+layout(binding = 4) uniform sampler2D u_AOMap;
 
 uniform bool u_FlipUV;
 
 // Shadow mapping
-uniform sampler2D u_ShadowMap;
+#define MAX_SHADOW_CASCADES 4
+
+// Shadow cascades (binding = 7); cascade i covers view depths up to u_CascadeSplits[i]
+layout(std140, binding = 7) uniform ShadowData
+{
+	mat4 u_CascadeViewProjections[MAX_SHADOW_CASCADES];
+	vec4 u_CascadeSplits;
+	vec4 u_CascadeBiasScales;
+	int u_CascadeCount;
+	int u_ShadowCascade;
+};
+uniform sampler2DArray u_ShadowMap;
 
 // IBL
 uniform bool u_UseIBL;
@@ -427,7 +525,15 @@ vec3 subsurfaceLobe(vec3 N, vec3 V, vec3 L, vec3 subsurfaceColor,
 }
 
 // 阴影计算
-float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
+float calculateShadow(vec3 worldPos, float viewDepth, vec3 normal, vec3 lightDir) {
+    // Pick the first cascade that reaches this depth; nothing past the last one is shadowed
+    int cascade = 0;
+    while(cascade < u_CascadeCount - 1 && viewDepth > u_CascadeSplits[cascade])
+        ++cascade;
+    if(viewDepth > u_CascadeSplits[cascade])
+        return 0.0;
+
+    vec4 fragPosLightSpace = u_CascadeViewProjections[cascade] * vec4(worldPos, 1.0);
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
 
@@ -435,19 +541,20 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
         projCoords.y < 0.0 || projCoords.y > 1.0)
         return 0.0;
 
-    float closestDepth = texture(u_ShadowMap, projCoords.xy).r;
+    float closestDepth = texture(u_ShadowMap, vec3(projCoords.xy, cascade)).r;
     float currentDepth = projCoords.z;
 
     float bias = max(u_ShadowBias * (1.0 - dot(normal, lightDir)), u_ShadowBias * 0.1);
+    bias *= u_CascadeBiasScales[cascade];
 
     float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(u_ShadowMap, 0);
+    vec2 texelSize = 1.0 / textureSize(u_ShadowMap, 0).xy;
     int pcfRange = int(u_ShadowSoftness);
     int sampleCount = 0;
 
     for(int x = -pcfRange; x <= pcfRange; ++x) {
         for(int y = -pcfRange; y <= pcfRange; ++y) {
-            float pcfDepth = texture(u_ShadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            float pcfDepth = texture(u_ShadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, cascade)).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
             sampleCount++;
         }
@@ -459,7 +566,7 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
 
 // 获取法线使用导数计算TBN
 vec3 getNormalFromMap(out float normalVariance) {
-    if(!u_UseNormalMap) {
+    if(!HAS_NORMAL_MAP) {
         normalVariance = 0.0;
         return normalize(v_Normal);
     }
@@ -584,12 +691,12 @@ void main() {
         uv.y = 1.0 - uv.y;
 
     // 获取材质属性
-    vec3 baseColorLinear = pow(u_Material.albedo, vec3(2.2));
-    vec3 texColorLinear = u_UseAlbedoMap ? pow(texture(u_AlbedoMap, uv).rgb, vec3(2.2)) : vec3(1.0);
+    vec3 baseColorLinear = pow(u_Material.albedo.rgb, vec3(2.2));
+    vec3 texColorLinear = HAS_ALBEDO_MAP ? pow(texture(u_AlbedoMap, uv).rgb, vec3(2.2)) : vec3(1.0);
     vec3 albedo = texColorLinear * baseColorLinear;
-    float metallic = u_UseMetallicMap ? texture(u_MetallicMap, uv).r : u_Material.metallic;
-    float roughness = u_UseRoughnessMap ? texture(u_RoughnessMap, uv).r : u_Material.roughness;
-    float ao = u_UseAOMap ? texture(u_AOMap, uv).r : u_Material.ao;
+    float metallic = HAS_METALLIC_MAP ? texture(u_MetallicMap, uv).r : u_Material.metallic;
+    float roughness = HAS_ROUGHNESS_MAP ? texture(u_RoughnessMap, uv).r : u_Material.roughness;
+    float ao = HAS_AO_MAP ? texture(u_AOMap, uv).r : u_Material.ao;
 
     // 获取法线
     float normalVariance;
@@ -615,7 +722,7 @@ void main() {
 
     // ================= Specular Anti-Aliasing =================
     float roughnessAA = clamp(roughness, 0.04, 1.0);
-    if(u_UseNormalMap) {
+    if(HAS_NORMAL_MAP) {
         float variance = normalVariance;
         float kernelRoughness = min(2.0 * variance, 1.0);
         float normalLength = length(texture(u_NormalMap, uv).xyz * 2.0 - 1.0);
@@ -639,7 +746,7 @@ void main() {
 
         float shadow = 0.0;
         if(u_EnableShadows != 0) {
-            shadow = calculateShadow(v_FragPosLightSpace, N, L);
+            shadow = calculateShadow(v_WorldPos, -(u_View * vec4(v_WorldPos, 1.0)).z, N, L);
         }
 
         Lo += evaluateLighting(N, V, L, T, B, albedo, roughness, metallic, F0, NoV, radiance, 1.0 - shadow);
@@ -648,7 +755,7 @@ void main() {
     // ========================================================================
     // 额外方向光（无阴影）
     // ========================================================================
-    for(int i = 0; i < u_DirLightCount; i++) {
+    for(int i = 0; i < u_NumDirLights; i++) {
         DirectionalLight light = u_DirLights[i];
         vec3 L = normalize(-light.direction);
         vec3 radiance = light.color * light.intensity;
@@ -656,11 +763,15 @@ void main() {
         Lo += evaluateLighting(N, V, L, T, B, albedo, roughness, metallic, F0, NoV, radiance, 1.0);
     }
 
+    // Lights touching this fragment's cluster
+    float viewDepth = -(u_View * vec4(v_WorldPos, 1.0)).z;
+    LightCluster cluster = u_LightClusters[getClusterIndex(gl_FragCoord.xy, viewDepth)];
+
     // ========================================================================
     // 点光源
     // ========================================================================
-    for(int i = 0; i < u_PointLightCount; i++) {
-        PointLight light = u_PointLights[i];
+    for(uint i = 0u; i < cluster.pointCount; i++) {
+        PointLight light = u_PointLights[u_LightIndices[cluster.offset + i]];
 
         vec3 L = light.position - v_WorldPos;
         float lightDist = length(L);
@@ -682,8 +793,8 @@ void main() {
     // ========================================================================
     // 聚光灯
     // ========================================================================
-    for(int i = 0; i < u_SpotLightCount; i++) {
-        SpotLight light = u_SpotLights[i];
+    for(uint i = 0u; i < cluster.spotCount; i++) {
+        SpotLight light = u_SpotLights[u_LightIndices[cluster.offset + cluster.pointCount + i]];
 
         vec3 L = light.position - v_WorldPos;
         float lightDist = length(L);
@@ -1,35 +1,49 @@
 #type vertex
 #version 450 core
+#extension GL_ARB_shader_draw_parameters : enable
 
 layout(location = 0) in vec3 a_Position;
 
-// Model uniform buffer (binding = 1)
-layout(std140, binding = 1) uniform ModelData
+// Per-instance model data (SSBO binding = 0), indexed from the draw's base instance
+struct InstanceData
 {
-	mat4 u_Model;
-	mat4 u_NormalMatrix;
-	int u_ObjectID;
+	mat4 model;
+	mat4 normalMatrix;
+	int objectID;
 };
 
-// Light uniform buffer (binding = 2)
-layout(std140, binding = 2) uniform LightData
+layout(std430, binding = 0) readonly buffer InstanceBuffer
 {
-	mat4 u_LightSpaceMatrix;
-	vec3 u_DirLightDirection;
-	float u_DirLightIntensity;
-	vec3 u_DirLightColor;
-	float _lightPadding0;
-	float u_ShadowBias;
-	float u_ShadowSoftness;
-	int u_EnableShadows;
-	float _lightPadding1;
-	float u_AmbientIntensity;
-	int u_NumPointLights;
-	int u_NumSpotLights;
+	InstanceData u_Instances[];
+};
+
+// Where the draw's instances start: straight from the draw where the driver has shader draw parameters,
+// otherwise written by the renderer before each draw (binding = 5)
+#ifdef GL_ARB_shader_draw_parameters
+#define FM_BASE_INSTANCE gl_BaseInstanceARB
+#else
+layout(std140, binding = 5) uniform DrawParameters
+{
+	int u_BaseInstance;
+};
+#define FM_BASE_INSTANCE u_BaseInstance
+#endif
+
+#define MAX_SHADOW_CASCADES 4
+
+// Shadow cascades (binding = 7); cascade i covers view depths up to u_CascadeSplits[i]
+layout(std140, binding = 7) uniform ShadowData
+{
+	mat4 u_CascadeViewProjections[MAX_SHADOW_CASCADES];
+	vec4 u_CascadeSplits;
+	vec4 u_CascadeBiasScales;
+	int u_CascadeCount;
+	int u_ShadowCascade;
 };
 
 void main() {
-    gl_Position = u_LightSpaceMatrix * u_Model * vec4(a_Position, 1.0);
+    InstanceData instance = u_Instances[FM_BASE_INSTANCE + gl_InstanceID];
+    gl_Position = u_CascadeViewProjections[u_ShadowCascade] * instance.model * vec4(a_Position, 1.0);
 }
 
 #type fragment
@@ -1,3 +1,5 @@
+#pragma multi_compile FM_ALBEDO_MAP FM_NORMAL_MAP FM_METALLIC_MAP FM_ROUGHNESS_MAP FM_AO_MAP
+
 #type vertex
 #version 450 core
 
@@ -25,10 +27,18 @@ layout(std140, binding = 1) uniform ModelData
 	int u_ObjectID;
 };
 
+#define MAX_DIR_LIGHTS 4
+
+struct DirectionalLight {
+    vec3 direction;
+    float intensity;
+    vec3 color;
+    float _padding0;
+};
+
 // Light uniform buffer (binding = 2)
 layout(std140, binding = 2) uniform LightData
 {
-	mat4 u_LightSpaceMatrix;
 	vec3 u_DirLightDirection;
 	float u_DirLightIntensity;
 	vec3 u_DirLightColor;
@@ -40,6 +50,8 @@ layout(std140, binding = 2) uniform LightData
 	float u_AmbientIntensity;
 	int u_NumPointLights;
 	int u_NumSpotLights;
+	float _lightPadding2;
+	DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
 };
 
 // Bone uniform buffer (binding = 4)
@@ -52,7 +64,6 @@ out vec3 v_WorldPos;
 out vec3 v_Normal;
 out vec4 v_Color;
 out vec2 v_TexCoords;
-out vec4 v_FragPosLightSpace;
 flat out int v_ObjectID;
 
 void main() {
@@ -81,7 +92,6 @@ void main() {
 
     v_Color = a_Color;
     v_TexCoords = a_TexCoords;
-    v_FragPosLightSpace = u_LightSpaceMatrix * worldPos;
     v_ObjectID = u_ObjectID;
 
     gl_Position = u_ViewProjection * worldPos;
@@ -97,7 +107,6 @@ in vec3 v_WorldPos;
 in vec3 v_Normal;
 in vec4 v_Color;
 in vec2 v_TexCoords;
-in vec4 v_FragPosLightSpace;
 flat in int v_ObjectID;
 
 const float PI = 3.14159265359;
@@ -131,10 +140,18 @@ layout(std140, binding = 0) uniform CameraData
 	vec3 u_CameraPosition;
 };
 
+#define MAX_DIR_LIGHTS 4
+
+struct DirectionalLight {
+    vec3 direction;
+    float intensity;
+    vec3 color;
+    float _padding0;
+};
+
 // Light uniform buffer (binding = 2)
 layout(std140, binding = 2) uniform LightData
 {
-	mat4 u_LightSpaceMatrix;
 	vec3 u_DirLightDirection;
 	float u_DirLightIntensity;
 	vec3 u_DirLightColor;
@@ -146,42 +163,73 @@ layout(std140, binding = 2) uniform LightData
 	float u_AmbientIntensity;
 	int u_NumPointLights;
 	int u_NumSpotLights;
+	float _lightPadding2;
+	DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
 };
 
-#define MAX_DIR_LIGHTS 4
-#define MAX_POINT_LIGHTS 16
-#define MAX_SPOT_LIGHTS 16
-
-struct DirectionalLight {
-    vec3 direction;
-    vec3 color;
-    float intensity;
-};
-
+// Clustered point and spot lights (SSBO bindings 1-4), cone angles stored as cosines.
+// Each fragment only loops over the lights assigned to its view-space cluster.
 struct PointLight {
     vec3 position;
+    float range;
     vec3 color;
     float intensity;
-    float range;
 };
 
 struct SpotLight {
     vec3 position;
+    float range;
     vec3 direction;
+    float innerConeAngle;
     vec3 color;
     float intensity;
-    float range;
-    float innerConeAngle;
     float outerConeAngle;
 };
 
-struct Material {
-    vec3 albedo;
-    float metallic;
-    float roughness;
-    float ao;
+struct LightCluster {
+    uint offset;
+    uint pointCount;
+    uint spotCount;
+    uint _padding0;
+};
+
+layout(std430, binding = 1) readonly buffer PointLightBuffer
+{
+	PointLight u_PointLights[];
+};
+
+layout(std430, binding = 2) readonly buffer SpotLightBuffer
+{
+	SpotLight u_SpotLights[];
+};
+
+layout(std430, binding = 3) readonly buffer LightClusterBuffer
+{
+	LightCluster u_LightClusters[];
+};
+
+layout(std430, binding = 4) readonly buffer LightIndexBuffer
+{
+	uint u_LightIndices[];
+};
+
+// Light cluster grid uniform buffer (binding = 6)
+layout(std140, binding = 6) uniform LightClusterGrid
+{
+	vec2 u_ClusterTileSize;
+	float u_ClusterSliceScale;
+	float u_ClusterSliceBias;
+	uvec3 u_ClusterGridSize;
+	int u_ClusterLogSlices;
 };
 
+uint getClusterIndex(vec2 fragCoord, float viewDepth) {
+    float d = u_ClusterLogSlices != 0 ? log(max(viewDepth, 1e-4)) : viewDepth;
+    uint slice = uint(clamp(floor(d * u_ClusterSliceScale + u_ClusterSliceBias), 0.0, float(u_ClusterGridSize.z - 1u)));
+    uvec2 tile = min(uvec2(fragCoord / u_ClusterTileSize), u_ClusterGridSize.xy - 1u);
+    return (slice * u_ClusterGridSize.y + tile.y) * u_ClusterGridSize.x + tile.x;
+}
+
 // Clear Coat
 uniform bool u_UseClearCoat;
 uniform float u_ClearCoat;
@@ -198,29 +246,71 @@ uniform vec3 u_SubsurfaceColor;
 uniform float u_SubsurfacePower;
 uniform float u_Thickness;
 
-uniform int u_DirLightCount;
-uniform DirectionalLight u_DirLights[MAX_DIR_LIGHTS];
-uniform int u_PointLightCount;
-uniform PointLight u_PointLights[MAX_POINT_LIGHTS];
-uniform int u_SpotLightCount;
-uniform SpotLight u_SpotLights[MAX_SPOT_LIGHTS];
-
-uniform Material u_Material;
-
-uniform bool u_UseAlbedoMap;
-uniform sampler2D u_AlbedoMap;
-uniform bool u_UseNormalMap;
-uniform sampler2D u_NormalMap;
+// Material uniform buffer (binding = 3)
+layout(std140, binding = 3) uniform MaterialData
+{
+    vec4 albedo;
+    vec4 ambient;
+    float metallic;
+    float roughness;
+    float ao;
+    float _padding0;
+    int hasAlbedoMap;
+    int hasNormalMap;
+    int hasMetallicMap;
+    int hasRoughnessMap;
+    int hasAOMap;
+} u_Material;
+
+// Compile-time per variant, so the texture fetches of absent maps are compiled out
+#ifdef FM_ALBEDO_MAP
+const bool HAS_ALBEDO_MAP = true;
+#else
+const bool HAS_ALBEDO_MAP = false;
+#endif
+#ifdef FM_NORMAL_MAP
+const bool HAS_NORMAL_MAP = true;
+#else
+const bool HAS_NORMAL_MAP = false;
+#endif
+#ifdef FM_METALLIC_MAP
+const bool HAS_METALLIC_MAP = true;
+#else
+const bool HAS_METALLIC_MAP = false;
+#endif
+#ifdef FM_ROUGHNESS_MAP
+const bool HAS_ROUGHNESS_MAP = true;
+#else
+const bool HAS_ROUGHNESS_MAP = false;
+#endif
+#ifdef FM_AO_MAP
+const bool HAS_AO_MAP = true;
+#else
+const bool HAS_AO_MAP = false;
+#endif
+
+layout(binding = 0) uniform sampler2D u_AlbedoMap;
+layout(binding = 1) uniform sampler2D u_NormalMap;
 uniform float u_NormalStrength;
 uniform float u_ToksvigStrength;
-uniform bool u_UseMetallicMap;
-uniform sampler2D u_MetallicMap;
-uniform bool u_UseRoughnessMap;
-uniform sampler2D u_RoughnessMap;
-uniform bool u_UseAOMap;
-uniform sampler2D u_AOMap;
+layout(binding = 2) uniform sampler2D u_MetallicMap;
+layout(binding = 3) uniform sampler2D u_RoughnessMap;
+layout(binding = 4) uniform sampler2D u_AOMap;
 uniform bool u_FlipUV;
-uniform sampler2D u_ShadowMap;
+
+// Shadow mapping
+#define MAX_SHADOW_CASCADES 4
+
+// Shadow cascades (binding = 7); cascade i covers view depths up to u_CascadeSplits[i]
+layout(std140, binding = 7) uniform ShadowData
+{
+	mat4 u_CascadeViewProjections[MAX_SHADOW_CASCADES];
+	vec4 u_CascadeSplits;
+	vec4 u_CascadeBiasScales;
+	int u_CascadeCount;
+	int u_ShadowCascade;
+};
+uniform sampler2DArray u_ShadowMap;
 
 // IBL
 uniform bool u_UseIBL;
@@ -352,22 +442,31 @@ vec3 subsurfaceLobe(vec3 N, vec3 V, vec3 L, vec3 subsurfaceColor,
     return subsurfaceColor * subsurface * diffuseColor * (1.0 / PI);
 }
 
-float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
+float calculateShadow(vec3 worldPos, float viewDepth, vec3 normal, vec3 lightDir) {
+    // Pick the first cascade that reaches this depth; nothing past the last one is shadowed
+    int cascade = 0;
+    while(cascade < u_CascadeCount - 1 && viewDepth > u_CascadeSplits[cascade])
+        ++cascade;
+    if(viewDepth > u_CascadeSplits[cascade])
+        return 0.0;
+
+    vec4 fragPosLightSpace = u_CascadeViewProjections[cascade] * vec4(worldPos, 1.0);
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
     if(projCoords.z > 1.0 || projCoords.x < 0.0 || projCoords.x > 1.0 ||
         projCoords.y < 0.0 || projCoords.y > 1.0)
         return 0.0;
-    float closestDepth = texture(u_ShadowMap, projCoords.xy).r;
+    float closestDepth = texture(u_ShadowMap, vec3(projCoords.xy, cascade)).r;
     float currentDepth = projCoords.z;
     float bias = max(u_ShadowBias * (1.0 - dot(normal, lightDir)), u_ShadowBias * 0.1);
+    bias *= u_CascadeBiasScales[cascade];
     float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(u_ShadowMap, 0);
+    vec2 texelSize = 1.0 / textureSize(u_ShadowMap, 0).xy;
     int pcfRange = int(u_ShadowSoftness);
     int sampleCount = 0;
     for(int x = -pcfRange; x <= pcfRange; ++x) {
         for(int y = -pcfRange; y <= pcfRange; ++y) {
-            float pcfDepth = texture(u_ShadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            float pcfDepth = texture(u_ShadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, cascade)).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
             sampleCount++;
         }
@@ -377,7 +476,7 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir) {
 }
 
 vec3 getNormalFromMap(out float normalVariance) {
-    if(!u_UseNormalMap) {
+    if(!HAS_NORMAL_MAP) {
         normalVariance = 0.0;
         return normalize(v_Normal);
     }
@@ -451,12 +550,12 @@ void main() {
     vec2 uv = v_TexCoords;
     if(u_FlipUV)
         uv.y = 1.0 - uv.y;
-    vec3 baseColorLinear = pow(u_Material.albedo, vec3(2.2));
-    vec3 texColorLinear = u_UseAlbedoMap ? pow(texture(u_AlbedoMap, uv).rgb, vec3(2.2)) : vec3(1.0);
+    vec3 baseColorLinear = pow(u_Material.albedo.rgb, vec3(2.2));
+    vec3 texColorLinear = HAS_ALBEDO_MAP ? pow(texture(u_AlbedoMap, uv).rgb, vec3(2.2)) : vec3(1.0);
     vec3 albedo = texColorLinear * baseColorLinear;
-    float metallic = u_UseMetallicMap ? texture(u_MetallicMap, uv).r : u_Material.metallic;
-    float roughness = u_UseRoughnessMap ? texture(u_RoughnessMap, uv).r : u_Material.roughness;
-    float ao = u_UseAOMap ? texture(u_AOMap, uv).r : u_Material.ao;
+    float metallic = HAS_METALLIC_MAP ? texture(u_MetallicMap, uv).r : u_Material.metallic;
+    float roughness = HAS_ROUGHNESS_MAP ? texture(u_RoughnessMap, uv).r : u_Material.roughness;
+    float ao = HAS_AO_MAP ? texture(u_AOMap, uv).r : u_Material.ao;
     float normalVariance;
     vec3 N = getNormalFromMap(normalVariance);
     vec3 V = normalize(u_CameraPosition - v_WorldPos);
@@ -488,7 +587,7 @@ void main() {
     N = normalize(mix(N_geom, N, normalWeight));
     NoV = max(dot(N, V), 1e-4);
     float roughnessAA = clamp(roughness, 0.04, 1.0);
-    if(u_UseNormalMap) {
+    if(HAS_NORMAL_MAP) {
         float variance = normalVariance;
         float kernelRoughness = min(2.0 * variance, 1.0);
         float normalLength = length(texture(u_NormalMap, uv).xyz * 2.0 - 1.0);
@@ -503,18 +602,22 @@ void main() {
         vec3 radiance = u_DirLightColor * u_DirLightIntensity;
         float shadow = 0.0;
         if(u_EnableShadows != 0) {
-            shadow = calculateShadow(v_FragPosLightSpace, N, L);
+            shadow = calculateShadow(v_WorldPos, -(u_View * vec4(v_WorldPos, 1.0)).z, N, L);
         }
         Lo += evaluateLighting(N, V, L, T, B, albedo, roughness, metallic, F0, NoV, radiance, 1.0 - shadow);
     }
-    for(int i = 0; i < u_DirLightCount; i++) {
+    for(int i = 0; i < u_NumDirLights; i++) {
         DirectionalLight light = u_DirLights[i];
         vec3 L = normalize(-light.direction);
         vec3 radiance = light.color * light.intensity;
         Lo += evaluateLighting(N, V, L, T, B, albedo, roughness, metallic, F0, NoV, radiance, 1.0);
     }
-    for(int i = 0; i < u_PointLightCount; i++) {
-        PointLight light = u_PointLights[i];
+    // Lights touching this fragment's cluster
+    float viewDepth = -(u_View * vec4(v_WorldPos, 1.0)).z;
+    LightCluster cluster = u_LightClusters[getClusterIndex(gl_FragCoord.xy, viewDepth)];
+
+    for(uint i = 0u; i < cluster.pointCount; i++) {
+        PointLight light = u_PointLights[u_LightIndices[cluster.offset + i]];
         vec3 L = light.position - v_WorldPos;
         float lightDist = length(L);
         if(lightDist > light.range) continue;
@@ -525,8 +628,8 @@ void main() {
         vec3 radiance = light.color * light.intensity * attenuation;
         Lo += evaluateLighting(N, V, L, T, B, albedo, roughness, metallic, F0, NoV, radiance, 1.0);
     }
-    for(int i = 0; i < u_SpotLightCount; i++) {
-        SpotLight light = u_SpotLights[i];
+    for(uint i = 0u; i < cluster.spotCount; i++) {
+        SpotLight light = u_SpotLights[u_LightIndices[cluster.offset + cluster.pointCount + i]];
         vec3 L = light.position - v_WorldPos;
         float lightDist = length(L);
         if(lightDist > light.range) continue;
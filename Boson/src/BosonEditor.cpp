@@ -98,6 +98,7 @@ namespace Fermion
         spec.windowHeight = 900;
         spec.maximized = true;
         spec.rendererConfig.ShaderPath = "../Boson/Resources/Shaders/";
+        spec.rendererConfig.ShaderCachePath = "ShaderCache/";
         Log::Info("start preparing to create the Application");
         return new Fermion::Bonson(spec, projectPath);
     }
@@ -244,6 +244,7 @@ namespace Fermion
             // Settings panel
             SettingsPanel::Context settingsCtx{
                 .viewportRenderer = m_viewportRenderer,
+                .activeScene = m_activeScene,
                 .editorCamera = &m_editorCamera,
                 .hoveredEntity = m_viewportPanel.getHoveredEntity(),
                 .viewportFocused = m_viewportPanel.isViewportFocused(),
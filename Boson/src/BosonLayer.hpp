@@ -13,6 +13,7 @@
 #include "Panels/OverlayRenderPanel.hpp"
 
 #include "Renderer/Renderers/SceneRenderer.hpp"
+#include "Scene/SceneSnapshot.hpp"
 
 #include <filesystem>
 #include <glm/gtc/type_ptr.hpp>
@@ -54,6 +55,7 @@ namespace Fermion
         void createScene3D();
         void saveSceneAs();
         void saveScene();
+        void exportRuntimeScene();
         void openScene();
         void openScene(const std::filesystem::path &path);
 
@@ -100,6 +102,8 @@ namespace Fermion
 
         SceneState m_sceneState = SceneState::Edit;
         std::shared_ptr<Scene> m_activeScene, m_editorScene, m_runtimeScene;
+        // Edit-mode state of m_editorScene while it plays
+        SceneSnapshot m_sceneSnapshot;
         std::unique_ptr<Texture2D> m_iconStop, m_iconPlay, m_iconPause, m_iconStep, m_iconSimulate;
         std::filesystem::path m_editorScenePath;
         AssetHandle m_editorSceneHandle{};
@@ -14,6 +14,9 @@ namespace Fermion
 
     void BosonLayer::createScene2D()
     {
+        if (m_sceneState != SceneState::Edit)
+            onSceneStop();
+
         m_activeScene = std::make_shared<Scene>();
         m_activeScene->onViewportResize(static_cast<uint32_t>(m_viewportPanel.getViewportSize().x),
                                         static_cast<uint32_t>(m_viewportPanel.getViewportSize().y));
@@ -40,6 +43,9 @@ namespace Fermion
 
     void BosonLayer::createScene3D()
     {
+        if (m_sceneState != SceneState::Edit)
+            onSceneStop();
+
         m_activeScene = std::make_shared<Scene>();
         m_activeScene->onViewportResize(static_cast<uint32_t>(m_viewportPanel.getViewportSize().x),
                                         static_cast<uint32_t>(m_viewportPanel.getViewportSize().y));
@@ -62,6 +68,13 @@ namespace Fermion
 
     void BosonLayer::saveSceneAs()
     {
+        // The editor scene holds play-mode state until stop restores it
+        if (m_sceneState != SceneState::Edit)
+        {
+            Log::Warn("Stop the scene before saving");
+            return;
+        }
+
         std::string defaultDir = "../Boson/assets/scenes/";
         if (auto project = Project::getActive())
         {
@@ -90,6 +103,12 @@ namespace Fermion
     }
     void BosonLayer::saveScene()
     {
+        if (m_sceneState != SceneState::Edit)
+        {
+            Log::Warn("Stop the scene before saving");
+            return;
+        }
+
         if (!m_editorScenePath.empty())
         {
             SceneSerializer serializer(m_editorScene);
@@ -110,6 +129,29 @@ namespace Fermion
         }
     }
 
+    void BosonLayer::exportRuntimeScene()
+    {
+        if (m_sceneState != SceneState::Edit)
+        {
+            Log::Warn("Stop the scene before exporting");
+            return;
+        }
+
+        if (m_editorScenePath.empty())
+        {
+            Log::Warn("Save the scene before exporting it for the runtime");
+            return;
+        }
+
+        // Written next to the .fmscene; Neutrino picks it up when it is at least as new
+        std::filesystem::path runtimePath = m_editorScenePath;
+        runtimePath.replace_extension(".fmrscene");
+
+        SceneSerializer serializer(m_editorScene);
+        syncEnvironmentSettingsToScene();
+        serializer.serializeRuntime(runtimePath);
+    }
+
     void BosonLayer::openScene()
     {
         std::string defaultDir = "../Boson/assets/scenes/";
@@ -185,7 +227,9 @@ namespace Fermion
             onSceneStop();
         m_sceneState = SceneState::Play;
 
-        m_activeScene = Scene::copy(m_editorScene);
+        // Play in place; stopping restores the snapshot instead of rebuilding the scene
+        m_sceneSnapshot.capture(*m_editorScene);
+        m_activeScene = m_editorScene;
         m_activeScene->onRuntimeStart();
         m_sceneHierarchyPanel.setEditingEnabled(false);
         m_viewportRenderer->setScene(m_activeScene);
@@ -197,7 +241,8 @@ namespace Fermion
         if (m_sceneState == SceneState::Play)
             onSceneStop();
         m_sceneState = SceneState::Simulate;
-        m_activeScene = Scene::copy(m_editorScene);
+        m_sceneSnapshot.capture(*m_editorScene);
+        m_activeScene = m_editorScene;
         m_activeScene->onSimulationStart();
         m_sceneHierarchyPanel.setEditingEnabled(false);
         m_viewportRenderer->setScene(m_activeScene);
@@ -210,6 +255,8 @@ namespace Fermion
             m_activeScene->onRuntimeStop();
         else if (m_sceneState == SceneState::Simulate)
             m_activeScene->onSimulationStop();
+        if (m_sceneSnapshot.isValid())
+            m_sceneSnapshot.restore(*m_editorScene);
 
         m_sceneState = SceneState::Edit;
         m_activeScene = m_editorScene;
@@ -231,6 +278,11 @@ namespace Fermion
         sceneEnv.shadowMapSize = rendererEnv.shadowMapSize;
         sceneEnv.shadowBias = rendererEnv.shadowBias;
         sceneEnv.shadowSoftness = rendererEnv.shadowSoftness;
+        sceneEnv.shadowCascadeCount = rendererEnv.shadowCascadeCount;
+        sceneEnv.shadowCascadeSplitLambda = rendererEnv.shadowCascadeSplitLambda;
+        sceneEnv.shadowDistance = rendererEnv.shadowDistance;
+        sceneEnv.shadowStaticCache = rendererEnv.shadowStaticCache;
+        sceneEnv.shadowCacheUpdateBudget = rendererEnv.shadowCacheUpdateBudget;
         sceneEnv.normalMapStrength = rendererEnv.normalMapStrength;
         sceneEnv.toksvigStrength = rendererEnv.toksvigStrength;
         sceneEnv.useIBL = rendererEnv.useIBL;
@@ -248,6 +300,11 @@ namespace Fermion
         rendererEnv.shadowMapSize = sceneEnv.shadowMapSize;
         rendererEnv.shadowBias = sceneEnv.shadowBias;
         rendererEnv.shadowSoftness = sceneEnv.shadowSoftness;
+        rendererEnv.shadowCascadeCount = sceneEnv.shadowCascadeCount;
+        rendererEnv.shadowCascadeSplitLambda = sceneEnv.shadowCascadeSplitLambda;
+        rendererEnv.shadowDistance = sceneEnv.shadowDistance;
+        rendererEnv.shadowStaticCache = sceneEnv.shadowStaticCache;
+        rendererEnv.shadowCacheUpdateBudget = sceneEnv.shadowCacheUpdateBudget;
         rendererEnv.normalMapStrength = sceneEnv.normalMapStrength;
         rendererEnv.toksvigStrength = sceneEnv.toksvigStrength;
         rendererEnv.useIBL = sceneEnv.useIBL;
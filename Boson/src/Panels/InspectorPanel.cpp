@@ -657,6 +657,8 @@ namespace Fermion
                                          drawMeshModelDropTarget(component, editorAssets);
                                          drawEngineInternalMeshPopup(component);
 
+                                         ImGui::Spacing();
+                                         ImGui::Checkbox("Occluder", &component.isOccluder);
                                          ImGui::Spacing();
                                          drawSubmeshMaterialsEditor(component, editorAssets); });
 
@@ -71,6 +71,8 @@ namespace Fermion
                 m_BosonLayer->saveScene();
             if (m_BosonLayer && ImGui::MenuItem("Save Scene As...", "Ctrl+Shift+S"))
                 m_BosonLayer->saveSceneAs();
+            if (m_BosonLayer && ImGui::MenuItem("Export Runtime Scene"))
+                m_BosonLayer->exportRuntimeScene();
             ImGui::Separator();
             if (m_BosonLayer && ImGui::MenuItem("new project"))
                 m_BosonLayer->newProject();
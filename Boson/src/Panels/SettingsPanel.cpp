@@ -3,6 +3,7 @@
 #include <imgui.h>
 #include <glm/gtc/type_ptr.hpp>
 #include "Project/Project.hpp"
+#include "Renderer/GeometryPool.hpp"
 
 namespace Fermion
 {
@@ -75,6 +76,13 @@ namespace Fermion
         ImGui::Text("Skybox Draw Calls: %u", stats.renderer3D.skyboxDrawCalls);
         ImGui::Text("IBL Draw Calls: %u", stats.renderer3D.iblDrawCalls);
         ImGui::Text("Draw Calls (3D Total): %u", stats.renderer3D.getTotalDrawCalls());
+        ImGui::Text("Occluders: %u (%u triangles)", stats.renderer3D.occluderCount, stats.renderer3D.occluderTriangles);
+        ImGui::Text("Occlusion Culled: %u / %u", stats.renderer3D.occlusionCulled, stats.renderer3D.occlusionTested);
+        ImGui::Text("Meshlets Culled: %u / %u", stats.renderer3D.meshletsCulled, stats.renderer3D.meshletsTested);
+        const GeometryPool::Statistics geometry = GeometryPool::getStatistics();
+        ImGui::Text("Geometry Pages: %u (%.1f / %.1f MiB)", geometry.pages,
+                    (geometry.vertexBytesUsed + geometry.indexBytesUsed) / (1024.0 * 1024.0),
+                    (geometry.vertexBytesCapacity + geometry.indexBytesCapacity) / (1024.0 * 1024.0));
         
 
         ImGui::End();
@@ -136,6 +144,16 @@ namespace Fermion
         {
             sceneInfo.environmentSettings.shadowMapSize = kShadowMapSizeLevels[shadowMapSizeIndex];
         }
+        ImGui::Separator();
+        int cascadeCount = static_cast<int>(sceneInfo.environmentSettings.shadowCascadeCount);
+        if (ImGui::SliderInt("Shadow Cascades", &cascadeCount, 1, static_cast<int>(MAX_SHADOW_CASCADES)))
+            sceneInfo.environmentSettings.shadowCascadeCount = static_cast<uint32_t>(cascadeCount);
+        ImGui::DragFloat("Cascade Split Lambda", &sceneInfo.environmentSettings.shadowCascadeSplitLambda, 0.01f, 0.0f, 1.0f);
+        ImGui::DragFloat("Shadow Distance", &sceneInfo.environmentSettings.shadowDistance, 1.0f, 1.0f, 5000.0f);
+        ImGui::Checkbox("Cache Static Shadows", &sceneInfo.environmentSettings.shadowStaticCache);
+        int cacheBudget = static_cast<int>(sceneInfo.environmentSettings.shadowCacheUpdateBudget);
+        if (ImGui::SliderInt("Cascade Updates / Frame", &cacheBudget, 1, static_cast<int>(MAX_SHADOW_CASCADES)))
+            sceneInfo.environmentSettings.shadowCacheUpdateBudget = static_cast<uint32_t>(cacheBudget);
         ImGui::End();
     }
 
@@ -170,6 +188,9 @@ namespace Fermion
             if (sceneInfo.gbufferDebug != SceneRenderer::GBufferDebugMode::None)
                 sceneInfo.renderMode = SceneRenderer::RenderMode::DeferredHybrid;
         }
+        ImGui::Checkbox("Occlusion Culling", &sceneInfo.occlusionCulling);
+        ImGui::Checkbox("Meshlet Culling", &sceneInfo.meshletCulling);
+        ImGui::DragFloat("Mesh LOD Bias", &sceneInfo.meshLodBias, 0.05f, -2.0f, 4.0f, "%.2f");
         ImGui::Checkbox("show depth buffer", &ctx.viewportRenderer->getSceneInfo().enableDepthView);
         if (ctx.viewportRenderer->getSceneInfo().enableDepthView)
         {
@@ -180,6 +201,17 @@ namespace Fermion
         ImGui::Checkbox("showPhysicsDebug", ctx.showPhysicsDebug);
         ImGui::Checkbox("showRenderEntities", ctx.showRenderEntities);
 
+        if (ctx.activeScene)
+        {
+            ImGui::SeparatorText("Physics Settings");
+            auto &physics = ctx.activeScene->getPhysicsSettings();
+            ImGui::DragFloat("Fixed Update Rate", &physics.fixedUpdateRate, 1.0f, 10.0f, 240.0f, "%.0f Hz");
+            int maxSubsteps = static_cast<int>(physics.maxSubsteps);
+            if (ImGui::SliderInt("Max Substeps", &maxSubsteps, 1, 16))
+                physics.maxSubsteps = static_cast<uint32_t>(maxSubsteps);
+            ImGui::Checkbox("Interpolate", &physics.interpolate);
+        }
+
         ImGui::SeparatorText("Infinite Grid Settings");
         ImGui::Checkbox("Show Infinite Grid", &sceneInfo.showInfiniteGrid);
         if (sceneInfo.showInfiniteGrid)
@@ -12,6 +12,7 @@ namespace Fermion
         struct Context
         {
             std::shared_ptr<SceneRenderer> viewportRenderer;
+            std::shared_ptr<Scene> activeScene;
             EditorCamera *editorCamera = nullptr;
             Entity hoveredEntity;
             bool viewportFocused = false;
@@ -350,6 +350,27 @@ namespace Fermion
             }
         }
 
+        // The ID buffers are exact and cover sprites, text and icons too. The scene BVH only tests mesh
+        // bounds, so it is just a fallback for pixels the readback has nothing for. Play mode renders
+        // through the scene camera, which the editor camera ray wouldn't match.
+        if (!hovered && ctx.activeScene && ctx.editorCamera && ctx.sceneState != 1)
+        {
+            const glm::vec2 ndc{local.x / size.x * 2.0f - 1.0f, 1.0f - local.y / size.y * 2.0f};
+            const glm::mat4 inverseViewProjection = glm::inverse(ctx.editorCamera->getViewProjection());
+            glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndc, -1.0f, 1.0f);
+            glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+            nearPoint /= nearPoint.w;
+            farPoint /= farPoint.w;
+
+            const glm::vec3 origin{nearPoint};
+            const glm::vec3 direction = glm::vec3(farPoint) - origin;
+            SpatialRaycastHit hit;
+            // A camera inside a mesh's bounds hits it at distance 0 wherever it looks; that's no pick
+            if (ctx.activeScene->getEntityManager().getSpatialIndex().raycast(origin, direction, glm::length(direction), hit) &&
+                hit.distance > 0.0f)
+                hovered = Entity{hit.entity, ctx.activeScene.get()};
+        }
+
         if (hovered.isValid())
             m_hoveredEntity = hovered;
     }
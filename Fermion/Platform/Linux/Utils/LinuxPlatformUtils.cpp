@@ -3,6 +3,9 @@
 #include <GLFW/glfw3.h>
 #include <unistd.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <cstdlib>
 namespace Fermion
 {
@@ -160,4 +163,43 @@ namespace Fermion
         }
     }
 
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    bool MappedFile::open(const std::filesystem::path &path)
+    {
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        void *data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps its own reference to the file
+        ::close(fd);
+        if (data == MAP_FAILED)
+            return false;
+
+        m_data = static_cast<const uint8_t *>(data);
+        m_size = static_cast<size_t>(info.st_size);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data)
+            munmap(const_cast<uint8_t *>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+
 } // namespace Fermion
@@ -49,17 +49,18 @@ namespace Fermion
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
-    void OpenGLVertexBuffer::setData(const void *data, uint32_t size)
+    void OpenGLVertexBuffer::setData(const void *data, uint32_t size, uint32_t offset)
     {
         glBindBuffer(GL_ARRAY_BUFFER, m_rendererID);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
     }
 
     /////////////////////////////////////////////////////////////////////////////
     // IndexBuffer //////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////////////
 
-    OpenGLIndexBuffer::OpenGLIndexBuffer(uint32_t *indices, uint32_t count) : m_count(count)
+    OpenGLIndexBuffer::OpenGLIndexBuffer(uint32_t *indices, uint32_t count)
+        : m_count(count), m_indexType(IndexType::UInt32)
     {
         FM_PROFILE_FUNCTION();
 
@@ -68,6 +69,27 @@ namespace Fermion
         glBufferData(GL_ARRAY_BUFFER, count * sizeof(uint32_t), indices, GL_STATIC_DRAW);
     }
 
+    OpenGLIndexBuffer::OpenGLIndexBuffer(uint16_t *indices, uint32_t count)
+        : m_count(count), m_indexType(IndexType::UInt16)
+    {
+        FM_PROFILE_FUNCTION();
+
+        glCreateBuffers(1, &m_rendererID);
+        glBindBuffer(GL_ARRAY_BUFFER, m_rendererID);
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(uint16_t), indices, GL_STATIC_DRAW);
+    }
+
+    OpenGLIndexBuffer::OpenGLIndexBuffer(uint32_t count, IndexType type)
+        : m_count(count), m_indexType(type)
+    {
+        FM_PROFILE_FUNCTION();
+
+        const size_t indexSize = type == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        glCreateBuffers(1, &m_rendererID);
+        glBindBuffer(GL_ARRAY_BUFFER, m_rendererID);
+        glBufferData(GL_ARRAY_BUFFER, count * indexSize, nullptr, GL_DYNAMIC_DRAW);
+    }
+
     OpenGLIndexBuffer::~OpenGLIndexBuffer()
     {
         FM_PROFILE_FUNCTION();
@@ -89,4 +111,11 @@ namespace Fermion
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
+    void OpenGLIndexBuffer::setData(const void *indices, uint32_t count, uint32_t offset)
+    {
+        // Through the named API so the vertex array's element buffer binding is left alone
+        const size_t indexSize = m_indexType == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        glNamedBufferSubData(m_rendererID, offset * indexSize, count * indexSize, indices);
+    }
+
 } // namespace Fermion
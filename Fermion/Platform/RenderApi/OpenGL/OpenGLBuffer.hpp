@@ -15,7 +15,7 @@ namespace Fermion {
 
         void unbind() const override;
 
-        void setData(const void *data, uint32_t size) override;
+        void setData(const void *data, uint32_t size, uint32_t offset = 0) override;
 
         const BufferLayout &getLayout() const override {
             return m_layout;
@@ -34,6 +34,10 @@ namespace Fermion {
     public:
         OpenGLIndexBuffer(uint32_t *indices, uint32_t count);
 
+        OpenGLIndexBuffer(uint16_t *indices, uint32_t count);
+
+        OpenGLIndexBuffer(uint32_t count, IndexType type);
+
         ~OpenGLIndexBuffer() override;
 
         virtual void bind() const;
@@ -44,8 +48,15 @@ namespace Fermion {
             return m_count;
         }
 
+        virtual IndexType getIndexType() const {
+            return m_indexType;
+        }
+
+        void setData(const void *indices, uint32_t count, uint32_t offset = 0) override;
+
     private:
         uint32_t m_rendererID;
         uint32_t m_count;
+        IndexType m_indexType;
     };
 } // namespace Fermion
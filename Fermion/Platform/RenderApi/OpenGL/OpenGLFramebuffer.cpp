@@ -94,6 +94,25 @@ namespace Fermion
             glFramebufferTexture2D(GL_FRAMEBUFFER, attachmentType, textureTarget(multisampled), id, 0);
         }
 
+        // Layered depth attachments are only used for shadow cascades, so they always get the shadow map sampling state
+        static void attachDepthTextureArray(uint32_t id, GLenum format, GLenum attachmentType, uint32_t width, uint32_t height, uint32_t layers)
+        {
+            glTextureStorage3D(id, 1, format, width, height, layers);
+            glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+            glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+            float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+            glTextureParameterfv(id, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, attachmentType, id, 0, 0);
+        }
+
+        static GLenum depthAttachmentType(FramebufferTextureFormat format)
+        {
+            return format == FramebufferTextureFormat::DEPTH24STENCIL8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+        }
+
         static bool isDepthFormat(FramebufferTextureFormat format)
         {
             switch (format)
@@ -233,7 +252,17 @@ namespace Fermion
             }
         }
 
-        if (m_depthAttachmentSpecification.textureFormat != FramebufferTextureFormat::None)
+        if (m_depthAttachmentSpecification.textureFormat != FramebufferTextureFormat::None && isLayered())
+        {
+            glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_depthAttachment);
+            const GLenum format = m_depthAttachmentSpecification.textureFormat == FramebufferTextureFormat::DEPTH24STENCIL8
+                                      ? GL_DEPTH24_STENCIL8
+                                      : GL_DEPTH_COMPONENT32F;
+            Utils::attachDepthTextureArray(m_depthAttachment, format,
+                                           Utils::depthAttachmentType(m_depthAttachmentSpecification.textureFormat),
+                                           m_specification.width, m_specification.height, m_specification.layers);
+        }
+        else if (m_depthAttachmentSpecification.textureFormat != FramebufferTextureFormat::None)
         {
             Utils::createTextures(multisample, &m_depthAttachment, 1);
             Utils::bindTexture(multisample, m_depthAttachment);
@@ -357,6 +386,14 @@ namespace Fermion
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
+    void OpenGLFramebuffer::bindLayer(uint32_t layer)
+    {
+        FERMION_ASSERT(isLayered() && layer < m_specification.layers, "Framebuffer layer out of range!");
+        glNamedFramebufferTextureLayer(m_rendererID, Utils::depthAttachmentType(m_depthAttachmentSpecification.textureFormat),
+                                       m_depthAttachment, 0, static_cast<GLint>(layer));
+        bind();
+    }
+
     void OpenGLFramebuffer::bindForRead()
     {
         // For MSAA, bind the resolve FBO (must call resolve() first)
@@ -550,8 +587,12 @@ namespace Fermion
     {
         glActiveTexture(GL_TEXTURE0 + slot);
 
+        if (isLayered())
+        {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, m_depthAttachment);
+        }
         // For MSAA, bind the resolved depth texture (must call resolve() first)
-        if (isMultisampled() && m_resolveDepthAttachment)
+        else if (isMultisampled() && m_resolveDepthAttachment)
         {
             glBindTexture(GL_TEXTURE_2D, m_resolveDepthAttachment);
         }
@@ -692,4 +733,18 @@ namespace Fermion
         glDrawBuffer(GL_BACK);
     }
 
+    void OpenGLFramebuffer::copyDepthLayerTo(const Framebuffer &target, uint32_t sourceLayer, uint32_t targetLayer) const
+    {
+        const auto &targetSpec = target.getSpecification();
+        FERMION_ASSERT(isLayered() && sourceLayer < m_specification.layers, "Source layer out of range!");
+        FERMION_ASSERT(targetSpec.layers > targetLayer, "Target layer out of range!");
+        FERMION_ASSERT(targetSpec.width == m_specification.width && targetSpec.height == m_specification.height,
+                       "Depth layer copy requires framebuffers of the same size!");
+
+        // A raw texel copy: no framebuffer bindings change and no depth test or format conversion applies
+        glCopyImageSubData(m_depthAttachment, GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(sourceLayer),
+                           target.getDepthAttachmentRendererID(), GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(targetLayer),
+                           static_cast<GLsizei>(m_specification.width), static_cast<GLsizei>(m_specification.height), 1);
+    }
+
 } // namespace Fermion
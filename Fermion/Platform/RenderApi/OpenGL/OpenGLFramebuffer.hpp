@@ -13,6 +13,7 @@ public:
 
     virtual void bind() override;
     virtual void unbind() override;
+    virtual void bindLayer(uint32_t layer) override;
 
     // Binds the resolve FBO for MSAA, or main FBO if not multisampled
     virtual void bindForRead() override;
@@ -55,12 +56,17 @@ public:
 
     virtual void blitToDefaultFramebuffer(uint32_t dstWidth, uint32_t dstHeight, const FramebufferBlitSpecification &spec) const override;
 
+    virtual void copyDepthLayerTo(const Framebuffer &target, uint32_t sourceLayer, uint32_t targetLayer) const override;
+
     virtual void resolve() override;
 
     virtual const FramebufferSpecification &getSpecification() const override {
         return m_specification;
     }
 
+private:
+    bool isLayered() const { return m_specification.layers > 0 && !isMultisampled(); }
+
 private:
     uint32_t m_rendererID = 0;
     FramebufferSpecification m_specification;
@@ -0,0 +1,208 @@
+﻿#include "fmpch.hpp"
+#include "OpenGLProgramCache.hpp"
+#include "Core/Log.hpp"
+#include <glad/glad.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace Fermion
+{
+    namespace
+    {
+        constexpr uint32_t kMagic = 0x42504D46; // "FMPB"
+        constexpr uint32_t kVersion = 1;
+        constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+        constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            // Repeats the file name's key, so a renamed or mixed-up file is never handed to the driver
+            uint64_t key;
+            uint32_t format;
+            uint32_t size;
+        };
+
+        struct CacheState
+        {
+            std::filesystem::path directory;
+            uint64_t driverHash = 0;
+            bool enabled = false;
+        };
+
+        CacheState &getCache()
+        {
+            static CacheState cache;
+            return cache;
+        }
+
+        // FNV-1a. Callers hash the terminating null too, so text moving between two strings changes the key
+        uint64_t hashBytes(const char *data, size_t size, uint64_t hash)
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= static_cast<unsigned char>(data[i]);
+                hash *= kFnvPrime;
+            }
+            return hash;
+        }
+
+        uint64_t hashString(const std::string &text, uint64_t hash)
+        {
+            return hashBytes(text.c_str(), text.size() + 1, hash);
+        }
+
+        uint64_t hashGLString(GLenum name, uint64_t hash)
+        {
+            const char *value = reinterpret_cast<const char *>(glGetString(name));
+            return value ? hashBytes(value, std::strlen(value) + 1, hash) : hash;
+        }
+
+        uint64_t getKey(const std::string &vertexSrc, const std::string &fragmentSrc)
+        {
+            return hashString(fragmentSrc, hashString(vertexSrc, getCache().driverHash));
+        }
+
+        std::filesystem::path getPath(uint64_t key)
+        {
+            return getCache().directory / std::format("{:016x}.bin", key);
+        }
+    } // namespace
+
+    void OpenGLProgramCache::init(const std::string &directory)
+    {
+        CacheState &cache = getCache();
+        cache.enabled = false;
+        if (directory.empty())
+            return;
+
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        if (formatCount <= 0)
+        {
+            Log::Warn("Driver has no program binary formats, shader cache disabled");
+            return;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec)
+        {
+            Log::Warn(std::format("Failed to create shader cache directory {}: {}", directory, ec.message()));
+            return;
+        }
+
+        uint64_t hash = hashGLString(GL_VENDOR, kFnvOffset);
+        hash = hashGLString(GL_RENDERER, hash);
+        hash = hashGLString(GL_VERSION, hash);
+
+        cache.directory = directory;
+        cache.driverHash = hash;
+        cache.enabled = true;
+    }
+
+    bool OpenGLProgramCache::isEnabled()
+    {
+        return getCache().enabled;
+    }
+
+    uint32_t OpenGLProgramCache::load(const std::string &vertexSrc, const std::string &fragmentSrc)
+    {
+        if (!isEnabled())
+            return 0;
+
+        FM_PROFILE_FUNCTION();
+
+        const uint64_t key = getKey(vertexSrc, fragmentSrc);
+        const std::filesystem::path path = getPath(key);
+
+        FileHeader header{};
+        std::vector<char> binary;
+        {
+            std::ifstream in(path, std::ios::in | std::ios::binary);
+            if (!in)
+                return 0;
+
+            if (in.read(reinterpret_cast<char *>(&header), sizeof(header)) && header.magic == kMagic &&
+                header.version == kVersion && header.key == key && header.size > 0)
+            {
+                binary.resize(header.size);
+                if (!in.read(binary.data(), header.size))
+                    binary.clear();
+            }
+        }
+
+        uint32_t program = 0;
+        if (!binary.empty())
+        {
+            program = glCreateProgram();
+            glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+            // Drivers may reject a binary for reasons the key can't see, so link status is the real check
+            GLint isLinked = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+            if (isLinked == GL_FALSE)
+            {
+                glDeleteProgram(program);
+                program = 0;
+            }
+        }
+
+        if (program == 0)
+        {
+            // The compile that follows stores a fresh binary under the same name
+            Log::Trace(std::format("Discarding unusable program binary {}", path.string()));
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+        return program;
+    }
+
+    void OpenGLProgramCache::store(uint32_t program, const std::string &vertexSrc, const std::string &fragmentSrc)
+    {
+        if (!isEnabled() || program == 0)
+            return;
+
+        FM_PROFILE_FUNCTION();
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        std::vector<char> binary(length);
+        GLsizei written = 0;
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0)
+            return;
+
+        const uint64_t key = getKey(vertexSrc, fragmentSrc);
+        const FileHeader header{kMagic, kVersion, key, format, static_cast<uint32_t>(written)};
+
+        // Written under a temporary name and renamed, so a reader never sees half a file
+        const std::filesystem::path path = getPath(key);
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+        bool saved = false;
+        {
+            std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.write(binary.data(), written);
+            saved = static_cast<bool>(out);
+        }
+
+        std::error_code ec;
+        if (saved)
+            std::filesystem::rename(tempPath, path, ec);
+        if (!saved || ec)
+        {
+            Log::Warn(std::format("Failed to write program binary {}", path.string()));
+            std::filesystem::remove(tempPath, ec);
+        }
+    }
+} // namespace Fermion
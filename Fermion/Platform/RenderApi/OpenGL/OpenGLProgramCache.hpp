@@ -0,0 +1,23 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+
+namespace Fermion
+{
+    // Linked programs saved with glGetProgramBinary, one file per program. The file name hashes the stage
+    // sources exactly as they are compiled (variant defines included) together with GL_VENDOR, GL_RENDERER
+    // and GL_VERSION, so editing a shader or updating the driver simply misses. A binary the driver refuses
+    // is deleted and the caller compiles from source.
+    class OpenGLProgramCache
+    {
+    public:
+        // Needs a current context; an empty directory, or a driver without binary formats, disables the cache
+        static void init(const std::string &directory);
+        static bool isEnabled();
+
+        // The linked program for these sources, or 0 when there is no usable binary
+        static uint32_t load(const std::string &vertexSrc, const std::string &fragmentSrc);
+        // Saves a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+        static void store(uint32_t program, const std::string &vertexSrc, const std::string &fragmentSrc);
+    };
+} // namespace Fermion
@@ -1,7 +1,28 @@
 ﻿#include "OpenGLRendererAPI.hpp"
+#include "Renderer/UniformBufferLayout.hpp"
 #include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
 namespace Fermion
 {
+    namespace
+    {
+        constexpr uint32_t kIndirectBufferSize = 1u << 20;
+
+        bool hasExtension(const char *name)
+        {
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (GLint i = 0; i < count; i++)
+            {
+                const char *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+                if (extension && std::strcmp(extension, name) == 0)
+                    return true;
+            }
+            return false;
+        }
+    } // namespace
+
     void OpenGLRendererAPI::init()
     {
         FM_PROFILE_FUNCTION();
@@ -11,6 +32,20 @@ namespace Fermion
 
         glEnable(GL_DEPTH_TEST);
         glEnable(GL_LINE_SMOOTH);
+
+        m_shaderDrawParameters = hasExtension("GL_ARB_shader_draw_parameters");
+        if (m_shaderDrawParameters)
+        {
+            m_indirectCapacity = kIndirectBufferSize;
+            glCreateBuffers(1, &m_indirectBuffer);
+            glNamedBufferData(m_indirectBuffer, m_indirectCapacity, nullptr, GL_STREAM_DRAW);
+        }
+        else
+        {
+            Log::Warn("OpenGLRendererAPI: GL_ARB_shader_draw_parameters is unavailable, indirect draws are issued one by one");
+            glCreateBuffers(1, &m_drawParametersBuffer);
+            glNamedBufferData(m_drawParametersBuffer, DrawParametersData::getSize(), nullptr, GL_DYNAMIC_DRAW);
+        }
     }
 
     void OpenGLRendererAPI::setViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
@@ -35,33 +70,78 @@ namespace Fermion
             glDisable(GL_BLEND);
     }
 
-    void OpenGLRendererAPI::drawIndexed(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount)
+    void OpenGLRendererAPI::drawIndexed(const VertexArray &vertexArray, uint32_t indexCount, uint32_t indexOffset,
+                                        int32_t baseVertex)
     {
-        vertexArray->bind();
-        uint32_t count = indexCount ? indexCount : vertexArray->getIndexBuffer()->getCount();
-        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
-        // glBindTexture(GL_TEXTURE_2D, 0);
-    }
+        vertexArray.bind();
 
-    void OpenGLRendererAPI::drawIndexed(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount, uint32_t indexOffset)
-    {
-        vertexArray->bind();
+        const auto &indexBuffer = vertexArray.getIndexBuffer();
+        uint32_t count = indexCount ? indexCount : indexBuffer->getCount();
+        const bool shortIndices = indexBuffer->getIndexType() == IndexType::UInt16;
+        const size_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
 
-        uint32_t count = indexCount ? indexCount : vertexArray->getIndexBuffer()->getCount();
+        glDrawElementsBaseVertex(GL_TRIANGLES, count, shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                                 (void *)(indexOffset * indexSize), baseVertex);
+    }
 
-        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void *)(indexOffset * sizeof(uint32_t)));
+    void OpenGLRendererAPI::drawIndexedInstanced(const VertexArray &vertexArray, uint32_t indexCount, uint32_t instanceCount,
+                                                 uint32_t indexOffset, int32_t baseVertex)
+    {
+        vertexArray.bind();
+        const auto &indexBuffer = vertexArray.getIndexBuffer();
+        uint32_t count = indexCount ? indexCount : indexBuffer->getCount();
+        const bool shortIndices = indexBuffer->getIndexType() == IndexType::UInt16;
+        const size_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                                          (void *)(indexOffset * indexSize), instanceCount, baseVertex);
     }
 
-    void OpenGLRendererAPI::drawIndexedInstanced(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount, uint32_t instanceCount)
+    void OpenGLRendererAPI::drawIndexedIndirect(const VertexArray &vertexArray, const DrawIndexedIndirectCommand *commands,
+                                                uint32_t drawCount)
     {
-        vertexArray->bind();
-        uint32_t count = indexCount ? indexCount : vertexArray->getIndexBuffer()->getCount();
-        glDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr, instanceCount);
+        if (drawCount == 0)
+            return;
+
+        vertexArray.bind();
+        const auto &indexBuffer = vertexArray.getIndexBuffer();
+        const bool shortIndices = indexBuffer->getIndexType() == IndexType::UInt16;
+        const GLenum indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        const size_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        if (!m_shaderDrawParameters)
+        {
+            glBindBufferBase(GL_UNIFORM_BUFFER, UniformBufferBinding::DrawParameters, m_drawParametersBuffer);
+            for (uint32_t i = 0; i < drawCount; i++)
+            {
+                const DrawIndexedIndirectCommand &command = commands[i];
+                const DrawParametersData parameters{static_cast<int>(command.baseInstance), {}};
+                glNamedBufferSubData(m_drawParametersBuffer, 0, sizeof(parameters), &parameters);
+                glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, command.indexCount, indexType,
+                                                              (void *)(command.firstIndex * indexSize),
+                                                              command.instanceCount, command.baseVertex,
+                                                              command.baseInstance);
+            }
+            return;
+        }
+
+        const uint32_t size = drawCount * sizeof(DrawIndexedIndirectCommand);
+        if (m_indirectCursor + size > m_indirectCapacity)
+        {
+            m_indirectCapacity = std::max(m_indirectCapacity, size);
+            glNamedBufferData(m_indirectBuffer, m_indirectCapacity, nullptr, GL_STREAM_DRAW);
+            m_indirectCursor = 0;
+        }
+        glNamedBufferSubData(m_indirectBuffer, m_indirectCursor, size, commands);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, (const void *)(uintptr_t)m_indirectCursor,
+                                    static_cast<GLsizei>(drawCount), 0);
+        m_indirectCursor += size;
     }
 
-    void OpenGLRendererAPI::drawLines(const std::shared_ptr<VertexArray> &vertexArray, uint32_t vertexCount)
+    void OpenGLRendererAPI::drawLines(const VertexArray &vertexArray, uint32_t vertexCount)
     {
-        vertexArray->bind();
+        vertexArray.bind();
         glDrawArrays(GL_LINES, 0, vertexCount);
     }
 
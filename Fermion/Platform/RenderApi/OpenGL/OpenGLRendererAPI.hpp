@@ -13,12 +13,29 @@ public:
     virtual void clear() override;
     virtual void setBlendEnabled(bool enabled) override;
 
-    virtual void drawIndexed(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount = 0) override;
-    virtual void drawIndexed(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount, uint32_t indexOffset) override;
-    virtual void drawIndexedInstanced(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount, uint32_t instanceCount) override;
-    virtual void drawLines(const std::shared_ptr<VertexArray> &vertexArray, uint32_t vertexCount) override;
+    using RendererAPI::drawIndexed;
+    using RendererAPI::drawIndexedInstanced;
+    using RendererAPI::drawLines;
+
+    virtual void drawIndexed(const VertexArray &vertexArray, uint32_t indexCount, uint32_t indexOffset, int32_t baseVertex = 0) override;
+    virtual void drawIndexedInstanced(const VertexArray &vertexArray, uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset, int32_t baseVertex = 0) override;
+    virtual void drawIndexedIndirect(const VertexArray &vertexArray, const DrawIndexedIndirectCommand *commands, uint32_t drawCount) override;
+    virtual void drawLines(const VertexArray &vertexArray, uint32_t vertexCount) override;
 
     virtual void setLineWidth(float width) override;
+
+private:
+    // With GL_ARB_shader_draw_parameters the shaders read each draw's base instance themselves, so a whole
+    // batch is one glMultiDrawElementsIndirect; without it every draw goes out alone after writing the
+    // draw parameters uniform buffer
+    bool m_shaderDrawParameters = false;
+
+    // Commands are appended to the indirect buffer and it is orphaned when full, so a draw never waits
+    // for the GPU to finish reading an earlier one
+    uint32_t m_indirectBuffer = 0;
+    uint32_t m_indirectCapacity = 0;
+    uint32_t m_indirectCursor = 0;
+    uint32_t m_drawParametersBuffer = 0;
 };
 
 } // namespace Fermion
@@ -1,7 +1,10 @@
 ﻿#include "OpenGLShader.hpp"
+#include "OpenGLProgramCache.hpp"
 #include "Core/Log.hpp"
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <glad/glad.h>
 
 namespace Fermion
@@ -20,6 +23,63 @@ namespace Fermion
             return 0;
         }
 
+        // ShaderKeyword bits of every '#pragma multi_compile' line in the file
+        static uint32_t ParseKeywords(const std::string &source, const std::string &filepath)
+        {
+            const std::string directive = "#pragma multi_compile";
+            uint32_t mask = 0;
+            size_t pos = source.find(directive);
+            while (pos != std::string::npos)
+            {
+                size_t eol = source.find_first_of("\r\n", pos);
+                std::istringstream line(source.substr(pos + directive.size(), eol == std::string::npos ? std::string::npos : eol - pos - directive.size()));
+                std::string name;
+                while (line >> name)
+                {
+                    uint32_t bit = ShaderKeyword::fromName(name);
+                    if (bit == 0)
+                        Log::Warn(std::format("Unknown shader keyword {} in {}", name, filepath));
+                    mask |= bit;
+                }
+                pos = source.find(directive, pos + directive.size());
+            }
+            return mask;
+        }
+
+        // The defines go right after #version, which has to stay the first directive of a stage; #line keeps
+        // the compiler's line numbers those of the stage source
+        static std::string InjectDefines(const std::string &source, uint32_t keywords)
+        {
+            std::string defines;
+            size_t insertPos = 0;
+            size_t versionPos = source.find("#version");
+            if (versionPos != std::string::npos)
+            {
+                size_t eol = source.find('\n', versionPos);
+                if (eol == std::string::npos)
+                {
+                    insertPos = source.size();
+                    defines += '\n';
+                }
+                else
+                {
+                    insertPos = eol + 1;
+                }
+            }
+            const auto nextLine = std::count(source.begin(), source.begin() + insertPos, '\n') + 1;
+
+            for (uint32_t i = 0; i < ShaderKeyword::Count; ++i)
+            {
+                if (keywords & (1u << i))
+                    defines += std::format("#define {}\n", ShaderKeyword::getName(i));
+            }
+            defines += std::format("#line {}\n", nextLine);
+
+            std::string result = source;
+            result.insert(insertPos, defines);
+            return result;
+        }
+
     } // namespace Utils
     OpenGLShader::OpenGLShader(const std::string &name, const std::string &vertexSrc, const std::string &fragmentSrc) : m_name(name)
     {
@@ -34,19 +94,22 @@ namespace Fermion
 
         std::string source = readFile(filepath);
         auto shaderSources = preProcess(source);
+        m_keywordMask = Utils::ParseKeywords(source, filepath);
 
         const std::string &vertexSrc = shaderSources[GL_VERTEX_SHADER];
         const std::string &fragmentSrc = shaderSources[GL_FRAGMENT_SHADER];
 
-        // 编译着色器
-        compile(vertexSrc, fragmentSrc);
-
         // asuploads/shaders/Basic.glsl -> Basic
         auto lastSlash = filepath.find_last_of("/\\");
         lastSlash = lastSlash == std::string::npos ? 0 : lastSlash + 1;
         auto lastDot = filepath.rfind('.');
         auto count = lastDot == std::string::npos ? filepath.size() - lastSlash : lastDot - lastSlash;
         m_name = filepath.substr(lastSlash, count);
+
+        // 编译着色器
+        compile(vertexSrc, fragmentSrc);
+        if (m_keywordMask != 0)
+            m_sources = std::move(shaderSources);
         // Log::Trace("Shader loaded: " + m_name);
     }
 
@@ -64,6 +127,13 @@ namespace Fermion
     {
         FM_PROFILE_FUNCTION();
 
+        m_rendererID = OpenGLProgramCache::load(vertexSrc, fragmentSrc);
+        if (m_rendererID != 0)
+        {
+            Log::Trace(std::format("Shader {} loaded from the program cache", m_name));
+            return;
+        }
+
         // 创建着色器
         uint32_t vertexShader = glCreateShader(GL_VERTEX_SHADER);
         const char *vertexSource = vertexSrc.c_str();
@@ -114,6 +184,8 @@ namespace Fermion
         m_rendererID = glCreateProgram();
         glAttachShader(m_rendererID, vertexShader);
         glAttachShader(m_rendererID, fragmentShader);
+        if (OpenGLProgramCache::isEnabled())
+            glProgramParameteri(m_rendererID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
         glLinkProgram(m_rendererID);
 
         // 检查链接错误
@@ -128,6 +200,7 @@ namespace Fermion
             glGetProgramInfoLog(m_rendererID, maxLength, &maxLength, infoLog.data());
 
             glDeleteProgram(m_rendererID);
+            m_rendererID = 0;
             glDeleteShader(vertexShader);
             glDeleteShader(fragmentShader);
 
@@ -141,6 +214,7 @@ namespace Fermion
         glDeleteShader(vertexShader);
         glDeleteShader(fragmentShader);
 
+        OpenGLProgramCache::store(m_rendererID, vertexSrc, fragmentSrc);
         Log::Trace("Shader compiled and linked successfully");
     }
 
@@ -199,6 +273,94 @@ namespace Fermion
 
         return shaderSources;
     }
+    std::shared_ptr<Shader> OpenGLShader::getVariant(uint32_t keywords)
+    {
+        keywords &= m_keywordMask;
+        if (keywords == 0)
+            return shared_from_this();
+
+        auto it = m_variants.find(keywords);
+        if (it != m_variants.end())
+            return it->second ? it->second : shared_from_this();
+
+        FM_PROFILE_FUNCTION();
+
+        std::string suffix;
+        for (uint32_t i = 0; i < ShaderKeyword::Count; ++i)
+        {
+            if (keywords & (1u << i))
+                suffix += suffix.empty() ? ShaderKeyword::getName(i) : std::format(" {}", ShaderKeyword::getName(i));
+        }
+
+        auto variant = std::make_shared<OpenGLShader>(std::format("{}[{}]", m_name, suffix),
+                                                      Utils::InjectDefines(m_sources[GL_VERTEX_SHADER], keywords),
+                                                      Utils::InjectDefines(m_sources[GL_FRAGMENT_SHADER], keywords));
+        if (variant->m_rendererID == 0)
+        {
+            // Drawing with the keyword-less program beats drawing nothing. The failure is cached as a null entry
+            // so the compile isn't retried; storing this shader itself would keep it alive forever
+            Log::Error(std::format("Shader variant {} failed to build, using {}", variant->m_name, m_name));
+            m_variants.emplace(keywords, nullptr);
+            return shared_from_this();
+        }
+
+        for (const auto &[name, uniform] : m_sharedUniforms)
+            variant->uploadSharedUniform(name, uniform);
+        m_variants.emplace(keywords, variant);
+        return variant;
+    }
+
+    void OpenGLShader::shareUniform(const std::string &name, SharedUniform::Type type, const float *values, uint32_t count)
+    {
+        SharedUniform &uniform = m_sharedUniforms.try_emplace(name).first->second;
+        uniform.type = type;
+        std::copy(values, values + count, uniform.floats.begin());
+        applySharedUniform(name, uniform);
+    }
+
+    void OpenGLShader::shareUniform(const std::string &name, SharedUniform::Type type, const int *values, uint32_t count)
+    {
+        SharedUniform &uniform = m_sharedUniforms.try_emplace(name).first->second;
+        uniform.type = type;
+        uniform.ints.assign(values, values + count);
+        applySharedUniform(name, uniform);
+    }
+
+    void OpenGLShader::applySharedUniform(const std::string &name, const SharedUniform &uniform)
+    {
+        for (auto &[keywords, variant] : m_variants)
+        {
+            if (variant)
+                variant->uploadSharedUniform(name, uniform);
+        }
+    }
+
+    void OpenGLShader::uploadSharedUniform(const std::string &name, const SharedUniform &uniform)
+    {
+        const int location = getUniformLocation(name);
+        switch (uniform.type)
+        {
+        case SharedUniform::Type::Int:
+            glProgramUniform1i(m_rendererID, location, uniform.ints[0]);
+            break;
+        case SharedUniform::Type::IntArray:
+            glProgramUniform1iv(m_rendererID, location, static_cast<GLsizei>(uniform.ints.size()), uniform.ints.data());
+            break;
+        case SharedUniform::Type::Float:
+            glProgramUniform1f(m_rendererID, location, uniform.floats[0]);
+            break;
+        case SharedUniform::Type::Float3:
+            glProgramUniform3fv(m_rendererID, location, 1, uniform.floats.data());
+            break;
+        case SharedUniform::Type::Float4:
+            glProgramUniform4fv(m_rendererID, location, 1, uniform.floats.data());
+            break;
+        case SharedUniform::Type::Mat4:
+            glProgramUniformMatrix4fv(m_rendererID, location, 1, GL_FALSE, uniform.floats.data());
+            break;
+        }
+    }
+
     void OpenGLShader::bind() const
     {
         FM_PROFILE_FUNCTION();
@@ -239,95 +401,121 @@ namespace Fermion
         FM_PROFILE_FUNCTION();
 
         uploadInt(name, value);
+        if (m_keywordMask != 0)
+            shareUniform(name, SharedUniform::Type::Int, &value, 1);
     }
     void OpenGLShader::setIntArray(const std::string &name, int *values, uint32_t count)
     {
         uploadIntArray(name, values, count);
+        if (m_keywordMask != 0)
+            shareUniform(name, SharedUniform::Type::IntArray, values, count);
     }
     void OpenGLShader::setBool(const std::string &name, bool value)
     {
         FM_PROFILE_FUNCTION();
         uploadBool(name, value);
+        if (m_keywordMask != 0)
+        {
+            const int intValue = value;
+            shareUniform(name, SharedUniform::Type::Int, &intValue, 1);
+        }
     }
     void OpenGLShader::setFloat(const std::string &name, float value)
     {
         FM_PROFILE_FUNCTION();
 
         uploadFloat(name, value);
+        if (m_keywordMask != 0)
+            shareUniform(name, SharedUniform::Type::Float, &value, 1);
     }
     void OpenGLShader::setFloat3(const std::string &name, float v0, float v1, float v2)
     {
         FM_PROFILE_FUNCTION();
 
         uploadFloat3(name, v0, v1, v2);
+        if (m_keywordMask != 0)
+        {
+            const float values[] = {v0, v1, v2};
+            shareUniform(name, SharedUniform::Type::Float3, values, 3);
+        }
     }
     void OpenGLShader::setFloat4(const std::string &name, float v0, float v1, float v2, float v3)
     {
         FM_PROFILE_FUNCTION();
 
         uploadFloat4(name, v0, v1, v2, v3);
+        if (m_keywordMask != 0)
+        {
+            const float values[] = {v0, v1, v2, v3};
+            shareUniform(name, SharedUniform::Type::Float4, values, 4);
+        }
     }
     void OpenGLShader::setFloat3(const std::string &name, const glm::vec3 &value)
     {
         FM_PROFILE_FUNCTION();
 
         uploadFloat3(name, value);
+        if (m_keywordMask != 0)
+            shareUniform(name, SharedUniform::Type::Float3, glm::value_ptr(value), 3);
     }
     void OpenGLShader::setFloat4(const std::string &name, const glm::vec4 &value)
     {
         FM_PROFILE_FUNCTION();
 
         uploadFloat4(name, value);
+        if (m_keywordMask != 0)
+            shareUniform(name, SharedUniform::Type::Float4, glm::value_ptr(value), 4);
     }
     void OpenGLShader::setMat4(const std::string &name, const glm::mat4 &matrix)
     {
         FM_PROFILE_FUNCTION();
 
         uploadMat4(name, matrix);
+        if (m_keywordMask != 0)
+            shareUniform(name, SharedUniform::Type::Mat4, glm::value_ptr(matrix), 16);
     }
     void OpenGLShader::uploadInt(const std::string &name, int value)
     {
-        glUniform1i(getUniformLocation(name), value);
+        glProgramUniform1i(m_rendererID, getUniformLocation(name), value);
     }
 
     void OpenGLShader::uploadIntArray(const std::string &name, int *values, uint32_t count)
     {
-        GLint location = glGetUniformLocation(m_rendererID, name.c_str());
-        glUniform1iv(location, count, values);
+        glProgramUniform1iv(m_rendererID, getUniformLocation(name), count, values);
     }
 
     void OpenGLShader::uploadBool(const std::string &name, bool value)
     {
-        glUniform1i(getUniformLocation(name), (int)value);
+        glProgramUniform1i(m_rendererID, getUniformLocation(name), (int)value);
     }
 
     void OpenGLShader::uploadFloat(const std::string &name, float value)
     {
-        glUniform1f(getUniformLocation(name), value);
+        glProgramUniform1f(m_rendererID, getUniformLocation(name), value);
     }
 
     void OpenGLShader::uploadFloat3(const std::string &name, float v0, float v1, float v2)
     {
-        glUniform3f(getUniformLocation(name), v0, v1, v2);
+        glProgramUniform3f(m_rendererID, getUniformLocation(name), v0, v1, v2);
     }
     void OpenGLShader::uploadFloat3(const std::string &name, const glm::vec3 &value)
     {
-        glUniform3f(getUniformLocation(name), value.x, value.y, value.z);
+        glProgramUniform3f(m_rendererID, getUniformLocation(name), value.x, value.y, value.z);
     }
 
     void OpenGLShader::uploadFloat4(const std::string &name, float v0, float v1, float v2, float v3)
     {
-        glUniform4f(getUniformLocation(name), v0, v1, v2, v3);
+        glProgramUniform4f(m_rendererID, getUniformLocation(name), v0, v1, v2, v3);
     }
 
     void OpenGLShader::uploadFloat4(const std::string &name, const glm::vec4 &value)
     {
-        glUniform4f(getUniformLocation(name), value.x, value.y, value.z, value.w);
+        glProgramUniform4f(m_rendererID, getUniformLocation(name), value.x, value.y, value.z, value.w);
     }
 
     void OpenGLShader::uploadMat4(const std::string &name, const glm::mat4 &matrix)
     {
-        glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
+        glProgramUniformMatrix4fv(m_rendererID, getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
     }
 
 } // namespace Fermion
@@ -1,13 +1,16 @@
 ﻿#pragma once
 #include "Renderer/Shader.hpp"
 
+#include <array>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <glm/glm.hpp>
 
 namespace Fermion {
 
-class OpenGLShader : public Shader {
+class OpenGLShader : public Shader, public std::enable_shared_from_this<OpenGLShader> {
 public:
     OpenGLShader() = default;
     OpenGLShader(const std::string &name, const std::string &vertexSrc, const std::string &fragmentSrc);
@@ -52,17 +55,43 @@ public:
         return m_name;
     }
 
+    virtual uint32_t getKeywordMask() const override {
+        return m_keywordMask;
+    }
+    virtual std::shared_ptr<Shader> getVariant(uint32_t keywords) override;
+
 private:
+    // Last value set through a setX on a shader with keywords, kept to be replayed on new variants
+    struct SharedUniform {
+        enum class Type : uint8_t { Int, IntArray, Float, Float3, Float4, Mat4 };
+        Type type = Type::Int;
+        std::array<float, 16> floats{};
+        std::vector<int> ints; // Int and IntArray
+    };
+
     int getUniformLocation(const std::string &name) const;
     void compile(const std::string &vertexSrc, const std::string &fragmentSrc);
     std::string readFile(const std::string &filepath);
     std::unordered_map<uint32_t, std::string> preProcess(const std::string &source);
+    // Records a value set on a shader with keywords and applies it to the variants compiled so far;
+    // variants compiled later get every recorded value when they are created. The record is reused, so
+    // setting a uniform again allocates nothing
+    void shareUniform(const std::string &name, SharedUniform::Type type, const float *values, uint32_t count);
+    void shareUniform(const std::string &name, SharedUniform::Type type, const int *values, uint32_t count);
+    void applySharedUniform(const std::string &name, const SharedUniform &uniform);
+    void uploadSharedUniform(const std::string &name, const SharedUniform &uniform);
 
 private:
-    uint32_t m_rendererID;
+    uint32_t m_rendererID = 0;
     std::string m_name;
     std::string m_filePathl;
     mutable std::unordered_map<std::string, int> m_UniformLocationCache;
+
+    // This object is the variant without keywords; the others are compiled from the stage sources kept here
+    uint32_t m_keywordMask = 0;
+    std::unordered_map<uint32_t, std::string> m_sources;
+    std::unordered_map<uint32_t, std::shared_ptr<OpenGLShader>> m_variants; // null for variants that failed to build
+    std::unordered_map<std::string, SharedUniform> m_sharedUniforms;
 };
 
 } // namespace Fermion
\ No newline at end of file
@@ -0,0 +1,54 @@
+﻿#include "fmpch.hpp"
+#include "OpenGLStorageBuffer.hpp"
+#include <glad/glad.h>
+
+namespace Fermion
+{
+    OpenGLStorageBuffer::OpenGLStorageBuffer(uint32_t bindingPoint, uint32_t size)
+        : m_bindingPoint(bindingPoint), m_size(size)
+    {
+        FM_PROFILE_FUNCTION();
+
+        glCreateBuffers(1, &m_rendererID);
+        glNamedBufferData(m_rendererID, size, nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, m_rendererID);
+    }
+
+    OpenGLStorageBuffer::~OpenGLStorageBuffer()
+    {
+        FM_PROFILE_FUNCTION();
+
+        if (m_rendererID != 0)
+        {
+            glDeleteBuffers(1, &m_rendererID);
+        }
+    }
+
+    void OpenGLStorageBuffer::bind() const
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_bindingPoint, m_rendererID);
+    }
+
+    void OpenGLStorageBuffer::unbind() const
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_bindingPoint, 0);
+    }
+
+    void OpenGLStorageBuffer::setData(const void *data, uint32_t size, uint32_t offset)
+    {
+        FM_PROFILE_FUNCTION();
+
+        FERMION_ASSERT(offset + size <= m_size, "Buffer overflow: trying to write beyond buffer size");
+        glNamedBufferSubData(m_rendererID, offset, size, data);
+    }
+
+    void OpenGLStorageBuffer::resize(uint32_t size)
+    {
+        FM_PROFILE_FUNCTION();
+
+        // Orphan the old storage; the buffer name and its binding stay the same
+        glNamedBufferData(m_rendererID, size, nullptr, GL_DYNAMIC_DRAW);
+        m_size = size;
+    }
+
+} // namespace Fermion
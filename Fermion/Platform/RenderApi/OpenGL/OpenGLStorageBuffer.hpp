@@ -0,0 +1,29 @@
+﻿#pragma once
+#include "Renderer/StorageBuffer.hpp"
+
+namespace Fermion
+{
+    // OpenGL implementation of shader storage buffer object
+    class OpenGLStorageBuffer : public StorageBuffer
+    {
+    public:
+        OpenGLStorageBuffer(uint32_t bindingPoint, uint32_t size);
+        virtual ~OpenGLStorageBuffer();
+
+        // Disable copy
+        OpenGLStorageBuffer(const OpenGLStorageBuffer &) = delete;
+        OpenGLStorageBuffer &operator=(const OpenGLStorageBuffer &) = delete;
+
+        virtual void bind() const override;
+        virtual void unbind() const override;
+        virtual void setData(const void *data, uint32_t size, uint32_t offset = 0) override;
+        virtual void resize(uint32_t size) override;
+        virtual uint32_t getSize() const override { return m_size; }
+        virtual uint32_t getBindingPoint() const override { return m_bindingPoint; }
+
+    private:
+        uint32_t m_rendererID = 0;
+        uint32_t m_bindingPoint = 0;
+        uint32_t m_size = 0;
+    };
+} // namespace Fermion
@@ -0,0 +1,137 @@
+﻿#include "fmpch.hpp"
+#include "OpenGLUniformRingBuffer.hpp"
+#include <glad/glad.h>
+
+namespace Fermion
+{
+    namespace
+    {
+        constexpr GLbitfield kMapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        uint32_t alignUp(uint32_t value, uint32_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    } // namespace
+
+    OpenGLUniformRingBuffer::OpenGLUniformRingBuffer(uint32_t frameSize)
+    {
+        FM_PROFILE_FUNCTION();
+
+        GLint alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        if (alignment > 0)
+            m_alignment = static_cast<uint32_t>(alignment);
+
+        createStorage(frameSize);
+    }
+
+    OpenGLUniformRingBuffer::~OpenGLUniformRingBuffer()
+    {
+        FM_PROFILE_FUNCTION();
+
+        for (uint32_t i = 0; i < FrameCount; ++i)
+            waitForFrame(i);
+        destroyStorage();
+    }
+
+    void OpenGLUniformRingBuffer::beginFrame()
+    {
+        FM_PROFILE_FUNCTION();
+
+        if (m_overflowed)
+        {
+            // Every region may still be in flight, so the old storage can only go once all are done
+            for (uint32_t i = 0; i < FrameCount; ++i)
+                waitForFrame(i);
+
+            const uint32_t frameSize = m_frameSize * 2;
+            Log::Warn(std::format("[UniformRingBuffer] Frame region full, growing to {} bytes", frameSize));
+            destroyStorage();
+            createStorage(frameSize);
+            m_overflowed = false;
+        }
+
+        m_frameIndex = (m_frameIndex + 1) % FrameCount;
+        waitForFrame(m_frameIndex);
+        m_frameOffset = 0;
+    }
+
+    void OpenGLUniformRingBuffer::endFrame()
+    {
+        FM_PROFILE_FUNCTION();
+
+        // Nothing was written, so there is nothing for the next user of this region to wait on
+        if (m_frameOffset == 0)
+            return;
+
+        m_fences[m_frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    void *OpenGLUniformRingBuffer::allocate(uint32_t size, uint32_t &offset)
+    {
+        const uint32_t alignedOffset = alignUp(m_frameOffset, m_alignment);
+        if (!m_mappedData || alignedOffset + size > m_frameSize)
+        {
+            m_overflowed = true;
+            return nullptr;
+        }
+
+        m_frameOffset = alignedOffset + size;
+        offset = m_frameIndex * m_frameSize + alignedOffset;
+        return m_mappedData + offset;
+    }
+
+    void OpenGLUniformRingBuffer::bindRange(uint32_t bindingPoint, uint32_t offset, uint32_t size) const
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, m_rendererID, offset, size);
+    }
+
+    void OpenGLUniformRingBuffer::createStorage(uint32_t frameSize)
+    {
+        // Region starts must satisfy the range binding alignment too
+        m_frameSize = alignUp(frameSize, m_alignment);
+        const GLsizeiptr totalSize = static_cast<GLsizeiptr>(m_frameSize) * FrameCount;
+
+        glCreateBuffers(1, &m_rendererID);
+        glNamedBufferStorage(m_rendererID, totalSize, nullptr, kMapFlags);
+        m_mappedData = static_cast<std::byte *>(glMapNamedBufferRange(m_rendererID, 0, totalSize, kMapFlags));
+        if (!m_mappedData)
+            Log::Error("[UniformRingBuffer] Failed to map persistent uniform storage");
+
+        m_frameIndex = 0;
+        m_frameOffset = 0;
+    }
+
+    void OpenGLUniformRingBuffer::destroyStorage()
+    {
+        if (m_rendererID == 0)
+            return;
+
+        if (m_mappedData)
+            glUnmapNamedBuffer(m_rendererID);
+        glDeleteBuffers(1, &m_rendererID);
+        m_rendererID = 0;
+        m_mappedData = nullptr;
+    }
+
+    void OpenGLUniformRingBuffer::waitForFrame(uint32_t frameIndex)
+    {
+        GLsync &fence = m_fences[frameIndex];
+        if (!fence)
+            return;
+
+        // Flush on the first wait so the fence is guaranteed to be submitted
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (true)
+        {
+            const GLenum result = glClientWaitSync(fence, flags, 1'000'000);
+            if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+                break;
+            flags = 0;
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+} // namespace Fermion
@@ -0,0 +1,44 @@
+﻿#pragma once
+#include "Renderer/UniformRingBuffer.hpp"
+
+#include <array>
+
+typedef struct __GLsync *GLsync;
+
+namespace Fermion
+{
+    // OpenGL ring buffer backed by immutable storage mapped once with
+    // GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT, one fence per frame region
+    class OpenGLUniformRingBuffer : public UniformRingBuffer
+    {
+    public:
+        explicit OpenGLUniformRingBuffer(uint32_t frameSize);
+        virtual ~OpenGLUniformRingBuffer();
+
+        // Disable copy
+        OpenGLUniformRingBuffer(const OpenGLUniformRingBuffer &) = delete;
+        OpenGLUniformRingBuffer &operator=(const OpenGLUniformRingBuffer &) = delete;
+
+        virtual void beginFrame() override;
+        virtual void endFrame() override;
+        virtual void *allocate(uint32_t size, uint32_t &offset) override;
+        virtual void bindRange(uint32_t bindingPoint, uint32_t offset, uint32_t size) const override;
+        virtual uint32_t getFrameSize() const override { return m_frameSize; }
+
+    private:
+        void createStorage(uint32_t frameSize);
+        void destroyStorage();
+        void waitForFrame(uint32_t frameIndex);
+
+    private:
+        uint32_t m_rendererID = 0;
+        std::byte *m_mappedData = nullptr;
+        std::array<GLsync, FrameCount> m_fences{};
+
+        uint32_t m_frameSize = 0;
+        uint32_t m_alignment = 256;
+        uint32_t m_frameIndex = 0;
+        uint32_t m_frameOffset = 0;
+        bool m_overflowed = false;
+    };
+} // namespace Fermion
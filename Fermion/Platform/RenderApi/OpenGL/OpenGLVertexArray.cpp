@@ -18,6 +18,9 @@ static GLenum ShaderDataTypeToOpenGLBaseType(ShaderDataType type) {
     case ShaderDataType::Int3: return GL_INT;
     case ShaderDataType::Int4: return GL_INT;
     case ShaderDataType::Bool: return GL_BOOL;
+    case ShaderDataType::Half2: return GL_HALF_FLOAT;
+    case ShaderDataType::UByte4: return GL_UNSIGNED_BYTE;
+    case ShaderDataType::Int1010102: return GL_INT_2_10_10_10_REV;
     }
 
     return 0;
@@ -59,7 +62,10 @@ void OpenGLVertexArray::addVertexBuffer(const std::shared_ptr<VertexBuffer> &ver
         case ShaderDataType::Float:
         case ShaderDataType::Float2:
         case ShaderDataType::Float3:
-        case ShaderDataType::Float4: {
+        case ShaderDataType::Float4:
+        case ShaderDataType::Half2:
+        case ShaderDataType::UByte4:
+        case ShaderDataType::Int1010102: {
             glEnableVertexAttribArray(m_vertexBufferIndex);
             glVertexAttribPointer(m_vertexBufferIndex,
                                   element.getComponentCount(),
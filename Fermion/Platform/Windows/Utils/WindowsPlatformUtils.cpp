@@ -142,4 +142,61 @@ namespace Fermion
         return result != -1;
     }
 
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    bool MappedFile::open(const std::filesystem::path &path)
+    {
+        close();
+
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_data = static_cast<const uint8_t *>(data);
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+        m_fileHandle = file;
+        m_mappingHandle = mapping;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mappingHandle)
+            CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+        if (m_fileHandle)
+            CloseHandle(static_cast<HANDLE>(m_fileHandle));
+        m_data = nullptr;
+        m_size = 0;
+        m_fileHandle = nullptr;
+        m_mappingHandle = nullptr;
+    }
+
 } // namespace Fermion
@@ -3,7 +3,10 @@
 #include "Asset/AssetManager.hpp"
 #include "Asset/AssetSerializer.hpp"
 #include "Renderer/Model/MaterialSerializer.hpp"
+#include "Renderer/Model/MeshletBuilder.hpp"
+#include "Renderer/Model/MeshOptimizer.hpp"
 #include "Renderer/Model/MeshSerializer.hpp"
+#include "Renderer/Model/MeshSimplifier.hpp"
 #include "Renderer/Model/ModelSerializer.hpp"
 #include "Animation/Skeleton.hpp"
 #include "Animation/AnimationClip.hpp"
@@ -549,7 +552,8 @@ namespace Fermion
 
         Assimp::Importer importer;
         const aiScene *scene = importer.ReadFile(assetPath.string(),
-                                                 aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_FlipUVs | aiProcess_LimitBoneWeights);
+                                                 aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_FlipUVs | aiProcess_LimitBoneWeights |
+                                                 aiProcess_JoinIdenticalVertices);
 
         if (!scene || !scene->mRootNode)
         {
@@ -647,14 +651,36 @@ namespace Fermion
         Log::Info(std::format("ModelSourceImporter: Generated {} SubMeshes with {} total vertices, {} indices",
                  subMeshes.size(), vertices.size(), indices.size()));
 
+        // assimp joins within each of its meshes only; merge what is left per submesh, bone data included
+        const size_t sourceVertexCount = vertices.size();
+        MeshOptimizer::weldVertices(vertices, indices, boneData, subMeshes);
+
+        // Coarser levels for distant draws; they only append indices over the same vertices
+        const size_t baseIndexCount = indices.size();
+        std::vector<SubMeshLod> lods = MeshSimplifier::generateLods(vertices, indices, subMeshes);
+        if (!lods.empty())
+        {
+            Log::Info(std::format("ModelSourceImporter: Generated {} LOD levels, {} extra indices",
+                     lods.size() / subMeshes.size(), indices.size() - baseIndexCount));
+        }
+
+        // Vertex cache and overdraw order for every range, then vertices in the order they are fetched
+        MeshOptimizer::optimizeRanges(indices, vertices, subMeshes, lods);
+        // Clusters for per-meshlet culling; they follow the optimized order, which the renumbering below keeps
+        std::vector<Meshlet> meshlets = MeshletBuilder::build(vertices, indices, subMeshes);
+        MeshOptimizer::optimizeVertexFetch(vertices, indices, boneData);
+        Log::Info(std::format("ModelSourceImporter: Optimized mesh, {} of {} vertices left after welding, {} meshlets",
+                 vertices.size(), sourceVertexCount, meshlets.size()));
+
         AssetMetadata meshMeta;
         meshMeta.Handle = make_handle_non_zero();
         meshMeta.Type = AssetType::Mesh;
         meshMeta.FilePath = meshPath;
         meshMeta.Name = assetPath.stem().string();
 
-        Mesh mesh(std::move(vertices), std::move(indices), std::move(subMeshes));
+        Mesh mesh(std::move(vertices), std::move(indices), std::move(subMeshes), std::move(lods));
         mesh.handle = meshMeta.Handle;
+        mesh.setMeshlets(std::move(meshlets));
 
         // Set bone data if present (for skinned meshes)
         if (!boneData.empty())
@@ -2,6 +2,7 @@
 
 #include "Core/Window.hpp"
 #include "Core/LayerStack.hpp"
+#include "Core/JobSystem.hpp"
 #include "Core/Layer.hpp"
 #include "Events/Event.hpp"
 #include "Events/ApplicationEvent.hpp"
@@ -32,6 +33,7 @@ namespace Fermion
         m_window->setEventCallback([this](IEvent &event)
                                    { this->onEvent(event); });
         m_window->setVSync(false);
+        JobSystem::init();
         Renderer::init();
         ScriptManager::init();
         MeshFactory::Init();
@@ -45,6 +47,8 @@ namespace Fermion
     {
         FM_PROFILE_FUNCTION();
         ScriptManager::shutdown();
+        JobSystem::shutdown();
+        Renderer::shutdown();
     }
 
     void Application::run()
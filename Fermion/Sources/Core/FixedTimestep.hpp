@@ -0,0 +1,54 @@
+#pragma once
+#include "Core/Timestep.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace Fermion
+{
+    // Turns variable frame times into a whole number of fixed steps. Time beyond 'maxSteps' per frame is
+    // dropped instead of carried over, so a single hitch can't make every following frame fall further behind.
+    class FixedTimestep
+    {
+    public:
+        FixedTimestep(float stepSeconds = 1.0f / 60.0f, uint32_t maxSteps = 8)
+            : m_stepSeconds(stepSeconds), m_maxSteps(maxSteps)
+        {
+        }
+
+        void setStepSeconds(float seconds) { m_stepSeconds = std::max(seconds, 1e-4f); }
+        float getStepSeconds() const { return m_stepSeconds; }
+
+        void setMaxSteps(uint32_t steps) { m_maxSteps = std::max(steps, 1u); }
+        uint32_t getMaxSteps() const { return m_maxSteps; }
+
+        // Adds a frame's worth of time and returns how many fixed steps to run for it
+        uint32_t advance(Timestep ts)
+        {
+            m_accumulator += std::max(ts.getSeconds(), 0.0f);
+
+            uint32_t steps = static_cast<uint32_t>(m_accumulator / m_stepSeconds);
+            if (steps > m_maxSteps)
+            {
+                steps = m_maxSteps;
+                m_accumulator = std::fmod(m_accumulator, m_stepSeconds);
+            }
+            else
+            {
+                m_accumulator = std::max(m_accumulator - static_cast<float>(steps) * m_stepSeconds, 0.0f);
+            }
+            return steps;
+        }
+
+        // Fraction of a step the accumulator is ahead of the last step, in [0, 1)
+        float getAlpha() const { return std::min(m_accumulator / m_stepSeconds, 1.0f); }
+
+        void reset() { m_accumulator = 0.0f; }
+
+    private:
+        float m_stepSeconds;
+        uint32_t m_maxSteps;
+        float m_accumulator = 0.0f;
+    };
+} // namespace Fermion
@@ -0,0 +1,222 @@
+#include "fmpch.hpp"
+#include "Core/JobSystem.hpp"
+
+#include <condition_variable>
+#include <deque>
+
+namespace Fermion
+{
+    namespace
+    {
+        struct Job
+        {
+            std::function<void()> function;
+            JobCounter *counter = nullptr;
+        };
+
+        // The owning thread pushes and pops at the back, thieves take from the front
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        std::vector<std::unique_ptr<WorkerQueue>> s_queues;
+        std::vector<std::thread> s_workers;
+
+        std::atomic<bool> s_running{false};
+        std::atomic<uint32_t> s_queuedJobs{0};
+        std::mutex s_wakeMutex;
+        std::condition_variable s_wakeCondition;
+
+        // Threads outside the pool share the main thread's queue
+        thread_local uint32_t s_threadIndex = 0;
+    } // namespace
+
+    void JobSystem::init(uint32_t workerCount)
+    {
+        if (s_running)
+            return;
+
+        if (workerCount == 0)
+        {
+            uint32_t hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+        }
+
+        s_threadIndex = 0;
+        s_queues.clear();
+        for (uint32_t i = 0; i < workerCount + 1; ++i)
+            s_queues.push_back(std::make_unique<WorkerQueue>());
+
+        s_running = true;
+        s_workers.reserve(workerCount);
+        for (uint32_t i = 1; i <= workerCount; ++i)
+            s_workers.emplace_back(&JobSystem::workerLoop, i);
+
+        Log::Info(std::format("JobSystem started with {} worker threads", workerCount));
+    }
+
+    void JobSystem::shutdown()
+    {
+        if (!s_running)
+            return;
+
+        // Let already queued work finish on the main thread before the workers go away
+        while (tryExecuteOne(0))
+        {
+        }
+
+        {
+            std::lock_guard lock(s_wakeMutex);
+            s_running = false;
+        }
+        s_wakeCondition.notify_all();
+
+        for (auto &worker : s_workers)
+            worker.join();
+        s_workers.clear();
+        s_queues.clear();
+        s_queuedJobs = 0;
+    }
+
+    bool JobSystem::isInitialized()
+    {
+        return s_running;
+    }
+
+    uint32_t JobSystem::getThreadCount()
+    {
+        return s_running ? static_cast<uint32_t>(s_queues.size()) : 1u;
+    }
+
+    uint32_t JobSystem::getThreadIndex()
+    {
+        return s_threadIndex;
+    }
+
+    void JobSystem::schedule(std::function<void()> job, JobCounter *counter, JobCounter *dependency)
+    {
+        if (counter)
+            counter->m_pending.fetch_add(1, std::memory_order_acq_rel);
+
+        if (dependency)
+        {
+            std::unique_lock lock(dependency->m_mutex);
+            if (!dependency->isDone())
+            {
+                dependency->m_continuations.push_back({std::move(job), counter});
+                return;
+            }
+        }
+
+        enqueue(std::move(job), counter);
+    }
+
+    void JobSystem::wait(JobCounter &counter)
+    {
+        const uint32_t threadIndex = s_threadIndex;
+        while (!counter.isDone())
+        {
+            if (!tryExecuteOne(threadIndex))
+                std::this_thread::yield();
+        }
+    }
+
+    void JobSystem::enqueue(std::function<void()> function, JobCounter *counter)
+    {
+        if (!s_running)
+        {
+            // No pool (e.g. tools that never called init): run inline so callers still make progress
+            function();
+            finishJob(counter);
+            return;
+        }
+
+        WorkerQueue &queue = *s_queues[s_threadIndex];
+        {
+            std::lock_guard lock(queue.mutex);
+            queue.jobs.push_back({std::move(function), counter});
+        }
+        s_queuedJobs.fetch_add(1, std::memory_order_release);
+
+        // Taking the lock orders this notify after a sleeping worker's predicate check
+        {
+            std::lock_guard lock(s_wakeMutex);
+        }
+        s_wakeCondition.notify_one();
+    }
+
+    void JobSystem::finishJob(JobCounter *counter)
+    {
+        if (!counter)
+            return;
+
+        std::vector<JobCounter::Continuation> continuations;
+        {
+            // Decrement under the lock so schedule() can't park a continuation after we collected them
+            std::lock_guard lock(counter->m_mutex);
+            if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                continuations.swap(counter->m_continuations);
+        }
+        for (auto &continuation : continuations)
+            enqueue(std::move(continuation.function), continuation.counter);
+    }
+
+    bool JobSystem::tryExecuteOne(uint32_t threadIndex)
+    {
+        if (s_queuedJobs.load(std::memory_order_acquire) == 0)
+            return false;
+
+        Job job;
+        bool found = false;
+
+        {
+            WorkerQueue &own = *s_queues[threadIndex];
+            std::lock_guard lock(own.mutex);
+            if (!own.jobs.empty())
+            {
+                job = std::move(own.jobs.back());
+                own.jobs.pop_back();
+                found = true;
+            }
+        }
+
+        const uint32_t queueCount = static_cast<uint32_t>(s_queues.size());
+        for (uint32_t offset = 1; !found && offset < queueCount; ++offset)
+        {
+            WorkerQueue &victim = *s_queues[(threadIndex + offset) % queueCount];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.jobs.empty())
+            {
+                job = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                found = true;
+            }
+        }
+
+        if (!found)
+            return false;
+
+        s_queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+        job.function();
+        finishJob(job.counter);
+        return true;
+    }
+
+    void JobSystem::workerLoop(uint32_t threadIndex)
+    {
+        s_threadIndex = threadIndex;
+        while (true)
+        {
+            if (tryExecuteOne(threadIndex))
+                continue;
+
+            std::unique_lock lock(s_wakeMutex);
+            s_wakeCondition.wait(lock, []()
+                                 { return !s_running || s_queuedJobs.load(std::memory_order_acquire) > 0; });
+            if (!s_running)
+                return;
+        }
+    }
+} // namespace Fermion
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Fermion
+{
+    // Counts the jobs scheduled against it that have not finished yet.
+    // Jobs scheduled with this counter as a dependency are queued once it drops to zero.
+    class JobCounter
+    {
+    public:
+        JobCounter() = default;
+        // The last finishing job releases m_mutex after the count hits zero; don't free it underneath that job
+        ~JobCounter() { std::lock_guard lock(m_mutex); }
+        JobCounter(const JobCounter &) = delete;
+        JobCounter &operator=(const JobCounter &) = delete;
+
+        bool isDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        struct Continuation
+        {
+            std::function<void()> function;
+            JobCounter *counter = nullptr;
+        };
+
+        std::atomic<uint32_t> m_pending{0};
+        std::mutex m_mutex;
+        std::vector<Continuation> m_continuations;
+
+        friend class JobSystem;
+    };
+
+    // Work-stealing job system shared by the engine, Jolt and Box2D.
+    // Thread index 0 is the thread that called init(); workers are 1..getThreadCount()-1.
+    class JobSystem
+    {
+    public:
+        // workerCount == 0 picks hardware_concurrency - 1
+        static void init(uint32_t workerCount = 0);
+        static void shutdown();
+
+        static bool isInitialized();
+        // Worker threads plus the main thread
+        static uint32_t getThreadCount();
+        static uint32_t getThreadIndex();
+
+        // Runs 'job' on any thread. 'counter' is incremented now and decremented when the job finishes.
+        // If 'dependency' is given the job is held back until that counter reaches zero.
+        static void schedule(std::function<void()> job, JobCounter *counter = nullptr,
+                             JobCounter *dependency = nullptr);
+
+        // Blocks until the counter reaches zero, executing other jobs in the meantime
+        static void wait(JobCounter &counter);
+
+        // Calls function(begin, end) for consecutive sub-ranges of [0, count) of at most grainSize items
+        template <typename Function>
+        static void parallelForRange(uint32_t count, uint32_t grainSize, Function &&function)
+        {
+            if (count == 0)
+                return;
+
+            grainSize = std::max(grainSize, 1u);
+            if (!isInitialized() || count <= grainSize)
+            {
+                function(0u, count);
+                return;
+            }
+
+            JobCounter counter;
+            for (uint32_t begin = 0; begin < count; begin += grainSize)
+            {
+                uint32_t end = std::min(count, begin + grainSize);
+                schedule([&function, begin, end]()
+                         { function(begin, end); },
+                         &counter);
+            }
+            wait(counter);
+        }
+
+        template <typename Function>
+        static void parallelFor(uint32_t count, uint32_t grainSize, Function &&function)
+        {
+            parallelForRange(count, grainSize, [&function](uint32_t begin, uint32_t end)
+                             {
+                for (uint32_t i = begin; i < end; ++i)
+                    function(i); });
+        }
+
+    private:
+        static void enqueue(std::function<void()> function, JobCounter *counter);
+        static void finishJob(JobCounter *counter);
+        static bool tryExecuteOne(uint32_t threadIndex);
+        static void workerLoop(uint32_t threadIndex);
+    };
+} // namespace Fermion
@@ -36,6 +36,7 @@
 #include "Renderer/Renderers/Renderer2D.hpp"
 #include "Renderer/Renderers/Renderer2DCompat.hpp"
 #include "Renderer/Renderers/SceneRenderer.hpp"
+#include "Renderer/Renderers/HeadlessRenderer.hpp"
 #include "Renderer/Shader.hpp"
 #include "Renderer/VertexArray.hpp"
 #include "Renderer/Texture/Texture.hpp"
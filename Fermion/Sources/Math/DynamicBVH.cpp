@@ -0,0 +1,383 @@
+#include "fmpch.hpp"
+#include "DynamicBVH.hpp"
+
+namespace Fermion
+{
+    namespace
+    {
+        // Leaves are stored enlarged so small movements don't touch the tree
+        constexpr float kAABBMargin = 0.1f;
+
+        AABB combine(const AABB &a, const AABB &b)
+        {
+            return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+        }
+
+        float area(const AABB &aabb)
+        {
+            glm::vec3 d = aabb.max - aabb.min;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        bool contains(const AABB &outer, const AABB &inner)
+        {
+            return glm::all(glm::lessThanEqual(outer.min, inner.min)) &&
+                   glm::all(glm::greaterThanEqual(outer.max, inner.max));
+        }
+
+        AABB fatten(const AABB &aabb)
+        {
+            return {aabb.min - glm::vec3(kAABBMargin), aabb.max + glm::vec3(kAABBMargin)};
+        }
+    } // namespace
+
+    int32_t DynamicBVH::createProxy(const AABB &aabb, uint32_t userData)
+    {
+        int32_t proxyId = allocateNode();
+        Node &node = m_nodes[proxyId];
+        node.aabb = fatten(aabb);
+        node.userData = userData;
+        node.height = 0;
+
+        insertLeaf(proxyId);
+        ++m_proxyCount;
+        return proxyId;
+    }
+
+    void DynamicBVH::destroyProxy(int32_t proxyId)
+    {
+        FERMION_ASSERT(proxyId >= 0 && proxyId < static_cast<int32_t>(m_nodes.size()), "Invalid BVH proxy");
+        FERMION_ASSERT(m_nodes[proxyId].isLeaf(), "BVH proxy is not a leaf");
+
+        removeLeaf(proxyId);
+        freeNode(proxyId);
+        --m_proxyCount;
+    }
+
+    bool DynamicBVH::moveProxy(int32_t proxyId, const AABB &aabb)
+    {
+        FERMION_ASSERT(proxyId >= 0 && proxyId < static_cast<int32_t>(m_nodes.size()), "Invalid BVH proxy");
+        FERMION_ASSERT(m_nodes[proxyId].isLeaf(), "BVH proxy is not a leaf");
+
+        Node &leaf = m_nodes[proxyId];
+        if (contains(leaf.aabb, aabb))
+            return false;
+
+        const AABB fatAABB = fatten(aabb);
+        if (!overlaps(leaf.aabb, fatAABB))
+        {
+            // Teleported: the old position says nothing about where it belongs now
+            removeLeaf(proxyId);
+            m_nodes[proxyId].aabb = fatAABB;
+            insertLeaf(proxyId);
+            return true;
+        }
+
+        // Small move: refit in place and let the rotations on the way up repair the structure
+        leaf.aabb = fatAABB;
+        refitAncestors(leaf.parent);
+        return true;
+    }
+
+    void DynamicBVH::clear()
+    {
+        m_nodes.clear();
+        m_root = NullNode;
+        m_freeList = NullNode;
+        m_proxyCount = 0;
+    }
+
+    float DynamicBVH::getAreaRatio() const
+    {
+        if (m_root == NullNode)
+            return 0.0f;
+
+        const float rootArea = area(m_nodes[m_root].aabb);
+        if (rootArea <= 0.0f)
+            return 0.0f;
+
+        float totalArea = 0.0f;
+        for (const Node &node : m_nodes)
+        {
+            if (node.height > 0)
+                totalArea += area(node.aabb);
+        }
+        return totalArea / rootArea;
+    }
+
+    bool DynamicBVH::overlaps(const AABB &a, const AABB &b)
+    {
+        return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::lessThanEqual(b.min, a.max));
+    }
+
+    float DynamicBVH::distanceSquared(const AABB &aabb, const glm::vec3 &point)
+    {
+        glm::vec3 closest = glm::clamp(point, aabb.min, aabb.max);
+        glm::vec3 delta = point - closest;
+        return glm::dot(delta, delta);
+    }
+
+    bool DynamicBVH::intersectRay(const AABB &aabb, const glm::vec3 &origin, const glm::vec3 &inverseDirection,
+                                  float maxDistance, float &entry)
+    {
+        glm::vec3 t0 = (aabb.min - origin) * inverseDirection;
+        glm::vec3 t1 = (aabb.max - origin) * inverseDirection;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+
+        float enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+        float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+        if (enter > exit)
+            return false;
+
+        entry = enter;
+        return true;
+    }
+
+    DynamicBVH::FrustumResult DynamicBVH::classifyFrustum(const std::array<glm::vec4, 6> &planes, const AABB &aabb)
+    {
+        FrustumResult result = FrustumResult::Inside;
+        for (const auto &plane : planes)
+        {
+            const glm::vec3 normal(plane);
+            const glm::vec3 positive = {
+                normal.x >= 0.0f ? aabb.max.x : aabb.min.x,
+                normal.y >= 0.0f ? aabb.max.y : aabb.min.y,
+                normal.z >= 0.0f ? aabb.max.z : aabb.min.z};
+            if (glm::dot(normal, positive) + plane.w < 0.0f)
+                return FrustumResult::Outside;
+
+            const glm::vec3 negative = {
+                normal.x >= 0.0f ? aabb.min.x : aabb.max.x,
+                normal.y >= 0.0f ? aabb.min.y : aabb.max.y,
+                normal.z >= 0.0f ? aabb.min.z : aabb.max.z};
+            if (glm::dot(normal, negative) + plane.w < 0.0f)
+                result = FrustumResult::Intersecting;
+        }
+        return result;
+    }
+
+    int32_t DynamicBVH::allocateNode()
+    {
+        if (m_freeList == NullNode)
+        {
+            m_nodes.emplace_back();
+            return static_cast<int32_t>(m_nodes.size() - 1);
+        }
+
+        int32_t index = m_freeList;
+        m_freeList = m_nodes[index].parent;
+        m_nodes[index] = Node{};
+        return index;
+    }
+
+    void DynamicBVH::freeNode(int32_t index)
+    {
+        Node &node = m_nodes[index];
+        node.parent = m_freeList;
+        node.child1 = NullNode;
+        node.child2 = NullNode;
+        node.height = -1;
+        m_freeList = index;
+    }
+
+    int32_t DynamicBVH::findBestSibling(const AABB &aabb) const
+    {
+        // Branch and bound over the SAH cost: the cost of placing the leaf next to a node is the area of
+        // the new parent plus the growth it causes in every ancestor.
+        const float leafArea = area(aabb);
+
+        int32_t best = m_root;
+        float bestCost = area(combine(m_nodes[m_root].aabb, aabb));
+
+        struct Candidate
+        {
+            int32_t index;
+            float inheritedCost;
+        };
+        std::vector<Candidate> stack;
+        stack.push_back({m_root, 0.0f});
+
+        while (!stack.empty())
+        {
+            Candidate candidate = stack.back();
+            stack.pop_back();
+            const Node &node = m_nodes[candidate.index];
+
+            const float directCost = area(combine(node.aabb, aabb));
+            const float cost = directCost + candidate.inheritedCost;
+            if (cost < bestCost)
+            {
+                best = candidate.index;
+                bestCost = cost;
+            }
+
+            if (node.isLeaf())
+                continue;
+
+            const float inheritedCost = candidate.inheritedCost + directCost - area(node.aabb);
+            if (leafArea + inheritedCost < bestCost)
+            {
+                stack.push_back({node.child1, inheritedCost});
+                stack.push_back({node.child2, inheritedCost});
+            }
+        }
+
+        return best;
+    }
+
+    void DynamicBVH::insertLeaf(int32_t leaf)
+    {
+        if (m_root == NullNode)
+        {
+            m_root = leaf;
+            m_nodes[leaf].parent = NullNode;
+            return;
+        }
+
+        const int32_t sibling = findBestSibling(m_nodes[leaf].aabb);
+        const int32_t oldParent = m_nodes[sibling].parent;
+
+        const int32_t newParent = allocateNode();
+        Node &parent = m_nodes[newParent];
+        parent.parent = oldParent;
+        parent.child1 = sibling;
+        parent.child2 = leaf;
+
+        if (oldParent != NullNode)
+        {
+            if (m_nodes[oldParent].child1 == sibling)
+                m_nodes[oldParent].child1 = newParent;
+            else
+                m_nodes[oldParent].child2 = newParent;
+        }
+        else
+        {
+            m_root = newParent;
+        }
+
+        m_nodes[sibling].parent = newParent;
+        m_nodes[leaf].parent = newParent;
+
+        refitAncestors(newParent);
+    }
+
+    void DynamicBVH::removeLeaf(int32_t leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = NullNode;
+            return;
+        }
+
+        const int32_t parent = m_nodes[leaf].parent;
+        const int32_t grandParent = m_nodes[parent].parent;
+        const int32_t sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+        if (grandParent != NullNode)
+        {
+            if (m_nodes[grandParent].child1 == parent)
+                m_nodes[grandParent].child1 = sibling;
+            else
+                m_nodes[grandParent].child2 = sibling;
+            m_nodes[sibling].parent = grandParent;
+            freeNode(parent);
+            refitAncestors(grandParent);
+        }
+        else
+        {
+            m_root = sibling;
+            m_nodes[sibling].parent = NullNode;
+            freeNode(parent);
+        }
+        m_nodes[leaf].parent = NullNode;
+    }
+
+    void DynamicBVH::refitNode(int32_t index)
+    {
+        Node &node = m_nodes[index];
+        const Node &child1 = m_nodes[node.child1];
+        const Node &child2 = m_nodes[node.child2];
+        node.aabb = combine(child1.aabb, child2.aabb);
+        node.height = 1 + glm::max(child1.height, child2.height);
+    }
+
+    void DynamicBVH::refitAncestors(int32_t index)
+    {
+        while (index != NullNode)
+        {
+            refitNode(index);
+            rotate(index);
+            index = m_nodes[index].parent;
+        }
+    }
+
+    void DynamicBVH::rotate(int32_t index)
+    {
+        // Try swapping one child of 'index' with a grandchild under the other child. The only internal
+        // node whose bounds change is the grandchild's parent, so keep the swap that shrinks it the most.
+        const Node &node = m_nodes[index];
+        if (node.height < 2)
+            return;
+
+        const int32_t b = node.child1;
+        const int32_t c = node.child2;
+        const Node &nodeB = m_nodes[b];
+        const Node &nodeC = m_nodes[c];
+
+        float bestDelta = 0.0f;
+        int32_t bestUpper = NullNode;
+        int32_t bestLower = NullNode;
+
+        auto consider = [&](int32_t upper, int32_t lower, int32_t lowerSibling, int32_t lowerParent)
+        {
+            const float delta = area(combine(m_nodes[upper].aabb, m_nodes[lowerSibling].aabb)) -
+                                area(m_nodes[lowerParent].aabb);
+            if (delta < bestDelta)
+            {
+                bestDelta = delta;
+                bestUpper = upper;
+                bestLower = lower;
+            }
+        };
+
+        if (!nodeC.isLeaf())
+        {
+            consider(b, nodeC.child1, nodeC.child2, c);
+            consider(b, nodeC.child2, nodeC.child1, c);
+        }
+        if (!nodeB.isLeaf())
+        {
+            consider(c, nodeB.child1, nodeB.child2, b);
+            consider(c, nodeB.child2, nodeB.child1, b);
+        }
+
+        if (bestUpper != NullNode)
+            swapNodes(bestUpper, bestLower);
+    }
+
+    void DynamicBVH::swapNodes(int32_t upper, int32_t lower)
+    {
+        // 'upper' is a child of A, 'lower' a child of upper's sibling
+        const int32_t a = m_nodes[upper].parent;
+        const int32_t lowerParent = m_nodes[lower].parent;
+
+        Node &nodeA = m_nodes[a];
+        if (nodeA.child1 == upper)
+            nodeA.child1 = lower;
+        else
+            nodeA.child2 = lower;
+
+        Node &nodeLowerParent = m_nodes[lowerParent];
+        if (nodeLowerParent.child1 == lower)
+            nodeLowerParent.child1 = upper;
+        else
+            nodeLowerParent.child2 = upper;
+
+        m_nodes[lower].parent = a;
+        m_nodes[upper].parent = lowerParent;
+
+        refitNode(lowerParent);
+        refitNode(a);
+    }
+} // namespace Fermion
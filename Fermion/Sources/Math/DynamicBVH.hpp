@@ -0,0 +1,225 @@
+#pragma once
+
+#include "AABB.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Fermion
+{
+    // Incrementally maintained AABB tree. Leaves are inserted at the sibling with the lowest
+    // surface-area cost and every ancestor touched by an insert, remove or refit is rebalanced
+    // with tree rotations, so the tree stays good without periodic rebuilds.
+    // Proxy ids are node indices and stay valid until destroyProxy().
+    class DynamicBVH
+    {
+    public:
+        static constexpr int32_t NullNode = -1;
+
+        DynamicBVH() = default;
+
+        int32_t createProxy(const AABB &aabb, uint32_t userData);
+        void destroyProxy(int32_t proxyId);
+        // Refits the proxy to 'aabb'. Returns false when the enlarged bounds still contain it and
+        // the tree was left untouched.
+        bool moveProxy(int32_t proxyId, const AABB &aabb);
+        void clear();
+
+        uint32_t getUserData(int32_t proxyId) const { return m_nodes[proxyId].userData; }
+        const AABB &getFatAABB(int32_t proxyId) const { return m_nodes[proxyId].aabb; }
+        uint32_t getProxyCount() const { return m_proxyCount; }
+        int32_t getHeight() const { return m_root == NullNode ? 0 : m_nodes[m_root].height; }
+        // Fat bounds of the whole tree; false when it is empty
+        bool getRootAABB(AABB &outAABB) const
+        {
+            if (m_root == NullNode)
+                return false;
+            outAABB = m_nodes[m_root].aabb;
+            return true;
+        }
+        // Sum of internal node areas over the root area, 1.0 is the best possible
+        float getAreaRatio() const;
+
+        // callback(userData, fullyInside); fullyInside is true when the proxy's whole fat box is in the frustum
+        template <typename Callback>
+        void queryFrustum(const std::array<glm::vec4, 6> &planes, Callback &&callback) const
+        {
+            if (m_root == NullNode)
+                return;
+
+            std::vector<int32_t> stack;
+            std::vector<int32_t> insideStack;
+            stack.push_back(m_root);
+            while (!stack.empty())
+            {
+                int32_t index = stack.back();
+                stack.pop_back();
+                const Node &node = m_nodes[index];
+
+                FrustumResult result = classifyFrustum(planes, node.aabb);
+                if (result == FrustumResult::Outside)
+                    continue;
+
+                if (result == FrustumResult::Inside)
+                {
+                    // Whole subtree is visible, no further plane tests
+                    insideStack.push_back(index);
+                    while (!insideStack.empty())
+                    {
+                        const Node &inside = m_nodes[insideStack.back()];
+                        insideStack.pop_back();
+                        if (inside.isLeaf())
+                        {
+                            callback(inside.userData, true);
+                            continue;
+                        }
+                        insideStack.push_back(inside.child1);
+                        insideStack.push_back(inside.child2);
+                    }
+                    continue;
+                }
+
+                if (node.isLeaf())
+                {
+                    callback(node.userData, false);
+                    continue;
+                }
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+
+        // callback(userData) for every proxy whose fat box overlaps 'aabb'
+        template <typename Callback>
+        void queryAABB(const AABB &aabb, Callback &&callback) const
+        {
+            if (m_root == NullNode)
+                return;
+
+            std::vector<int32_t> stack;
+            stack.push_back(m_root);
+            while (!stack.empty())
+            {
+                const Node &node = m_nodes[stack.back()];
+                stack.pop_back();
+                if (!overlaps(node.aabb, aabb))
+                    continue;
+
+                if (node.isLeaf())
+                {
+                    callback(node.userData);
+                    continue;
+                }
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+
+        // callback(userData) for every proxy whose fat box touches the sphere
+        template <typename Callback>
+        void querySphere(const glm::vec3 &center, float radius, Callback &&callback) const
+        {
+            if (m_root == NullNode)
+                return;
+
+            const float radiusSq = radius * radius;
+            std::vector<int32_t> stack;
+            stack.push_back(m_root);
+            while (!stack.empty())
+            {
+                const Node &node = m_nodes[stack.back()];
+                stack.pop_back();
+                if (distanceSquared(node.aabb, center) > radiusSq)
+                    continue;
+
+                if (node.isLeaf())
+                {
+                    callback(node.userData);
+                    continue;
+                }
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+
+        // callback(userData, entryDistance) -> float. The returned value becomes the new maximum distance,
+        // so returning the hit distance clips the ray and returning 0 stops the query.
+        template <typename Callback>
+        void raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, Callback &&callback) const
+        {
+            if (m_root == NullNode)
+                return;
+
+            const glm::vec3 inverseDirection = 1.0f / direction;
+            std::vector<int32_t> stack;
+            stack.push_back(m_root);
+            while (!stack.empty())
+            {
+                const Node &node = m_nodes[stack.back()];
+                stack.pop_back();
+
+                float entry = 0.0f;
+                if (!intersectRay(node.aabb, origin, inverseDirection, maxDistance, entry))
+                    continue;
+
+                if (node.isLeaf())
+                {
+                    maxDistance = callback(node.userData, entry);
+                    if (maxDistance <= 0.0f)
+                        return;
+                    continue;
+                }
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+
+        static bool overlaps(const AABB &a, const AABB &b);
+        static float distanceSquared(const AABB &aabb, const glm::vec3 &point);
+        // Slab test, 'entry' is the distance along the ray where it enters the box (0 if it starts inside)
+        static bool intersectRay(const AABB &aabb, const glm::vec3 &origin, const glm::vec3 &inverseDirection,
+                                 float maxDistance, float &entry);
+
+    private:
+        struct Node
+        {
+            AABB aabb;
+            int32_t parent = NullNode; // next free node while on the free list
+            int32_t child1 = NullNode;
+            int32_t child2 = NullNode;
+            int32_t height = 0; // 0 for leaves, -1 for free nodes
+            uint32_t userData = 0;
+
+            bool isLeaf() const { return child1 == NullNode; }
+        };
+
+        enum class FrustumResult : uint8_t
+        {
+            Outside,
+            Intersecting,
+            Inside
+        };
+
+        static FrustumResult classifyFrustum(const std::array<glm::vec4, 6> &planes, const AABB &aabb);
+
+        int32_t allocateNode();
+        void freeNode(int32_t index);
+
+        void insertLeaf(int32_t leaf);
+        void removeLeaf(int32_t leaf);
+        int32_t findBestSibling(const AABB &aabb) const;
+
+        void refitNode(int32_t index);
+        void refitAncestors(int32_t index);
+        void rotate(int32_t index);
+        void swapNodes(int32_t upper, int32_t lower);
+
+    private:
+        std::vector<Node> m_nodes;
+        int32_t m_root = NullNode;
+        int32_t m_freeList = NullNode;
+        uint32_t m_proxyCount = 0;
+    };
+} // namespace Fermion
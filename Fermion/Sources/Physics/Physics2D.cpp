@@ -4,9 +4,38 @@
 #include "Scene/Entity.hpp"
 #include "Scene/EntityManager.hpp"
 #include "Core/Log.hpp"
+#include "Core/JobSystem.hpp"
 
 namespace Fermion
 {
+    namespace
+    {
+        // Box2D indexes per-worker scratch memory by worker index, so the pool must not exceed its limit
+        constexpr uint32_t kMaxBox2DWorkers = 64;
+
+        void *EnqueueBox2DTask(b2TaskCallback *task, int itemCount, int minRange, void *taskContext, void *userContext)
+        {
+            auto *counter = new JobCounter();
+            const int threadCount = static_cast<int>(JobSystem::getThreadCount());
+            const int rangeSize = std::max(minRange, (itemCount + threadCount - 1) / threadCount);
+            for (int start = 0; start < itemCount; start += rangeSize)
+            {
+                int end = std::min(itemCount, start + rangeSize);
+                JobSystem::schedule([task, start, end, taskContext]()
+                                    { task(start, end, JobSystem::getThreadIndex(), taskContext); },
+                                    counter);
+            }
+            return counter;
+        }
+
+        void FinishBox2DTask(void *userTask, void *userContext)
+        {
+            auto *counter = static_cast<JobCounter *>(userTask);
+            JobSystem::wait(*counter);
+            delete counter;
+        }
+    } // namespace
+
     Physics2DWorld::~Physics2DWorld()
     {
         stop();
@@ -17,6 +46,12 @@ namespace Fermion
         FM_PROFILE_FUNCTION();
         b2WorldDef worldDef = b2DefaultWorldDef();
         worldDef.gravity = {0.0f, -9.8f};
+        if (JobSystem::isInitialized() && JobSystem::getThreadCount() <= kMaxBox2DWorkers)
+        {
+            worldDef.workerCount = static_cast<int>(JobSystem::getThreadCount());
+            worldDef.enqueueTask = EnqueueBox2DTask;
+            worldDef.finishTask = FinishBox2DTask;
+        }
         m_world = b2CreateWorld(&worldDef);
 
         createBodies(scene);
@@ -90,7 +125,7 @@ namespace Fermion
         for (auto e : view)
         {
             Entity entity{e, scene};
-            TransformComponent worldTransform = scene->getEntityManager().getWorldSpaceTransform(entity);
+            TransformComponent worldTransform = scene->getEntityManager().getCachedWorldSpaceTransform(entity);
             auto &rb2d = entity.getComponent<Rigidbody2DComponent>();
 
             b2BodyDef bodyDef = b2DefaultBodyDef();
@@ -289,7 +324,7 @@ namespace Fermion
             if (!b2Body_IsValid(bodyId))
                 continue;
 
-            TransformComponent worldTransform = scene->getEntityManager().getWorldSpaceTransform(entity);
+            TransformComponent worldTransform = scene->getEntityManager().getCachedWorldSpaceTransform(entity);
             b2Body_SetTransform(bodyId,
                                 {worldTransform.translation.x, worldTransform.translation.y},
                                 b2MakeRot(worldTransform.rotation.z));
@@ -400,7 +435,7 @@ namespace Fermion
             b2Transform xf = b2Body_GetTransform(bodyId);
 
             float angle = atan2f(xf.q.s, xf.q.c);
-            TransformComponent worldTransform = scene->getEntityManager().getWorldSpaceTransform(entity);
+            TransformComponent worldTransform = scene->getEntityManager().getCachedWorldSpaceTransform(entity);
             worldTransform.translation.x = xf.p.x;
             worldTransform.translation.y = xf.p.y;
             worldTransform.rotation.z = angle;
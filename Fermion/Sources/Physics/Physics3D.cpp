@@ -1,6 +1,7 @@
 #include "fmpch.hpp"
 #include "Physics/Physics3D.hpp"
 #include "Physics/Physics3DJoltInit.hpp"
+#include "Physics/Physics3DJobSystem.hpp"
 #include "Physics/Physics3DLayers.hpp"
 #include "Physics/Physics3DTypes.hpp"
 #include "Physics/Physics3DShapes.hpp"
@@ -10,6 +11,7 @@
 #include "Scene/Entity.hpp"
 #include "Scene/Components.hpp"
 #include "Core/Log.hpp"
+#include "Core/JobSystem.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
@@ -65,9 +67,17 @@ namespace Fermion
 
         if (!m_jobSystem)
         {
-            uint32_t hardwareThreads = std::thread::hardware_concurrency();
-            uint32_t workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
-            m_jobSystem.reset(new JPH::JobSystemThreadPool(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, workerCount));
+            // Share the engine workers when they exist so Jolt doesn't compete with them for cores
+            if (JobSystem::isInitialized())
+            {
+                m_jobSystem.reset(new Physics3DInternal::Physics3DJobSystem(JPH::cMaxPhysicsBarriers));
+            }
+            else
+            {
+                uint32_t hardwareThreads = std::thread::hardware_concurrency();
+                uint32_t workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+                m_jobSystem.reset(new JPH::JobSystemThreadPool(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, workerCount));
+            }
         }
 
         m_physicsSystem = std::make_unique<JPH::PhysicsSystem>();
@@ -82,7 +92,7 @@ namespace Fermion
         {
             Entity entity{entityID, scene};
             auto &rb = view.get<Rigidbody3DComponent>(entityID);
-            TransformComponent worldTransform = scene->getEntityManager().getWorldSpaceTransform(entity);
+            TransformComponent worldTransform = scene->getEntityManager().getCachedWorldSpaceTransform(entity);
 
             // Determine which collider type to use (prioritize BoxCollider, then CapsuleCollider, then CircleCollider)
             JPH::ShapeRefC shape;
@@ -429,7 +439,7 @@ namespace Fermion
                     continue;
 
                 Entity entity{entityID, scene};
-                TransformComponent worldTransform = scene->getEntityManager().getWorldSpaceTransform(entity);
+                TransformComponent worldTransform = scene->getEntityManager().getCachedWorldSpaceTransform(entity);
                 glm::quat rotationQuat = glm::quat(worldTransform.getRotationEuler());
                 glm::vec3 offset{0.0f};
                 if (entity.hasComponent<BoxCollider3DComponent>())
@@ -507,7 +517,7 @@ namespace Fermion
             }
             glm::vec3 worldOffset = rotation * offset;
 
-            TransformComponent worldTransform = scene->getEntityManager().getWorldSpaceTransform(entity);
+            TransformComponent worldTransform = scene->getEntityManager().getCachedWorldSpaceTransform(entity);
             worldTransform.translation = position - worldOffset;
             worldTransform.setRotationEuler(glm::eulerAngles(rotation));
 
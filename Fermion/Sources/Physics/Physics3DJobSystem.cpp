@@ -0,0 +1,50 @@
+#include "fmpch.hpp"
+#include "Physics/Physics3DJobSystem.hpp"
+#include "Core/JobSystem.hpp"
+
+namespace Fermion::Physics3DInternal
+{
+    Physics3DJobSystem::Physics3DJobSystem(JPH::uint maxBarriers)
+        : JPH::JobSystemWithBarrier(maxBarriers)
+    {
+    }
+
+    int Physics3DJobSystem::GetMaxConcurrency() const
+    {
+        return static_cast<int>(JobSystem::getThreadCount());
+    }
+
+    Physics3DJobSystem::JobHandle Physics3DJobSystem::CreateJob(const char *inName, JPH::ColorArg inColor,
+                                                                const JobFunction &inJobFunction, JPH::uint32 inNumDependencies)
+    {
+        Job *job = new Job(inName, inColor, this, inJobFunction, inNumDependencies);
+
+        // The handle keeps the job alive; Jolt calls FreeJob once the last reference is released
+        JobHandle handle(job);
+        if (inNumDependencies == 0)
+            QueueJob(job);
+        return handle;
+    }
+
+    void Physics3DJobSystem::QueueJob(Job *inJob)
+    {
+        // Jolt may also execute the job while waiting on a barrier; Job::Execute makes sure it only runs once
+        inJob->AddRef();
+        JobSystem::schedule([inJob]()
+                            {
+            inJob->Execute();
+            inJob->Release(); });
+    }
+
+    void Physics3DJobSystem::QueueJobs(Job **inJobs, JPH::uint inNumJobs)
+    {
+        for (JPH::uint i = 0; i < inNumJobs; ++i)
+            QueueJob(inJobs[i]);
+    }
+
+    void Physics3DJobSystem::FreeJob(Job *inJob)
+    {
+        delete inJob;
+    }
+
+} // namespace Fermion::Physics3DInternal
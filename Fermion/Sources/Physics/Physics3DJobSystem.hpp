@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+
+namespace Fermion::Physics3DInternal
+{
+    // Runs Jolt's jobs on the engine JobSystem instead of a private thread pool.
+    // Barrier bookkeeping is inherited from JobSystemWithBarrier.
+    class Physics3DJobSystem final : public JPH::JobSystemWithBarrier
+    {
+    public:
+        explicit Physics3DJobSystem(JPH::uint maxBarriers);
+
+        int GetMaxConcurrency() const override;
+        JobHandle CreateJob(const char *inName, JPH::ColorArg inColor, const JobFunction &inJobFunction,
+                            JPH::uint32 inNumDependencies = 0) override;
+
+    protected:
+        void QueueJob(Job *inJob) override;
+        void QueueJobs(Job **inJobs, JPH::uint inNumJobs) override;
+        void FreeJob(Job *inJob) override;
+    };
+
+} // namespace Fermion::Physics3DInternal
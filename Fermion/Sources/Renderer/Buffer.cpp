@@ -37,4 +37,26 @@ std::shared_ptr<IndexBuffer> IndexBuffer::create(uint32_t *indices, uint32_t siz
     return nullptr;
 }
 
+std::shared_ptr<IndexBuffer> IndexBuffer::create(uint16_t *indices, uint32_t size) {
+    switch (Renderer::getAPI()) {
+    case RendererAPI::API::None:
+        return nullptr;
+    case RendererAPI::API::OpenGL:
+        return std::make_shared<OpenGLIndexBuffer>(indices, size);
+    }
+
+    return nullptr;
+}
+
+std::shared_ptr<IndexBuffer> IndexBuffer::create(uint32_t count, IndexType type) {
+    switch (Renderer::getAPI()) {
+    case RendererAPI::API::None:
+        return nullptr;
+    case RendererAPI::API::OpenGL:
+        return std::make_shared<OpenGLIndexBuffer>(count, type);
+    }
+
+    return nullptr;
+}
+
 } // namespace Fermion
\ No newline at end of file
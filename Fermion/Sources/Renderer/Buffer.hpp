@@ -16,7 +16,11 @@ namespace Fermion
         Int2,
         Int3,
         Int4,
-        Bool
+        Bool,
+        // Packed vertex attributes; read as vec2/vec4 floats, BufferElement::normalized selects unorm/snorm
+        Half2,
+        UByte4,
+        Int1010102
     };
 
     static uint32_t ShaderDataTypeSize(const ShaderDataType type)
@@ -45,6 +49,10 @@ namespace Fermion
             return 4 * 4;
         case ShaderDataType::Bool:
             return 1;
+        case ShaderDataType::Half2:
+        case ShaderDataType::UByte4:
+        case ShaderDataType::Int1010102:
+            return 4;
         default:
             return 0;
         }
@@ -93,6 +101,12 @@ namespace Fermion
                 return 4;
             case ShaderDataType::Bool:
                 return 1;
+            case ShaderDataType::Half2:
+                return 2;
+            case ShaderDataType::UByte4:
+                return 4;
+            case ShaderDataType::Int1010102:
+                return 4;
             }
 
             return 0;
@@ -166,7 +180,8 @@ namespace Fermion
 
         virtual void unbind() const = 0;
 
-        virtual void setData(const void *data, uint32_t size) = 0;
+        // offset and size in bytes
+        virtual void setData(const void *data, uint32_t size, uint32_t offset = 0) = 0;
 
         virtual const BufferLayout &getLayout() const = 0;
 
@@ -177,7 +192,12 @@ namespace Fermion
         static std::shared_ptr<VertexBuffer> create(float *vertices, uint32_t size);
     };
 
-    // Currently only supports 32-bit index buffers
+    enum class IndexType
+    {
+        UInt16,
+        UInt32
+    };
+
     class IndexBuffer
     {
     public:
@@ -189,6 +209,16 @@ namespace Fermion
 
         virtual uint32_t getCount() const = 0;
 
+        virtual IndexType getIndexType() const = 0;
+
+        // offset and count in indices of the buffer's type
+        virtual void setData(const void *indices, uint32_t count, uint32_t offset = 0) = 0;
+
         static std::shared_ptr<IndexBuffer> create(uint32_t *indices, uint32_t count);
+
+        static std::shared_ptr<IndexBuffer> create(uint16_t *indices, uint32_t count);
+
+        // Room for count indices, filled in later with setData
+        static std::shared_ptr<IndexBuffer> create(uint32_t count, IndexType type);
     };
 } // namespace Fermion
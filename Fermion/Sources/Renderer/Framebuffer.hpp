@@ -48,6 +48,8 @@ namespace Fermion
         uint32_t width = 0, height = 0;
         FramebufferAttachmentSpecification attachments;
         uint32_t samples = 1;
+        // Non-zero makes the depth attachment a 2D texture array with this many layers; see bindLayer()
+        uint32_t layers = 0;
 
         bool swapChainTarget = false;
     };
@@ -97,6 +99,9 @@ namespace Fermion
         virtual void bind() = 0;
         virtual void unbind() = 0;
 
+        // Binds the framebuffer with its layered depth attachment rendering into the given layer
+        virtual void bindLayer(uint32_t layer) = 0;
+
         // Binds the framebuffer for reading (uses resolve FBO for MSAA)
         virtual void bindForRead() = 0;
 
@@ -117,6 +122,9 @@ namespace Fermion
 
         virtual void blitToDefaultFramebuffer(uint32_t dstWidth, uint32_t dstHeight, const FramebufferBlitSpecification &spec) const = 0;
 
+        // Copies one layer of a layered depth attachment into a layer of another framebuffer of the same size and format
+        virtual void copyDepthLayerTo(const Framebuffer &target, uint32_t sourceLayer, uint32_t targetLayer) const = 0;
+
         virtual void resolve() = 0;
 
         virtual bool isMultisampled() const { return getSpecification().samples > 1; }
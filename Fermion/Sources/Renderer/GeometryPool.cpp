@@ -0,0 +1,250 @@
+#include "fmpch.hpp"
+#include "Renderer/GeometryPool.hpp"
+#include "Renderer/VertexArray.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace Fermion
+{
+    RangeAllocator::RangeAllocator(uint32_t capacity) : m_capacity(capacity)
+    {
+        if (capacity > 0)
+            m_freeRanges.emplace(0, capacity);
+    }
+
+    std::optional<uint32_t> RangeAllocator::allocate(uint32_t count)
+    {
+        if (count == 0)
+            return 0;
+
+        for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it)
+        {
+            if (it->second < count)
+                continue;
+
+            const uint32_t offset = it->first;
+            const uint32_t remaining = it->second - count;
+            m_freeRanges.erase(it);
+            if (remaining > 0)
+                m_freeRanges.emplace(offset + count, remaining);
+            m_used += count;
+            return offset;
+        }
+        return std::nullopt;
+    }
+
+    void RangeAllocator::free(uint32_t offset, uint32_t count)
+    {
+        if (count == 0)
+            return;
+
+        m_used -= count;
+        auto next = m_freeRanges.lower_bound(offset);
+        if (next != m_freeRanges.begin())
+        {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset)
+            {
+                offset = previous->first;
+                count += previous->second;
+                m_freeRanges.erase(previous);
+            }
+        }
+        if (next != m_freeRanges.end() && offset + count == next->first)
+        {
+            count += next->second;
+            m_freeRanges.erase(next);
+        }
+        m_freeRanges.emplace(offset, count);
+    }
+
+    class GeometryPage
+    {
+    public:
+        GeometryPage(const BufferLayout &layout, IndexType indexType, uint32_t vertexCapacity, uint32_t indexCapacity)
+            : layout(layout), indexType(indexType), vertices(vertexCapacity), indices(indexCapacity)
+        {
+            vertexBuffer = VertexBuffer::create(vertexCapacity * layout.getStride());
+            indexBuffer = IndexBuffer::create(indexCapacity, indexType);
+            vertexArray = VertexArray::create();
+            if (!vertexBuffer || !indexBuffer || !vertexArray)
+                return;
+
+            vertexBuffer->setLayout(layout);
+            vertexArray->addVertexBuffer(vertexBuffer);
+            vertexArray->setIndexBuffer(indexBuffer);
+        }
+
+        bool isValid() const { return vertexBuffer && indexBuffer && vertexArray; }
+
+        BufferLayout layout;
+        IndexType indexType;
+        std::shared_ptr<VertexBuffer> vertexBuffer;
+        std::shared_ptr<IndexBuffer> indexBuffer;
+        std::shared_ptr<VertexArray> vertexArray;
+
+        // Guards the allocators; allocations may be released from any thread
+        std::mutex mutex;
+        RangeAllocator vertices;
+        RangeAllocator indices;
+    };
+
+    namespace
+    {
+        uint32_t getIndexSize(IndexType type)
+        {
+            return type == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        }
+
+        bool isSameLayout(const BufferLayout &a, const BufferLayout &b)
+        {
+            return a.getStride() == b.getStride() &&
+                   std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const BufferElement &x, const BufferElement &y)
+                              { return x.type == y.type && x.normalized == y.normalized && x.divisor == y.divisor &&
+                                       x.offset == y.offset; });
+        }
+
+        struct PoolState
+        {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<GeometryPage>> pages;
+        };
+
+        PoolState &getPool()
+        {
+            // Never destroyed, since meshes may release allocations during static destruction; shutdown()
+            // frees the pages while the context is still alive
+            static PoolState *pool = new PoolState();
+            return *pool;
+        }
+
+        void releasePageIfEmpty(const std::shared_ptr<GeometryPage> &page)
+        {
+            // Pool lock first, as in GeometryPool::allocate(), which may have refilled the page meanwhile
+            PoolState &pool = getPool();
+            std::lock_guard<std::mutex> poolLock(pool.mutex);
+            {
+                std::lock_guard<std::mutex> pageLock(page->mutex);
+                if (page->vertices.getUsed() != 0 || page->indices.getUsed() != 0)
+                    return;
+            }
+            std::erase(pool.pages, page);
+        }
+    } // namespace
+
+    GeometryAllocation::GeometryAllocation(std::shared_ptr<GeometryPage> page, uint32_t firstVertex,
+                                           uint32_t vertexCount, uint32_t firstIndex, uint32_t indexCount)
+        : m_page(std::move(page)), m_firstVertex(firstVertex), m_vertexCount(vertexCount),
+          m_firstIndex(firstIndex), m_indexCount(indexCount)
+    {
+    }
+
+    GeometryAllocation::~GeometryAllocation()
+    {
+        bool empty = false;
+        {
+            std::lock_guard<std::mutex> lock(m_page->mutex);
+            m_page->vertices.free(m_firstVertex, m_vertexCount);
+            m_page->indices.free(m_firstIndex, m_indexCount);
+            empty = m_page->vertices.getUsed() == 0 && m_page->indices.getUsed() == 0;
+        }
+        // The buffers go with the last reference to the page, usually this one
+        if (empty)
+            releasePageIfEmpty(m_page);
+    }
+
+    const std::shared_ptr<VertexArray> &GeometryAllocation::getVertexArray() const
+    {
+        return m_page->vertexArray;
+    }
+
+    std::shared_ptr<GeometryAllocation> GeometryPool::allocate(const BufferLayout &layout, const void *vertices,
+                                                               uint32_t vertexCount, IndexType indexType,
+                                                               const void *indices, uint32_t indexCount)
+    {
+        const uint32_t stride = layout.getStride();
+        if (stride == 0)
+            return nullptr;
+
+        PoolState &pool = getPool();
+        std::lock_guard<std::mutex> poolLock(pool.mutex);
+
+        auto tryPage = [&](const std::shared_ptr<GeometryPage> &page) -> std::shared_ptr<GeometryAllocation>
+        {
+            std::optional<uint32_t> firstVertex;
+            std::optional<uint32_t> firstIndex;
+            {
+                std::lock_guard<std::mutex> pageLock(page->mutex);
+                firstVertex = page->vertices.allocate(vertexCount);
+                if (!firstVertex)
+                    return nullptr;
+                firstIndex = page->indices.allocate(indexCount);
+                if (!firstIndex)
+                {
+                    page->vertices.free(*firstVertex, vertexCount);
+                    return nullptr;
+                }
+            }
+
+            // The ranges belong to this allocation alone, so the upload needs no lock
+            if (vertexCount > 0)
+                page->vertexBuffer->setData(vertices, vertexCount * stride, *firstVertex * stride);
+            if (indexCount > 0)
+                page->indexBuffer->setData(indices, indexCount, *firstIndex);
+            return std::make_shared<GeometryAllocation>(page, *firstVertex, vertexCount, *firstIndex, indexCount);
+        };
+
+        for (const auto &page : pool.pages)
+        {
+            if (page->indexType != indexType || !isSameLayout(page->layout, layout))
+                continue;
+            if (auto allocation = tryPage(page))
+                return allocation;
+        }
+
+        const uint32_t vertexCapacity = std::max(PageVertexBytes / stride, vertexCount);
+        const uint32_t indexCapacity = std::max(PageIndexBytes / getIndexSize(indexType), indexCount);
+        auto page = std::make_shared<GeometryPage>(layout, indexType, vertexCapacity, indexCapacity);
+        if (!page->isValid())
+            return nullptr;
+        pool.pages.push_back(page);
+        return tryPage(page);
+    }
+
+    void GeometryPool::shutdown()
+    {
+        PoolState &pool = getPool();
+        std::lock_guard<std::mutex> poolLock(pool.mutex);
+
+        // Allocations still alive keep their page object, but not its buffers
+        for (const auto &page : pool.pages)
+        {
+            std::lock_guard<std::mutex> pageLock(page->mutex);
+            page->vertexArray.reset();
+            page->indexBuffer.reset();
+            page->vertexBuffer.reset();
+        }
+        pool.pages.clear();
+    }
+
+    GeometryPool::Statistics GeometryPool::getStatistics()
+    {
+        PoolState &pool = getPool();
+        std::lock_guard<std::mutex> poolLock(pool.mutex);
+
+        Statistics statistics;
+        statistics.pages = static_cast<uint32_t>(pool.pages.size());
+        for (const auto &page : pool.pages)
+        {
+            std::lock_guard<std::mutex> pageLock(page->mutex);
+            const uint32_t stride = page->layout.getStride();
+            const uint32_t indexSize = getIndexSize(page->indexType);
+            statistics.vertexBytesUsed += static_cast<uint64_t>(page->vertices.getUsed()) * stride;
+            statistics.vertexBytesCapacity += static_cast<uint64_t>(page->vertices.getCapacity()) * stride;
+            statistics.indexBytesUsed += static_cast<uint64_t>(page->indices.getUsed()) * indexSize;
+            statistics.indexBytesCapacity += static_cast<uint64_t>(page->indices.getCapacity()) * indexSize;
+        }
+        return statistics;
+    }
+} // namespace Fermion
@@ -0,0 +1,89 @@
+#pragma once
+#include "Renderer/Buffer.hpp"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace Fermion
+{
+    class VertexArray;
+
+    // First-fit free list over [0, capacity), in whole elements. Freed ranges merge with their free
+    // neighbours, so a page that empties out becomes one free range again.
+    class RangeAllocator
+    {
+    public:
+        explicit RangeAllocator(uint32_t capacity);
+
+        std::optional<uint32_t> allocate(uint32_t count);
+        void free(uint32_t offset, uint32_t count);
+
+        uint32_t getCapacity() const { return m_capacity; }
+        uint32_t getUsed() const { return m_used; }
+
+    private:
+        uint32_t m_capacity;
+        uint32_t m_used = 0;
+        // Offset -> size of every free range
+        std::map<uint32_t, uint32_t> m_freeRanges;
+    };
+
+    class GeometryPage;
+
+    // One mesh's vertices and indices inside a shared page. Draws add getFirstVertex() to their base vertex
+    // and getFirstIndex() to their index offset. The ranges go back to the page when this is destroyed.
+    class GeometryAllocation
+    {
+    public:
+        GeometryAllocation(std::shared_ptr<GeometryPage> page, uint32_t firstVertex, uint32_t vertexCount,
+                           uint32_t firstIndex, uint32_t indexCount);
+        ~GeometryAllocation();
+
+        GeometryAllocation(const GeometryAllocation &) = delete;
+        GeometryAllocation &operator=(const GeometryAllocation &) = delete;
+
+        const std::shared_ptr<VertexArray> &getVertexArray() const;
+        uint32_t getFirstVertex() const { return m_firstVertex; }
+        uint32_t getFirstIndex() const { return m_firstIndex; }
+
+    private:
+        std::shared_ptr<GeometryPage> m_page;
+        uint32_t m_firstVertex;
+        uint32_t m_vertexCount;
+        uint32_t m_firstIndex;
+        uint32_t m_indexCount;
+    };
+
+    // Shared vertex and index buffers for static meshes. Meshes with the same vertex layout and index type
+    // are sub-allocated from the same page, so their draws bind one vertex array and can be merged into a
+    // single indirect draw. A page that is full is followed by another; a mesh too large for a page gets a
+    // page of its own. A page is freed once its last allocation is released.
+    class GeometryPool
+    {
+    public:
+        static constexpr uint32_t PageVertexBytes = 32u << 20;
+        static constexpr uint32_t PageIndexBytes = 16u << 20;
+
+        struct Statistics
+        {
+            uint32_t pages = 0;
+            uint64_t vertexBytesUsed = 0;
+            uint64_t vertexBytesCapacity = 0;
+            uint64_t indexBytesUsed = 0;
+            uint64_t indexBytesCapacity = 0;
+        };
+
+        // Uploads the vertices (laid out as layout says) and indices into a page; nullptr without a renderer
+        static std::shared_ptr<GeometryAllocation> allocate(const BufferLayout &layout, const void *vertices,
+                                                            uint32_t vertexCount, IndexType indexType,
+                                                            const void *indices, uint32_t indexCount);
+
+        // Frees every page's buffers; call while the graphics context is still current
+        static void shutdown();
+
+        static Statistics getStatistics();
+    };
+} // namespace Fermion
@@ -0,0 +1,53 @@
+#include "fmpch.hpp"
+#include "Renderer/IndirectDrawBatch.hpp"
+#include "Renderer/MeshDrawList.hpp"
+#include "Renderer/RenderCommandQueue.hpp"
+
+namespace Fermion
+{
+    uint32_t IndirectDrawBatch::add(RenderCommandQueue &queue, const VertexArray *vao,
+                                    const DrawIndexedIndirectCommand &command)
+    {
+        const uint32_t drawCalls = bind(queue, vao);
+        m_commands.push_back(command);
+        return drawCalls;
+    }
+
+    uint32_t IndirectDrawBatch::addRun(RenderCommandQueue &queue, const MeshDrawList &drawList, const MeshDrawRun &run)
+    {
+        const MeshDrawCommand &cmd = drawList.getRunCommand(run);
+        const uint32_t drawCalls = bind(queue, cmd.vao.get());
+        if (cmd.rangeCount == 0)
+        {
+            m_commands.push_back({cmd.indexCount, run.count, cmd.indexOffset, cmd.baseVertex, run.first});
+            return drawCalls;
+        }
+
+        // Partially culled draws never share a run, so each range draws the run's single instance
+        const uint32_t *counts = drawList.getRangeCounts(cmd);
+        const uint32_t *offsets = drawList.getRangeOffsets(cmd);
+        for (uint32_t i = 0; i < cmd.rangeCount; ++i)
+            m_commands.push_back({counts[i], 1, offsets[i], cmd.baseVertex, run.first});
+        return drawCalls;
+    }
+
+    uint32_t IndirectDrawBatch::flush(RenderCommandQueue &queue)
+    {
+        if (m_commands.empty())
+            return 0;
+
+        queue.submitDrawIndexedIndirect(m_vao, m_commands.data(), static_cast<uint32_t>(m_commands.size()));
+        m_commands.clear();
+        return 1;
+    }
+
+    uint32_t IndirectDrawBatch::bind(RenderCommandQueue &queue, const VertexArray *vao)
+    {
+        if (vao == m_vao)
+            return 0;
+
+        const uint32_t drawCalls = flush(queue);
+        m_vao = vao;
+        return drawCalls;
+    }
+} // namespace Fermion
@@ -0,0 +1,34 @@
+#pragma once
+#include "Renderer/RendererAPI.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace Fermion
+{
+    class MeshDrawList;
+    class RenderCommandQueue;
+    struct MeshDrawRun;
+
+    // Gathers consecutive non-skinned mesh draws into one indirect draw. Static meshes share the vertex
+    // array of their GeometryPool page, so a batch spans different meshes as long as nothing else changes:
+    // callers flush before binding another pipeline or material, and before any draw that isn't batched.
+    // The batch itself only flushes when the vertex array changes.
+    //
+    // Every method returns the number of draw calls it recorded, for the renderer statistics.
+    class IndirectDrawBatch
+    {
+    public:
+        uint32_t add(RenderCommandQueue &queue, const VertexArray *vao, const DrawIndexedIndirectCommand &command);
+        // One command per surviving meshlet range of the run's draw, or one instanced command for the run
+        uint32_t addRun(RenderCommandQueue &queue, const MeshDrawList &drawList, const MeshDrawRun &run);
+        uint32_t flush(RenderCommandQueue &queue);
+
+    private:
+        uint32_t bind(RenderCommandQueue &queue, const VertexArray *vao);
+
+        const VertexArray *m_vao = nullptr;
+        // Copied into the queue on flush, so the capacity carries over from frame to frame
+        std::vector<DrawIndexedIndirectCommand> m_commands;
+    };
+} // namespace Fermion
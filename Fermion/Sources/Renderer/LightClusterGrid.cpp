@@ -0,0 +1,260 @@
+#include "fmpch.hpp"
+#include "Renderer/LightClusterGrid.hpp"
+#include "Core/JobSystem.hpp"
+
+#include <cmath>
+
+namespace Fermion
+{
+    namespace
+    {
+        // The far plane is only used to spread the slices; keep it finite for infinite projections
+        constexpr float kMaxDepthRange = 10000.0f;
+
+        bool isPerspective(const glm::mat4 &projection)
+        {
+            return projection[3][3] == 0.0f;
+        }
+
+        glm::vec3 unproject(const glm::mat4 &inverseProjection, float ndcX, float ndcY, float ndcZ)
+        {
+            glm::vec4 p = inverseProjection * glm::vec4(ndcX, ndcY, ndcZ, 1.0f);
+            return glm::vec3(p) / p.w;
+        }
+
+        bool sphereIntersectsAABB(const glm::vec3 &center, float radius, const AABB &aabb)
+        {
+            glm::vec3 closest = glm::clamp(center, aabb.min, aabb.max);
+            glm::vec3 d = center - closest;
+            return glm::dot(d, d) <= radius * radius;
+        }
+    } // namespace
+
+    void LightClusterGrid::build(const EnvironmentLight &lights, const glm::mat4 &view, const glm::mat4 &projection,
+                                 uint32_t viewportWidth, uint32_t viewportHeight)
+    {
+        viewportWidth = std::max(viewportWidth, 1u);
+        viewportHeight = std::max(viewportHeight, 1u);
+        if (m_clusterBounds.empty() || projection != m_cachedProjection ||
+            viewportWidth != m_cachedWidth || viewportHeight != m_cachedHeight)
+        {
+            buildClusterBounds(projection, viewportWidth, viewportHeight);
+        }
+
+        m_pointLights.resize(lights.pointLights.size());
+        m_pointSpheres.resize(lights.pointLights.size());
+        for (size_t i = 0; i < lights.pointLights.size(); ++i)
+        {
+            const auto &l = lights.pointLights[i];
+            m_pointLights[i] = {.position = l.position, .range = l.range, .color = l.color, .intensity = l.intensity};
+            m_pointSpheres[i] = makeSphere(glm::vec3(view * glm::vec4(l.position, 1.0f)), l.range);
+        }
+
+        m_spotLights.resize(lights.spotLights.size());
+        m_spotSpheres.resize(lights.spotLights.size());
+        for (size_t i = 0; i < lights.spotLights.size(); ++i)
+        {
+            const auto &l = lights.spotLights[i];
+            const glm::vec3 direction = glm::normalize(l.direction);
+            m_spotLights[i] = {.position = l.position,
+                               .range = l.range,
+                               .direction = direction,
+                               .innerConeAngle = l.innerConeAngle,
+                               .color = l.color,
+                               .intensity = l.intensity,
+                               .outerConeAngle = l.outerConeAngle};
+
+            // Tightest sphere around the cone; outerConeAngle is already a cosine
+            const float cosAngle = l.outerConeAngle;
+            glm::vec3 center = l.position;
+            float radius = l.range;
+            if (cosAngle > 0.0f)
+            {
+                if (cosAngle >= 0.70710678f)
+                {
+                    radius = l.range / (2.0f * cosAngle);
+                    center = l.position + direction * radius;
+                }
+                else
+                {
+                    radius = l.range * std::sqrt(1.0f - cosAngle * cosAngle);
+                    center = l.position + direction * (l.range * cosAngle);
+                }
+            }
+            m_spotSpheres[i] = makeSphere(glm::vec3(view * glm::vec4(center, 1.0f)), radius);
+        }
+
+        m_clusters.resize(ClusterCount);
+        m_lightIndices.clear();
+        if (m_pointLights.empty() && m_spotLights.empty())
+        {
+            std::fill(m_clusters.begin(), m_clusters.end(), LightClusterData{});
+            return;
+        }
+
+        m_slices.resize(Slices);
+        JobSystem::parallelFor(Slices, 1, [this](uint32_t slice)
+                               { assignSlice(slice); });
+
+        // Concatenate the slices; their cluster offsets were relative to the slice's own index list
+        for (uint32_t slice = 0; slice < Slices; ++slice)
+        {
+            const uint32_t base = static_cast<uint32_t>(m_lightIndices.size());
+            const uint32_t first = getClusterIndex(0, 0, slice);
+            for (uint32_t i = first; i < first + TilesX * TilesY; ++i)
+                m_clusters[i].offset += base;
+
+            const auto &indices = m_slices[slice].indices;
+            m_lightIndices.insert(m_lightIndices.end(), indices.begin(), indices.end());
+        }
+    }
+
+    void LightClusterGrid::buildClusterBounds(const glm::mat4 &projection, uint32_t viewportWidth,
+                                              uint32_t viewportHeight)
+    {
+        m_cachedProjection = projection;
+        m_cachedWidth = viewportWidth;
+        m_cachedHeight = viewportHeight;
+
+        const glm::mat4 inverseProjection = glm::inverse(projection);
+        const bool logarithmic = isPerspective(projection);
+
+        m_nearDepth = -unproject(inverseProjection, 0.0f, 0.0f, -1.0f).z;
+        m_farDepth = -unproject(inverseProjection, 0.0f, 0.0f, 1.0f).z;
+        if (logarithmic)
+            m_nearDepth = std::max(m_nearDepth, 1e-3f);
+        if (!std::isfinite(m_farDepth) || m_farDepth <= m_nearDepth || m_farDepth - m_nearDepth > kMaxDepthRange)
+            m_farDepth = m_nearDepth + kMaxDepthRange;
+
+        m_gridData.gridSize = {TilesX, TilesY, Slices};
+        m_gridData.logarithmicSlices = logarithmic ? 1 : 0;
+        m_gridData.tileSize = {std::ceil(static_cast<float>(viewportWidth) / TilesX),
+                               std::ceil(static_cast<float>(viewportHeight) / TilesY)};
+        if (logarithmic)
+        {
+            const float logRange = std::log(m_farDepth / m_nearDepth);
+            m_gridData.sliceScale = Slices / logRange;
+            m_gridData.sliceBias = -static_cast<float>(Slices) * std::log(m_nearDepth) / logRange;
+        }
+        else
+        {
+            m_gridData.sliceScale = Slices / (m_farDepth - m_nearDepth);
+            m_gridData.sliceBias = -m_nearDepth * m_gridData.sliceScale;
+        }
+
+        // Each tile corner is a view-space line (a ray for perspective, parallel lines for orthographic);
+        // a cluster is bounded by where its four corner lines cross the slice's near and far depths.
+        // NDC depth 0 rather than 1 keeps the second point finite for infinite far planes.
+        m_clusterBounds.resize(ClusterCount);
+        for (uint32_t y = 0; y < TilesY; ++y)
+        {
+            for (uint32_t x = 0; x < TilesX; ++x)
+            {
+                const float ndcX[2] = {-1.0f + 2.0f * (x * m_gridData.tileSize.x) / viewportWidth,
+                                       -1.0f + 2.0f * ((x + 1) * m_gridData.tileSize.x) / viewportWidth};
+                const float ndcY[2] = {-1.0f + 2.0f * (y * m_gridData.tileSize.y) / viewportHeight,
+                                       -1.0f + 2.0f * ((y + 1) * m_gridData.tileSize.y) / viewportHeight};
+
+                glm::vec3 lineStart[4];
+                glm::vec3 lineDelta[4];
+                for (int c = 0; c < 4; ++c)
+                {
+                    const glm::vec3 a = unproject(inverseProjection, ndcX[c & 1], ndcY[c >> 1], -1.0f);
+                    const glm::vec3 b = unproject(inverseProjection, ndcX[c & 1], ndcY[c >> 1], 0.0f);
+                    // Parameterize by view depth (-z)
+                    lineDelta[c] = (b - a) / (a.z - b.z);
+                    lineStart[c] = a + lineDelta[c] * a.z;
+                }
+
+                for (uint32_t slice = 0; slice < Slices; ++slice)
+                {
+                    const float depths[2] = {getSliceDepth(slice), getSliceDepth(slice + 1)};
+                    glm::vec3 min(FLT_MAX);
+                    glm::vec3 max(-FLT_MAX);
+                    for (float depth : depths)
+                    {
+                        for (int c = 0; c < 4; ++c)
+                        {
+                            const glm::vec3 p = lineStart[c] + lineDelta[c] * depth;
+                            min = glm::min(min, p);
+                            max = glm::max(max, p);
+                        }
+                    }
+                    m_clusterBounds[getClusterIndex(x, y, slice)] = {min, max};
+                }
+            }
+        }
+    }
+
+    float LightClusterGrid::getSliceDepth(uint32_t slice) const
+    {
+        const float t = static_cast<float>(slice) / Slices;
+        if (m_gridData.logarithmicSlices)
+            return m_nearDepth * std::pow(m_farDepth / m_nearDepth, t);
+        return m_nearDepth + (m_farDepth - m_nearDepth) * t;
+    }
+
+    LightClusterGrid::LightSphere LightClusterGrid::makeSphere(const glm::vec3 &center, float radius) const
+    {
+        LightSphere sphere{center, radius, 1, 0};
+
+        const float minDepth = std::max(-center.z - radius, m_nearDepth);
+        const float maxDepth = std::min(-center.z + radius, m_farDepth);
+        if (minDepth > maxDepth)
+            return sphere; // Entirely in front of the near plane or behind the far plane
+
+        auto toSlice = [this](float depth)
+        {
+            const float d = m_gridData.logarithmicSlices ? std::log(depth) : depth;
+            const float slice = std::floor(d * m_gridData.sliceScale + m_gridData.sliceBias);
+            return static_cast<uint32_t>(std::clamp(slice, 0.0f, static_cast<float>(Slices - 1)));
+        };
+        sphere.firstSlice = toSlice(minDepth);
+        sphere.lastSlice = toSlice(maxDepth);
+        return sphere;
+    }
+
+    void LightClusterGrid::assignSlice(uint32_t slice)
+    {
+        SliceScratch &scratch = m_slices[slice];
+        scratch.indices.clear();
+        scratch.pointCandidates.clear();
+        scratch.spotCandidates.clear();
+
+        for (uint32_t i = 0; i < m_pointSpheres.size(); ++i)
+        {
+            if (slice >= m_pointSpheres[i].firstSlice && slice <= m_pointSpheres[i].lastSlice)
+                scratch.pointCandidates.push_back(i);
+        }
+        for (uint32_t i = 0; i < m_spotSpheres.size(); ++i)
+        {
+            if (slice >= m_spotSpheres[i].firstSlice && slice <= m_spotSpheres[i].lastSlice)
+                scratch.spotCandidates.push_back(i);
+        }
+
+        for (uint32_t y = 0; y < TilesY; ++y)
+        {
+            for (uint32_t x = 0; x < TilesX; ++x)
+            {
+                const uint32_t index = getClusterIndex(x, y, slice);
+                const AABB &bounds = m_clusterBounds[index];
+                LightClusterData &cluster = m_clusters[index];
+                cluster.offset = static_cast<uint32_t>(scratch.indices.size());
+
+                for (uint32_t light : scratch.pointCandidates)
+                {
+                    if (sphereIntersectsAABB(m_pointSpheres[light].center, m_pointSpheres[light].radius, bounds))
+                        scratch.indices.push_back(light);
+                }
+                cluster.pointCount = static_cast<uint32_t>(scratch.indices.size()) - cluster.offset;
+
+                for (uint32_t light : scratch.spotCandidates)
+                {
+                    if (sphereIntersectsAABB(m_spotSpheres[light].center, m_spotSpheres[light].radius, bounds))
+                        scratch.indices.push_back(light);
+                }
+                cluster.spotCount = static_cast<uint32_t>(scratch.indices.size()) - cluster.offset - cluster.pointCount;
+            }
+        }
+    }
+} // namespace Fermion
@@ -0,0 +1,86 @@
+#pragma once
+#include "Math/AABB.hpp"
+#include "Renderer/UniformBufferLayout.hpp"
+#include "Scene/Scene.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Fermion
+{
+    // View-space froxel grid for clustered shading. The screen is split into TilesX x TilesY tiles and the
+    // view depth into Slices exponential slices (linear for orthographic cameras). Every cluster gets the
+    // point and spot lights whose bounding sphere touches its view-space AABB, so fragments only loop over
+    // the lights of their own cluster.
+    //
+    // Assignment runs on the CPU, one JobSystem job per depth slice, and needs no GL context; the output is
+    // laid out exactly as the shaders read it from the light storage buffers.
+    class LightClusterGrid
+    {
+    public:
+        static constexpr uint32_t TilesX = 16;
+        static constexpr uint32_t TilesY = 9;
+        static constexpr uint32_t Slices = 24;
+        static constexpr uint32_t ClusterCount = TilesX * TilesY * Slices;
+
+        // Rebuilds the cluster bounds if the projection or viewport changed, then assigns the lights
+        void build(const EnvironmentLight &lights, const glm::mat4 &view, const glm::mat4 &projection,
+                   uint32_t viewportWidth, uint32_t viewportHeight);
+
+        const LightClusterGridData &getGridData() const { return m_gridData; }
+        const std::vector<PointLightData> &getPointLights() const { return m_pointLights; }
+        const std::vector<SpotLightData> &getSpotLights() const { return m_spotLights; }
+        const std::vector<LightClusterData> &getClusters() const { return m_clusters; }
+        const std::vector<uint32_t> &getLightIndices() const { return m_lightIndices; }
+
+        static uint32_t getClusterIndex(uint32_t tileX, uint32_t tileY, uint32_t slice)
+        {
+            return (slice * TilesY + tileY) * TilesX + tileX;
+        }
+        // View space, valid after build()
+        const AABB &getClusterBounds(uint32_t index) const { return m_clusterBounds[index]; }
+
+    private:
+        struct LightSphere
+        {
+            glm::vec3 center;        // View space
+            float radius;
+            uint32_t firstSlice;
+            uint32_t lastSlice;
+        };
+
+        // Owned by one slice job; reused across frames so assignment doesn't allocate once warmed up
+        struct SliceScratch
+        {
+            std::vector<uint32_t> pointCandidates;
+            std::vector<uint32_t> spotCandidates;
+            std::vector<uint32_t> indices;
+        };
+
+        void buildClusterBounds(const glm::mat4 &projection, uint32_t viewportWidth, uint32_t viewportHeight);
+        float getSliceDepth(uint32_t slice) const;
+        LightSphere makeSphere(const glm::vec3 &center, float radius) const;
+        void assignSlice(uint32_t slice);
+
+        LightClusterGridData m_gridData{};
+        float m_nearDepth = 0.1f;
+        float m_farDepth = 1000.0f;
+
+        // Cached until the projection or the viewport changes
+        glm::mat4 m_cachedProjection{0.0f};
+        uint32_t m_cachedWidth = 0;
+        uint32_t m_cachedHeight = 0;
+        std::vector<AABB> m_clusterBounds;
+
+        std::vector<PointLightData> m_pointLights;
+        std::vector<SpotLightData> m_spotLights;
+        std::vector<LightSphere> m_pointSpheres;
+        std::vector<LightSphere> m_spotSpheres;
+
+        // Cluster offsets are slice-local until build() concatenates the slices' index lists
+        std::vector<SliceScratch> m_slices;
+        std::vector<LightClusterData> m_clusters;
+        std::vector<uint32_t> m_lightIndices;
+    };
+} // namespace Fermion
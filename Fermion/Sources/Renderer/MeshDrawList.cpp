@@ -0,0 +1,255 @@
+#include "fmpch.hpp"
+#include "Renderer/MeshDrawList.hpp"
+#include "Core/JobSystem.hpp"
+
+#include <array>
+#include <bit>
+
+namespace Fermion
+{
+    namespace
+    {
+        constexpr uint32_t kKeyGrainSize = 256;
+        constexpr uint32_t kInstanceGrainSize = 128;
+
+        // Materials and meshes are keyed by a hash of their address: equal states always share bits, and a
+        // rare collision only interleaves two states, it never breaks ordering between passes
+        uint64_t hashValue(uint64_t x, uint32_t bits)
+        {
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdull;
+            x ^= x >> 33;
+            return x >> (64 - bits);
+        }
+
+        uint64_t hashPointer(const void *pointer, uint32_t bits)
+        {
+            return hashValue(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer)), bits);
+        }
+
+        // Vertex array in the high quarter, index range below it
+        uint64_t meshKey(const MeshDrawCommand &cmd, uint32_t bits)
+        {
+            const uint32_t vaoBits = bits / 4;
+            return hashPointer(cmd.vao.get(), vaoBits) << (bits - vaoBits) |
+                   hashValue(cmd.indexOffset, bits - vaoBits);
+        }
+
+        // Non-negative floats compare like their bit patterns. std::max would keep -0.0f (and NaN), whose sign bit
+        // lands in the neighbouring key field once the depth is shifted down
+        uint32_t depthBits(float depth)
+        {
+            return std::bit_cast<uint32_t>(depth > 0.0f ? depth : 0.0f);
+        }
+
+        MeshDrawBucket getBucket(const MeshDrawCommand &cmd)
+        {
+            if (cmd.visible)
+                return cmd.transparent ? MeshDrawBucket::Transparent : MeshDrawBucket::Opaque;
+            return cmd.transparent ? MeshDrawBucket::CulledTransparent : MeshDrawBucket::CulledOpaque;
+        }
+
+        // Skinned draws carry their own bone palette and partially culled draws their own ranges, so neither
+        // shares a run
+        bool canInstance(const MeshDrawCommand &a, const MeshDrawCommand &b)
+        {
+            return !a.isSkinned && !b.isSkinned &&
+                   a.rangeCount == 0 && b.rangeCount == 0 &&
+                   a.vao == b.vao &&
+                   a.indexOffset == b.indexOffset &&
+                   a.baseVertex == b.baseVertex &&
+                   a.indexCount == b.indexCount &&
+                   a.material == b.material &&
+                   a.pipeline == b.pipeline;
+        }
+    } // namespace
+
+    void MeshDrawList::add(MeshDrawCommand &&command)
+    {
+        m_pipelineIDs.push_back(getPipelineID(command.pipeline.get()));
+        if (command.transparent)
+            ++m_transparentCount;
+        m_commands.push_back(std::move(command));
+    }
+
+    uint32_t MeshDrawList::addRanges(const uint32_t *indexCounts, const uint32_t *indexOffsets, uint32_t count,
+                                     uint32_t indexBase)
+    {
+        const uint32_t first = static_cast<uint32_t>(m_rangeCounts.size());
+        m_rangeCounts.insert(m_rangeCounts.end(), indexCounts, indexCounts + count);
+        for (uint32_t i = 0; i < count; ++i)
+            m_rangeOffsets.push_back(indexBase + indexOffsets[i]);
+        return first;
+    }
+
+    void MeshDrawList::clear()
+    {
+        m_commands.clear();
+        m_pipelineIDs.clear();
+        m_pipelines.clear();
+        m_rangeCounts.clear();
+        m_rangeOffsets.clear();
+        m_keys.clear();
+        m_order.clear();
+        m_instances.clear();
+        m_runs.clear();
+        m_bucketRuns = {};
+        m_transparentCount = 0;
+    }
+
+    void MeshDrawList::sort(const glm::mat4 &view)
+    {
+        FM_PROFILE_FUNCTION();
+
+        const uint32_t count = static_cast<uint32_t>(m_commands.size());
+        m_keys.resize(count);
+        m_order.resize(count);
+
+        // Third row of the view matrix: view-space z of a world position
+        const glm::vec4 viewZ(view[0][2], view[1][2], view[2][2], view[3][2]);
+
+        JobSystem::parallelForRange(count, kKeyGrainSize, [&](uint32_t begin, uint32_t end)
+                                    {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const MeshDrawCommand &cmd = m_commands[i];
+                const glm::vec3 center = (cmd.aabb.min + cmd.aabb.max) * 0.5f;
+                const float depth = -glm::dot(viewZ, cmd.transform * glm::vec4(center, 1.0f));
+                const uint32_t depthKey = depthBits(depth);
+                const uint64_t pipeline = m_pipelineIDs[i];
+                const uint64_t bucket = static_cast<uint64_t>(getBucket(cmd));
+
+                uint64_t key;
+                if (!cmd.transparent)
+                {
+                    key = bucket << 62 |
+                          pipeline << 54 |
+                          hashPointer(cmd.material.get(), 16) << 38 |
+                          meshKey(cmd, 16) << 22 |
+                          depthKey >> 9;
+                }
+                else
+                {
+                    key = bucket << 62 |
+                          static_cast<uint64_t>(~depthKey) << 30 |
+                          pipeline << 22 |
+                          hashPointer(cmd.material.get(), 12) << 10 |
+                          meshKey(cmd, 10);
+                }
+
+                m_keys[i] = key;
+                m_order[i] = i;
+            } });
+
+        radixSort();
+        buildRuns();
+    }
+
+    uint8_t MeshDrawList::getPipelineID(const Pipeline *pipeline)
+    {
+        for (size_t i = 0; i < m_pipelines.size(); ++i)
+        {
+            if (m_pipelines[i] == pipeline)
+                return static_cast<uint8_t>(i);
+        }
+
+        if (m_pipelines.size() == 255)
+            return 255;
+        m_pipelines.push_back(pipeline);
+        return static_cast<uint8_t>(m_pipelines.size() - 1);
+    }
+
+    void MeshDrawList::radixSort()
+    {
+        const size_t count = m_keys.size();
+        if (count < 2)
+            return;
+
+        m_scratchKeys.resize(count);
+        m_scratchOrder.resize(count);
+
+        uint64_t *keys = m_keys.data();
+        uint32_t *order = m_order.data();
+        uint64_t *scratchKeys = m_scratchKeys.data();
+        uint32_t *scratchOrder = m_scratchOrder.data();
+
+        // LSD over 8-bit digits; a digit every key shares (unused pipeline bits, the pass of an all-opaque
+        // frame) costs one histogram pass and no scatter
+        for (uint32_t shift = 0; shift < 64; shift += 8)
+        {
+            std::array<uint32_t, 256> offsets{};
+            for (size_t i = 0; i < count; ++i)
+                ++offsets[(keys[i] >> shift) & 0xFF];
+
+            if (offsets[(keys[0] >> shift) & 0xFF] == count)
+                continue;
+
+            uint32_t sum = 0;
+            for (uint32_t &offset : offsets)
+            {
+                const uint32_t bucketSize = offset;
+                offset = sum;
+                sum += bucketSize;
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const uint32_t destination = offsets[(keys[i] >> shift) & 0xFF]++;
+                scratchKeys[destination] = keys[i];
+                scratchOrder[destination] = order[i];
+            }
+
+            std::swap(keys, scratchKeys);
+            std::swap(order, scratchOrder);
+        }
+
+        if (keys != m_keys.data())
+        {
+            m_keys.swap(m_scratchKeys);
+            m_order.swap(m_scratchOrder);
+        }
+    }
+
+    void MeshDrawList::buildRuns()
+    {
+        const uint32_t count = static_cast<uint32_t>(m_order.size());
+        m_instances.resize(count);
+
+        JobSystem::parallelForRange(count, kInstanceGrainSize, [&](uint32_t begin, uint32_t end)
+                                    {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const MeshDrawCommand &cmd = m_commands[m_order[i]];
+                ModelData &instance = m_instances[i];
+                instance.model = cmd.transform;
+                instance.normalMatrix = glm::transpose(glm::inverse(cmd.transform));
+                instance.objectID = cmd.objectID;
+            } });
+
+        m_runs.clear();
+        m_bucketRuns = {};
+        size_t bucketIndex = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const size_t bucket = static_cast<size_t>(m_keys[i] >> 62);
+            while (bucketIndex < bucket)
+                m_bucketRuns[++bucketIndex] = m_runs.size();
+
+            const MeshDrawCommand &cmd = m_commands[m_order[i]];
+            // A run never crosses into the next bucket
+            if (m_runs.size() > m_bucketRuns[bucketIndex])
+            {
+                MeshDrawRun &run = m_runs.back();
+                if (canInstance(getRunCommand(run), cmd))
+                {
+                    ++run.count;
+                    continue;
+                }
+            }
+            m_runs.push_back({i, 1});
+        }
+
+        while (bucketIndex < static_cast<size_t>(MeshDrawBucket::Count))
+            m_bucketRuns[++bucketIndex] = m_runs.size();
+    }
+} // namespace Fermion
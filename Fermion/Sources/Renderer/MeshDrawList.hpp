@@ -0,0 +1,102 @@
+#pragma once
+#include "Renderer/RenderDrawCommand.hpp"
+#include "Renderer/UniformBufferLayout.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Fermion
+{
+    // Frustum-culled draws get their own buckets: they are skipped by the camera passes but still cast shadows
+    enum class MeshDrawBucket : uint8_t
+    {
+        Opaque = 0,
+        Transparent,
+        CulledOpaque,
+        CulledTransparent,
+        Count
+    };
+
+    // Consecutive sorted draws that differ only in their ModelData; drawn with one instanced call.
+    // first indexes both the sorted order and getInstances().
+    struct MeshDrawRun
+    {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    // Mesh draws for one frame, kept in submission order, plus a sorted draw order.
+    // Only the 64-bit keys and their indices move during sorting; the commands themselves stay put.
+    //
+    // Opaque keys:      [bucket:2][pipeline:8][material:16][mesh:16][depth:22]  state first, then front to back
+    // Transparent keys: [bucket:2][depth:32][pipeline:8][material:12][mesh:10]  back to front
+    //
+    // Meshes in the same geometry page share a vertex array, so the mesh field takes its high bits from the
+    // vertex array and the rest from the index range: draws of one page end up next to each other, where
+    // they can be merged into one indirect draw, and draws of one submesh next to each other within that.
+    //
+    // After sorting, neighbouring draws with the same mesh, submesh range, material and pipeline are merged
+    // into runs, and every draw's ModelData is written to getInstances() in sorted order.
+    class MeshDrawList
+    {
+    public:
+        void add(MeshDrawCommand &&command);
+        // Index ranges for a command's firstRange/rangeCount, with indexBase added to every offset; returns
+        // the first one's index
+        uint32_t addRanges(const uint32_t *indexCounts, const uint32_t *indexOffsets, uint32_t count,
+                           uint32_t indexBase = 0);
+        void clear();
+
+        // Builds the keys from view-space depth, radix-sorts them and builds the instance runs
+        void sort(const glm::mat4 &view);
+
+        const std::vector<MeshDrawCommand> &getCommands() const { return m_commands; }
+        const MeshDrawCommand &operator[](uint32_t index) const { return m_commands[index]; }
+
+        // Valid after sort()
+        std::span<const MeshDrawRun> getRuns(MeshDrawBucket bucket) const
+        {
+            const size_t index = static_cast<size_t>(bucket);
+            return {m_runs.data() + m_bucketRuns[index], m_bucketRuns[index + 1] - m_bucketRuns[index]};
+        }
+        // Every bucket, culled ones included
+        std::span<const MeshDrawRun> getRuns() const { return m_runs; }
+        const MeshDrawCommand &getRunCommand(const MeshDrawRun &run) const { return m_commands[m_order[run.first]]; }
+        // Command of a sorted draw; the index is the one used by getInstances()
+        const MeshDrawCommand &getSortedCommand(uint32_t index) const { return m_commands[m_order[index]]; }
+        // Per sorted draw, ready to upload to the instance storage buffer
+        const std::vector<ModelData> &getInstances() const { return m_instances; }
+        const uint32_t *getRangeCounts(const MeshDrawCommand &cmd) const { return m_rangeCounts.data() + cmd.firstRange; }
+        const uint32_t *getRangeOffsets(const MeshDrawCommand &cmd) const { return m_rangeOffsets.data() + cmd.firstRange; }
+
+        bool empty() const { return m_commands.empty(); }
+        size_t size() const { return m_commands.size(); }
+        bool hasTransparent() const { return m_transparentCount > 0; }
+
+    private:
+        uint8_t getPipelineID(const Pipeline *pipeline);
+        void radixSort();
+        void buildRuns();
+
+        std::vector<MeshDrawCommand> m_commands;
+        // Per command, filled in add(); the pipeline table is tiny so exact ids are cheap
+        std::vector<uint8_t> m_pipelineIDs;
+        std::vector<const Pipeline *> m_pipelines;
+        // Index ranges of partially culled draws, kept apart so the draw commands stay small
+        std::vector<uint32_t> m_rangeCounts;
+        std::vector<uint32_t> m_rangeOffsets;
+
+        std::vector<uint64_t> m_keys;
+        std::vector<uint32_t> m_order;
+        std::vector<uint64_t> m_scratchKeys;
+        std::vector<uint32_t> m_scratchOrder;
+        std::vector<ModelData> m_instances;
+        std::vector<MeshDrawRun> m_runs;
+        // Start of each bucket in m_runs, plus the end
+        std::array<size_t, static_cast<size_t>(MeshDrawBucket::Count) + 1> m_bucketRuns{};
+        size_t m_transparentCount = 0;
+    };
+} // namespace Fermion
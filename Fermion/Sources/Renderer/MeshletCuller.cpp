@@ -0,0 +1,184 @@
+#include "fmpch.hpp"
+#include "Renderer/MeshletCuller.hpp"
+#include "Renderer/Model/Mesh.hpp"
+#include "Math/Math.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FM_MESHLET_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace Fermion
+{
+    namespace
+    {
+        // Column lengths of the transform may differ by this fraction and still count as a uniform scale
+        constexpr float kUniformScaleTolerance = 1e-3f;
+
+        // The SIMD path loads Center + Radius and ConeAxis + ConeCutoff as one vector each
+        static_assert(offsetof(Meshlet, Radius) == offsetof(Meshlet, Center) + 3 * sizeof(float));
+        static_assert(offsetof(Meshlet, ConeCutoff) == offsetof(Meshlet, ConeAxis) + 3 * sizeof(float));
+
+        struct LocalView
+        {
+            std::array<glm::vec4, 6> planes;
+            // Length of each plane's normal in mesh space; scales the bounding radius
+            std::array<float, 6> planeScales;
+            glm::vec3 camera;
+            bool coneCulling;
+        };
+
+        bool isUniformScale(const glm::mat3 &linear)
+        {
+            const float sx = glm::length(linear[0]);
+            const float sy = glm::length(linear[1]);
+            const float sz = glm::length(linear[2]);
+            const float minScale = std::min({sx, sy, sz});
+            const float maxScale = std::max({sx, sy, sz});
+            // Equal column lengths whose volume matches their product are also orthogonal
+            const float volume = sx * sy * sz;
+            return minScale > 0.0f && maxScale - minScale <= maxScale * kUniformScaleTolerance &&
+                   std::abs(glm::determinant(linear) - volume) <= volume * 3.0f * kUniformScaleTolerance;
+        }
+
+        bool isVisible(const Meshlet &meshlet, const LocalView &view)
+        {
+            for (size_t p = 0; p < view.planes.size(); ++p)
+            {
+                const glm::vec4 &plane = view.planes[p];
+                if (glm::dot(glm::vec3(plane), meshlet.Center) + plane.w + meshlet.Radius * view.planeScales[p] < 0.0f)
+                    return false;
+            }
+
+            if (view.coneCulling && meshlet.ConeCutoff < 1.0f)
+            {
+                const glm::vec3 toCenter = meshlet.Center - view.camera;
+                if (glm::dot(toCenter, meshlet.ConeAxis) >= meshlet.ConeCutoff * glm::length(toCenter) + meshlet.Radius)
+                    return false;
+            }
+            return true;
+        }
+
+#if FM_MESHLET_SSE2
+        // Bit i set when meshlets[i] survives, for four meshlets
+        int testFour(const Meshlet *meshlets, const LocalView &view)
+        {
+            __m128 cx = _mm_loadu_ps(&meshlets[0].Center.x);
+            __m128 cy = _mm_loadu_ps(&meshlets[1].Center.x);
+            __m128 cz = _mm_loadu_ps(&meshlets[2].Center.x);
+            __m128 radius = _mm_loadu_ps(&meshlets[3].Center.x);
+            _MM_TRANSPOSE4_PS(cx, cy, cz, radius);
+
+            const __m128 zero = _mm_setzero_ps();
+            __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (size_t p = 0; p < view.planes.size(); ++p)
+            {
+                const glm::vec4 &plane = view.planes[p];
+                __m128 distance = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.y)));
+                distance = _mm_add_ps(distance, _mm_mul_ps(cz, _mm_set1_ps(plane.z)));
+                distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+                distance = _mm_add_ps(distance, _mm_mul_ps(radius, _mm_set1_ps(view.planeScales[p])));
+                visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, zero));
+            }
+
+            if (view.coneCulling)
+            {
+                __m128 ax = _mm_loadu_ps(&meshlets[0].ConeAxis.x);
+                __m128 ay = _mm_loadu_ps(&meshlets[1].ConeAxis.x);
+                __m128 az = _mm_loadu_ps(&meshlets[2].ConeAxis.x);
+                __m128 cutoff = _mm_loadu_ps(&meshlets[3].ConeAxis.x);
+                _MM_TRANSPOSE4_PS(ax, ay, az, cutoff);
+
+                const __m128 dx = _mm_sub_ps(cx, _mm_set1_ps(view.camera.x));
+                const __m128 dy = _mm_sub_ps(cy, _mm_set1_ps(view.camera.y));
+                const __m128 dz = _mm_sub_ps(cz, _mm_set1_ps(view.camera.z));
+                __m128 along = _mm_add_ps(_mm_mul_ps(dx, ax), _mm_mul_ps(dy, ay));
+                along = _mm_add_ps(along, _mm_mul_ps(dz, az));
+                __m128 distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+                distance = _mm_sqrt_ps(_mm_add_ps(distance, _mm_mul_ps(dz, dz)));
+
+                const __m128 limit = _mm_add_ps(_mm_mul_ps(cutoff, distance), radius);
+                const __m128 backfacing = _mm_and_ps(_mm_cmpge_ps(along, limit), _mm_cmplt_ps(cutoff, _mm_set1_ps(1.0f)));
+                visible = _mm_andnot_ps(backfacing, visible);
+            }
+            return _mm_movemask_ps(visible);
+        }
+#endif
+    } // namespace
+
+    void MeshletCuller::begin(const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition)
+    {
+        m_planes = Math::ExtractFrustumPlanes(viewProjection);
+        m_cameraPosition = cameraPosition;
+        m_statistics = {};
+    }
+
+    uint32_t MeshletCuller::cull(std::span<const Meshlet> meshlets, const glm::mat4 &transform, bool backfaceCulling)
+    {
+        m_indexCounts.clear();
+        m_indexOffsets.clear();
+        if (meshlets.empty())
+            return 0;
+
+        LocalView view;
+        for (size_t p = 0; p < m_planes.size(); ++p)
+        {
+            // plane(transform * x) == (transpose(transform) * plane)(x)
+            const glm::vec4 &plane = m_planes[p];
+            view.planes[p] = glm::vec4(glm::dot(transform[0], plane), glm::dot(transform[1], plane),
+                                       glm::dot(transform[2], plane), glm::dot(transform[3], plane));
+            view.planeScales[p] = glm::length(glm::vec3(view.planes[p]));
+        }
+        view.camera = glm::vec3(glm::inverse(transform) * glm::vec4(m_cameraPosition, 1.0f));
+        view.coneCulling = backfaceCulling && isUniformScale(glm::mat3(transform));
+
+        const uint32_t count = static_cast<uint32_t>(meshlets.size());
+        uint32_t kept = 0;
+        uint32_t survivors = 0;
+        uint32_t i = 0;
+#if FM_MESHLET_SSE2
+        for (; i + 4 <= count; i += 4)
+        {
+            const int mask = testFour(meshlets.data() + i, view);
+            for (uint32_t lane = 0; lane < 4; ++lane)
+            {
+                if (mask & (1 << lane))
+                {
+                    addRange(meshlets[i + lane].IndexOffset, meshlets[i + lane].IndexCount);
+                    kept += meshlets[i + lane].IndexCount;
+                    ++survivors;
+                }
+            }
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            if (isVisible(meshlets[i], view))
+            {
+                addRange(meshlets[i].IndexOffset, meshlets[i].IndexCount);
+                kept += meshlets[i].IndexCount;
+                ++survivors;
+            }
+        }
+
+        m_statistics.tested += count;
+        m_statistics.culled += count - survivors;
+        return kept;
+    }
+
+    void MeshletCuller::addRange(uint32_t indexOffset, uint32_t indexCount)
+    {
+        // Neighbouring meshlets are usually contiguous in the index buffer, so most survivors merge
+        if (!m_indexOffsets.empty() && m_indexOffsets.back() + m_indexCounts.back() == indexOffset)
+        {
+            m_indexCounts.back() += indexCount;
+            return;
+        }
+        m_indexOffsets.push_back(indexOffset);
+        m_indexCounts.push_back(indexCount);
+    }
+} // namespace Fermion
@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Fermion
+{
+    struct Meshlet;
+
+    // Per-meshlet culling on the CPU. Every meshlet of a draw is tested against the camera frustum and, for
+    // back-face culled pipelines, against its normal cone; the index ranges of the survivors are merged where
+    // they touch and drawn as one indirect draw. Four meshlets are tested per step (SSE2 where available, scalar
+    // otherwise), so it needs no GPU support and runs the same on software rasterizers.
+    //
+    // The tests run in the mesh's own space: the frustum planes are carried into it by the transposed
+    // transform and the camera by its inverse, so the stored bounds are never transformed.
+    class MeshletCuller
+    {
+    public:
+        struct Statistics
+        {
+            uint32_t tested = 0;
+            uint32_t culled = 0;
+        };
+
+        void begin(const glm::mat4 &viewProjection, const glm::vec3 &cameraPosition);
+
+        // Returns the number of surviving indices; their ranges are in getIndexCounts/getIndexOffsets until
+        // the next call. The cone test is skipped for mirrored or non-uniformly scaled transforms, which
+        // don't preserve the cone's angle.
+        uint32_t cull(std::span<const Meshlet> meshlets, const glm::mat4 &transform, bool backfaceCulling);
+
+        const std::vector<uint32_t> &getIndexCounts() const { return m_indexCounts; }
+        const std::vector<uint32_t> &getIndexOffsets() const { return m_indexOffsets; }
+        const Statistics &getStatistics() const { return m_statistics; }
+
+    private:
+        void addRange(uint32_t indexOffset, uint32_t indexCount);
+
+        std::array<glm::vec4, 6> m_planes{};
+        glm::vec3 m_cameraPosition{0.0f};
+        std::vector<uint32_t> m_indexCounts;
+        std::vector<uint32_t> m_indexOffsets;
+        Statistics m_statistics;
+    };
+} // namespace Fermion
@@ -1,4 +1,5 @@
 #include "Material.hpp"
+#include "../UniformBuffer.hpp"
 #include "../Shader.hpp"
 #include "Project/Project.hpp"
 #include "Asset/AssetManager/RuntimeAssetManager.hpp"
@@ -18,22 +19,26 @@ namespace Fermion
     void Material::setDiffuseColor(const glm::vec4 &color)
     {
         DiffuseColor = color;
+        m_GPU.dirty = true;
     }
 
     void Material::setAmbientColor(const glm::vec4 &color)
     {
         AmbientColor = color;
+        m_GPU.dirty = true;
     }
 
     void Material::setDiffuseTexture(AssetHandle textureHandle)
     {
         DiffuseTextureHandle = textureHandle;
+        m_GPU.dirty = true;
     }
 
     // PBR setters
     void Material::setMaterialType(MaterialType type)
     {
         Type = type;
+        m_GPU.dirty = true;
     }
 
     void Material::setName(const std::string &name)
@@ -44,61 +49,82 @@ namespace Fermion
     void Material::setAlbedo(const glm::vec3 &albedo)
     {
         Albedo = albedo;
+        m_GPU.dirty = true;
     }
 
     void Material::setMetallic(float metallic)
     {
         Metallic = glm::clamp(metallic, 0.0f, 1.0f);
+        m_GPU.dirty = true;
     }
 
     void Material::setRoughness(float roughness)
     {
         Roughness = glm::clamp(roughness, 0.0f, 1.0f);
+        m_GPU.dirty = true;
     }
 
     void Material::setAO(float ao)
     {
         AO = glm::clamp(ao, 0.0f, 1.0f);
+        m_GPU.dirty = true;
     }
 
     void Material::setAlbedoMap(AssetHandle textureHandle)
     {
         m_Maps.AlbedoMapHandle = textureHandle;
+        m_GPU.dirty = true;
     }
 
     void Material::setNormalMap(AssetHandle textureHandle)
     {
         m_Maps.NormalMapHandle = textureHandle;
+        m_GPU.dirty = true;
     }
 
     void Material::setMetallicMap(AssetHandle textureHandle)
     {
         m_Maps.MetallicMapHandle = textureHandle;
+        m_GPU.dirty = true;
     }
 
     void Material::setRoughnessMap(AssetHandle textureHandle)
     {
         m_Maps.RoughnessMapHandle = textureHandle;
+        m_GPU.dirty = true;
     }
 
     void Material::setAOMap(AssetHandle textureHandle)
     {
         m_Maps.AOMapHandle = textureHandle;
+        m_GPU.dirty = true;
     }
 
     // Bind
-    void Material::bind(const std::shared_ptr<Shader> &shader, int slot) const
+    void Material::bind(Shader *shader) const
     {
-        if (Type == MaterialType::PBR)
-        {
-            bindPBR(shader, slot);
-        }
-        else
+        if (m_GPU.dirty)
+            updateGPUState();
+
+        if (shader && shader->getKeywordMask() != 0)
+            shader->getVariant(m_GPU.shaderKeywords)->bind();
+
+        if (m_GPU.uniformBuffer)
+            m_GPU.uniformBuffer->bind();
+        for (uint32_t slot = 0; slot < MaterialTextureSlot::Count; ++slot)
         {
-            bindPhong(shader, slot);
+            if (m_GPU.textures[slot])
+                m_GPU.textures[slot]->bind(slot);
         }
     }
 
+    uint32_t Material::getShaderKeywords() const
+    {
+        if (m_GPU.dirty)
+            updateGPUState();
+        return m_GPU.shaderKeywords;
+    }
+
     // Clone / Copy
     std::shared_ptr<Material> Material::clone() const
     {
@@ -127,6 +153,7 @@ namespace Fermion
         m_Maps.AOMapHandle = other.m_Maps.AOMapHandle;
 
         m_EditorData = other.m_EditorData;
+        m_GPU.dirty = true;
     }
 
     // Getters
@@ -170,60 +197,63 @@ namespace Fermion
         m_EditorData = data;
     }
 
-    void Material::bindPhong(const std::shared_ptr<Shader> &shader, int slot) const
+    void Material::updateGPUState() const
     {
         auto assetManager = Project::getRuntimeAssetManager();
-        std::shared_ptr<Texture2D> texture = nullptr;
+        bool pending = false;
 
-        if (static_cast<uint64_t>(DiffuseTextureHandle) != 0)
+        // Textures that exist but haven't finished loading keep the material dirty so they are picked up later
+        auto resolve = [&](AssetHandle handle) -> std::shared_ptr<Texture2D>
         {
-            texture = assetManager->getAsset<Texture2D>(DiffuseTextureHandle);
-        }
-
-        bool hasTexture = texture && texture->isLoaded();
-        shader->setBool("u_UseTexture", hasTexture);
-        shader->setFloat4("u_Kd", DiffuseColor);
-        shader->setFloat4("u_Ka", AmbientColor);
+            if (static_cast<uint64_t>(handle) == 0)
+                return nullptr;
+            auto texture = assetManager->getAsset<Texture2D>(handle);
+            if (texture && !texture->isLoaded())
+            {
+                pending = true;
+                return nullptr;
+            }
+            return texture;
+        };
 
-        if (hasTexture)
+        MaterialData data{};
+        m_GPU.textures = {};
+        if (Type == MaterialType::PBR)
         {
-            texture->bind(slot);
-            shader->setInt("u_Texture", slot);
+            data.albedo = glm::vec4(Albedo, 1.0f);
+            data.metallic = Metallic;
+            data.roughness = Roughness;
+            data.ao = AO;
+
+            m_GPU.textures[MaterialTextureSlot::Albedo] = resolve(m_Maps.AlbedoMapHandle);
+            m_GPU.textures[MaterialTextureSlot::Normal] = resolve(m_Maps.NormalMapHandle);
+            m_GPU.textures[MaterialTextureSlot::Metallic] = resolve(m_Maps.MetallicMapHandle);
+            m_GPU.textures[MaterialTextureSlot::Roughness] = resolve(m_Maps.RoughnessMapHandle);
+            m_GPU.textures[MaterialTextureSlot::AO] = resolve(m_Maps.AOMapHandle);
         }
-    }
-
-    void Material::bindPBR(const std::shared_ptr<Shader> &shader, int slot) const
-    {
-        shader->setFloat3("u_Material.albedo", Albedo);
-        shader->setFloat("u_Material.metallic", Metallic);
-        shader->setFloat("u_Material.roughness", Roughness);
-        shader->setFloat("u_Material.ao", AO);
-
-        auto assetManager = Project::getRuntimeAssetManager();
-        int currentSlot = slot;
-
-        auto bindMap = [&](AssetHandle handle, const char *uniformName, const char *useFlag)
+        else
         {
-            if (static_cast<uint64_t>(handle) != 0)
-            {
-                auto texture = assetManager->getAsset<Texture2D>(handle);
-                if (texture && texture->isLoaded())
-                {
-                    texture->bind(currentSlot);
-                    shader->setInt(uniformName, currentSlot);
-                    shader->setBool(useFlag, true);
-                    currentSlot++;
-                    return;
-                }
-            }
-            shader->setBool(useFlag, false);
-        };
+            data.albedo = DiffuseColor;
+            data.ambient = AmbientColor;
+            m_GPU.textures[MaterialTextureSlot::Albedo] = resolve(DiffuseTextureHandle);
+        }
 
-        bindMap(m_Maps.AlbedoMapHandle, "u_AlbedoMap", "u_UseAlbedoMap");
-        bindMap(m_Maps.NormalMapHandle, "u_NormalMap", "u_UseNormalMap");
-        bindMap(m_Maps.MetallicMapHandle, "u_MetallicMap", "u_UseMetallicMap");
-        bindMap(m_Maps.RoughnessMapHandle, "u_RoughnessMap", "u_UseRoughnessMap");
-        bindMap(m_Maps.AOMapHandle, "u_AOMap", "u_UseAOMap");
+        data.hasAlbedoMap = m_GPU.textures[MaterialTextureSlot::Albedo] ? 1 : 0;
+        data.hasNormalMap = m_GPU.textures[MaterialTextureSlot::Normal] ? 1 : 0;
+        data.hasMetallicMap = m_GPU.textures[MaterialTextureSlot::Metallic] ? 1 : 0;
+        data.hasRoughnessMap = m_GPU.textures[MaterialTextureSlot::Roughness] ? 1 : 0;
+        data.hasAOMap = m_GPU.textures[MaterialTextureSlot::AO] ? 1 : 0;
+
+        m_GPU.shaderKeywords = (data.hasAlbedoMap ? ShaderKeyword::AlbedoMap : 0) |
+                               (data.hasNormalMap ? ShaderKeyword::NormalMap : 0) |
+                               (data.hasMetallicMap ? ShaderKeyword::MetallicMap : 0) |
+                               (data.hasRoughnessMap ? ShaderKeyword::RoughnessMap : 0) |
+                               (data.hasAOMap ? ShaderKeyword::AOMap : 0);
+
+        if (!m_GPU.uniformBuffer)
+            m_GPU.uniformBuffer = UniformBuffer::create(UniformBufferBinding::Material, MaterialData::getSize());
+        m_GPU.uniformBuffer->setData(&data, MaterialData::getSize());
+        m_GPU.dirty = pending;
     }
 
 } // namespace Fermion
@@ -1,11 +1,16 @@
 #pragma once
 #include "fmpch.hpp"
 #include "Asset/Asset.hpp"
+#include "Renderer/UniformBufferLayout.hpp"
 #include "glm/glm.hpp"
 
+#include <array>
+
 namespace Fermion
 {
 
+    class UniformBuffer;
+    class Texture2D;
     class Shader;
     enum class MaterialType : uint8_t
     {
@@ -68,7 +73,14 @@ namespace Fermion
         void setRoughnessMap(AssetHandle textureHandle);
         void setAOMap(AssetHandle textureHandle);
 
-        void bind(const std::shared_ptr<Shader> &shader, int slot = 0) const;
+        // Binds the material's parameter block and texture set, uploading them first if the material changed.
+        // Given the shader of the bound pipeline, also binds that shader's variant for getShaderKeywords()
+        void bind(Shader *shader = nullptr) const;
+        // ShaderKeyword bits for the maps the material samples; maps still loading are left out until they load.
+        // Render thread only, like bind()
+        uint32_t getShaderKeywords() const;
+        // For edits made through the handle references below, which the setters can't see
+        void markDirty() { m_GPU.dirty = true; }
         std::shared_ptr<Material> clone() const;
         void copyFrom(const Material &other);
 
@@ -103,8 +115,25 @@ namespace Fermion
         void setEditorData(const MaterialNodeEditorData &data);
 
     private:
-        void bindPhong(const std::shared_ptr<Shader> &shader, int slot) const;
-        void bindPBR(const std::shared_ptr<Shader> &shader, int slot) const;
+        void updateGPUState() const;
+
+        // Built lazily on the render thread. A copied material starts dirty and never shares the
+        // parameter block of the material it was copied from
+        struct GPUState
+        {
+            GPUState() = default;
+            GPUState(const GPUState &) {}
+            GPUState &operator=(const GPUState &)
+            {
+                dirty = true;
+                return *this;
+            }
+
+            std::shared_ptr<UniformBuffer> uniformBuffer;
+            std::array<std::shared_ptr<Texture2D>, MaterialTextureSlot::Count> textures;
+            uint32_t shaderKeywords = 0;
+            bool dirty = true;
+        };
 
     private:
         MaterialType Type;
@@ -123,6 +152,8 @@ namespace Fermion
 
         MapAssets m_Maps;
         MaterialNodeEditorData m_EditorData;
+
+        mutable GPUState m_GPU;
     };
 
 } // namespace Fermion
@@ -1,11 +1,14 @@
 #include "Mesh.hpp"
+#include "MeshPacking.hpp"
 #include "../VertexArray.hpp"
+#include "../GeometryPool.hpp"
 #include <assimp/postprocess.h>
 namespace Fermion
 {
     Mesh::Mesh(std::vector<Vertex> vertices,
                std::vector<uint32_t> indices,
-               std::vector<SubMesh> subMeshes) : m_vertices(std::move(vertices)),
+               std::vector<SubMesh> subMeshes,
+               std::vector<SubMeshLod> lods) : m_vertices(std::move(vertices)),
                                                  m_indices(std::move(indices)),
                                                  m_SubMeshes(std::move(subMeshes))
     {
@@ -19,6 +22,9 @@ namespace Fermion
             m_SubMeshes.push_back(sub);
         }
 
+        if (!lods.empty())
+            setSubMeshLods(std::move(lods));
+
         setupMesh();
         calculateBoundingBox();
     }
@@ -41,6 +47,75 @@ namespace Fermion
         Log::Info("---------------------------------------------------");
     }
 
+    SubMeshLod Mesh::getSubMeshLod(size_t subMesh, uint32_t lod) const
+    {
+        const SubMesh &base = m_SubMeshes[subMesh];
+        if (lod == 0 || m_SubMeshLods.empty())
+            return {base.IndexOffset, base.IndexCount, 0.0f};
+
+        lod = std::min(lod, getLodCount() - 1);
+        return m_SubMeshLods[(lod - 1) * m_SubMeshes.size() + subMesh];
+    }
+
+    void Mesh::setSubMeshLods(std::vector<SubMeshLod> lods)
+    {
+        if (m_SubMeshes.empty() || lods.size() % m_SubMeshes.size() != 0)
+        {
+            Log::Warn(std::format("Mesh: Ignoring {} LOD ranges for {} submeshes", lods.size(), m_SubMeshes.size()));
+            return;
+        }
+        for (const SubMeshLod &lod : lods)
+        {
+            if (static_cast<uint64_t>(lod.IndexOffset) + lod.IndexCount > m_indices.size())
+            {
+                Log::Warn(std::format("Mesh: Ignoring LOD ranges past its {} indices", m_indices.size()));
+                return;
+            }
+        }
+        m_SubMeshLods = std::move(lods);
+        if (m_VAO)
+            setupMesh();
+    }
+
+    void Mesh::setMeshlets(std::vector<Meshlet> meshlets)
+    {
+        std::sort(meshlets.begin(), meshlets.end(), [](const Meshlet &a, const Meshlet &b)
+                  { return a.IndexOffset < b.IndexOffset; });
+
+        std::vector<std::pair<uint32_t, uint32_t>> ranges(m_SubMeshes.size(), {0u, 0u});
+        size_t assigned = 0;
+        for (size_t i = 0; i < m_SubMeshes.size(); i++)
+        {
+            const SubMesh &subMesh = m_SubMeshes[i];
+            const auto first = std::lower_bound(meshlets.begin(), meshlets.end(), subMesh.IndexOffset,
+                                                [](const Meshlet &m, uint32_t offset)
+                                                { return m.IndexOffset < offset; });
+            auto last = first;
+            while (last != meshlets.end() &&
+                   last->IndexOffset + last->IndexCount <= subMesh.IndexOffset + subMesh.IndexCount)
+                ++last;
+            ranges[i] = {static_cast<uint32_t>(first - meshlets.begin()), static_cast<uint32_t>(last - first)};
+            assigned += last - first;
+        }
+
+        if (assigned != meshlets.size())
+        {
+            Log::Warn(std::format("Mesh: Ignoring {} meshlets that don't fit its {} submeshes", meshlets.size(),
+                                  m_SubMeshes.size()));
+            return;
+        }
+        m_Meshlets = std::move(meshlets);
+        m_SubMeshMeshletRanges = std::move(ranges);
+    }
+
+    uint32_t Mesh::getBaseIndexCount() const
+    {
+        uint32_t count = 0;
+        for (const auto &subMesh : m_SubMeshes)
+            count = std::max(count, subMesh.IndexOffset + subMesh.IndexCount);
+        return m_SubMeshLods.empty() ? static_cast<uint32_t>(m_indices.size()) : count;
+    }
+
     void Mesh::calculateBoundingBox()
     {
         m_BoundingBox.min = {FLT_MAX, FLT_MAX, FLT_MAX};
@@ -55,6 +130,22 @@ namespace Fermion
             m_BoundingBox.max.y = std::max(m_BoundingBox.max.y, vertex.Position.y);
             m_BoundingBox.max.z = std::max(m_BoundingBox.max.z, vertex.Position.z);
         }
+
+        m_SubMeshBounds.resize(m_SubMeshes.size());
+        for (size_t i = 0; i < m_SubMeshes.size(); i++)
+        {
+            const SubMesh &subMesh = m_SubMeshes[i];
+            AABB bounds({FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX});
+            const uint32_t end = std::min<uint32_t>(subMesh.IndexOffset + subMesh.IndexCount,
+                                                    static_cast<uint32_t>(m_indices.size()));
+            for (uint32_t index = subMesh.IndexOffset; index < end; index++)
+            {
+                const glm::vec3 &position = m_vertices[m_indices[index]].Position;
+                bounds.min = glm::min(bounds.min, position);
+                bounds.max = glm::max(bounds.max, position);
+            }
+            m_SubMeshBounds[i] = subMesh.IndexOffset < end ? bounds : m_BoundingBox;
+        }
     }
 
     void Mesh::loadMesh(const std::string &path)
@@ -357,18 +448,51 @@ namespace Fermion
 
     void Mesh::setupMesh()
     {
+        // The GPU copy is packed; the CPU keeps full-precision vertices for bounds and other CPU-side queries
+        const PackedVertexFormat vertexFormat = MeshPacking::chooseVertexFormat(m_vertices);
+        std::vector<uint8_t> packedVertices;
+        MeshPacking::packVertices(m_vertices, vertexFormat, packedVertices);
+        const BufferLayout vertexLayout = MeshPacking::getVertexLayout(vertexFormat);
+
+        const PackedIndexFormat indexFormat = MeshPacking::chooseIndexFormat(m_indices, m_SubMeshes, m_SubMeshLods);
+        m_SubMeshBaseVertices = indexFormat.baseVertices;
+
+        std::vector<uint16_t> packedIndices;
+        if (indexFormat.shortIndices)
+            MeshPacking::packIndices(m_indices, m_SubMeshes, m_SubMeshLods, indexFormat, packedIndices);
+
+        const uint32_t vertexCount = static_cast<uint32_t>(m_vertices.size());
+        const uint32_t indexCount = static_cast<uint32_t>(m_indices.size());
+        const IndexType indexType = indexFormat.shortIndices ? IndexType::UInt16 : IndexType::UInt32;
+        const void *indexData = indexFormat.shortIndices ? static_cast<const void *>(packedIndices.data())
+                                                         : static_cast<const void *>(m_indices.data());
+
+        // Static meshes share pooled buffers so that draws of different meshes can merge into one indirect draw
+        m_Geometry = m_isSkinned ? nullptr
+                                 : GeometryPool::allocate(vertexLayout, packedVertices.data(), vertexCount, indexType,
+                                                          indexData, indexCount);
+        if (m_Geometry)
+        {
+            m_VAO = m_Geometry->getVertexArray();
+            m_FirstVertex = m_Geometry->getFirstVertex();
+            m_FirstIndex = m_Geometry->getFirstIndex();
+            return;
+        }
+
         m_VAO = VertexArray::create();
+        m_FirstVertex = 0;
+        m_FirstIndex = 0;
 
         auto vbo = VertexBuffer::create(
-            reinterpret_cast<float *>(m_vertices.data()),
-            (uint32_t)(m_vertices.size() * sizeof(Vertex)));
-
-        vbo->setLayout({{ShaderDataType::Float3, "a_Position"},
-                        {ShaderDataType::Float3, "a_Normal"},
-                        {ShaderDataType::Float4, "a_Color"},
-                        {ShaderDataType::Float2, "a_TexCoords"}});
-
-        auto ibo = IndexBuffer::create(m_indices.data(), (uint32_t)m_indices.size());
+            reinterpret_cast<float *>(packedVertices.data()),
+            (uint32_t)packedVertices.size());
+        vbo->setLayout(vertexLayout);
+
+        std::shared_ptr<IndexBuffer> ibo;
+        if (indexFormat.shortIndices)
+            ibo = IndexBuffer::create(packedIndices.data(), (uint32_t)packedIndices.size());
+        else
+            ibo = IndexBuffer::create(m_indices.data(), (uint32_t)m_indices.size());
 
         m_VAO->addVertexBuffer(vbo);
 
@@ -6,10 +6,12 @@
 #include "Animation/AnimationClip.hpp"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
+#include <span>
 
 namespace Fermion
 {
     class VertexArray;
+    class GeometryAllocation;
     struct Vertex
     {
         glm::vec3 Position;
@@ -31,6 +33,26 @@ namespace Fermion
         uint32_t IndexCount = 0;
     };
 
+    // A coarser version of a submesh: another range of the index buffer over the same vertices
+    struct SubMeshLod
+    {
+        uint32_t IndexOffset = 0;
+        uint32_t IndexCount = 0;
+        float Error = 0.0f; // Largest deviation from the full-detail surface, in mesh units
+    };
+
+    // A small cluster of consecutive triangles in a submesh's full-detail range, with the bounds used to cull
+    // it on the CPU. Center and ConeAxis come first so four meshlets transpose into SIMD lanes directly.
+    struct Meshlet
+    {
+        glm::vec3 Center = glm::vec3(0.0f); // Bounding sphere, in mesh space
+        float Radius = 0.0f;
+        glm::vec3 ConeAxis = glm::vec3(0.0f, 0.0f, 1.0f); // Average facing of the triangles
+        float ConeCutoff = 1.0f;                           // Sine of the normal cone's half angle; 1 never culls
+        uint32_t IndexOffset = 0;
+        uint32_t IndexCount = 0;
+    };
+
     enum MemoryMeshType : uint16_t
     {
         None = 0,
@@ -61,7 +83,8 @@ namespace Fermion
 
         Mesh(std::vector<Vertex> vertices,
              std::vector<uint32_t> indices,
-             std::vector<SubMesh> subMeshes = {});
+             std::vector<SubMesh> subMeshes = {},
+             std::vector<SubMeshLod> lods = {});
 
         ~Mesh() = default;
 
@@ -82,6 +105,49 @@ namespace Fermion
             return m_SubMeshes;
         }
 
+        // Level 0 is the submeshes themselves; coarser levels follow their indices in the index buffer
+        uint32_t getLodCount() const
+        {
+            return static_cast<uint32_t>(m_SubMeshLods.size() / std::max<size_t>(m_SubMeshes.size(), 1)) + 1;
+        }
+        SubMeshLod getSubMeshLod(size_t subMesh, uint32_t lod) const;
+        // (lodCount - 1) * submeshes ranges, level-major, as MeshSimplifier::generateLods returns them.
+        // Re-uploads the index buffer, whose packing depends on the ranges; pass them to the constructor instead
+        void setSubMeshLods(std::vector<SubMeshLod> lods);
+        const std::vector<SubMeshLod> &getSubMeshLods() const
+        {
+            return m_SubMeshLods;
+        }
+        // Indices of the full-detail submeshes, before any coarser level
+        uint32_t getBaseIndexCount() const;
+        // Sorted by index offset; every meshlet lies inside one submesh's full-detail range
+        void setMeshlets(std::vector<Meshlet> meshlets);
+        const std::vector<Meshlet> &getMeshlets() const
+        {
+            return m_Meshlets;
+        }
+        // Empty when the mesh was imported without meshlets
+        std::span<const Meshlet> getSubMeshMeshlets(size_t subMesh) const
+        {
+            if (subMesh >= m_SubMeshMeshletRanges.size())
+                return {};
+            const auto [first, count] = m_SubMeshMeshletRanges[subMesh];
+            return {m_Meshlets.data() + first, count};
+        }
+
+        // Added to the submesh's indices when drawing: where the mesh's vertices start in a shared geometry
+        // page, plus the submesh's base when 16-bit indices are relative to it
+        int32_t getSubMeshBaseVertex(size_t subMesh) const
+        {
+            const uint32_t base = subMesh < m_SubMeshBaseVertices.size() ? m_SubMeshBaseVertices[subMesh] : 0;
+            return static_cast<int32_t>(m_FirstVertex + base);
+        }
+        // Added to every index offset when drawing; where the mesh's indices start in a shared geometry page
+        uint32_t getFirstIndex() const
+        {
+            return m_FirstIndex;
+        }
+
         const std::string &getPath() const
         {
             return m_ModelPath;
@@ -93,6 +159,11 @@ namespace Fermion
         {
             return m_BoundingBox;
         }
+        // Bounds of the vertices a submesh indexes; the whole mesh's bounds if it has no indices
+        const AABB &getSubMeshBounds(size_t index) const
+        {
+            return index < m_SubMeshBounds.size() ? m_SubMeshBounds[index] : m_BoundingBox;
+        }
 
         bool isSkinned() const { return m_isSkinned; }
 
@@ -126,11 +197,21 @@ namespace Fermion
         std::vector<Vertex> m_vertices;
         std::vector<uint32_t> m_indices;
         std::vector<SubMesh> m_SubMeshes;
+        std::vector<SubMeshLod> m_SubMeshLods;
+        std::vector<uint32_t> m_SubMeshBaseVertices;
+        std::vector<Meshlet> m_Meshlets;
+        // First meshlet and meshlet count of every submesh
+        std::vector<std::pair<uint32_t, uint32_t>> m_SubMeshMeshletRanges;
 
         std::string m_ModelPath;
         AABB m_BoundingBox;
+        std::vector<AABB> m_SubMeshBounds;
 
         std::shared_ptr<VertexArray> m_VAO = nullptr;
+        // Static meshes live in a GeometryPool page shared with other meshes; skinned meshes own their buffers
+        std::shared_ptr<GeometryAllocation> m_Geometry;
+        uint32_t m_FirstVertex = 0;
+        uint32_t m_FirstIndex = 0;
 
         // Skinning data
         bool m_isSkinned = false;
@@ -0,0 +1,353 @@
+#include "fmpch.hpp"
+#include "MeshOptimizer.hpp"
+#include "Core/JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <set>
+#include <unordered_map>
+
+namespace Fermion
+{
+    namespace
+    {
+        // Forsyth's scoring: an LRU cache model and a bonus for vertices with few triangles left
+        constexpr uint32_t kCacheSize = 32;
+        constexpr float kCacheDecayPower = 1.5f;
+        constexpr float kLastTriangleScore = 0.75f;
+        constexpr float kValenceBoostScale = 2.0f;
+        constexpr float kValenceBoostPower = 0.5f;
+
+        // FIFO size used to find where the cache-ordered list restarts; 16 entries is typical of current GPUs
+        constexpr uint32_t kFifoCacheSize = 16;
+
+        constexpr uint32_t kNone = UINT32_MAX;
+
+        float vertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+        {
+            if (remainingTriangles == 0)
+                return -1.0f;
+
+            float score = 0.0f;
+            if (cachePosition >= 0)
+            {
+                if (cachePosition < 3)
+                {
+                    // The triangle just drawn; the same score for all three so there is no preferred winding
+                    score = kLastTriangleScore;
+                }
+                else
+                {
+                    const float scale = 1.0f / static_cast<float>(kCacheSize - 3);
+                    score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, kCacheDecayPower);
+                }
+            }
+            return score + kValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -kValenceBoostPower);
+        }
+
+        // Range indices renumbered to [0, span) so per-vertex arrays stay as small as the range
+        struct LocalVertices
+        {
+            uint32_t first = 0;
+            uint32_t count = 0;
+
+            explicit LocalVertices(const uint32_t *indices, size_t indexCount)
+            {
+                if (indexCount == 0)
+                    return;
+                const auto [minIt, maxIt] = std::minmax_element(indices, indices + indexCount);
+                first = *minIt;
+                count = *maxIt - *minIt + 1;
+            }
+        };
+
+        uint64_t hashBytes(const void *data, size_t size, uint64_t hash = 14695981039346656037ull)
+        {
+            const auto *bytes = static_cast<const uint8_t *>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+    } // namespace
+
+    void MeshOptimizer::weldVertices(const std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+                                     const std::vector<VertexBoneData> &boneData,
+                                     const std::vector<SubMesh> &subMeshes)
+    {
+        const bool skinned = boneData.size() == vertices.size();
+        auto hash = [&](uint32_t v)
+        {
+            const uint64_t h = hashBytes(&vertices[v], sizeof(Vertex));
+            return static_cast<size_t>(skinned ? hashBytes(&boneData[v], sizeof(VertexBoneData), h) : h);
+        };
+        auto equal = [&](uint32_t a, uint32_t b)
+        {
+            return std::memcmp(&vertices[a], &vertices[b], sizeof(Vertex)) == 0 &&
+                   (!skinned || std::memcmp(&boneData[a], &boneData[b], sizeof(VertexBoneData)) == 0);
+        };
+
+        JobSystem::parallelFor(static_cast<uint32_t>(subMeshes.size()), 1, [&](uint32_t s)
+                               {
+            const SubMesh &subMesh = subMeshes[s];
+            const size_t end = std::min<size_t>(static_cast<size_t>(subMesh.IndexOffset) + subMesh.IndexCount,
+                                                indices.size());
+
+            std::unordered_map<uint32_t, uint32_t, decltype(hash), decltype(equal)> canonical(
+                subMesh.IndexCount, hash, equal);
+            for (size_t i = subMesh.IndexOffset; i < end; i++)
+                indices[i] = canonical.emplace(indices[i], indices[i]).first->second; });
+    }
+
+    void MeshOptimizer::optimizeVertexCache(uint32_t *indices, size_t indexCount)
+    {
+        const uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+        if (triangleCount < 2)
+            return;
+
+        const LocalVertices local(indices, triangleCount * 3);
+        auto vertexAt = [&](uint32_t triangle, uint32_t corner)
+        { return indices[triangle * 3 + corner] - local.first; };
+
+        // Triangles of every vertex; the first remaining[v] entries of its list are the ones not yet emitted
+        std::vector<uint32_t> remaining(local.count, 0);
+        for (uint32_t i = 0; i < triangleCount * 3; i++)
+            remaining[indices[i] - local.first]++;
+
+        std::vector<uint32_t> adjacencyOffsets(local.count + 1, 0);
+        for (uint32_t v = 0; v < local.count; v++)
+            adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remaining[v];
+
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (uint32_t t = 0; t < triangleCount; t++)
+                for (uint32_t c = 0; c < 3; c++)
+                    adjacency[fill[vertexAt(t, c)]++] = t;
+        }
+
+        std::vector<int32_t> cachePositions(local.count, -1);
+        std::vector<float> vertexScores(local.count);
+        for (uint32_t v = 0; v < local.count; v++)
+            vertexScores[v] = vertexScore(-1, remaining[v]);
+
+        std::vector<float> triangleScores(triangleCount);
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        uint32_t best = 0;
+        for (uint32_t t = 0; t < triangleCount; t++)
+        {
+            triangleScores[t] = vertexScores[vertexAt(t, 0)] + vertexScores[vertexAt(t, 1)] +
+                                vertexScores[vertexAt(t, 2)];
+            if (triangleScores[t] > triangleScores[best])
+                best = t;
+        }
+
+        std::vector<uint32_t> output;
+        output.reserve(triangleCount * 3);
+        std::vector<uint32_t> cache;
+        std::vector<uint32_t> nextCache;
+        cache.reserve(kCacheSize + 3);
+        nextCache.reserve(kCacheSize + 3);
+        uint32_t scanCursor = 0;
+
+        for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+        {
+            if (best == kNone)
+            {
+                // Nothing in the cache has triangles left; continue with the next one in the original order
+                while (emitted[scanCursor])
+                    scanCursor++;
+                best = scanCursor;
+            }
+
+            const uint32_t triangle = best;
+            emitted[triangle] = 1;
+
+            nextCache.clear();
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                const uint32_t v = vertexAt(triangle, c);
+                output.push_back(v + local.first);
+                nextCache.push_back(v);
+
+                // Swap the triangle out of the vertex's remaining list
+                uint32_t *list = adjacency.data() + adjacencyOffsets[v];
+                uint32_t *it = std::find(list, list + remaining[v], triangle);
+                std::swap(*it, list[remaining[v] - 1]);
+                remaining[v]--;
+            }
+            for (uint32_t v : cache)
+            {
+                if (v != nextCache[0] && v != nextCache[1] && v != nextCache[2])
+                    nextCache.push_back(v);
+            }
+
+            // Rescore everything in the cache, including what just fell out of it, then pick the best
+            // triangle touching the cache
+            for (uint32_t i = 0; i < nextCache.size(); i++)
+            {
+                const uint32_t v = nextCache[i];
+                cachePositions[v] = i < kCacheSize ? static_cast<int32_t>(i) : -1;
+                vertexScores[v] = vertexScore(cachePositions[v], remaining[v]);
+            }
+
+            best = kNone;
+            float bestScore = -1.0f;
+            for (uint32_t v : nextCache)
+            {
+                const uint32_t *list = adjacency.data() + adjacencyOffsets[v];
+                for (uint32_t i = 0; i < remaining[v]; i++)
+                {
+                    const uint32_t t = list[i];
+                    triangleScores[t] = vertexScores[vertexAt(t, 0)] + vertexScores[vertexAt(t, 1)] +
+                                        vertexScores[vertexAt(t, 2)];
+                    if (triangleScores[t] > bestScore)
+                    {
+                        bestScore = triangleScores[t];
+                        best = t;
+                    }
+                }
+            }
+
+            if (nextCache.size() > kCacheSize)
+                nextCache.resize(kCacheSize);
+            cache.swap(nextCache);
+        }
+
+        std::copy(output.begin(), output.end(), indices);
+    }
+
+    void MeshOptimizer::optimizeOverdraw(uint32_t *indices, size_t indexCount, const std::vector<Vertex> &vertices)
+    {
+        const uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+        if (triangleCount < 2)
+            return;
+
+        // Cluster boundaries: triangles that miss the FIFO cache with all three vertices
+        const LocalVertices local(indices, triangleCount * 3);
+        std::vector<uint32_t> cacheStamps(local.count, 0);
+        uint32_t time = kFifoCacheSize + 1;
+        std::vector<uint32_t> clusterStarts;
+        for (uint32_t t = 0; t < triangleCount; t++)
+        {
+            uint32_t misses = 0;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                const uint32_t v = indices[t * 3 + c] - local.first;
+                if (time - cacheStamps[v] > kFifoCacheSize)
+                {
+                    cacheStamps[v] = time++;
+                    misses++;
+                }
+            }
+            if (t == 0 || misses == 3)
+                clusterStarts.push_back(t);
+        }
+        if (clusterStarts.size() < 2)
+            return;
+        clusterStarts.push_back(triangleCount);
+
+        // Area-weighted centroid and normal of every cluster and of the whole range
+        const uint32_t clusterCount = static_cast<uint32_t>(clusterStarts.size() - 1);
+        std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+        std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+        glm::vec3 meshCentroid(0.0f);
+        float meshArea = 0.0f;
+        for (uint32_t cluster = 0; cluster < clusterCount; cluster++)
+        {
+            float clusterArea = 0.0f;
+            for (uint32_t t = clusterStarts[cluster]; t < clusterStarts[cluster + 1]; t++)
+            {
+                const glm::vec3 &p0 = vertices[indices[t * 3 + 0]].Position;
+                const glm::vec3 &p1 = vertices[indices[t * 3 + 1]].Position;
+                const glm::vec3 &p2 = vertices[indices[t * 3 + 2]].Position;
+                const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float area = glm::length(normal);
+                clusterCentroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+                clusterNormals[cluster] += normal;
+                clusterArea += area;
+            }
+            meshCentroid += clusterCentroids[cluster];
+            meshArea += clusterArea;
+            if (clusterArea > 0.0f)
+                clusterCentroids[cluster] /= clusterArea;
+        }
+        if (meshArea <= 0.0f)
+            return;
+        meshCentroid /= meshArea;
+
+        // Clusters facing out from further away are likely to hide the others, so they draw first
+        std::vector<float> sortKeys(clusterCount, 0.0f);
+        for (uint32_t cluster = 0; cluster < clusterCount; cluster++)
+        {
+            const float length = glm::length(clusterNormals[cluster]);
+            if (length > 0.0f)
+                sortKeys[cluster] = glm::dot(clusterCentroids[cluster] - meshCentroid, clusterNormals[cluster] / length);
+        }
+
+        std::vector<uint32_t> order(clusterCount);
+        for (uint32_t i = 0; i < clusterCount; i++)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+                         { return sortKeys[a] > sortKeys[b]; });
+
+        std::vector<uint32_t> output;
+        output.reserve(triangleCount * 3);
+        for (uint32_t cluster : order)
+        {
+            output.insert(output.end(), indices + clusterStarts[cluster] * 3, indices + clusterStarts[cluster + 1] * 3);
+        }
+        std::copy(output.begin(), output.end(), indices);
+    }
+
+    void MeshOptimizer::optimizeRanges(std::vector<uint32_t> &indices, const std::vector<Vertex> &vertices,
+                                       const std::vector<SubMesh> &subMeshes, const std::vector<SubMeshLod> &lods)
+    {
+        // Submeshes that stop simplifying early repeat a level's range; each range is reordered once
+        std::set<std::pair<uint32_t, uint32_t>> unique;
+        for (const SubMesh &subMesh : subMeshes)
+            unique.emplace(subMesh.IndexOffset, subMesh.IndexCount);
+        for (const SubMeshLod &lod : lods)
+            unique.emplace(lod.IndexOffset, lod.IndexCount);
+
+        std::vector<std::pair<uint32_t, uint32_t>> ranges(unique.begin(), unique.end());
+        JobSystem::parallelFor(static_cast<uint32_t>(ranges.size()), 1, [&](uint32_t r)
+                               {
+            const auto [offset, count] = ranges[r];
+            if (static_cast<size_t>(offset) + count > indices.size())
+                return;
+            optimizeVertexCache(indices.data() + offset, count);
+            optimizeOverdraw(indices.data() + offset, count, vertices); });
+    }
+
+    void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+                                            std::vector<VertexBoneData> &boneData)
+    {
+        const bool skinned = boneData.size() == vertices.size();
+        std::vector<uint32_t> remap(vertices.size(), kNone);
+        std::vector<Vertex> reordered;
+        std::vector<VertexBoneData> reorderedBones;
+        reordered.reserve(vertices.size());
+        if (skinned)
+            reorderedBones.reserve(boneData.size());
+
+        for (uint32_t &index : indices)
+        {
+            if (remap[index] == kNone)
+            {
+                remap[index] = static_cast<uint32_t>(reordered.size());
+                reordered.push_back(vertices[index]);
+                if (skinned)
+                    reorderedBones.push_back(boneData[index]);
+            }
+            index = remap[index];
+        }
+
+        vertices = std::move(reordered);
+        if (skinned)
+            boneData = std::move(reorderedBones);
+    }
+} // namespace Fermion
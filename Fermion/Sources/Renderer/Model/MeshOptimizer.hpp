@@ -0,0 +1,36 @@
+#pragma once
+#include "Mesh.hpp"
+
+#include <vector>
+
+namespace Fermion
+{
+    // Import-time reordering for the GPU. Identical vertices are welded, every index range is reordered for the
+    // post-transform vertex cache (Forsyth's linear-speed algorithm) and then for overdraw, and the vertices are
+    // finally renumbered in the order the index buffer first reads them, so vertex fetches stay sequential.
+    //
+    // The overdraw pass follows Sander, Nehab and Barczak: the cache-ordered triangles are split only where the
+    // cache restarts anyway, and the pieces are sorted so surfaces facing away from the mesh's centre draw
+    // first. The cache efficiency of the first pass is unchanged by it.
+    class MeshOptimizer
+    {
+    public:
+        // Points the indices of each submesh at one copy of every bitwise identical vertex (bone data
+        // included). Vertices never merge across submeshes, so each submesh keeps its own block of vertices;
+        // the unused copies stay until optimizeVertexFetch drops them.
+        static void weldVertices(const std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+                                 const std::vector<VertexBoneData> &boneData, const std::vector<SubMesh> &subMeshes);
+
+        static void optimizeVertexCache(uint32_t *indices, size_t indexCount);
+        // Expects a cache-optimized triangle list
+        static void optimizeOverdraw(uint32_t *indices, size_t indexCount, const std::vector<Vertex> &vertices);
+
+        // Both passes above for every submesh and coarser level, in parallel
+        static void optimizeRanges(std::vector<uint32_t> &indices, const std::vector<Vertex> &vertices,
+                                   const std::vector<SubMesh> &subMeshes, const std::vector<SubMeshLod> &lods);
+
+        // Renumbers vertices (and their bone data) by first use and drops the ones no index reads
+        static void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+                                        std::vector<VertexBoneData> &boneData);
+    };
+} // namespace Fermion
@@ -0,0 +1,187 @@
+#include "fmpch.hpp"
+#include "MeshPacking.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+namespace Fermion
+{
+    namespace
+    {
+        constexpr uint32_t kNoSubMesh = UINT32_MAX;
+
+        // The full-detail range of every submesh, then its coarser levels
+        template <typename Fn>
+        void forEachRange(const std::vector<SubMesh> &subMeshes, const std::vector<SubMeshLod> &lods, size_t indexCount,
+                          Fn &&fn)
+        {
+            auto visit = [&](uint32_t subMesh, uint32_t offset, uint32_t count)
+            {
+                const size_t end = std::min<size_t>(static_cast<size_t>(offset) + count, indexCount);
+                for (size_t index = offset; index < end; index++)
+                    fn(subMesh, index);
+            };
+
+            for (uint32_t i = 0; i < subMeshes.size(); i++)
+                visit(i, subMeshes[i].IndexOffset, subMeshes[i].IndexCount);
+            if (subMeshes.empty())
+                return;
+            for (size_t i = 0; i < lods.size(); i++)
+                visit(static_cast<uint32_t>(i % subMeshes.size()), lods[i].IndexOffset, lods[i].IndexCount);
+        }
+
+        template <typename T>
+        void write(uint8_t *&cursor, const T &value)
+        {
+            std::memcpy(cursor, &value, sizeof(T));
+            cursor += sizeof(T);
+        }
+
+        template <typename T>
+        T read(const uint8_t *&cursor)
+        {
+            T value;
+            std::memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return value;
+        }
+    } // namespace
+
+    uint32_t PackedVertexFormat::getStride() const
+    {
+        return sizeof(glm::vec3) + sizeof(uint32_t) +
+               (unormColor ? sizeof(uint32_t) : sizeof(glm::vec4)) +
+               (halfTexCoord ? sizeof(uint32_t) : sizeof(glm::vec2));
+    }
+
+    BufferLayout MeshPacking::getVertexLayout(const PackedVertexFormat &format)
+    {
+        return {{ShaderDataType::Float3, "a_Position"},
+                {ShaderDataType::Int1010102, "a_Normal", true},
+                {format.unormColor ? ShaderDataType::UByte4 : ShaderDataType::Float4, "a_Color", format.unormColor},
+                {format.halfTexCoord ? ShaderDataType::Half2 : ShaderDataType::Float2, "a_TexCoords"}};
+    }
+
+    PackedVertexFormat MeshPacking::chooseVertexFormat(const std::vector<Vertex> &vertices)
+    {
+        PackedVertexFormat format;
+        format.unormColor = std::all_of(vertices.begin(), vertices.end(), [](const Vertex &v)
+                                        { return glm::all(glm::greaterThanEqual(v.Color, glm::vec4(0.0f))) &&
+                                                 glm::all(glm::lessThanEqual(v.Color, glm::vec4(1.0f))); });
+        format.halfTexCoord = std::all_of(vertices.begin(), vertices.end(), [](const Vertex &v)
+                                          { return glm::all(glm::lessThanEqual(glm::abs(v.TexCoord),
+                                                                               glm::vec2(MaxHalfTexCoord))); });
+        return format;
+    }
+
+    void MeshPacking::packVertices(const std::vector<Vertex> &vertices, const PackedVertexFormat &format,
+                                   std::vector<uint8_t> &out)
+    {
+        out.resize(vertices.size() * format.getStride());
+        uint8_t *cursor = out.data();
+        for (const Vertex &v : vertices)
+        {
+            write(cursor, v.Position);
+
+            const float length = glm::length(v.Normal);
+            const glm::vec3 normal = length > 0.0f ? v.Normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+            write(cursor, glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f)));
+
+            if (format.unormColor)
+                write(cursor, glm::packUnorm4x8(v.Color));
+            else
+                write(cursor, v.Color);
+
+            if (format.halfTexCoord)
+                write(cursor, glm::packHalf2x16(v.TexCoord));
+            else
+                write(cursor, v.TexCoord);
+        }
+    }
+
+    void MeshPacking::unpackVertices(const uint8_t *data, size_t vertexCount, const PackedVertexFormat &format,
+                                     std::vector<Vertex> &out)
+    {
+        out.resize(vertexCount);
+        const uint8_t *cursor = data;
+        for (Vertex &v : out)
+        {
+            v.Position = read<glm::vec3>(cursor);
+            v.Normal = glm::vec3(glm::unpackSnorm3x10_1x2(read<uint32_t>(cursor)));
+            v.Color = format.unormColor ? glm::unpackUnorm4x8(read<uint32_t>(cursor)) : read<glm::vec4>(cursor);
+            v.TexCoord = format.halfTexCoord ? glm::unpackHalf2x16(read<uint32_t>(cursor)) : read<glm::vec2>(cursor);
+        }
+    }
+
+    PackedIndexFormat MeshPacking::chooseIndexFormat(const std::vector<uint32_t> &indices,
+                                                     const std::vector<SubMesh> &subMeshes,
+                                                     const std::vector<SubMeshLod> &lods)
+    {
+        PackedIndexFormat format;
+        format.baseVertices.assign(subMeshes.size(), 0);
+
+        const uint32_t maxIndex = indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end());
+        if (maxIndex <= UINT16_MAX)
+        {
+            format.shortIndices = true;
+            return format;
+        }
+
+        // Every index has to belong to exactly one submesh for its base vertex to be unambiguous
+        std::vector<uint32_t> owners(indices.size(), kNoSubMesh);
+        std::vector<uint32_t> minVertex(subMeshes.size(), UINT32_MAX);
+        std::vector<uint32_t> maxVertex(subMeshes.size(), 0);
+        bool shared = false;
+        forEachRange(subMeshes, lods, indices.size(), [&](uint32_t subMesh, size_t index)
+                     {
+                         shared |= owners[index] != kNoSubMesh && owners[index] != subMesh;
+                         owners[index] = subMesh;
+                         minVertex[subMesh] = std::min(minVertex[subMesh], indices[index]);
+                         maxVertex[subMesh] = std::max(maxVertex[subMesh], indices[index]);
+                     });
+
+        if (shared || std::find(owners.begin(), owners.end(), kNoSubMesh) != owners.end())
+            return format;
+        for (size_t i = 0; i < subMeshes.size(); i++)
+        {
+            if (minVertex[i] != UINT32_MAX && maxVertex[i] - minVertex[i] > UINT16_MAX)
+                return format;
+        }
+
+        for (size_t i = 0; i < subMeshes.size(); i++)
+            format.baseVertices[i] = minVertex[i] == UINT32_MAX ? 0 : minVertex[i];
+        format.shortIndices = true;
+        return format;
+    }
+
+    void MeshPacking::packIndices(const std::vector<uint32_t> &indices, const std::vector<SubMesh> &subMeshes,
+                                  const std::vector<SubMeshLod> &lods, const PackedIndexFormat &format,
+                                  std::vector<uint16_t> &out)
+    {
+        out.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); i++)
+            out[i] = static_cast<uint16_t>(indices[i]);
+
+        if (std::any_of(format.baseVertices.begin(), format.baseVertices.end(), [](uint32_t base)
+                        { return base != 0; }))
+        {
+            forEachRange(subMeshes, lods, indices.size(), [&](uint32_t subMesh, size_t index)
+                         { out[index] = static_cast<uint16_t>(indices[index] - format.baseVertices[subMesh]); });
+        }
+    }
+
+    void MeshPacking::unpackIndices(const uint16_t *data, size_t indexCount, const std::vector<SubMesh> &subMeshes,
+                                    const std::vector<SubMeshLod> &lods, const PackedIndexFormat &format,
+                                    std::vector<uint32_t> &out)
+    {
+        out.assign(data, data + indexCount);
+
+        if (std::any_of(format.baseVertices.begin(), format.baseVertices.end(), [](uint32_t base)
+                        { return base != 0; }))
+        {
+            forEachRange(subMeshes, lods, indexCount, [&](uint32_t subMesh, size_t index)
+                         { out[index] = data[index] + format.baseVertices[subMesh]; });
+        }
+    }
+} // namespace Fermion
@@ -0,0 +1,52 @@
+#pragma once
+#include "Mesh.hpp"
+#include "Renderer/Buffer.hpp"
+
+#include <vector>
+
+namespace Fermion
+{
+    // How a mesh's vertices are stored on the GPU and in .fmesh files. Positions stay 32-bit floats and normals
+    // are always signed 10:10:10:2; colors and texture coordinates are packed only when every vertex fits.
+    struct PackedVertexFormat
+    {
+        bool unormColor = false;   // 8 bits per channel, otherwise four floats
+        bool halfTexCoord = false; // Half floats, otherwise two floats
+
+        uint32_t getStride() const;
+    };
+
+    // 16-bit indices are used when the mesh has at most 65536 vertices, or when every submesh together with
+    // its coarser levels spans at most that many; the indices of each range are then relative to its
+    // submesh's base vertex.
+    struct PackedIndexFormat
+    {
+        bool shortIndices = false;
+        std::vector<uint32_t> baseVertices; // One per submesh; all zero with 32-bit indices
+    };
+
+    class MeshPacking
+    {
+    public:
+        // Texture coordinates beyond this stay full floats; below it half floats are exact to 1/1024
+        static constexpr float MaxHalfTexCoord = 2.0f;
+
+        static PackedVertexFormat chooseVertexFormat(const std::vector<Vertex> &vertices);
+        // The vertex attributes of packVertices' output
+        static BufferLayout getVertexLayout(const PackedVertexFormat &format);
+        static void packVertices(const std::vector<Vertex> &vertices, const PackedVertexFormat &format,
+                                 std::vector<uint8_t> &out);
+        static void unpackVertices(const uint8_t *data, size_t vertexCount, const PackedVertexFormat &format,
+                                   std::vector<Vertex> &out);
+
+        static PackedIndexFormat chooseIndexFormat(const std::vector<uint32_t> &indices,
+                                                   const std::vector<SubMesh> &subMeshes,
+                                                   const std::vector<SubMeshLod> &lods);
+        static void packIndices(const std::vector<uint32_t> &indices, const std::vector<SubMesh> &subMeshes,
+                                const std::vector<SubMeshLod> &lods, const PackedIndexFormat &format,
+                                std::vector<uint16_t> &out);
+        static void unpackIndices(const uint16_t *data, size_t indexCount, const std::vector<SubMesh> &subMeshes,
+                                  const std::vector<SubMeshLod> &lods, const PackedIndexFormat &format,
+                                  std::vector<uint32_t> &out);
+    };
+} // namespace Fermion
@@ -1,4 +1,5 @@
 #include "MeshSerializer.hpp"
+#include "MeshPacking.hpp"
 #include <fstream>
 
 namespace Fermion
@@ -7,7 +8,7 @@ namespace Fermion
     struct MeshBinaryHeader
     {
         uint32_t magic = 0x4D455348;      // "MESH" in ASCII
-        uint32_t version = 2;             // Version 2 adds bone data support
+        uint32_t version = 5;             // Version 2 adds bone data support, 3 adds LOD ranges after it, 4 packs vertices and indices, 5 appends meshlets
         uint32_t vertexCount;
         uint32_t indexCount;
         uint32_t subMeshCount;
@@ -16,6 +17,23 @@ namespace Fermion
         uint32_t nameLength;              //暂时保留为0
     };
 
+    // Version 4: follows the header and says how the vertices and indices are packed (see MeshPacking)
+    struct MeshBinaryPacking
+    {
+        uint8_t unormColor = 0;
+        uint8_t halfTexCoord = 0;
+        uint8_t shortIndices = 0;
+        uint8_t reserved = 0;
+    };
+
+    namespace
+    {
+        bool isRangeInside(uint32_t offset, uint32_t count, uint32_t size)
+        {
+            return static_cast<uint64_t>(offset) + count <= size;
+        }
+    } // namespace
+
     bool MeshSerializer::serialize(const std::filesystem::path &filepath, const Mesh &mesh,
                                    const MeshSerializeOptions &options)
     {
@@ -35,18 +53,39 @@ namespace Fermion
         header.nameLength = 0;
 
 
+        const auto &lods = mesh.getSubMeshLods();
+        const PackedVertexFormat vertexFormat = MeshPacking::chooseVertexFormat(mesh.getVertices());
+        const PackedIndexFormat indexFormat = MeshPacking::chooseIndexFormat(mesh.getIndices(), mesh.getSubMeshes(), lods);
+
+        MeshBinaryPacking packing;
+        packing.unormColor = vertexFormat.unormColor;
+        packing.halfTexCoord = vertexFormat.halfTexCoord;
+        packing.shortIndices = indexFormat.shortIndices;
+
         file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&packing), sizeof(packing));
 
         if (header.vertexCount > 0)
         {
-            file.write(reinterpret_cast<const char*>(mesh.getVertices().data()),
-                      header.vertexCount * sizeof(Vertex));
+            std::vector<uint8_t> packedVertices;
+            MeshPacking::packVertices(mesh.getVertices(), vertexFormat, packedVertices);
+            file.write(reinterpret_cast<const char*>(packedVertices.data()), packedVertices.size());
         }
 
         if (header.indexCount > 0)
         {
-            file.write(reinterpret_cast<const char*>(mesh.getIndices().data()),
-                      header.indexCount * sizeof(uint32_t));
+            if (indexFormat.shortIndices)
+            {
+                std::vector<uint16_t> packedIndices;
+                MeshPacking::packIndices(mesh.getIndices(), mesh.getSubMeshes(), lods, indexFormat, packedIndices);
+                file.write(reinterpret_cast<const char*>(packedIndices.data()),
+                          header.indexCount * sizeof(uint16_t));
+            }
+            else
+            {
+                file.write(reinterpret_cast<const char*>(mesh.getIndices().data()),
+                          header.indexCount * sizeof(uint32_t));
+            }
         }
 
         if (header.subMeshCount > 0)
@@ -62,6 +101,30 @@ namespace Fermion
                       header.boneDataCount * sizeof(VertexBoneData));
         }
 
+        const uint32_t lodRangeCount = static_cast<uint32_t>(lods.size());
+        file.write(reinterpret_cast<const char*>(&lodRangeCount), sizeof(lodRangeCount));
+        if (lodRangeCount > 0)
+        {
+            file.write(reinterpret_cast<const char*>(lods.data()),
+                      lodRangeCount * sizeof(SubMeshLod));
+        }
+
+        // Needed to turn the 16-bit indices back into mesh vertex indices
+        if (indexFormat.shortIndices && header.subMeshCount > 0)
+        {
+            file.write(reinterpret_cast<const char*>(indexFormat.baseVertices.data()),
+                      header.subMeshCount * sizeof(uint32_t));
+        }
+
+        const auto &meshlets = mesh.getMeshlets();
+        const uint32_t meshletCount = static_cast<uint32_t>(meshlets.size());
+        file.write(reinterpret_cast<const char*>(&meshletCount), sizeof(meshletCount));
+        if (meshletCount > 0)
+        {
+            file.write(reinterpret_cast<const char*>(meshlets.data()),
+                      meshletCount * sizeof(Meshlet));
+        }
+
         file.close();
 
         return true;
@@ -81,34 +144,74 @@ namespace Fermion
             return nullptr;
         }
 
+        // Ranges and indices from the file feed GPU draws directly, so a truncated or corrupt file is rejected
+        // rather than loaded partially
+        auto fail = [&](const char *reason) -> std::shared_ptr<Mesh>
+        {
+            Log::Error(std::format("MeshSerializer: Rejecting {}: {}", filepath.string(), reason));
+            return nullptr;
+        };
+
         MeshBinaryHeader header;
         file.read(reinterpret_cast<char*>(&header), sizeof(header));
 
-        if (header.magic != 0x4D455348)
+        if (!file || header.magic != 0x4D455348)
         {
             return nullptr;
         }
 
-        // Support both version 1 and 2
-        if (header.version != 1 && header.version != 2)
+        if (header.version < 1 || header.version > 5)
         {
             return nullptr;
         }
 
+        MeshBinaryPacking packing;
+        if (header.version >= 4)
+        {
+            file.read(reinterpret_cast<char*>(&packing), sizeof(packing));
+            if (!file)
+                return fail("truncated header");
+        }
+
+        PackedVertexFormat vertexFormat;
+        vertexFormat.unormColor = packing.unormColor != 0;
+        vertexFormat.halfTexCoord = packing.halfTexCoord != 0;
+
         std::vector<Vertex> vertices(header.vertexCount);
-        if (header.vertexCount > 0)
+        if (header.vertexCount > 0 && header.version >= 4)
+        {
+            std::vector<uint8_t> packedVertices(static_cast<size_t>(header.vertexCount) * vertexFormat.getStride());
+            file.read(reinterpret_cast<char*>(packedVertices.data()), packedVertices.size());
+            MeshPacking::unpackVertices(packedVertices.data(), header.vertexCount, vertexFormat, vertices);
+        }
+        else if (header.vertexCount > 0)
         {
             file.read(reinterpret_cast<char*>(vertices.data()),
                      header.vertexCount * sizeof(Vertex));
         }
+        if (!file)
+            return fail("truncated vertices");
 
-        std::vector<uint32_t> indices(header.indexCount);
-        if (header.indexCount > 0)
+        // 16-bit indices are unpacked once the ranges and base vertices they are relative to have been read
+        std::vector<uint32_t> indices;
+        std::vector<uint16_t> packedIndices;
+        if (packing.shortIndices)
         {
-            file.read(reinterpret_cast<char*>(indices.data()),
-                     header.indexCount * sizeof(uint32_t));
+            packedIndices.resize(header.indexCount);
+            file.read(reinterpret_cast<char*>(packedIndices.data()),
+                     header.indexCount * sizeof(uint16_t));
         }
-
+        else
+        {
+            indices.resize(header.indexCount);
+            if (header.indexCount > 0)
+            {
+                file.read(reinterpret_cast<char*>(indices.data()),
+                         header.indexCount * sizeof(uint32_t));
+            }
+        }
+        if (!file)
+            return fail("truncated indices");
 
         std::vector<SubMesh> subMeshes(header.subMeshCount);
         if (header.subMeshCount > 0)
@@ -116,6 +219,13 @@ namespace Fermion
             file.read(reinterpret_cast<char*>(subMeshes.data()),
                      header.subMeshCount * sizeof(SubMesh));
         }
+        if (!file)
+            return fail("truncated submeshes");
+        for (const SubMesh &subMesh : subMeshes)
+        {
+            if (!isRangeInside(subMesh.IndexOffset, subMesh.IndexCount, header.indexCount))
+                return fail("submesh range outside the index buffer");
+        }
 
         // Read bone data if version 2 and has bone data
         std::vector<VertexBoneData> boneData;
@@ -124,13 +234,79 @@ namespace Fermion
             boneData.resize(header.boneDataCount);
             file.read(reinterpret_cast<char*>(boneData.data()),
                      header.boneDataCount * sizeof(VertexBoneData));
+            if (!file)
+                return fail("truncated bone data");
+        }
+
+        std::vector<SubMeshLod> lods;
+        if (header.version >= 3)
+        {
+            uint32_t lodRangeCount = 0;
+            file.read(reinterpret_cast<char*>(&lodRangeCount), sizeof(lodRangeCount));
+            lods.resize(lodRangeCount);
+            if (lodRangeCount > 0)
+            {
+                file.read(reinterpret_cast<char*>(lods.data()),
+                         lodRangeCount * sizeof(SubMeshLod));
+            }
+            if (!file)
+                return fail("truncated LOD ranges");
+            if (!lods.empty() && (subMeshes.empty() || lods.size() % subMeshes.size() != 0))
+                return fail("LOD range count doesn't match the submeshes");
+            for (const SubMeshLod &lod : lods)
+            {
+                if (!isRangeInside(lod.IndexOffset, lod.IndexCount, header.indexCount))
+                    return fail("LOD range outside the index buffer");
+            }
+        }
+
+        if (packing.shortIndices)
+        {
+            PackedIndexFormat indexFormat;
+            indexFormat.shortIndices = true;
+            indexFormat.baseVertices.resize(header.subMeshCount);
+            if (header.subMeshCount > 0)
+            {
+                file.read(reinterpret_cast<char*>(indexFormat.baseVertices.data()),
+                         header.subMeshCount * sizeof(uint32_t));
+            }
+            if (!file)
+                return fail("truncated base vertices");
+            MeshPacking::unpackIndices(packedIndices.data(), packedIndices.size(), subMeshes, lods, indexFormat,
+                                       indices);
+        }
+        for (uint32_t index : indices)
+        {
+            if (index >= header.vertexCount)
+                return fail("index outside the vertex buffer");
+        }
+
+        std::vector<Meshlet> meshlets;
+        if (header.version >= 5)
+        {
+            uint32_t meshletCount = 0;
+            file.read(reinterpret_cast<char*>(&meshletCount), sizeof(meshletCount));
+            meshlets.resize(meshletCount);
+            if (meshletCount > 0)
+            {
+                file.read(reinterpret_cast<char*>(meshlets.data()),
+                         meshletCount * sizeof(Meshlet));
+            }
+            if (!file)
+                return fail("truncated meshlets");
+            for (const Meshlet &meshlet : meshlets)
+            {
+                if (!isRangeInside(meshlet.IndexOffset, meshlet.IndexCount, header.indexCount))
+                    return fail("meshlet range outside the index buffer");
+            }
         }
 
         file.close();
 
         auto mesh = std::make_shared<Mesh>(std::move(vertices),
                                            std::move(indices),
-                                           std::move(subMeshes));
+                                           std::move(subMeshes),
+                                           std::move(lods));
         mesh->handle = handle;
 
         // Set bone data if present
@@ -138,6 +314,10 @@ namespace Fermion
         {
             mesh->setBoneData(std::move(boneData));
         }
+        if (!meshlets.empty())
+        {
+            mesh->setMeshlets(std::move(meshlets));
+        }
 
 
         return mesh;
@@ -0,0 +1,431 @@
+#include "fmpch.hpp"
+#include "MeshSimplifier.hpp"
+#include "Core/JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+namespace Fermion
+{
+    namespace
+    {
+        // Weight of a collapse's normal and UV change, relative to the size of the mesh
+        constexpr float kAttributeWeight = 0.05f;
+        // Each pass collapses at most one edge per vertex neighbourhood
+        constexpr uint32_t kMaxPasses = 64;
+
+        // Sum of squared distances to a set of planes, weighted by triangle area
+        struct Quadric
+        {
+            double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+            double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+            double c = 0.0;
+            double weight = 0.0;
+
+            static Quadric fromPlane(const glm::dvec3 &n, double d, double w)
+            {
+                Quadric q;
+                q.a00 = n.x * n.x * w;
+                q.a01 = n.x * n.y * w;
+                q.a02 = n.x * n.z * w;
+                q.a11 = n.y * n.y * w;
+                q.a12 = n.y * n.z * w;
+                q.a22 = n.z * n.z * w;
+                q.b0 = n.x * d * w;
+                q.b1 = n.y * d * w;
+                q.b2 = n.z * d * w;
+                q.c = d * d * w;
+                q.weight = w;
+                return q;
+            }
+
+            void add(const Quadric &other)
+            {
+                a00 += other.a00;
+                a01 += other.a01;
+                a02 += other.a02;
+                a11 += other.a11;
+                a12 += other.a12;
+                a22 += other.a22;
+                b0 += other.b0;
+                b1 += other.b1;
+                b2 += other.b2;
+                c += other.c;
+                weight += other.weight;
+            }
+
+            // Mean squared distance of p to the planes
+            double error(const glm::vec3 &p) const
+            {
+                if (weight <= 0.0)
+                    return 0.0;
+                const double x = p.x, y = p.y, z = p.z;
+                const double e = a00 * x * x + a11 * y * y + a22 * z * z +
+                                 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                                 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+                return std::max(e, 0.0) / weight;
+            }
+        };
+
+        struct Collapse
+        {
+            uint32_t from; // Unlocked, so it is its own only wedge
+            uint32_t to;   // The wedge of the target position 'from' takes over
+            float cost;
+            float error;
+        };
+
+        bool positionLess(const glm::vec3 &a, const glm::vec3 &b)
+        {
+            if (a.x != b.x)
+                return a.x < b.x;
+            if (a.y != b.y)
+                return a.y < b.y;
+            return a.z < b.z;
+        }
+    } // namespace
+
+    float MeshSimplifier::simplify(const std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+                                   size_t targetIndexCount)
+    {
+        targetIndexCount -= targetIndexCount % 3;
+        if (indices.size() < 3 || indices.size() <= targetIndexCount)
+            return 0.0f;
+
+        // Work on local ids of the vertices this index list uses
+        std::vector<uint32_t> used(indices);
+        std::sort(used.begin(), used.end());
+        used.erase(std::unique(used.begin(), used.end()), used.end());
+        const uint32_t vertexCount = static_cast<uint32_t>(used.size());
+
+        std::vector<uint32_t> triangles(indices.size());
+        for (size_t i = 0; i < indices.size(); ++i)
+            triangles[i] = static_cast<uint32_t>(std::lower_bound(used.begin(), used.end(), indices[i]) - used.begin());
+
+        auto vertex = [&](uint32_t local) -> const Vertex &
+        { return vertices[used[local]]; };
+
+        // Vertices at the same position are wedges of one canonical vertex; wedges form a circular list.
+        // Copies whose attributes match too (unwelded input) are folded into one wedge, so only real seams
+        // end up with more than one
+        std::vector<uint32_t> order(vertexCount);
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+                  {
+            if (vertex(a).Position != vertex(b).Position)
+                return positionLess(vertex(a).Position, vertex(b).Position);
+            return a < b; });
+
+        std::vector<uint32_t> canonical(vertexCount);
+        std::vector<uint32_t> wedgeCount(vertexCount, 0);
+        std::vector<uint32_t> nextWedge(vertexCount);
+        std::vector<uint32_t> alias(vertexCount);
+        std::vector<uint32_t> wedges;
+        for (uint32_t i = 0; i < vertexCount;)
+        {
+            uint32_t end = i + 1;
+            while (end < vertexCount && vertex(order[end]).Position == vertex(order[i]).Position)
+                ++end;
+
+            wedges.clear();
+            for (uint32_t k = i; k < end; ++k)
+            {
+                const uint32_t v = order[k];
+                auto same = std::find_if(wedges.begin(), wedges.end(), [&](uint32_t w)
+                                         { return std::memcmp(&vertex(w), &vertex(v), sizeof(Vertex)) == 0; });
+                alias[v] = same != wedges.end() ? *same : v;
+                if (same == wedges.end())
+                    wedges.push_back(v);
+                canonical[v] = order[i];
+            }
+            for (size_t k = 0; k < wedges.size(); ++k)
+                nextWedge[wedges[k]] = wedges[(k + 1) % wedges.size()];
+            wedgeCount[order[i]] = static_cast<uint32_t>(wedges.size());
+            i = end;
+        }
+        for (uint32_t &local : triangles)
+            local = alias[local];
+
+        // Plane quadrics, and the edges used by exactly one triangle (open borders) or by more than two
+        std::vector<Quadric> quadrics(vertexCount);
+        std::unordered_map<uint64_t, uint32_t> edgeUses;
+        edgeUses.reserve(triangles.size());
+        glm::vec3 boundsMin(FLT_MAX);
+        glm::vec3 boundsMax(-FLT_MAX);
+        for (size_t t = 0; t < triangles.size(); t += 3)
+        {
+            const uint32_t c[3] = {canonical[triangles[t]], canonical[triangles[t + 1]], canonical[triangles[t + 2]]};
+            const glm::dvec3 p0 = vertex(c[0]).Position;
+            const glm::dvec3 p1 = vertex(c[1]).Position;
+            const glm::dvec3 p2 = vertex(c[2]).Position;
+            glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+            const double doubleArea = glm::length(normal);
+            if (doubleArea > 0.0)
+            {
+                normal /= doubleArea;
+                const Quadric q = Quadric::fromPlane(normal, -glm::dot(normal, p0), doubleArea * 0.5);
+                for (uint32_t corner : c)
+                    quadrics[corner].add(q);
+            }
+
+            for (int e = 0; e < 3; ++e)
+            {
+                const uint64_t a = std::min(c[e], c[(e + 1) % 3]);
+                const uint64_t b = std::max(c[e], c[(e + 1) % 3]);
+                ++edgeUses[(a << 32) | b];
+            }
+            for (uint32_t corner : c)
+            {
+                boundsMin = glm::min(boundsMin, vertex(corner).Position);
+                boundsMax = glm::max(boundsMax, vertex(corner).Position);
+            }
+        }
+
+        std::vector<uint8_t> locked(vertexCount, 0);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            if (wedgeCount[v] > 1)
+                locked[v] = 1;
+        }
+        for (const auto &[edge, uses] : edgeUses)
+        {
+            if (uses != 2)
+            {
+                locked[static_cast<uint32_t>(edge >> 32)] = 1;
+                locked[static_cast<uint32_t>(edge & 0xffffffffu)] = 1;
+            }
+        }
+
+        const float attributeScale = kAttributeWeight * glm::length(boundsMax - boundsMin);
+        const float attributeWeight = attributeScale * attributeScale;
+
+        std::vector<Collapse> collapses;
+        std::vector<uint32_t> adjacencyOffsets;
+        std::vector<uint32_t> adjacency;
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<uint8_t> touched(vertexCount);
+        float maxError = 0.0f;
+
+        for (uint32_t pass = 0; pass < kMaxPasses && triangles.size() > targetIndexCount; ++pass)
+        {
+            // Triangles around each canonical vertex
+            adjacencyOffsets.assign(vertexCount + 1, 0);
+            for (uint32_t local : triangles)
+                ++adjacencyOffsets[canonical[local] + 1];
+            std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+            adjacency.resize(triangles.size());
+            {
+                std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for (uint32_t i = 0; i < triangles.size(); ++i)
+                    adjacency[cursor[canonical[triangles[i]]]++] = i / 3;
+            }
+
+            collapses.clear();
+            auto addCandidate = [&](uint32_t from, uint32_t to)
+            {
+                if (locked[from] || from == to)
+                    return;
+
+                // Take over the wedge of the target whose attributes are closest
+                const Vertex &source = vertex(from);
+                uint32_t wedge = to;
+                float attributeError = FLT_MAX;
+                uint32_t w = to;
+                do
+                {
+                    const glm::vec3 dn = vertex(w).Normal - source.Normal;
+                    const glm::vec2 duv = vertex(w).TexCoord - source.TexCoord;
+                    const float e = 0.25f * glm::dot(dn, dn) + glm::dot(duv, duv);
+                    if (e < attributeError)
+                    {
+                        attributeError = e;
+                        wedge = w;
+                    }
+                    w = nextWedge[w];
+                } while (w != to);
+
+                Quadric q = quadrics[from];
+                q.add(quadrics[to]);
+                const float error = static_cast<float>(q.error(vertex(to).Position));
+                collapses.push_back({from, wedge, error + attributeWeight * attributeError, std::sqrt(error)});
+            };
+            for (size_t t = 0; t < triangles.size(); t += 3)
+            {
+                for (int e = 0; e < 3; ++e)
+                {
+                    const uint32_t a = canonical[triangles[t + e]];
+                    const uint32_t b = canonical[triangles[t + (e + 1) % 3]];
+                    addCandidate(a, b);
+                    addCandidate(b, a);
+                }
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b)
+                      {
+                if (a.from != b.from)
+                    return a.from < b.from;
+                return a.to < b.to; });
+            collapses.erase(std::unique(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b)
+                                        { return a.from == b.from && a.to == b.to; }),
+                            collapses.end());
+            std::stable_sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b)
+                             { return a.cost < b.cost; });
+
+            std::iota(remap.begin(), remap.end(), 0u);
+            std::fill(touched.begin(), touched.end(), 0);
+            size_t triangleCount = triangles.size() / 3;
+            const size_t targetTriangles = targetIndexCount / 3;
+            bool collapsed = false;
+
+            for (const Collapse &collapse : collapses)
+            {
+                if (triangleCount <= targetTriangles)
+                    break;
+                const uint32_t target = canonical[collapse.to];
+                if (touched[collapse.from] || touched[target])
+                    continue;
+
+                // Triangles along the edge disappear; the others must not flip or turn by more than 60 degrees
+                const glm::vec3 &targetPosition = vertex(target).Position;
+                uint32_t removed = 0;
+                bool flips = false;
+                for (uint32_t i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1] && !flips; ++i)
+                {
+                    const uint32_t *corners = &triangles[adjacency[i] * 3];
+                    glm::vec3 p[3];
+                    bool hasTarget = false;
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        p[k] = vertex(corners[k]).Position;
+                        hasTarget |= canonical[corners[k]] == target;
+                    }
+                    if (hasTarget)
+                    {
+                        ++removed;
+                        continue;
+                    }
+
+                    const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        if (canonical[corners[k]] == collapse.from)
+                            p[k] = targetPosition;
+                    }
+                    const glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    flips = glm::dot(before, after) <= 0.5f * glm::length(before) * glm::length(after);
+                }
+                if (flips)
+                    continue;
+
+                // Nothing around this edge moves again in this pass, so the flip test above stays valid
+                for (uint32_t i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1]; ++i)
+                {
+                    const uint32_t *corners = &triangles[adjacency[i] * 3];
+                    for (int k = 0; k < 3; ++k)
+                        touched[canonical[corners[k]]] = 1;
+                }
+                touched[target] = 1;
+
+                remap[collapse.from] = collapse.to;
+                quadrics[target].add(quadrics[collapse.from]);
+                maxError = std::max(maxError, collapse.error);
+                triangleCount -= removed;
+                collapsed = true;
+            }
+
+            if (!collapsed)
+                break;
+
+            size_t write = 0;
+            for (size_t t = 0; t < triangles.size(); t += 3)
+            {
+                const uint32_t v0 = remap[triangles[t]];
+                const uint32_t v1 = remap[triangles[t + 1]];
+                const uint32_t v2 = remap[triangles[t + 2]];
+                if (canonical[v0] == canonical[v1] || canonical[v1] == canonical[v2] || canonical[v0] == canonical[v2])
+                    continue;
+                triangles[write++] = v0;
+                triangles[write++] = v1;
+                triangles[write++] = v2;
+            }
+            triangles.resize(write);
+        }
+
+        indices.resize(triangles.size());
+        for (size_t i = 0; i < triangles.size(); ++i)
+            indices[i] = used[triangles[i]];
+        return maxError;
+    }
+
+    std::vector<SubMeshLod> MeshSimplifier::generateLods(const std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+                                                         const std::vector<SubMesh> &subMeshes,
+                                                         const MeshLodSettings &settings)
+    {
+        if (subMeshes.empty() || settings.maxLodCount < 2)
+            return {};
+
+        const uint32_t subMeshCount = static_cast<uint32_t>(subMeshes.size());
+        const float reduction = std::clamp(settings.reductionPerLod, 0.1f, 0.9f);
+
+        // Each level is simplified from the one before it; errors add up along the chain
+        struct Chain
+        {
+            std::vector<std::vector<uint32_t>> levels;
+            std::vector<float> errors;
+        };
+        std::vector<Chain> chains(subMeshCount);
+        JobSystem::parallelFor(subMeshCount, 1, [&](uint32_t s)
+                               {
+            const SubMesh &subMesh = subMeshes[s];
+            std::vector<uint32_t> current(indices.begin() + subMesh.IndexOffset,
+                                          indices.begin() + subMesh.IndexOffset + subMesh.IndexCount);
+            float error = 0.0f;
+            for (uint32_t level = 1; level < settings.maxLodCount; ++level)
+            {
+                if (current.size() / 3 <= settings.minTriangles)
+                    break;
+
+                std::vector<uint32_t> next = current;
+                error += simplify(vertices, next, static_cast<size_t>(current.size() * reduction));
+                // Not worth another draw range if it barely got simpler
+                if (next.size() * 10 > current.size() * 9)
+                    break;
+
+                chains[s].levels.push_back(next);
+                chains[s].errors.push_back(error);
+                current = std::move(next);
+            } });
+
+        size_t levelCount = 0;
+        for (const Chain &chain : chains)
+            levelCount = std::max(levelCount, chain.levels.size());
+
+        std::vector<SubMeshLod> lods(levelCount * subMeshCount);
+        for (size_t level = 0; level < levelCount; ++level)
+        {
+            for (uint32_t s = 0; s < subMeshCount; ++s)
+            {
+                const Chain &chain = chains[s];
+                SubMeshLod &lod = lods[level * subMeshCount + s];
+                if (level < chain.levels.size())
+                {
+                    lod = {static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(chain.levels[level].size()),
+                           chain.errors[level]};
+                    indices.insert(indices.end(), chain.levels[level].begin(), chain.levels[level].end());
+                }
+                else if (level > 0)
+                {
+                    lod = lods[(level - 1) * subMeshCount + s];
+                }
+                else
+                {
+                    lod = {subMeshes[s].IndexOffset, subMeshes[s].IndexCount, 0.0f};
+                }
+            }
+        }
+        return lods;
+    }
+} // namespace Fermion
@@ -0,0 +1,34 @@
+#pragma once
+#include "Mesh.hpp"
+
+#include <vector>
+
+namespace Fermion
+{
+    struct MeshLodSettings
+    {
+        uint32_t maxLodCount = 4;     // Including the full-detail level
+        float reductionPerLod = 0.5f; // Index count of each level relative to the one before it
+        uint32_t minTriangles = 32;   // A submesh stops getting coarser below this
+    };
+
+    // Import-time simplification with the quadric error metric. Edges collapse into one of their endpoints, so
+    // every level reuses the mesh's vertices and only adds indices. Vertices on open borders and on attribute
+    // seams (copies at one position whose UVs, normals or colors differ) never move, and the normal and UV change
+    // of a collapse adds to its cost, so silhouettes and texture layout survive the coarser levels. Copies with
+    // identical attributes are treated as one vertex, so the input does not have to be welded first.
+    class MeshSimplifier
+    {
+    public:
+        // Collapses edges of the triangle list until at most targetIndexCount indices remain or nothing else can
+        // collapse; returns the largest deviation introduced, in mesh units
+        static float simplify(const std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+                              size_t targetIndexCount);
+
+        // Appends the coarser levels of every submesh to 'indices' and returns their ranges for
+        // Mesh::setSubMeshLods. Submeshes that stop simplifying early repeat their last level.
+        static std::vector<SubMeshLod> generateLods(const std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+                                                    const std::vector<SubMesh> &subMeshes,
+                                                    const MeshLodSettings &settings = {});
+    };
+} // namespace Fermion
@@ -0,0 +1,138 @@
+#include "fmpch.hpp"
+#include "MeshletBuilder.hpp"
+#include "Core/JobSystem.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Fermion
+{
+    namespace
+    {
+        // A triangle turned further than about 75 degrees from the meshlet's average normal starts a new one
+        constexpr float kMinNormalDot = 0.25f;
+        // Cones wider than this (cosine of the half angle) can't reject anything useful and are disabled
+        constexpr float kMinConeDot = 0.1f;
+
+        glm::vec3 triangleNormal(const std::vector<Vertex> &vertices, const uint32_t *triangle)
+        {
+            const glm::vec3 &p0 = vertices[triangle[0]].Position;
+            const glm::vec3 &p1 = vertices[triangle[1]].Position;
+            const glm::vec3 &p2 = vertices[triangle[2]].Position;
+            const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            const float length = glm::length(normal);
+            return length > 0.0f ? normal / length : glm::vec3(0.0f);
+        }
+    } // namespace
+
+    std::vector<Meshlet> MeshletBuilder::build(const std::vector<Vertex> &vertices,
+                                               const std::vector<uint32_t> &indices,
+                                               const std::vector<SubMesh> &subMeshes)
+    {
+        std::vector<std::vector<Meshlet>> perSubMesh(subMeshes.size());
+        JobSystem::parallelFor(static_cast<uint32_t>(subMeshes.size()), 1, [&](uint32_t s)
+                               {
+            const SubMesh &subMesh = subMeshes[s];
+            if (static_cast<size_t>(subMesh.IndexOffset) + subMesh.IndexCount > indices.size())
+                return;
+
+            std::vector<Meshlet> &meshlets = perSubMesh[s];
+            uint32_t meshletVertices[MaxVertices];
+            uint32_t vertexCount = 0;
+            glm::vec3 normalSum(0.0f);
+            Meshlet current;
+            current.IndexOffset = subMesh.IndexOffset;
+
+            auto finish = [&](uint32_t end)
+            {
+                current.IndexCount = end - current.IndexOffset;
+                if (current.IndexCount > 0)
+                {
+                    computeBounds(vertices, indices, current);
+                    meshlets.push_back(current);
+                }
+                current = {};
+                current.IndexOffset = end;
+                vertexCount = 0;
+                normalSum = glm::vec3(0.0f);
+            };
+
+            const uint32_t end = subMesh.IndexOffset + subMesh.IndexCount / 3 * 3;
+            for (uint32_t i = subMesh.IndexOffset; i < end; i += 3)
+            {
+                const uint32_t *triangle = indices.data() + i;
+                uint32_t newVertices = 0;
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    if (std::find(meshletVertices, meshletVertices + vertexCount, triangle[c]) ==
+                        meshletVertices + vertexCount)
+                        newVertices++;
+                }
+
+                const glm::vec3 normal = triangleNormal(vertices, triangle);
+                const float normalSumLength = glm::length(normalSum);
+                const bool turnsAway = normalSumLength > 0.0f && normal != glm::vec3(0.0f) &&
+                                       glm::dot(normal, normalSum / normalSumLength) < kMinNormalDot;
+                const uint32_t triangleCount = (i - current.IndexOffset) / 3;
+                if (triangleCount > 0 &&
+                    (vertexCount + newVertices > MaxVertices || triangleCount >= MaxTriangles || turnsAway))
+                    finish(i);
+
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    if (std::find(meshletVertices, meshletVertices + vertexCount, triangle[c]) ==
+                        meshletVertices + vertexCount)
+                        meshletVertices[vertexCount++] = triangle[c];
+                }
+                normalSum += normal;
+            }
+            finish(end); });
+
+        std::vector<Meshlet> meshlets;
+        for (auto &subMeshMeshlets : perSubMesh)
+            meshlets.insert(meshlets.end(), subMeshMeshlets.begin(), subMeshMeshlets.end());
+        std::sort(meshlets.begin(), meshlets.end(), [](const Meshlet &a, const Meshlet &b)
+                  { return a.IndexOffset < b.IndexOffset; });
+        return meshlets;
+    }
+
+    void MeshletBuilder::computeBounds(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+                                       Meshlet &meshlet)
+    {
+        const uint32_t begin = meshlet.IndexOffset;
+        const uint32_t end = meshlet.IndexOffset + meshlet.IndexCount;
+
+        glm::vec3 min(FLT_MAX);
+        glm::vec3 max(-FLT_MAX);
+        for (uint32_t i = begin; i < end; i++)
+        {
+            min = glm::min(min, vertices[indices[i]].Position);
+            max = glm::max(max, vertices[indices[i]].Position);
+        }
+        meshlet.Center = (min + max) * 0.5f;
+        meshlet.Radius = 0.0f;
+        for (uint32_t i = begin; i < end; i++)
+            meshlet.Radius = std::max(meshlet.Radius, glm::length(vertices[indices[i]].Position - meshlet.Center));
+
+        // The cone has to hold every triangle's normal; the backface test then needs the sine of its half angle
+        glm::vec3 axis(0.0f);
+        for (uint32_t i = begin; i + 3 <= end; i += 3)
+            axis += triangleNormal(vertices, indices.data() + i);
+        const float axisLength = glm::length(axis);
+        meshlet.ConeAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+        meshlet.ConeCutoff = 1.0f;
+        if (axisLength <= 0.0f)
+            return;
+
+        float minDot = 1.0f;
+        for (uint32_t i = begin; i + 3 <= end; i += 3)
+        {
+            const glm::vec3 normal = triangleNormal(vertices, indices.data() + i);
+            if (glm::length(normal) > 0.0f)
+                minDot = std::min(minDot, glm::dot(normal, meshlet.ConeAxis));
+        }
+        if (minDot > kMinConeDot)
+            meshlet.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+} // namespace Fermion
@@ -0,0 +1,26 @@
+#pragma once
+#include "Mesh.hpp"
+
+#include <vector>
+
+namespace Fermion
+{
+    // Import-time clustering for MeshletCuller. Each submesh's full-detail range is cut into runs of
+    // consecutive triangles. A run ends when it would exceed MaxVertices unique vertices or MaxTriangles
+    // triangles, or when a triangle faces too far from the run's average normal for the cone test to ever
+    // reject it. The index order is kept, so the cache and overdraw order that MeshOptimizer produced survives.
+    class MeshletBuilder
+    {
+    public:
+        static constexpr uint32_t MaxVertices = 64;
+        static constexpr uint32_t MaxTriangles = 124;
+
+        // Sorted by index offset, ready for Mesh::setMeshlets
+        static std::vector<Meshlet> build(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+                                          const std::vector<SubMesh> &subMeshes);
+
+        // Bounding sphere and normal cone of indices[IndexOffset, IndexOffset + IndexCount)
+        static void computeBounds(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+                                  Meshlet &meshlet);
+    };
+} // namespace Fermion
@@ -0,0 +1,361 @@
+#include "fmpch.hpp"
+#include "Renderer/OcclusionCuller.hpp"
+#include "Renderer/Model/Mesh.hpp"
+#include "Core/JobSystem.hpp"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FM_OCCLUSION_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace Fermion
+{
+    namespace
+    {
+        // Points closer than this to the eye plane are treated as crossing the near plane
+        constexpr float kMinClipW = 1e-4f;
+        // Triangles per setup job
+        constexpr uint32_t kSetupGrain = 1024;
+
+        uint32_t getMipCount()
+        {
+            uint32_t count = 1;
+            while ((OcclusionCuller::Width >> count) > 0 && (OcclusionCuller::Height >> count) > 0)
+                ++count;
+            return count;
+        }
+    } // namespace
+
+    void OcclusionCuller::begin(const glm::mat4 &viewProjection)
+    {
+        m_viewProjection = viewProjection;
+        m_candidates.clear();
+        m_selected.clear();
+        m_rasterized = false;
+        m_statistics = {};
+
+        if (m_depthMips.empty())
+        {
+            m_depthMips.resize(getMipCount());
+            for (uint32_t level = 0; level < m_depthMips.size(); ++level)
+                m_depthMips[level].assign((Width >> level) * (Height >> level), 1.0f);
+            m_tileBins.resize(TilesX * TilesY);
+        }
+    }
+
+    void OcclusionCuller::addOccluder(const std::shared_ptr<Mesh> &mesh, const glm::mat4 &transform, bool flagged)
+    {
+        if (!mesh || mesh->isSkinned() || mesh->getBaseIndexCount() < 3)
+            return;
+
+        const ScreenRect rect = projectBounds(AABB::TransformAABB(mesh->getBoundingBox(), transform));
+        float screenFraction = 1.0f;
+        if (!rect.crossesNearPlane)
+        {
+            const glm::vec2 min = glm::clamp(glm::vec2(rect.min), glm::vec2(-1.0f), glm::vec2(1.0f));
+            const glm::vec2 max = glm::clamp(glm::vec2(rect.max), glm::vec2(-1.0f), glm::vec2(1.0f));
+            screenFraction = (max.x - min.x) * (max.y - min.y) * 0.25f;
+        }
+
+        m_candidates.push_back({mesh, transform, screenFraction,
+                                mesh->getBaseIndexCount() / 3, flagged});
+    }
+
+    bool OcclusionCuller::isOccluded(const AABB &worldBounds)
+    {
+        if (!m_rasterized)
+            rasterize();
+
+        ++m_statistics.tested;
+        if (m_selected.empty())
+            return false;
+
+        // Boxes reaching behind the eye or out of the view are left to the frustum test
+        const ScreenRect rect = projectBounds(worldBounds);
+        if (rect.crossesNearPlane || rect.min.z > 1.0f ||
+            rect.max.x < -1.0f || rect.min.x > 1.0f || rect.max.y < -1.0f || rect.min.y > 1.0f)
+            return false;
+
+        auto toPixel = [](float ndc, uint32_t size)
+        {
+            const float pixel = std::floor((ndc * 0.5f + 0.5f) * static_cast<float>(size));
+            return static_cast<uint32_t>(std::clamp(pixel, 0.0f, static_cast<float>(size - 1)));
+        };
+        const uint32_t x0 = toPixel(rect.min.x, Width);
+        const uint32_t x1 = toPixel(rect.max.x, Width);
+        const uint32_t y0 = toPixel(rect.min.y, Height);
+        const uint32_t y1 = toPixel(rect.max.y, Height);
+
+        // Coarsest level where the box spans at most a few texels
+        const uint32_t extent = std::max(x1 - x0, y1 - y0);
+        uint32_t level = 0;
+        while (level + 1 < m_depthMips.size() && (extent >> level) > 2)
+            ++level;
+
+        const std::vector<float> &mip = m_depthMips[level];
+        const uint32_t mipWidth = Width >> level;
+        float maxDepth = 0.0f;
+        for (uint32_t y = y0 >> level; y <= (y1 >> level); ++y)
+        {
+            for (uint32_t x = x0 >> level; x <= (x1 >> level); ++x)
+                maxDepth = std::max(maxDepth, mip[y * mipWidth + x]);
+        }
+
+        if (rect.min.z <= maxDepth)
+            return false;
+        ++m_statistics.culled;
+        return true;
+    }
+
+    OcclusionCuller::ScreenRect OcclusionCuller::projectBounds(const AABB &worldBounds) const
+    {
+        ScreenRect rect{glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX), false};
+        for (int c = 0; c < 8; ++c)
+        {
+            const glm::vec3 corner((c & 1) ? worldBounds.max.x : worldBounds.min.x,
+                                   (c & 2) ? worldBounds.max.y : worldBounds.min.y,
+                                   (c & 4) ? worldBounds.max.z : worldBounds.min.z);
+            const glm::vec4 clip = m_viewProjection * glm::vec4(corner, 1.0f);
+            if (clip.w < kMinClipW)
+            {
+                rect.crossesNearPlane = true;
+                return rect;
+            }
+            const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            rect.min = glm::min(rect.min, ndc);
+            rect.max = glm::max(rect.max, ndc);
+        }
+        return rect;
+    }
+
+    void OcclusionCuller::selectOccluders()
+    {
+        std::vector<uint32_t> order(m_candidates.size());
+        for (uint32_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        // Flagged first, then the largest on screen; stable so ties keep submission order
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+                         {
+            const Occluder &lhs = m_candidates[a];
+            const Occluder &rhs = m_candidates[b];
+            if (lhs.flagged != rhs.flagged)
+                return lhs.flagged;
+            return lhs.screenFraction > rhs.screenFraction; });
+
+        m_triangleOffsets.clear();
+        uint32_t triangles = 0;
+        for (uint32_t index : order)
+        {
+            const Occluder &occluder = m_candidates[index];
+            if (!occluder.flagged)
+            {
+                if (occluder.screenFraction < MinOccluderScreenFraction ||
+                    occluder.triangleCount > MaxAutoOccluderTriangles ||
+                    triangles + occluder.triangleCount > TriangleBudget)
+                    continue;
+            }
+            m_selected.push_back(index);
+            m_triangleOffsets.push_back(triangles);
+            triangles += occluder.triangleCount;
+        }
+        m_triangleOffsets.push_back(triangles);
+    }
+
+    void OcclusionCuller::rasterize()
+    {
+        m_rasterized = true;
+        selectOccluders();
+
+        const uint32_t triangleCount = m_triangleOffsets.back();
+        m_statistics.occluders = static_cast<uint32_t>(m_selected.size());
+        m_statistics.occluderTriangles = triangleCount;
+
+        std::fill(m_depthMips[0].begin(), m_depthMips[0].end(), 1.0f);
+        if (m_selected.empty())
+            return;
+
+        m_triangles.resize(triangleCount);
+        JobSystem::parallelForRange(triangleCount, kSetupGrain, [this](uint32_t begin, uint32_t end)
+                                    { setupTriangles(begin, end); });
+
+        for (auto &bin : m_tileBins)
+            bin.clear();
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            const ScreenTriangle &triangle = m_triangles[i];
+            if (!triangle.valid)
+                continue;
+            for (int ty = triangle.minY / static_cast<int>(TileHeight); ty <= triangle.maxY / static_cast<int>(TileHeight); ++ty)
+            {
+                for (int tx = triangle.minX / static_cast<int>(TileWidth); tx <= triangle.maxX / static_cast<int>(TileWidth); ++tx)
+                    m_tileBins[ty * TilesX + tx].push_back(i);
+            }
+        }
+
+        JobSystem::parallelFor(TilesX * TilesY, 1, [this](uint32_t tile)
+                               { rasterizeTile(tile); });
+        buildDepthPyramid();
+    }
+
+    void OcclusionCuller::setupTriangles(uint32_t begin, uint32_t end)
+    {
+        uint32_t occluder = static_cast<uint32_t>(
+            std::upper_bound(m_triangleOffsets.begin(), m_triangleOffsets.end(), begin) - m_triangleOffsets.begin() - 1);
+        const Occluder *current = nullptr;
+        glm::mat4 modelViewProjection{1.0f};
+
+        for (uint32_t t = begin; t < end; ++t)
+        {
+            while (t >= m_triangleOffsets[occluder + 1])
+                ++occluder;
+            const Occluder &source = m_candidates[m_selected[occluder]];
+            if (current != &source)
+            {
+                current = &source;
+                modelViewProjection = m_viewProjection * source.transform;
+            }
+
+            ScreenTriangle &triangle = m_triangles[t];
+            triangle.valid = false;
+
+            const auto &vertices = source.mesh->getVertices();
+            const auto &indices = source.mesh->getIndices();
+            const uint32_t first = (t - m_triangleOffsets[occluder]) * 3;
+
+            bool clipped = false;
+            for (int v = 0; v < 3; ++v)
+            {
+                const glm::vec4 clip = modelViewProjection * glm::vec4(vertices[indices[first + v]].Position, 1.0f);
+                // Occluders only need to be conservative, so triangles crossing the near plane are skipped
+                // rather than clipped
+                if (clip.w < kMinClipW)
+                {
+                    clipped = true;
+                    break;
+                }
+                const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+                triangle.v[v] = {(ndc.x * 0.5f + 0.5f) * Width, (ndc.y * 0.5f + 0.5f) * Height, ndc.z};
+            }
+            if (clipped)
+                continue;
+
+            const glm::vec3 &a = triangle.v[0];
+            const glm::vec3 &b = triangle.v[1];
+            const glm::vec3 &c = triangle.v[2];
+            const float area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+            if (std::abs(area) < 1e-6f || (a.z > 1.0f && b.z > 1.0f && c.z > 1.0f))
+                continue;
+            // Both windings occlude; make every triangle counter-clockwise so inside is where all edges are >= 0
+            if (area < 0.0f)
+                std::swap(triangle.v[1], triangle.v[2]);
+
+            // Pixels whose centers fall inside the triangle's bounds
+            const glm::vec2 min = glm::min(glm::min(glm::vec2(a), glm::vec2(b)), glm::vec2(c));
+            const glm::vec2 max = glm::max(glm::max(glm::vec2(a), glm::vec2(b)), glm::vec2(c));
+            triangle.minX = std::max(static_cast<int>(std::ceil(min.x - 0.5f)), 0);
+            triangle.minY = std::max(static_cast<int>(std::ceil(min.y - 0.5f)), 0);
+            triangle.maxX = std::min(static_cast<int>(std::floor(max.x - 0.5f)), static_cast<int>(Width) - 1);
+            triangle.maxY = std::min(static_cast<int>(std::floor(max.y - 0.5f)), static_cast<int>(Height) - 1);
+            triangle.valid = triangle.minX <= triangle.maxX && triangle.minY <= triangle.maxY;
+        }
+    }
+
+    void OcclusionCuller::rasterizeTile(uint32_t tile)
+    {
+        const int tileMinX = static_cast<int>((tile % TilesX) * TileWidth);
+        const int tileMinY = static_cast<int>((tile / TilesX) * TileHeight);
+        const int tileMaxX = tileMinX + static_cast<int>(TileWidth) - 1;
+        const int tileMaxY = tileMinY + static_cast<int>(TileHeight) - 1;
+        float *depth = m_depthMips[0].data();
+
+        for (uint32_t index : m_tileBins[tile])
+        {
+            const ScreenTriangle &triangle = m_triangles[index];
+            const glm::vec3 &v0 = triangle.v[0];
+            const glm::vec3 &v1 = triangle.v[1];
+            const glm::vec3 &v2 = triangle.v[2];
+
+            // Edge functions e(x, y) = A * x + B * y + C for the edges opposite v0, v1 and v2
+            const float edgeA[3] = {v1.y - v2.y, v2.y - v0.y, v0.y - v1.y};
+            const float edgeB[3] = {v2.x - v1.x, v0.x - v2.x, v1.x - v0.x};
+            const float edgeC[3] = {v1.x * v2.y - v1.y * v2.x, v2.x * v0.y - v2.y * v0.x, v0.x * v1.y - v0.y * v1.x};
+
+            // NDC depth is affine in screen space
+            const float area = edgeC[0] + edgeC[1] + edgeC[2];
+            const float dzdx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+            const float dzdy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+
+            // Whole four-pixel blocks; the tile's own edges are multiples of four
+            const int minX = std::max(triangle.minX, tileMinX) & ~3;
+            const int maxX = std::min(triangle.maxX, tileMaxX);
+            const int minY = std::max(triangle.minY, tileMinY);
+            const int maxY = std::min(triangle.maxY, tileMaxY);
+
+            for (int y = minY; y <= maxY; ++y)
+            {
+                const float centerY = static_cast<float>(y) + 0.5f;
+                const float rowEdge[3] = {edgeB[0] * centerY + edgeC[0], edgeB[1] * centerY + edgeC[1],
+                                          edgeB[2] * centerY + edgeC[2]};
+                const float rowDepth = v0.z + dzdy * (centerY - v0.y) - dzdx * v0.x;
+                float *row = depth + y * Width;
+
+#ifdef FM_OCCLUSION_SSE2
+                const __m128 lane = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+                const __m128 zero = _mm_setzero_ps();
+                for (int x = minX; x <= maxX; x += 4)
+                {
+                    const __m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane);
+                    const __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[0]), centerX), _mm_set1_ps(rowEdge[0]));
+                    const __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[1]), centerX), _mm_set1_ps(rowEdge[1]));
+                    const __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[2]), centerX), _mm_set1_ps(rowEdge[2]));
+                    const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                                                     _mm_cmpge_ps(e2, zero));
+                    if (_mm_movemask_ps(inside) == 0)
+                        continue;
+
+                    const __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), centerX), _mm_set1_ps(rowDepth));
+                    const __m128 previous = _mm_loadu_ps(row + x);
+                    const __m128 nearest = _mm_min_ps(previous, z);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+                }
+#else
+                for (int x = minX; x <= maxX; x += 4)
+                {
+                    for (int lane = 0; lane < 4; ++lane)
+                    {
+                        const float centerX = static_cast<float>(x + lane) + 0.5f;
+                        if (edgeA[0] * centerX + rowEdge[0] < 0.0f || edgeA[1] * centerX + rowEdge[1] < 0.0f ||
+                            edgeA[2] * centerX + rowEdge[2] < 0.0f)
+                            continue;
+                        row[x + lane] = std::min(row[x + lane], dzdx * centerX + rowDepth);
+                    }
+                }
+#endif
+            }
+        }
+    }
+
+    void OcclusionCuller::buildDepthPyramid()
+    {
+        for (uint32_t level = 1; level < m_depthMips.size(); ++level)
+        {
+            const std::vector<float> &source = m_depthMips[level - 1];
+            std::vector<float> &target = m_depthMips[level];
+            const uint32_t sourceWidth = Width >> (level - 1);
+            const uint32_t width = Width >> level;
+            const uint32_t height = Height >> level;
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                const float *row0 = source.data() + (y * 2) * sourceWidth;
+                const float *row1 = row0 + sourceWidth;
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    target[y * width + x] = std::max(std::max(row0[x * 2], row0[x * 2 + 1]),
+                                                     std::max(row1[x * 2], row1[x * 2 + 1]));
+                }
+            }
+        }
+    }
+} // namespace Fermion
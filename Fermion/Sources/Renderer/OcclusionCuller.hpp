@@ -0,0 +1,101 @@
+#pragma once
+#include "Math/AABB.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Fermion
+{
+    class Mesh;
+
+    // Software occlusion culling. A few large occluder meshes are rasterized into a Width x Height CPU depth
+    // buffer, one JobSystem job per screen tile and four pixels per step (SSE2 where available, scalar
+    // otherwise); a max-depth pyramid built from it then answers whether a world-space box is certainly hidden.
+    //
+    // Flagged occluders are always rasterized; the other candidates compete by projected size for the triangle
+    // budget. Everything runs on the CPU and needs no GL context, so the same input always gives the same
+    // visibility and statistics.
+    class OcclusionCuller
+    {
+    public:
+        static constexpr uint32_t Width = 256;
+        static constexpr uint32_t Height = 128;
+        static constexpr uint32_t TileWidth = 64;
+        static constexpr uint32_t TileHeight = 32;
+        static constexpr uint32_t TilesX = Width / TileWidth;
+        static constexpr uint32_t TilesY = Height / TileHeight;
+
+        // Auto-selected occluders must be at least this fraction of the screen and at most this many triangles;
+        // all occluders together stop at the triangle budget, which only flagged occluders may exceed
+        static constexpr float MinOccluderScreenFraction = 0.02f;
+        static constexpr uint32_t MaxAutoOccluderTriangles = 8192;
+        static constexpr uint32_t TriangleBudget = 65536;
+
+        struct Statistics
+        {
+            uint32_t occluders = 0;
+            uint32_t occluderTriangles = 0;
+            uint32_t tested = 0;
+            uint32_t culled = 0;
+        };
+
+        // Drops the previous frame's occluders and depth buffer
+        void begin(const glm::mat4 &viewProjection);
+        // Skinned meshes are ignored; their bind pose says little about where the vertices are
+        void addOccluder(const std::shared_ptr<Mesh> &mesh, const glm::mat4 &transform, bool flagged);
+
+        // The first query after begin() selects and rasterizes the occluders
+        bool isOccluded(const AABB &worldBounds);
+
+        const Statistics &getStatistics() const { return m_statistics; }
+        // Row-major from the bottom-left, NDC depth; valid after the first query
+        const std::vector<float> &getDepthBuffer() const { return m_depthMips.front(); }
+
+    private:
+        struct Occluder
+        {
+            std::shared_ptr<Mesh> mesh;
+            glm::mat4 transform;
+            float screenFraction;
+            uint32_t triangleCount;
+            bool flagged;
+        };
+
+        // Screen-space triangle, counter-clockwise; x and y in pixels, z in NDC
+        struct ScreenTriangle
+        {
+            glm::vec3 v[3];
+            int minX, minY, maxX, maxY;
+            bool valid;
+        };
+
+        struct ScreenRect
+        {
+            glm::vec3 min;
+            glm::vec3 max;
+            bool crossesNearPlane;
+        };
+
+        ScreenRect projectBounds(const AABB &worldBounds) const;
+        void selectOccluders();
+        void rasterize();
+        void setupTriangles(uint32_t begin, uint32_t end);
+        void rasterizeTile(uint32_t tile);
+        void buildDepthPyramid();
+
+        glm::mat4 m_viewProjection{1.0f};
+        std::vector<Occluder> m_candidates;
+        std::vector<uint32_t> m_selected;
+        // Triangles before each selected occluder, plus the total at the end
+        std::vector<uint32_t> m_triangleOffsets;
+        std::vector<ScreenTriangle> m_triangles;
+        std::vector<std::vector<uint32_t>> m_tileBins;
+
+        // Level 0 is the depth buffer; every level above holds the farthest depth of its 2x2 texels
+        std::vector<std::vector<float>> m_depthMips;
+        bool m_rasterized = false;
+        Statistics m_statistics{};
+    };
+} // namespace Fermion
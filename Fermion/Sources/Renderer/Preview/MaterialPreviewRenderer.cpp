@@ -218,10 +218,16 @@ namespace Fermion
         shader->setFloat("u_LightIntensity", settings.lightIntensity);
         shader->setFloat("u_AmbientIntensity", settings.ambientIntensity);
 
-        material->bind(shader);
+        material->bind(shader.get());
 
-        vertexArray->bind();
-        Renderer::getRendererAPI().drawIndexed(vertexArray);
+        // The sphere may share its geometry page with other meshes, so only its own ranges are drawn
+        const auto &subMeshes = m_sphereMesh->getSubMeshes();
+        for (size_t i = 0; i < subMeshes.size(); i++)
+        {
+            Renderer::getRendererAPI().drawIndexed(*vertexArray, subMeshes[i].IndexCount,
+                                                   m_sphereMesh->getFirstIndex() + subMeshes[i].IndexOffset,
+                                                   m_sphereMesh->getSubMeshBaseVertex(i));
+        }
 
         m_framebuffer->resolve();
 
@@ -1,79 +1,218 @@
+#include "fmpch.hpp"
 #include "Renderer/RenderCommandQueue.hpp"
 #include "Renderer/RendererAPI.hpp"
 #include "Renderer/Pipeline.hpp"
 #include "Renderer/Framebuffer.hpp"
 #include "Renderer/VertexArray.hpp"
+#include "Renderer/UniformBuffer.hpp"
+#include "Renderer/UniformRingBuffer.hpp"
+#include "Renderer/Model/Material.hpp"
+
+#include <cstring>
 
 namespace Fermion {
 
-namespace {
-    // 命令执行器 - 使用 overloaded 模式实现 visitor
-    template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
-    template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
+void* RenderCommandQueue::CommandBuffer::allocate(size_t size, size_t alignment) {
+    FERMION_ASSERT(alignment <= alignof(std::max_align_t), "Render command alignment exceeds the arena's");
+
+    while (m_BlockIndex < m_Blocks.size()) {
+        Block& block = m_Blocks[m_BlockIndex];
+        size_t offset = (m_BlockOffset + alignment - 1) & ~(alignment - 1);
+        if (offset + size <= block.size) {
+            m_BlockOffset = offset + size;
+            return block.memory.get() + offset;
+        }
+        ++m_BlockIndex;
+        m_BlockOffset = 0;
+    }
+
+    // Only reached while warming up, or for a payload larger than anything seen before
+    Block block;
+    block.size = std::max(size, BlockSize);
+    block.memory.reset(new std::byte[block.size]);
+    m_Blocks.push_back(std::move(block));
+    m_BlockIndex = m_Blocks.size() - 1;
+    m_BlockOffset = size;
+    return m_Blocks.back().memory.get();
+}
+
+void RenderCommandQueue::CommandBuffer::reset() {
+    for (const CommandRecord& record : records) {
+        if (record.type != RenderCmdType::Custom)
+            continue;
+        const auto* custom = static_cast<const CustomCommand*>(record.payload);
+        if (custom->destroy)
+            custom->destroy(custom->callable);
+    }
+    records.clear();
+    m_BlockIndex = 0;
+    m_BlockOffset = 0;
+}
+
+void RenderCommandQueue::submitUniformData(UniformBuffer* buffer, const void* data, uint32_t size, uint32_t offset) {
+    // Both paths below write exactly [offset, offset + size) of the block; never let that run past its end
+    const uint32_t blockSize = buffer->getSize();
+    FERMION_ASSERT(static_cast<uint64_t>(offset) + size <= blockSize, "Uniform update runs past the end of its buffer");
+    if (offset >= blockSize)
+        return;
+    size = std::min(size, blockSize - offset);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    // The whole block is bound, so the range covers the buffer's size rather than just the update
+    if (m_UniformRing) {
+        uint32_t ringOffset = 0;
+        if (auto* block = static_cast<std::byte*>(m_UniformRing->allocate(blockSize, ringOffset))) {
+            std::memcpy(block + offset, data, size);
+            record(CmdBindUniformRange{m_UniformRing, buffer->getBindingPoint(), ringOffset, blockSize});
+            return;
+        }
+    }
+
+    void* copy = m_Buffers[m_RecordingIndex].allocate(size, alignof(std::max_align_t));
+    std::memcpy(copy, data, size);
+    record(CmdUpdateUniformBuffer{buffer, copy, size, offset});
+    if (m_UniformRing)
+        record(CmdBindUniformBuffer{buffer});
+}
+
+void RenderCommandQueue::submitDrawIndexedIndirect(const VertexArray* vao, const DrawIndexedIndirectCommand* commands,
+                                                   uint32_t drawCount) {
+    if (drawCount == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto* copy = static_cast<DrawIndexedIndirectCommand*>(m_Buffers[m_RecordingIndex].allocate(
+        drawCount * sizeof(DrawIndexedIndirectCommand), alignof(DrawIndexedIndirectCommand)));
+    std::memcpy(copy, commands, drawCount * sizeof(DrawIndexedIndirectCommand));
+    record(CmdDrawIndexedIndirect{vao, copy, drawCount});
 }
 
 void RenderCommandQueue::flush(RendererAPI& api) {
-    // 复制命令列表以便释放锁
-    std::vector<RenderCmd> commands;
+    // 切换录制缓冲区以便释放锁
+    CommandBuffer* commands;
     {
         std::lock_guard<std::mutex> lock(m_Mutex);
-        commands = std::move(m_Commands);
-        m_Commands.clear();
+        commands = &m_Buffers[m_RecordingIndex];
+        m_RecordingIndex ^= 1;
     }
 
+    // Materials bind the variant of this pipeline's shader that matches their keywords
+    Pipeline* boundPipeline = nullptr;
+
     // 执行所有命令
-    for (auto& cmd : commands) {
-        std::visit(overloaded{
-            [&api](const CmdSetViewport& c) {
-                api.setViewport(c.x, c.y, c.width, c.height);
-            },
-            [&api](const CmdSetClearColor& c) {
-                api.setClearColor(c.color);
-            },
-            [&api](const CmdClear&) {
-                api.clear();
-            },
-            [&api](const CmdSetBlendEnabled& c) {
-                api.setBlendEnabled(c.enabled);
-            },
-            [&api](const CmdSetLineWidth& c) {
-                api.setLineWidth(c.width);
-            },
-            [](const CmdBindPipeline& c) {
-                if (c.pipeline)
-                    c.pipeline->bind();
-            },
-            [](const CmdBindFramebuffer& c) {
-                if (c.framebuffer)
-                    c.framebuffer->bind();
-            },
-            [](const CmdUnbindFramebuffer& c) {
-                if (c.framebuffer)
-                    c.framebuffer->unbind();
-            },
-            [&api](const CmdDrawIndexed& c) {
-                if (c.vao)
-                    api.drawIndexed(c.vao, c.indexCount, c.indexOffset);
-            },
-            [&api](const CmdDrawIndexedInstanced& c) {
-                if (c.vao)
-                    api.drawIndexedInstanced(c.vao, c.indexCount, c.instanceCount);
-            },
-            [&api](const CmdDrawLines& c) {
-                if (c.vao)
-                    api.drawLines(c.vao, c.vertexCount);
-            },
-            [](const CmdCustom& c) {
-                if (c.execute)
-                    c.execute();
+    for (const CommandRecord& record : commands->records) {
+        const void* payload = record.payload;
+        switch (record.type) {
+        case RenderCmdType::SetViewport: {
+            const auto& c = *static_cast<const CmdSetViewport*>(payload);
+            api.setViewport(c.x, c.y, c.width, c.height);
+            break;
+        }
+        case RenderCmdType::SetClearColor:
+            api.setClearColor(static_cast<const CmdSetClearColor*>(payload)->color);
+            break;
+        case RenderCmdType::Clear:
+            api.clear();
+            break;
+        case RenderCmdType::SetBlendEnabled:
+            api.setBlendEnabled(static_cast<const CmdSetBlendEnabled*>(payload)->enabled);
+            break;
+        case RenderCmdType::SetLineWidth:
+            api.setLineWidth(static_cast<const CmdSetLineWidth*>(payload)->width);
+            break;
+        case RenderCmdType::BindPipeline:
+            if (Pipeline* pipeline = static_cast<const CmdBindPipeline*>(payload)->pipeline)
+            {
+                pipeline->bind();
+                boundPipeline = pipeline;
             }
-        }, cmd);
+            break;
+        case RenderCmdType::BindFramebuffer:
+            if (Framebuffer* framebuffer = static_cast<const CmdBindFramebuffer*>(payload)->framebuffer)
+                framebuffer->bind();
+            break;
+        case RenderCmdType::BindFramebufferLayer: {
+            const auto& c = *static_cast<const CmdBindFramebufferLayer*>(payload);
+            if (c.framebuffer)
+                c.framebuffer->bindLayer(c.layer);
+            break;
+        }
+        case RenderCmdType::UnbindFramebuffer:
+            if (Framebuffer* framebuffer = static_cast<const CmdUnbindFramebuffer*>(payload)->framebuffer)
+                framebuffer->unbind();
+            break;
+        case RenderCmdType::UpdateUniformBuffer: {
+            const auto& c = *static_cast<const CmdUpdateUniformBuffer*>(payload);
+            if (c.buffer)
+                c.buffer->setData(c.data, c.size, c.offset);
+            break;
+        }
+        case RenderCmdType::BindUniformBuffer:
+            if (const UniformBuffer* buffer = static_cast<const CmdBindUniformBuffer*>(payload)->buffer)
+                buffer->bind();
+            break;
+        case RenderCmdType::BindUniformRange: {
+            const auto& c = *static_cast<const CmdBindUniformRange*>(payload);
+            if (c.ring)
+                c.ring->bindRange(c.bindingPoint, c.offset, c.size);
+            break;
+        }
+        case RenderCmdType::BindMaterial:
+            if (const Material* material = static_cast<const CmdBindMaterial*>(payload)->material)
+                material->bind(boundPipeline ? boundPipeline->getShader().get() : nullptr);
+            break;
+        case RenderCmdType::BindDepthAttachment: {
+            const auto& c = *static_cast<const CmdBindDepthAttachment*>(payload);
+            if (c.framebuffer)
+                c.framebuffer->bindDepthAttachment(c.slot);
+            break;
+        }
+        case RenderCmdType::CopyDepthLayer: {
+            const auto& c = *static_cast<const CmdCopyDepthLayer*>(payload);
+            if (c.source && c.target)
+                c.source->copyDepthLayerTo(*c.target, c.sourceLayer, c.targetLayer);
+            break;
+        }
+        case RenderCmdType::DrawIndexed: {
+            const auto& c = *static_cast<const CmdDrawIndexed*>(payload);
+            if (c.vao)
+                api.drawIndexed(*c.vao, c.indexCount, c.indexOffset, c.baseVertex);
+            break;
+        }
+        case RenderCmdType::DrawIndexedInstanced: {
+            const auto& c = *static_cast<const CmdDrawIndexedInstanced*>(payload);
+            if (c.vao)
+                api.drawIndexedInstanced(*c.vao, c.indexCount, c.instanceCount, c.indexOffset, c.baseVertex);
+            break;
+        }
+        case RenderCmdType::DrawIndexedIndirect: {
+            const auto& c = *static_cast<const CmdDrawIndexedIndirect*>(payload);
+            if (c.vao)
+                api.drawIndexedIndirect(*c.vao, c.commands, c.drawCount);
+            break;
+        }
+        case RenderCmdType::DrawLines: {
+            const auto& c = *static_cast<const CmdDrawLines*>(payload);
+            if (c.vao)
+                api.drawLines(*c.vao, c.vertexCount);
+            break;
+        }
+        case RenderCmdType::Custom: {
+            const auto& c = *static_cast<const CustomCommand*>(payload);
+            c.invoke(c.callable);
+            break;
+        }
+        }
     }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    commands->reset();
 }
 
 void RenderCommandQueue::clear() {
     std::lock_guard<std::mutex> lock(m_Mutex);
-    m_Commands.clear();
+    m_Buffers[m_RecordingIndex].reset();
 }
 
 } // namespace Fermion
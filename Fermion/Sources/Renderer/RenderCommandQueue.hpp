@@ -1,26 +1,61 @@
 #pragma once
 #include "Renderer/RenderCommands.hpp"
-#include <vector>
+#include <cstddef>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
 
 namespace Fermion {
 
 class RendererAPI;
 
+// Commands are recorded into a linear arena and replayed with a switch on their type. The arena's blocks
+// and the record list keep their capacity, so a warmed-up queue records a frame without allocating.
+// Recording and replay use separate buffers: commands submitted while a flush is running land in the
+// next flush.
 class RenderCommandQueue {
 public:
+    RenderCommandQueue() = default;
+    RenderCommandQueue(const RenderCommandQueue&) = delete;
+    RenderCommandQueue& operator=(const RenderCommandQueue&) = delete;
+
     // 提交单个命令
     template<typename T>
     void submit(T&& cmd) {
         std::lock_guard<std::mutex> lock(m_Mutex);
-        m_Commands.emplace_back(std::forward<T>(cmd));
+        record(std::forward<T>(cmd));
     }
 
     // 批量提交命令
     template<typename... Args>
     void submitBatch(Args&&... cmds) {
         std::lock_guard<std::mutex> lock(m_Mutex);
-        (m_Commands.emplace_back(std::forward<Args>(cmds)), ...);
+        (record(std::forward<Args>(cmds)), ...);
+    }
+
+    // Stores the callable itself in the arena; it is invoked and destroyed during flush
+    template<typename F>
+    void submitCustom(F&& function) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        recordCustom(std::forward<F>(function));
+    }
+
+    // With a uniform ring set, writes the data straight into a fresh block of the ring and binds that
+    // range in place of the buffer; bytes of the block outside [offset, offset + size) are undefined.
+    // Otherwise, or when the ring is full, copies the data into the arena and uploads it to the buffer
+    // when the queue is flushed.
+    void submitUniformData(UniformBuffer* buffer, const void* data, uint32_t size, uint32_t offset = 0);
+
+    // Copies the draw commands into the arena and records one indirect draw over them
+    void submitDrawIndexedIndirect(const VertexArray* vao, const DrawIndexedIndirectCommand* commands,
+                                   uint32_t drawCount);
+
+    // The ring must be between beginFrame() and endFrame() while commands are recorded and flushed
+    void setUniformRing(UniformRingBuffer* ring) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_UniformRing = ring;
     }
 
     // 执行所有命令
@@ -31,16 +66,89 @@ public:
 
     bool empty() const {
         std::lock_guard<std::mutex> lock(m_Mutex);
-        return m_Commands.empty();
+        return m_Buffers[m_RecordingIndex].records.empty();
     }
 
     size_t size() const {
         std::lock_guard<std::mutex> lock(m_Mutex);
-        return m_Commands.size();
+        return m_Buffers[m_RecordingIndex].records.size();
     }
 
 private:
-    std::vector<RenderCmd> m_Commands;
+    struct CommandRecord {
+        RenderCmdType type;
+        void* payload;
+    };
+
+    struct CustomCommand {
+        void (*invoke)(void*);
+        void (*destroy)(void*);
+        void* callable;
+    };
+
+    class CommandBuffer {
+    public:
+        CommandBuffer() = default;
+        CommandBuffer(const CommandBuffer&) = delete;
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+        ~CommandBuffer() { reset(); }
+
+        void* allocate(size_t size, size_t alignment);
+        // Destroys pending custom commands and rewinds the arena, keeping its blocks
+        void reset();
+
+        std::vector<CommandRecord> records;
+
+    private:
+        static constexpr size_t BlockSize = 64 * 1024;
+
+        struct Block {
+            std::unique_ptr<std::byte[]> memory;
+            size_t size = 0;
+        };
+
+        std::vector<Block> m_Blocks;
+        size_t m_BlockIndex = 0;
+        size_t m_BlockOffset = 0;
+    };
+
+    template<typename T>
+    void record(T&& cmd) {
+        using Command = std::decay_t<T>;
+        if constexpr (std::is_same_v<Command, CmdCustom>) {
+            if (cmd.execute)
+                recordCustom(std::forward<T>(cmd).execute);
+        } else {
+            static_assert(std::is_trivially_copyable_v<Command> && std::is_trivially_destructible_v<Command>,
+                          "Render commands other than CmdCustom must be trivially copyable");
+            CommandBuffer& buffer = m_Buffers[m_RecordingIndex];
+            void* payload = buffer.allocate(sizeof(Command), alignof(Command));
+            new (payload) Command(std::forward<T>(cmd));
+            buffer.records.push_back({Command::Type, payload});
+        }
+    }
+
+    template<typename F>
+    void recordCustom(F&& function) {
+        using Callable = std::decay_t<F>;
+        CommandBuffer& buffer = m_Buffers[m_RecordingIndex];
+
+        void* storage = buffer.allocate(sizeof(Callable), alignof(Callable));
+        Callable* callable = new (storage) Callable(std::forward<F>(function));
+
+        auto* custom = static_cast<CustomCommand*>(buffer.allocate(sizeof(CustomCommand), alignof(CustomCommand)));
+        custom->invoke = [](void* p) { (*static_cast<Callable*>(p))(); };
+        custom->destroy = nullptr;
+        if constexpr (!std::is_trivially_destructible_v<Callable>)
+            custom->destroy = [](void* p) { static_cast<Callable*>(p)->~Callable(); };
+        custom->callable = callable;
+
+        buffer.records.push_back({RenderCmdType::Custom, custom});
+    }
+
+    CommandBuffer m_Buffers[2];
+    uint32_t m_RecordingIndex = 0;
+    UniformRingBuffer* m_UniformRing = nullptr;
     mutable std::mutex m_Mutex;
 };
 
@@ -1,6 +1,5 @@
 #pragma once
 #include <cstdint>
-#include <variant>
 #include <memory>
 #include <functional>
 #include <glm/glm.hpp>
@@ -10,82 +9,199 @@ namespace Fermion {
 class Pipeline;
 class Framebuffer;
 class VertexArray;
+class UniformBuffer;
+class UniformRingBuffer;
+class Material;
+struct DrawIndexedIndirectCommand;
+
+// 命令类型 - 回放时按类型 switch 分发
+
+enum class RenderCmdType : uint8_t {
+    SetViewport,
+    SetClearColor,
+    Clear,
+    SetBlendEnabled,
+    SetLineWidth,
+    BindPipeline,
+    BindFramebuffer,
+    BindFramebufferLayer,
+    UnbindFramebuffer,
+    UpdateUniformBuffer,
+    BindUniformBuffer,
+    BindUniformRange,
+    BindMaterial,
+    BindDepthAttachment,
+    CopyDepthLayer,
+    DrawIndexed,
+    DrawIndexedInstanced,
+    DrawIndexedIndirect,
+    DrawLines,
+    Custom
+};
+
+// Every command except CmdCustom is trivially copyable: it is copied into the queue's arena and
+// never destroyed. Pointers are non-owning and must stay valid until the queue is flushed.
 
 // 状态命令
 
 struct CmdSetViewport {
+    static constexpr RenderCmdType Type = RenderCmdType::SetViewport;
     uint32_t x, y, width, height;
 };
 
 struct CmdSetClearColor {
+    static constexpr RenderCmdType Type = RenderCmdType::SetClearColor;
     glm::vec4 color;
 };
 
-struct CmdClear {};
+struct CmdClear {
+    static constexpr RenderCmdType Type = RenderCmdType::Clear;
+};
 
 struct CmdSetBlendEnabled {
+    static constexpr RenderCmdType Type = RenderCmdType::SetBlendEnabled;
     bool enabled;
 };
 
 struct CmdSetLineWidth {
+    static constexpr RenderCmdType Type = RenderCmdType::SetLineWidth;
     float width;
 };
 
 
 // 绑定命令
 struct CmdBindPipeline {
-    std::shared_ptr<Pipeline> pipeline;
+    static constexpr RenderCmdType Type = RenderCmdType::BindPipeline;
+    Pipeline* pipeline;
+
+    CmdBindPipeline(Pipeline* pipeline) : pipeline(pipeline) {}
+    CmdBindPipeline(const std::shared_ptr<Pipeline>& pipeline) : pipeline(pipeline.get()) {}
 };
 
 struct CmdBindFramebuffer {
-    std::shared_ptr<Framebuffer> framebuffer;
+    static constexpr RenderCmdType Type = RenderCmdType::BindFramebuffer;
+    Framebuffer* framebuffer;
+
+    CmdBindFramebuffer(Framebuffer* framebuffer) : framebuffer(framebuffer) {}
+    CmdBindFramebuffer(const std::shared_ptr<Framebuffer>& framebuffer) : framebuffer(framebuffer.get()) {}
+};
+
+// Binds the framebuffer rendering into one layer of its layered depth attachment
+struct CmdBindFramebufferLayer {
+    static constexpr RenderCmdType Type = RenderCmdType::BindFramebufferLayer;
+    Framebuffer* framebuffer;
+    uint32_t layer;
 };
 
 struct CmdUnbindFramebuffer {
-    std::shared_ptr<Framebuffer> framebuffer;
+    static constexpr RenderCmdType Type = RenderCmdType::UnbindFramebuffer;
+    Framebuffer* framebuffer;
+
+    CmdUnbindFramebuffer(Framebuffer* framebuffer) : framebuffer(framebuffer) {}
+    CmdUnbindFramebuffer(const std::shared_ptr<Framebuffer>& framebuffer) : framebuffer(framebuffer.get()) {}
+};
+
+// Uploads a byte range into a uniform buffer. Use RenderCommandQueue::submitUniformData to copy
+// transient data (per-draw model matrices) into the queue instead of pointing at it.
+struct CmdUpdateUniformBuffer {
+    static constexpr RenderCmdType Type = RenderCmdType::UpdateUniformBuffer;
+    UniformBuffer* buffer;
+    const void* data;
+    uint32_t size;
+    uint32_t offset = 0;
+};
+
+// Points the buffer's binding point back at the buffer itself, after ranges of a ring were bound there
+struct CmdBindUniformBuffer {
+    static constexpr RenderCmdType Type = RenderCmdType::BindUniformBuffer;
+    const UniformBuffer* buffer;
+};
+
+// Binds a range of a uniform ring buffer; the data was written when the command was recorded
+struct CmdBindUniformRange {
+    static constexpr RenderCmdType Type = RenderCmdType::BindUniformRange;
+    const UniformRingBuffer* ring;
+    uint32_t bindingPoint;
+    uint32_t offset;
+    uint32_t size;
+};
+
+// Binds the material's parameter block and texture set
+struct CmdBindMaterial {
+    static constexpr RenderCmdType Type = RenderCmdType::BindMaterial;
+    const Material* material;
+};
+
+struct CmdBindDepthAttachment {
+    static constexpr RenderCmdType Type = RenderCmdType::BindDepthAttachment;
+    const Framebuffer* framebuffer;
+    uint32_t slot;
+};
+
+// Copies one depth layer between two layered framebuffers of the same size and format
+struct CmdCopyDepthLayer {
+    static constexpr RenderCmdType Type = RenderCmdType::CopyDepthLayer;
+    const Framebuffer* source;
+    const Framebuffer* target;
+    uint32_t sourceLayer;
+    uint32_t targetLayer;
 };
 
 // 绘制命令
 
 struct CmdDrawIndexed {
-    std::shared_ptr<VertexArray> vao;
+    static constexpr RenderCmdType Type = RenderCmdType::DrawIndexed;
+    const VertexArray* vao;
     uint32_t indexCount;
     uint32_t indexOffset = 0;
+    int32_t baseVertex = 0;
+
+    CmdDrawIndexed(const VertexArray* vao, uint32_t indexCount, uint32_t indexOffset = 0, int32_t baseVertex = 0)
+        : vao(vao), indexCount(indexCount), indexOffset(indexOffset), baseVertex(baseVertex) {}
+    CmdDrawIndexed(const std::shared_ptr<VertexArray>& vao, uint32_t indexCount, uint32_t indexOffset = 0, int32_t baseVertex = 0)
+        : vao(vao.get()), indexCount(indexCount), indexOffset(indexOffset), baseVertex(baseVertex) {}
 };
 
 struct CmdDrawIndexedInstanced {
-    std::shared_ptr<VertexArray> vao;
+    static constexpr RenderCmdType Type = RenderCmdType::DrawIndexedInstanced;
+    const VertexArray* vao;
     uint32_t indexCount;
     uint32_t instanceCount;
+    uint32_t indexOffset = 0;
+    int32_t baseVertex = 0;
+
+    CmdDrawIndexedInstanced(const VertexArray* vao, uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset = 0, int32_t baseVertex = 0)
+        : vao(vao), indexCount(indexCount), instanceCount(instanceCount), indexOffset(indexOffset), baseVertex(baseVertex) {}
+    CmdDrawIndexedInstanced(const std::shared_ptr<VertexArray>& vao, uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset = 0, int32_t baseVertex = 0)
+        : vao(vao.get()), indexCount(indexCount), instanceCount(instanceCount), indexOffset(indexOffset), baseVertex(baseVertex) {}
+};
+
+// Several indexed draws of one vertex array in one call. Use RenderCommandQueue::submitDrawIndexedIndirect
+// to copy the draw commands into the queue.
+struct CmdDrawIndexedIndirect {
+    static constexpr RenderCmdType Type = RenderCmdType::DrawIndexedIndirect;
+    const VertexArray* vao;
+    const DrawIndexedIndirectCommand* commands;
+    uint32_t drawCount;
 };
 
 struct CmdDrawLines {
-    std::shared_ptr<VertexArray> vao;
+    static constexpr RenderCmdType Type = RenderCmdType::DrawLines;
+    const VertexArray* vao;
     uint32_t vertexCount;
+
+    CmdDrawLines(const VertexArray* vao, uint32_t vertexCount) : vao(vao), vertexCount(vertexCount) {}
+    CmdDrawLines(const std::shared_ptr<VertexArray>& vao, uint32_t vertexCount) : vao(vao.get()), vertexCount(vertexCount) {}
 };
 
 // 自定义命令 - 用于复杂操作
 // 这是一个过渡方案，未来可以进一步拆分
+// Prefer RenderCommandQueue::submitCustom on hot paths: it stores the callable in the arena instead of
+// a std::function that may allocate.
 
 struct CmdCustom {
+    static constexpr RenderCmdType Type = RenderCmdType::Custom;
     std::function<void()> execute;
 };
 
-// 命令变体类型
-
-using RenderCmd = std::variant<
-    CmdSetViewport,
-    CmdSetClearColor,
-    CmdClear,
-    CmdSetBlendEnabled,
-    CmdSetLineWidth,
-    CmdBindPipeline,
-    CmdBindFramebuffer,
-    CmdUnbindFramebuffer,
-    CmdDrawIndexed,
-    CmdDrawIndexedInstanced,
-    CmdDrawLines,
-    CmdCustom
->;
-
 } // namespace Fermion
@@ -17,6 +17,10 @@ struct MeshDrawCommand {
     // GPU draw info
     uint32_t indexCount;
     uint32_t indexOffset;
+    int32_t baseVertex = 0;
+    // Surviving meshlet ranges in MeshDrawList::getRangeCounts/getRangeOffsets; none draws the whole range
+    uint32_t firstRange = 0;
+    uint32_t rangeCount = 0;
     int objectID = -1;
 
 
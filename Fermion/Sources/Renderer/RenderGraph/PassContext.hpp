@@ -2,7 +2,7 @@
 #include "RenderGraphResource.hpp"
 #include "Renderer/RenderCommandQueue.hpp"
 #include <memory>
-#include <unordered_map>
+#include <span>
 
 namespace Fermion
 {
@@ -11,20 +11,20 @@ namespace Fermion
     public:
         RenderCommandQueue &commandQueue;
 
-        PassContext(RenderCommandQueue &queue,
-                    std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<Framebuffer>> &resources)
+        PassContext(RenderCommandQueue &queue, std::span<const RenderGraphResource> resources)
             : commandQueue(queue), m_Resources(resources)
         {
         }
 
         std::shared_ptr<Framebuffer> getFramebuffer(RenderGraphResourceHandle handle) const
         {
-            auto it = m_Resources.find(handle);
-            return it != m_Resources.end() ? it->second : nullptr;
+            if (!handle.isValid() || handle.getIndex() >= m_Resources.size())
+                return nullptr;
+            return m_Resources[handle.getIndex()].getFramebuffer();
         }
 
     private:
-        std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<Framebuffer>> &m_Resources;
+        std::span<const RenderGraphResource> m_Resources;
     };
 
 } // namespace Fermion
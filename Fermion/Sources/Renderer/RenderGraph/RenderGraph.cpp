@@ -1,51 +1,117 @@
+#include "fmpch.hpp"
 #include "RenderGraph.hpp"
 #include "Core/Log.hpp"
 
 namespace Fermion
 {
-    RenderGraph::RenderGraph() = default;
+    namespace
+    {
+        constexpr uint64_t kHashOffset = 14695981039346656037ull;
+        constexpr uint64_t kHashPrime = 1099511628211ull;
+    } // namespace
+
+    RenderGraph::RenderGraph()
+    {
+        m_StructureHash = kHashOffset;
+    }
 
     RenderGraphResourceHandle RenderGraph::declareResource(const std::string &name, const RenderGraphResourceDesc &desc)
     {
-        auto resource = std::make_shared<RenderGraphResource>(name, desc);
-        auto handle = resource->getHandle();
-        m_Resources[handle] = resource;
-        m_Dirty = true;
+        const auto handle = RenderGraphResourceHandle::fromIndex(static_cast<uint32_t>(m_ResourceCount));
+
+        if (m_ResourceCount < m_Resources.size())
+        {
+            // A persistent resource declared the same way again keeps its framebuffer
+            RenderGraphResource &slot = m_Resources[m_ResourceCount];
+            std::shared_ptr<Framebuffer> keep;
+            if (!slot.isExternal() && !desc.isTransient && slot.getDesc() == desc)
+                keep = slot.getFramebuffer();
+            else
+                releaseSlot(slot);
+            slot = RenderGraphResource(handle, name, desc);
+            slot.setFramebuffer(std::move(keep));
+        }
+        else
+        {
+            m_Resources.emplace_back(handle, name, desc);
+        }
+        ++m_ResourceCount;
+
+        hashStructure(name);
+        hashStructure((static_cast<uint64_t>(desc.width) << 32) | desc.height);
+        hashStructure((static_cast<uint64_t>(desc.type) << 32) | (static_cast<uint64_t>(desc.format) << 1) |
+                      (desc.isTransient ? 1u : 0u));
         return handle;
     }
 
     RenderGraphResourceHandle RenderGraph::importResource(const std::string &name, std::shared_ptr<Framebuffer> external)
     {
-        auto resource = std::make_shared<RenderGraphResource>(name, external);
-        auto handle = resource->getHandle();
-        m_Resources[handle] = resource;
-        m_Dirty = true;
+        const auto handle = RenderGraphResourceHandle::fromIndex(static_cast<uint32_t>(m_ResourceCount));
+
+        if (m_ResourceCount < m_Resources.size())
+        {
+            releaseSlot(m_Resources[m_ResourceCount]);
+            m_Resources[m_ResourceCount] = RenderGraphResource(handle, name, external);
+        }
+        else
+            m_Resources.emplace_back(handle, name, external);
+        ++m_ResourceCount;
+
+        // The framebuffer itself is data; only the fact that the slot is imported shapes the graph
+        hashStructure(name);
+        hashStructure(~0ull);
         return handle;
     }
 
+    void RenderGraph::markOutput(RenderGraphResourceHandle handle)
+    {
+        if (!handle.isValid() || handle.getIndex() >= m_ResourceCount)
+            return;
+
+        m_Resources[handle.getIndex()].markOutput();
+        hashStructure(handle.id);
+    }
+
     void RenderGraph::addPass(const std::string &name, std::function<void(PassBuilder &)> setupFunc)
     {
-        PassBuilder builder(name);
+        if (m_PassCount == m_Passes.size())
+            m_Passes.emplace_back();
+
+        RenderGraphPass &pass = m_Passes[m_PassCount++];
+        PassBuilder builder(pass, name);
         setupFunc(builder);
-        m_Passes.push_back(builder.build());
-        m_Dirty = true;
+
+        hashStructure(name);
+        hashStructure(pass.getInputs().size());
+        for (const auto &input : pass.getInputs())
+            hashStructure(input.id);
+        hashStructure(pass.getOutputs().size());
+        for (const auto &output : pass.getOutputs())
+            hashStructure(output.id);
     }
 
     bool RenderGraph::compile()
     {
+        if (m_Compiled && m_CompiledHash == m_StructureHash)
+            return m_LastCompileSuccess;
+
+        FM_PROFILE_FUNCTION();
+
         m_ExecutionOrder.clear();
-        m_Compiled = false;
+        m_Lifetimes.clear();
+        m_CulledPassCount = 0;
+        m_Compiled = true;
+        m_CompiledHash = m_StructureHash;
 
-        if (m_Passes.empty())
+        if (m_PassCount == 0)
         {
-            m_Compiled = true;
-            m_Dirty = false;
             m_LastCompileSuccess = true;
             m_LastError.clear();
             return true;
         }
 
-        auto result = m_Compiler.compile(m_Passes, m_Resources);
+        const std::span<const RenderGraphPass> passes(m_Passes.data(), m_PassCount);
+        auto result = m_Compiler.compile(passes, std::span<const RenderGraphResource>(m_Resources.data(), m_ResourceCount));
 
         m_LastCompileSuccess = result.success;
         m_LastError = result.errorMessage;
@@ -55,35 +121,49 @@ namespace Fermion
             Log::Error("RenderGraph compile error: " + result.errorMessage);
             FERMION_ASSERT(false, "RenderGraph compilation failed");
 
-            m_ExecutionOrder.clear();
-            for (size_t i = 0; i < m_Passes.size(); ++i)
+            // Run everything in declaration order with every resource alive for the whole frame
+            for (size_t i = 0; i < m_PassCount; ++i)
                 m_ExecutionOrder.push_back(i);
+            m_Lifetimes.assign(m_ResourceCount, {0, static_cast<uint32_t>(m_PassCount - 1)});
         }
         else
         {
             m_ExecutionOrder = std::move(result.executionOrder);
+            m_Lifetimes = std::move(result.lifetimes);
+            m_CulledPassCount = result.culledPassCount;
         }
 
-        m_Compiled = true;
-        m_Dirty = false;
         return result.success;
     }
 
     void RenderGraph::execute(RenderCommandQueue &commandQueue, RendererAPI &api)
     {
-        if (m_Dirty || !m_Compiled)
-            compile();
+        compile();
 
-        m_Executor.execute(m_Passes, m_ExecutionOrder, m_Resources, m_ResourcePool, commandQueue, api);
+        // Persistent resources from a larger earlier frame that weren't declared this time
+        for (size_t i = m_ResourceCount; i < m_Resources.size(); ++i)
+            releaseSlot(m_Resources[i]);
+
+        m_Executor.execute(std::span<const RenderGraphPass>(m_Passes.data(), m_PassCount), m_ExecutionOrder,
+                           m_Lifetimes, std::span<RenderGraphResource>(m_Resources.data(), m_ResourceCount),
+                           m_ResourcePool, commandQueue, api);
+        m_ResourcePool.endFrame();
     }
 
     void RenderGraph::reset()
     {
+        m_PassCount = 0;
+        m_ResourceCount = 0;
+        m_StructureHash = kHashOffset;
+    }
+
+    void RenderGraph::invalidate()
+    {
+        reset();
+        m_ResourcePool.reset();
         m_Passes.clear();
         m_Resources.clear();
         m_ExecutionOrder.clear();
-        m_ResourcePool.reset();
-        m_Dirty = true;
         m_Compiled = false;
         m_LastCompileSuccess = true;
         m_LastError.clear();
@@ -91,10 +171,37 @@ namespace Fermion
 
     std::shared_ptr<Framebuffer> RenderGraph::getFramebuffer(RenderGraphResourceHandle handle) const
     {
-        auto it = m_Resources.find(handle);
-        if (it != m_Resources.end())
-            return it->second->getFramebuffer();
+        if (handle.isValid() && handle.getIndex() < m_ResourceCount)
+            return m_Resources[handle.getIndex()].getFramebuffer();
         return nullptr;
     }
 
+    void RenderGraph::releaseSlot(RenderGraphResource &resource)
+    {
+        if (resource.isExternal() || !resource.getFramebuffer())
+            return;
+
+        m_ResourcePool.releaseFramebuffer(resource.getFramebuffer());
+        resource.setFramebuffer(nullptr);
+    }
+
+    void RenderGraph::hashStructure(uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            m_StructureHash ^= (value >> (i * 8)) & 0xff;
+            m_StructureHash *= kHashPrime;
+        }
+    }
+
+    void RenderGraph::hashStructure(const std::string &value)
+    {
+        for (char c : value)
+        {
+            m_StructureHash ^= static_cast<uint8_t>(c);
+            m_StructureHash *= kHashPrime;
+        }
+        hashStructure(value.size());
+    }
+
 } // namespace Fermion
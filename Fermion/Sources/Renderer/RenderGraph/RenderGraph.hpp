@@ -6,11 +6,13 @@
 #include "RenderGraphResourcePool.hpp"
 #include "Renderer/RenderCommandQueue.hpp"
 #include <memory>
-#include <unordered_map>
 #include <vector>
 
 namespace Fermion
 {
+    // Passes and resources are declared again every frame, but that only rebinds callbacks: pass and
+    // resource slots are reused, and the structure (pass names, reads, writes, resource descriptions) is
+    // hashed while it is declared. compile() re-runs validation and sorting only when that hash changes.
     class RenderGraph
     {
     public:
@@ -18,28 +20,47 @@ namespace Fermion
 
         RenderGraphResourceHandle declareResource(const std::string &name, const RenderGraphResourceDesc &desc);
         RenderGraphResourceHandle importResource(const std::string &name, std::shared_ptr<Framebuffer> external);
+        // Keeps the passes producing 'handle' from being culled even if no pass reads it
+        void markOutput(RenderGraphResourceHandle handle);
 
         void addPass(const std::string &name, std::function<void(PassBuilder &)> setupFunc);
 
         bool compile();
         void execute(RenderCommandQueue &commandQueue, RendererAPI &api);
+        // Starts a new declaration. The compiled order and pooled framebuffers are kept for the next frame.
         void reset();
+        // Forgets the cached compilation as well, e.g. after the pool's framebuffers became invalid
+        void invalidate();
 
         bool lastCompileSucceeded() const { return m_LastCompileSuccess; }
         const std::string &getLastError() const { return m_LastError; }
+        uint64_t getStructureHash() const { return m_StructureHash; }
+        size_t getCulledPassCount() const { return m_CulledPassCount; }
 
         std::shared_ptr<Framebuffer> getFramebuffer(RenderGraphResourceHandle handle) const;
 
     private:
-        std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<RenderGraphResource>> m_Resources;
+        // Hands a pooled framebuffer back when its slot is redeclared or dropped
+        void releaseSlot(RenderGraphResource &resource);
+        void hashStructure(uint64_t value);
+        void hashStructure(const std::string &value);
+
+    private:
+        // Slots past the counts belong to earlier frames and are only kept for reuse
+        std::vector<RenderGraphResource> m_Resources;
         std::vector<RenderGraphPass> m_Passes;
+        size_t m_ResourceCount = 0;
+        size_t m_PassCount = 0;
         std::vector<size_t> m_ExecutionOrder;
+        std::vector<RenderGraphResourceLifetime> m_Lifetimes;
+        size_t m_CulledPassCount = 0;
 
         RenderGraphCompiler m_Compiler;
         RenderGraphExecutor m_Executor;
         RenderGraphResourcePool m_ResourcePool;
 
-        bool m_Dirty = true;
+        uint64_t m_StructureHash = 0;
+        uint64_t m_CompiledHash = 0;
         bool m_Compiled = false;
         bool m_LastCompileSuccess = true;
         std::string m_LastError;
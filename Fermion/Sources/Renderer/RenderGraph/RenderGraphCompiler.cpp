@@ -2,14 +2,13 @@
 #include "Core/Log.hpp"
 #include <format>
 #include <queue>
-#include <unordered_map>
 
 namespace Fermion
 {
-    RenderGraphCompileResult RenderGraphCompiler::compile(
-        const std::vector<RenderGraphPass> &passes,
-        const std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<RenderGraphResource>> &resources)
+    RenderGraphCompileResult RenderGraphCompiler::compile(std::span<const RenderGraphPass> passes,
+                                                          std::span<const RenderGraphResource> resources)
     {
+        const size_t resourceCount = resources.size();
         RenderGraphCompileResult result;
 
         if (passes.empty())
@@ -18,14 +17,14 @@ namespace Fermion
             return result;
         }
 
-        if (!validatePasses(passes, resources, result.errorMessage))
+        if (!validatePasses(passes, resourceCount, result.errorMessage))
         {
             result.success = false;
             return result;
         }
 
         bool hasCycle = false;
-        result.executionOrder = topologicalSort(passes, hasCycle, result.errorMessage);
+        result.executionOrder = topologicalSort(passes, resourceCount, hasCycle, result.errorMessage);
 
         if (hasCycle || result.executionOrder.size() != passes.size())
         {
@@ -35,34 +34,54 @@ namespace Fermion
             return result;
         }
 
+        result.culledPassCount = cullPasses(passes, resources, result.executionOrder);
+        result.lifetimes.resize(resourceCount);
+        computeLifetimes(passes, result.executionOrder, result.lifetimes);
+
         result.success = true;
         return result;
     }
 
-    bool RenderGraphCompiler::validatePasses(
-        const std::vector<RenderGraphPass> &passes,
-        const std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<RenderGraphResource>> &resources,
-        std::string &errorMessage)
+    bool RenderGraphCompiler::validatePasses(std::span<const RenderGraphPass> passes, size_t resourceCount,
+                                             std::string &errorMessage)
     {
-        std::unordered_map<RenderGraphResourceHandle, size_t> producerByResource;
+        m_ProducerByResource.assign(resourceCount, -1);
 
         for (size_t passIndex = 0; passIndex < passes.size(); ++passIndex)
         {
             const auto &pass = passes[passIndex];
 
+            for (const auto &input : pass.getInputs())
+            {
+                if (input.isValid() && input.getIndex() >= resourceCount)
+                {
+                    errorMessage = std::format("Pass '{}' reads an undeclared resource #{}",
+                                               getPassLabel(passes, passIndex), input.getIndex());
+                    return false;
+                }
+            }
+
             for (const auto &output : pass.getOutputs())
             {
                 if (!output.isValid())
                     continue;
 
-                auto [it, inserted] = producerByResource.emplace(output, passIndex);
-                if (!inserted)
+                if (output.getIndex() >= resourceCount)
+                {
+                    errorMessage = std::format("Pass '{}' writes an undeclared resource #{}",
+                                               getPassLabel(passes, passIndex), output.getIndex());
+                    return false;
+                }
+
+                int64_t &producer = m_ProducerByResource[output.getIndex()];
+                if (producer >= 0)
                 {
                     errorMessage = std::format("Resource has multiple producers: '{}' and '{}'",
-                                               getPassLabel(passes, it->second),
+                                               getPassLabel(passes, static_cast<size_t>(producer)),
                                                getPassLabel(passes, passIndex));
                     return false;
                 }
+                producer = static_cast<int64_t>(passIndex);
             }
         }
 
@@ -70,21 +89,15 @@ namespace Fermion
     }
 
     std::vector<size_t> RenderGraphCompiler::topologicalSort(
-        const std::vector<RenderGraphPass> &passes,
+        std::span<const RenderGraphPass> passes,
+        size_t resourceCount,
         bool &hasCycle,
         std::string &errorMessage)
     {
         const size_t passCount = passes.size();
-        std::unordered_map<RenderGraphResourceHandle, size_t> producerByResource;
 
-        for (size_t pass = 0; pass < passCount; ++pass)
-        {
-            for (const auto &output : passes[pass].getOutputs())
-            {
-                if (output.isValid())
-                    producerByResource[output] = pass;
-            }
-        }
+        // validatePasses() left the producer of every resource in m_ProducerByResource
+        FERMION_ASSERT(m_ProducerByResource.size() == resourceCount, "Render graph producers not gathered");
 
         std::vector<std::vector<size_t>> edges(passCount);
         std::vector<uint32_t> indegree(passCount, 0);
@@ -96,11 +109,11 @@ namespace Fermion
                 if (!input.isValid())
                     continue;
 
-                auto it = producerByResource.find(input);
-                if (it == producerByResource.end())
+                const int64_t producerIndex = m_ProducerByResource[input.getIndex()];
+                if (producerIndex < 0)
                     continue;
 
-                const size_t producer = it->second;
+                const size_t producer = static_cast<size_t>(producerIndex);
                 if (producer == consumer)
                     continue;
 
@@ -157,7 +170,79 @@ namespace Fermion
         return executionOrder;
     }
 
-    std::string RenderGraphCompiler::getPassLabel(const std::vector<RenderGraphPass> &passes, size_t index) const
+    size_t RenderGraphCompiler::cullPasses(std::span<const RenderGraphPass> passes,
+                                           std::span<const RenderGraphResource> resources,
+                                           std::vector<size_t> &executionOrder)
+    {
+        // Roots: passes that only have side effects (they write targets they own, so they declare no
+        // outputs) and passes writing an imported or explicitly marked output
+        std::vector<uint8_t> alive(passes.size(), 0);
+        std::vector<size_t> stack;
+        for (size_t pass = 0; pass < passes.size(); ++pass)
+        {
+            const auto &outputs = passes[pass].getOutputs();
+            bool root = outputs.empty();
+            for (const auto &output : outputs)
+                root = root || (output.isValid() && resources[output.getIndex()].isOutput());
+
+            if (root)
+            {
+                alive[pass] = 1;
+                stack.push_back(pass);
+            }
+        }
+
+        // Everything a live pass reads keeps its producer alive
+        while (!stack.empty())
+        {
+            const size_t pass = stack.back();
+            stack.pop_back();
+            for (const auto &input : passes[pass].getInputs())
+            {
+                if (!input.isValid())
+                    continue;
+
+                const int64_t producer = m_ProducerByResource[input.getIndex()];
+                if (producer >= 0 && !alive[producer])
+                {
+                    alive[producer] = 1;
+                    stack.push_back(static_cast<size_t>(producer));
+                }
+            }
+        }
+
+        const size_t before = executionOrder.size();
+        std::erase_if(executionOrder, [&](size_t pass)
+                      { return !alive[pass]; });
+        return before - executionOrder.size();
+    }
+
+    void RenderGraphCompiler::computeLifetimes(std::span<const RenderGraphPass> passes,
+                                               const std::vector<size_t> &executionOrder,
+                                               std::vector<RenderGraphResourceLifetime> &lifetimes)
+    {
+        auto touch = [&](RenderGraphResourceHandle handle, uint32_t position)
+        {
+            if (!handle.isValid())
+                return;
+
+            auto &lifetime = lifetimes[handle.getIndex()];
+            if (!lifetime.isUsed())
+                lifetime.firstUse = position;
+            lifetime.lastUse = position;
+        };
+
+        for (uint32_t position = 0; position < executionOrder.size(); ++position)
+        {
+            const auto &pass = passes[executionOrder[position]];
+            for (const auto &input : pass.getInputs())
+                touch(input, position);
+            for (const auto &output : pass.getOutputs())
+                touch(output, position);
+        }
+    }
+
+    std::string RenderGraphCompiler::getPassLabel(std::span<const RenderGraphPass> passes, size_t index) const
     {
         if (index >= passes.size())
             return std::format("#{}", index);
@@ -1,38 +1,62 @@
 #pragma once
 #include "RenderGraphPass.hpp"
 #include "RenderGraphResource.hpp"
-#include <memory>
-#include <unordered_map>
+#include <limits>
+#include <span>
 #include <vector>
 
 namespace Fermion
 {
+    // Positions in the execution order between which a resource must stay allocated
+    struct RenderGraphResourceLifetime
+    {
+        static constexpr uint32_t Unused = std::numeric_limits<uint32_t>::max();
+
+        uint32_t firstUse = Unused;
+        uint32_t lastUse = Unused;
+
+        bool isUsed() const { return firstUse != Unused; }
+    };
+
     struct RenderGraphCompileResult
     {
         bool success = false;
+        // Live passes only; culled passes don't appear
         std::vector<size_t> executionOrder;
+        // Indexed by resource
+        std::vector<RenderGraphResourceLifetime> lifetimes;
+        size_t culledPassCount = 0;
         std::string errorMessage;
     };
 
     class RenderGraphCompiler
     {
     public:
-        RenderGraphCompileResult compile(
-            const std::vector<RenderGraphPass> &passes,
-            const std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<RenderGraphResource>> &resources);
+        RenderGraphCompileResult compile(std::span<const RenderGraphPass> passes,
+                                         std::span<const RenderGraphResource> resources);
 
     private:
-        bool validatePasses(
-            const std::vector<RenderGraphPass> &passes,
-            const std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<RenderGraphResource>> &resources,
-            std::string &errorMessage);
+        bool validatePasses(std::span<const RenderGraphPass> passes, size_t resourceCount, std::string &errorMessage);
 
         std::vector<size_t> topologicalSort(
-            const std::vector<RenderGraphPass> &passes,
+            std::span<const RenderGraphPass> passes,
+            size_t resourceCount,
             bool &hasCycle,
             std::string &errorMessage);
 
-        std::string getPassLabel(const std::vector<RenderGraphPass> &passes, size_t index) const;
+        // Drops passes that contribute neither to an output resource nor to a pass without outputs
+        size_t cullPasses(std::span<const RenderGraphPass> passes,
+                          std::span<const RenderGraphResource> resources,
+                          std::vector<size_t> &executionOrder);
+
+        static void computeLifetimes(std::span<const RenderGraphPass> passes,
+                                     const std::vector<size_t> &executionOrder,
+                                     std::vector<RenderGraphResourceLifetime> &lifetimes);
+
+        std::string getPassLabel(std::span<const RenderGraphPass> passes, size_t index) const;
+
+        // Producing pass per resource index, reused between compiles
+        std::vector<int64_t> m_ProducerByResource;
     };
 
 } // namespace Fermion
@@ -5,9 +5,10 @@
 namespace Fermion
 {
     void RenderGraphExecutor::execute(
-        const std::vector<RenderGraphPass> &passes,
+        std::span<const RenderGraphPass> passes,
         const std::vector<size_t> &executionOrder,
-        std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<RenderGraphResource>> &resources,
+        const std::vector<RenderGraphResourceLifetime> &lifetimes,
+        std::span<RenderGraphResource> resources,
         RenderGraphResourcePool &resourcePool,
         RenderCommandQueue &commandQueue,
         RendererAPI &api)
@@ -17,66 +18,64 @@ namespace Fermion
         Log::Trace(std::format("RenderGraphExecutor::execute - Frame {}, passes: {}, executionOrder: {}",
                   frameCount, passes.size(), executionOrder.size()));
 
-        allocateResources(resources, resourcePool);
-
-        std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<Framebuffer>> framebufferMap;
-        for (auto &[handle, resource] : resources)
-        {
-            if (resource->getFramebuffer())
-                framebufferMap[handle] = resource->getFramebuffer();
-        }
-
         // 执行所有 pass，录制命令到 commandQueue
-        for (size_t passIndex : executionOrder)
+        for (uint32_t position = 0; position < executionOrder.size(); ++position)
         {
+            const size_t passIndex = executionOrder[position];
             const auto &pass = passes[passIndex];
+            acquireResources(position, lifetimes, resources, resourcePool);
 
             Log::Trace(std::format("  Pass[{}]: {}, shouldExecute: {}",
                       passIndex, pass.getName(), pass.shouldExecute()));
 
-            if (!pass.shouldExecute())
-                continue;
-
-            PassContext context(commandQueue, framebufferMap);
-
-            if (pass.getExecuteFunc())
+            if (pass.shouldExecute() && pass.getExecuteFunc())
+            {
+                PassContext context(commandQueue, resources);
                 pass.getExecuteFunc()(context);
+            }
+
+            // Commands are only recorded here and replay in the same order, so a framebuffer released
+            // after its last recorded use can safely be handed to a later pass
+            releaseResources(position, lifetimes, resources, resourcePool);
         }
 
         // 统一执行所有录制的命令
         Log::Trace("  Flushing command queue...");
         commandQueue.flush(api);
         Log::Trace("  Command queue flushed");
-        releaseResources(resources, resourcePool);
     }
 
-    void RenderGraphExecutor::allocateResources(
-        std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<RenderGraphResource>> &resources,
-        RenderGraphResourcePool &resourcePool)
+    void RenderGraphExecutor::acquireResources(uint32_t position,
+                                               const std::vector<RenderGraphResourceLifetime> &lifetimes,
+                                               std::span<RenderGraphResource> resources,
+                                               RenderGraphResourcePool &resourcePool)
     {
-        for (auto &[handle, resource] : resources)
+        for (size_t i = 0; i < resources.size() && i < lifetimes.size(); ++i)
         {
-            if (resource->isExternal() || resource->getFramebuffer())
+            auto &resource = resources[i];
+            if (lifetimes[i].firstUse != position || resource.isExternal() || resource.isVirtual() ||
+                resource.getFramebuffer())
                 continue;
 
-            auto framebuffer = resourcePool.acquireFramebuffer(resource->getDesc());
-            resource->setFramebuffer(framebuffer);
+            resource.setFramebuffer(resourcePool.acquireFramebuffer(resource.getDesc()));
         }
     }
 
-    void RenderGraphExecutor::releaseResources(
-        std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<RenderGraphResource>> &resources,
-        RenderGraphResourcePool &resourcePool)
+    void RenderGraphExecutor::releaseResources(uint32_t position,
+                                               const std::vector<RenderGraphResourceLifetime> &lifetimes,
+                                               std::span<RenderGraphResource> resources,
+                                               RenderGraphResourcePool &resourcePool)
     {
-        for (auto &[handle, resource] : resources)
+        for (size_t i = 0; i < resources.size() && i < lifetimes.size(); ++i)
         {
-            if (resource->isExternal() || !resource->isTransient())
+            auto &resource = resources[i];
+            if (lifetimes[i].lastUse != position || resource.isExternal() || !resource.isTransient())
                 continue;
 
-            if (auto framebuffer = resource->getFramebuffer())
+            if (const auto &framebuffer = resource.getFramebuffer())
             {
                 resourcePool.releaseFramebuffer(framebuffer);
-                resource->setFramebuffer(nullptr);
+                resource.setFramebuffer(nullptr);
             }
         }
     }
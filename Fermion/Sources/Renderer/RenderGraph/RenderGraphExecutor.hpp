@@ -1,10 +1,10 @@
 #pragma once
+#include "RenderGraphCompiler.hpp"
 #include "RenderGraphPass.hpp"
 #include "RenderGraphResource.hpp"
 #include "RenderGraphResourcePool.hpp"
 #include "Renderer/RenderCommandQueue.hpp"
-#include <memory>
-#include <unordered_map>
+#include <span>
 #include <vector>
 
 namespace Fermion
@@ -13,21 +13,22 @@ namespace Fermion
     {
     public:
         void execute(
-            const std::vector<RenderGraphPass> &passes,
+            std::span<const RenderGraphPass> passes,
             const std::vector<size_t> &executionOrder,
-            std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<RenderGraphResource>> &resources,
+            const std::vector<RenderGraphResourceLifetime> &lifetimes,
+            std::span<RenderGraphResource> resources,
             RenderGraphResourcePool &resourcePool,
             RenderCommandQueue &commandQueue,
             RendererAPI &api);
 
     private:
-        void allocateResources(
-            std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<RenderGraphResource>> &resources,
-            RenderGraphResourcePool &resourcePool);
+        // Transients are acquired right before their first use and handed back right after their last,
+        // so later transients with the same description alias the same framebuffer
+        void acquireResources(uint32_t position, const std::vector<RenderGraphResourceLifetime> &lifetimes,
+                              std::span<RenderGraphResource> resources, RenderGraphResourcePool &resourcePool);
 
-        void releaseResources(
-            std::unordered_map<RenderGraphResourceHandle, std::shared_ptr<RenderGraphResource>> &resources,
-            RenderGraphResourcePool &resourcePool);
+        void releaseResources(uint32_t position, const std::vector<RenderGraphResourceLifetime> &lifetimes,
+                              std::span<RenderGraphResource> resources, RenderGraphResourcePool &resourcePool);
     };
 
 } // namespace Fermion
@@ -13,6 +13,7 @@ namespace Fermion
         using ExecuteFunc = std::function<void(PassContext &)>;
         using ConditionFunc = std::function<bool()>;
 
+        RenderGraphPass() = default;
         RenderGraphPass(const std::string &name) : m_Name(name) {}
 
         const std::string &getName() const { return m_Name; }
@@ -33,10 +34,19 @@ namespace Fermion
         ConditionFunc m_ConditionFunc;
     };
 
+    // Fills a pass slot owned by the graph. Slots are reused across frames, so the input/output
+    // vectors keep their capacity and re-declaring an unchanged pass doesn't allocate.
     class PassBuilder
     {
     public:
-        PassBuilder(const std::string &name) : m_Pass(name) {}
+        PassBuilder(RenderGraphPass &pass, const std::string &name) : m_Pass(pass)
+        {
+            m_Pass.m_Name = name;
+            m_Pass.m_Inputs.clear();
+            m_Pass.m_Outputs.clear();
+            m_Pass.m_ExecuteFunc = nullptr;
+            m_Pass.m_ConditionFunc = nullptr;
+        }
 
         PassBuilder &read(RenderGraphResourceHandle resource)
         {
@@ -62,10 +72,8 @@ namespace Fermion
             return *this;
         }
 
-        RenderGraphPass build() { return std::move(m_Pass); }
-
     private:
-        RenderGraphPass m_Pass;
+        RenderGraphPass &m_Pass;
     };
 
 } // namespace Fermion
@@ -2,19 +2,16 @@
 
 namespace Fermion
 {
-    RenderGraphResource::RenderGraphResource(const std::string &name, const RenderGraphResourceDesc &desc)
-        : m_Name(name), m_Desc(desc), m_IsExternal(false)
+    RenderGraphResource::RenderGraphResource(RenderGraphResourceHandle handle, const std::string &name,
+                                             const RenderGraphResourceDesc &desc)
+        : m_Name(name), m_Handle(handle), m_Desc(desc), m_IsExternal(false)
     {
-        while (!m_Handle.isValid())
-            m_Handle = RenderGraphResourceHandle{};
     }
 
-    RenderGraphResource::RenderGraphResource(const std::string &name, std::shared_ptr<Framebuffer> external)
-        : m_Name(name), m_Framebuffer(external), m_IsExternal(true)
+    RenderGraphResource::RenderGraphResource(RenderGraphResourceHandle handle, const std::string &name,
+                                             std::shared_ptr<Framebuffer> external)
+        : m_Name(name), m_Handle(handle), m_IsExternal(true), m_Framebuffer(external)
     {
-        while (!m_Handle.isValid())
-            m_Handle = RenderGraphResourceHandle{};
-
         if (external)
         {
             const auto &spec = external->getSpecification();
@@ -1,18 +1,32 @@
 #pragma once
-#include "Core/UUID.hpp"
 #include "Renderer/Framebuffer.hpp"
+#include <cstdint>
 #include <memory>
 #include <string>
 
 namespace Fermion
 {
-    using RenderGraphResourceHandle = UUID;
+    // Index into the graph's resource table, stored off by one so a zero-initialised handle is invalid.
+    // Handles are only meaningful for the frame (declaration) that produced them.
+    struct RenderGraphResourceHandle
+    {
+        uint32_t id = 0;
+
+        bool isValid() const { return id != 0; }
+        uint32_t getIndex() const { return id - 1; }
+
+        static RenderGraphResourceHandle fromIndex(uint32_t index) { return {index + 1}; }
+
+        bool operator==(const RenderGraphResourceHandle &) const = default;
+    };
 
     enum class RenderGraphResourceType
     {
         Texture2D,
         TextureCube,
-        Buffer
+        Buffer,
+        // Ordering token between passes that render into targets they own; never allocated
+        Virtual
     };
 
     struct RenderGraphResourceDesc
@@ -22,28 +36,35 @@ namespace Fermion
         uint32_t height = 0;
         FramebufferTextureFormat format = FramebufferTextureFormat::RGBA8;
         bool isTransient = true;
+
+        bool operator==(const RenderGraphResourceDesc &) const = default;
     };
 
     class RenderGraphResource
     {
     public:
-        RenderGraphResource(const std::string &name, const RenderGraphResourceDesc &desc);
-        RenderGraphResource(const std::string &name, std::shared_ptr<Framebuffer> external);
+        RenderGraphResource(RenderGraphResourceHandle handle, const std::string &name, const RenderGraphResourceDesc &desc);
+        RenderGraphResource(RenderGraphResourceHandle handle, const std::string &name, std::shared_ptr<Framebuffer> external);
 
         const std::string &getName() const { return m_Name; }
         RenderGraphResourceHandle getHandle() const { return m_Handle; }
         const RenderGraphResourceDesc &getDesc() const { return m_Desc; }
         bool isExternal() const { return m_IsExternal; }
         bool isTransient() const { return m_Desc.isTransient; }
+        bool isVirtual() const { return m_Desc.type == RenderGraphResourceType::Virtual; }
+        // Imported resources and ones marked as outputs keep the passes that write them alive
+        bool isOutput() const { return m_IsExternal || m_IsOutput; }
+        void markOutput() { m_IsOutput = true; }
 
         void setFramebuffer(std::shared_ptr<Framebuffer> framebuffer) { m_Framebuffer = framebuffer; }
-        std::shared_ptr<Framebuffer> getFramebuffer() const { return m_Framebuffer; }
+        const std::shared_ptr<Framebuffer> &getFramebuffer() const { return m_Framebuffer; }
 
     private:
         std::string m_Name;
         RenderGraphResourceHandle m_Handle;
         RenderGraphResourceDesc m_Desc;
         bool m_IsExternal = false;
+        bool m_IsOutput = false;
         std::shared_ptr<Framebuffer> m_Framebuffer;
     };
 
@@ -9,6 +9,7 @@ namespace Fermion
             if (!pooled.inUse && isCompatible(pooled.framebuffer->getSpecification(), desc))
             {
                 pooled.inUse = true;
+                pooled.lastUsedFrame = m_FrameIndex;
                 return pooled.framebuffer;
             }
         }
@@ -20,11 +21,11 @@ namespace Fermion
         spec.swapChainTarget = false;
 
         auto framebuffer = Framebuffer::create(spec);
-        m_Pool.push_back({framebuffer, true});
+        m_Pool.push_back({framebuffer, true, m_FrameIndex});
         return framebuffer;
     }
 
-    void RenderGraphResourcePool::releaseFramebuffer(std::shared_ptr<Framebuffer> framebuffer)
+    void RenderGraphResourcePool::releaseFramebuffer(const std::shared_ptr<Framebuffer> &framebuffer)
     {
         for (auto &pooled : m_Pool)
         {
@@ -36,6 +37,13 @@ namespace Fermion
         }
     }
 
+    void RenderGraphResourcePool::endFrame()
+    {
+        std::erase_if(m_Pool, [this](const PooledFramebuffer &pooled)
+                      { return !pooled.inUse && m_FrameIndex - pooled.lastUsedFrame >= m_MaxIdleFrames; });
+        ++m_FrameIndex;
+    }
+
     void RenderGraphResourcePool::reset()
     {
         for (auto &pooled : m_Pool)
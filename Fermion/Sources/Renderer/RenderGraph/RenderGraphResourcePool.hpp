@@ -8,17 +8,26 @@ namespace Fermion
     {
     public:
         std::shared_ptr<Framebuffer> acquireFramebuffer(const RenderGraphResourceDesc &desc);
-        void releaseFramebuffer(std::shared_ptr<Framebuffer> framebuffer);
+        void releaseFramebuffer(const std::shared_ptr<Framebuffer> &framebuffer);
+        // Destroys framebuffers nobody acquired during the last 'maxIdleFrames' frames, so targets of a
+        // debug view or a resolution that is no longer used don't stay resident
+        void endFrame();
         void reset();
 
+        void setMaxIdleFrames(uint32_t frames) { m_MaxIdleFrames = frames; }
+        size_t getFramebufferCount() const { return m_Pool.size(); }
+
     private:
         struct PooledFramebuffer
         {
             std::shared_ptr<Framebuffer> framebuffer;
             bool inUse = false;
+            uint64_t lastUsedFrame = 0;
         };
 
         std::vector<PooledFramebuffer> m_Pool;
+        uint64_t m_FrameIndex = 0;
+        uint32_t m_MaxIdleFrames = 4;
 
         bool isCompatible(const FramebufferSpecification &spec, const RenderGraphResourceDesc &desc) const;
     };
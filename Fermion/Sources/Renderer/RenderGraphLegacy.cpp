@@ -5,19 +5,20 @@ namespace Fermion
     ResourceHandle RenderGraphLegacy::createResource()
     {
         RenderGraphResourceDesc desc;
+        desc.type = RenderGraphResourceType::Virtual;
         desc.isTransient = true;
-        desc.width = 1920;
-        desc.height = 1080;
-        desc.format = FramebufferTextureFormat::RGBA8;
 
         return m_Graph.declareResource("LegacyResource", desc);
     }
 
-    RenderGraphLegacy::PassHandle RenderGraphLegacy::addPass(const LegacyRenderGraphPass &pass)
+    void RenderGraphLegacy::markOutput(ResourceHandle resource)
     {
-        m_LegacyPasses.push_back(pass);
+        m_Graph.markOutput(resource);
+    }
 
-        m_Graph.addPass(pass.Name, [pass](PassBuilder &builder)
+    RenderGraphLegacy::PassHandle RenderGraphLegacy::addPass(LegacyRenderGraphPass pass)
+    {
+        m_Graph.addPass(pass.Name, [&pass](PassBuilder &builder)
                         {
             for (const auto &input : pass.Inputs)
             {
@@ -31,14 +32,14 @@ namespace Fermion
                     builder.write(output);
             }
 
-            builder.execute([pass](PassContext &ctx)
-                            {
-                if (pass.Execute)
-                    pass.Execute(ctx.commandQueue);
-            });
+            if (pass.Execute)
+            {
+                builder.execute([execute = std::move(pass.Execute)](PassContext &ctx)
+                                { execute(ctx.commandQueue); });
+            }
         });
 
-        return m_LegacyPasses.size() - 1;
+        return m_PassCount++;
     }
 
     bool RenderGraphLegacy::compile()
@@ -54,7 +55,7 @@ namespace Fermion
     void RenderGraphLegacy::reset()
     {
         m_Graph.reset();
-        m_LegacyPasses.clear();
+        m_PassCount = 0;
     }
 
     bool RenderGraphLegacy::lastCompileSucceeded() const
@@ -21,8 +21,10 @@ namespace Fermion
     public:
         using PassHandle = size_t;
 
+        // Dependency token only: legacy passes render into framebuffers their renderers own
         ResourceHandle createResource();
-        PassHandle addPass(const LegacyRenderGraphPass &pass);
+        void markOutput(ResourceHandle resource);
+        PassHandle addPass(LegacyRenderGraphPass pass);
         bool compile();
         void execute(RenderCommandQueue &queue, RendererAPI &api);
         void reset();
@@ -30,7 +32,7 @@ namespace Fermion
 
     private:
         RenderGraph m_Graph;
-        std::vector<LegacyRenderGraphPass> m_LegacyPasses;
+        size_t m_PassCount = 0;
     };
 
 } // namespace Fermion
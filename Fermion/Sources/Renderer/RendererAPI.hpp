@@ -6,6 +6,16 @@
 
 namespace Fermion {
 
+// Laid out as glMultiDrawElementsIndirect reads it. firstIndex is in indices; baseInstance is where the
+// draw's instances start in the instance storage buffer
+struct DrawIndexedIndirectCommand {
+    uint32_t indexCount;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
 class RendererAPI {
 public:
     enum class API {
@@ -23,10 +33,27 @@ public:
     virtual void clear() = 0;
     virtual void setBlendEnabled(bool enabled) = 0;
 
-    virtual void drawIndexed(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount = 0) = 0;
-    virtual void drawIndexed(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount, uint32_t indexOffset) = 0;
-    virtual void drawIndexedInstanced(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount, uint32_t instanceCount) = 0;
-    virtual void drawLines(const std::shared_ptr<VertexArray> &vertexArray, uint32_t vertexCount) = 0;
+    // The command queue replays draws through raw references so its commands stay trivially copyable.
+    // baseVertex is added to every index, for meshes whose 16-bit indices are relative to each submesh
+    virtual void drawIndexed(const VertexArray &vertexArray, uint32_t indexCount, uint32_t indexOffset, int32_t baseVertex = 0) = 0;
+    virtual void drawIndexedInstanced(const VertexArray &vertexArray, uint32_t indexCount, uint32_t instanceCount, uint32_t indexOffset, int32_t baseVertex = 0) = 0;
+    // Several draws of one vertex array in a single call. Mesh shaders find their instances through the
+    // draw's baseInstance, so different meshes of a shared geometry page can go in one call
+    virtual void drawIndexedIndirect(const VertexArray &vertexArray, const DrawIndexedIndirectCommand *commands, uint32_t drawCount) = 0;
+    virtual void drawLines(const VertexArray &vertexArray, uint32_t vertexCount) = 0;
+
+    void drawIndexed(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount = 0) {
+        drawIndexed(*vertexArray, indexCount, 0);
+    }
+    void drawIndexed(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount, uint32_t indexOffset) {
+        drawIndexed(*vertexArray, indexCount, indexOffset);
+    }
+    void drawIndexedInstanced(const std::shared_ptr<VertexArray> &vertexArray, uint32_t indexCount, uint32_t instanceCount) {
+        drawIndexedInstanced(*vertexArray, indexCount, instanceCount, 0);
+    }
+    void drawLines(const std::shared_ptr<VertexArray> &vertexArray, uint32_t vertexCount) {
+        drawLines(*vertexArray, vertexCount);
+    }
 
     virtual void setLineWidth(float width) = 0;
 
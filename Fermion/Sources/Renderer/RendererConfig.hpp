@@ -4,5 +4,7 @@
 namespace Fermion {
 struct RendererConfig {
     std::string ShaderPath;
+    // Where linked shader programs are cached between runs; empty compiles every shader from source
+    std::string ShaderCachePath;
 };
 } // namespace Fermion
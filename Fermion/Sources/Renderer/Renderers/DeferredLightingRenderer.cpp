@@ -50,11 +50,16 @@ namespace Fermion
                                             const GBufferRenderer& gBuffer,
                                             const ShadowMapRenderer* shadowRenderer,
                                             EnvironmentRenderer* envRenderer,
+                                            ResourceHandle gBufferHandle,
+                                            ResourceHandle shadowMap,
                                             ResourceHandle lightingResult)
     {
         LegacyRenderGraphPass pass;
         pass.Name = "LightingPass";
-        pass.Inputs = {};  // Dependencies are accessed via references
+        // The framebuffers themselves are accessed via references; the handles order the passes
+        pass.Inputs = {gBufferHandle};
+        if (shadowMap.isValid())
+            pass.Inputs.push_back(shadowMap);
         pass.Outputs = {lightingResult};
         pass.Execute = [this, &context, &gBuffer, shadowRenderer, envRenderer](RenderCommandQueue& queue)
         {
@@ -80,7 +85,6 @@ namespace Fermion
 
             // Update light uniform buffer
             LightData lightData;
-            lightData.lightSpaceMatrix = shadowRenderer ? shadowRenderer->getLightSpaceMatrix() : glm::mat4(1.0f);
 
             // Main directional light (first one, used for shadow mapping)
             if (!context.environmentLight.directionalLights.empty())
@@ -100,10 +104,17 @@ namespace Fermion
             lightData.shadowBias = context.shadowBias;
             lightData.shadowSoftness = context.shadowSoftness;
             lightData.enableShadows = (context.enableShadows && shadowRenderer && shadowRenderer->getShadowMapFramebuffer()) ? 1 : 0;
-            lightData.numDirLights = std::max(0, std::min(4, (int)context.environmentLight.directionalLights.size() - 1));
+            if (lightData.enableShadows)
+                queue.submitUniformData(context.shadowUBO.get(), &shadowRenderer->getShadowData(), sizeof(ShadowData));
+            lightData.numDirLights = std::max(0, std::min((int)MAX_DIR_LIGHTS, (int)context.environmentLight.directionalLights.size() - 1));
+            for (int i = 0; i < lightData.numDirLights; i++)
+            {
+                const auto& l = context.environmentLight.directionalLights[i + 1]; // Skip main light at index 0
+                lightData.dirLights[i] = {.direction = l.direction, .intensity = l.intensity, .color = l.color};
+            }
             lightData.ambientIntensity = context.ambientIntensity;
-            lightData.numPointLights = std::min(16u, (uint32_t)context.environmentLight.pointLights.size());
-            lightData.numSpotLights = std::min(16u, (uint32_t)context.environmentLight.spotLights.size());
+            lightData.numPointLights = (int)context.environmentLight.pointLights.size();
+            lightData.numSpotLights = (int)context.environmentLight.spotLights.size();
 
             EnvironmentRenderer::IBLSettings iblSettings = {
                 .useIBL = context.useIBL,
@@ -119,24 +130,12 @@ namespace Fermion
 
             bool enableShadows = context.enableShadows && shadowRenderer && shadowRenderer->getShadowMapFramebuffer();
 
-            // Additional directional lights (excluding the main one)
-            uint32_t maxDirLights = 4;
-            uint32_t dirLightCount = 0;
-            if (context.environmentLight.directionalLights.size() > 1)
-            {
-                dirLightCount = std::min(maxDirLights, (uint32_t)(context.environmentLight.directionalLights.size() - 1));
-            }
-
-            auto envLight = context.environmentLight;
             auto shadowFB = enableShadows ? shadowRenderer->getShadowMapFramebuffer() : nullptr;
 
-            queue.submit(CmdCustom{[this, lightUBO = context.lightUBO, lightData,
-                                    gBufferFramebuffer, inverseViewProjection,
+            queue.submitUniformData(context.lightUBO.get(), &lightData, sizeof(LightData));
+            queue.submit(CmdCustom{[this, gBufferFramebuffer, inverseViewProjection,
                                     envRenderer, iblSettings,
-                                    enableShadows, shadowFB,
-                                    dirLightCount, envLight]() {
-                lightUBO->setData(&lightData, sizeof(LightData));
-
+                                    enableShadows, shadowFB]() {
                 m_pipeline->bind();
                 auto shader = m_pipeline->getShader();
 
@@ -170,50 +169,11 @@ namespace Fermion
                     shader->setInt("u_ShadowMap", 10);
                     shadowFB->bindDepthAttachment(10);
                 }
-
-                shader->setInt("u_DirLightCount", dirLightCount);
-                for (uint32_t i = 0; i < dirLightCount; i++)
-                {
-                    const auto& l = envLight.directionalLights[i + 1]; // Skip main light at index 0
-                    std::string base = "u_DirLights[" + std::to_string(i) + "]";
-                    shader->setFloat3(base + ".direction", l.direction);
-                    shader->setFloat3(base + ".color", l.color);
-                    shader->setFloat(base + ".intensity", l.intensity);
-                }
-
-                // Point and spot lights
-                uint32_t maxLights = 16;
-                uint32_t pointCount = std::min(maxLights, (uint32_t)envLight.pointLights.size());
-                shader->setInt("u_PointLightCount", pointCount);
-                for (uint32_t i = 0; i < pointCount; i++)
-                {
-                    const auto& l = envLight.pointLights[i];
-                    std::string base = "u_PointLights[" + std::to_string(i) + "]";
-                    shader->setFloat3(base + ".position", l.position);
-                    shader->setFloat3(base + ".color", l.color);
-                    shader->setFloat(base + ".intensity", l.intensity);
-                    shader->setFloat(base + ".range", l.range);
-                }
-
-                uint32_t spotCount = std::min(maxLights, (uint32_t)envLight.spotLights.size());
-                shader->setInt("u_SpotLightCount", spotCount);
-                for (uint32_t i = 0; i < spotCount; i++)
-                {
-                    const auto& l = envLight.spotLights[i];
-                    std::string base = "u_SpotLights[" + std::to_string(i) + "]";
-                    shader->setFloat3(base + ".position", l.position);
-                    shader->setFloat3(base + ".direction", glm::normalize(l.direction));
-                    shader->setFloat3(base + ".color", l.color);
-                    shader->setFloat(base + ".intensity", l.intensity);
-                    shader->setFloat(base + ".range", l.range);
-                    shader->setFloat(base + ".innerConeAngle", l.innerConeAngle);
-                    shader->setFloat(base + ".outerConeAngle", l.outerConeAngle);
-                }
             }});
 
             queue.submit(CmdDrawIndexed{m_quadVA, m_quadVA->getIndexBuffer()->getCount()});
         };
-        renderGraph.addPass(pass);
+        renderGraph.addPass(std::move(pass));
     }
 
 } // namespace Fermion
@@ -23,6 +23,8 @@ namespace Fermion
                      const GBufferRenderer& gBuffer,
                      const ShadowMapRenderer* shadowRenderer,
                      EnvironmentRenderer* envRenderer,
+                     ResourceHandle gBufferHandle,
+                     ResourceHandle shadowMap,
                      ResourceHandle lightingResult);
 
     private:
@@ -262,7 +262,7 @@ namespace Fermion
             RecordSkyboxPass(queue, cmd);
         };
 
-        renderGraph.addPass(pass);
+        renderGraph.addPass(std::move(pass));
     }
 
     TextureCube *EnvironmentRenderer::getEnvironmentCubemap() const
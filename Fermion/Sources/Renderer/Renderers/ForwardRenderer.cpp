@@ -6,8 +6,23 @@
 #include "Renderer/UniformBufferLayout.hpp"
 #include "Renderer/UniformBuffer.hpp"
 #include "Renderer/Pipeline.hpp"
+#include "Renderer/Framebuffer.hpp"
+#include "Renderer/Shader.hpp"
+#include "Renderer/Model/Material.hpp"
+
 namespace Fermion
 {
+    namespace
+    {
+        // Lights come from the light uniform buffer and the clustered light storage buffers; only the
+        // normal map settings are still plain uniforms
+        void bindSurfaceUniforms(Shader& shader, const RenderContext& context)
+        {
+            shader.setFloat("u_NormalStrength", context.normalMapStrength);
+            shader.setFloat("u_ToksvigStrength", context.toksvigStrength);
+        }
+    } // namespace
+
     ForwardRenderer::ForwardRenderer()
     {
         // Phong Mesh Pipeline
@@ -52,7 +67,7 @@ namespace Fermion
 
     void ForwardRenderer::addPass(RenderGraphLegacy& renderGraph,
                                    const RenderContext& context,
-                                   const std::vector<MeshDrawCommand>& drawList,
+                                   const MeshDrawList& drawList,
                                    const ShadowMapRenderer* shadowRenderer,
                                    EnvironmentRenderer* envRenderer,
                                    ResourceHandle shadowMap,
@@ -76,7 +91,7 @@ namespace Fermion
         }
         pass.Execute = [this, &context, &drawList, shadowRenderer, envRenderer, transparentOnly, geometryDrawCalls, iblDrawCalls](RenderCommandQueue& queue)
         {
-            std::shared_ptr<Pipeline> currentPipeline = nullptr;
+            Pipeline* currentPipeline = nullptr;
             EnvironmentRenderer::IBLSettings iblSettings = {
                 .useIBL = context.useIBL,
                 .irradianceMapSize = context.irradianceMapSize,
@@ -87,7 +102,6 @@ namespace Fermion
 
             // Update light uniform buffer once for all forward pass draws
             LightData lightData;
-            lightData.lightSpaceMatrix = shadowRenderer ? shadowRenderer->getLightSpaceMatrix() : glm::mat4(1.0f);
 
             // Main directional light (first one, used for shadow mapping)
             if (!context.environmentLight.directionalLights.empty())
@@ -107,148 +121,107 @@ namespace Fermion
             lightData.shadowBias = context.shadowBias;
             lightData.shadowSoftness = context.shadowSoftness;
             lightData.enableShadows = (context.enableShadows && shadowRenderer && shadowRenderer->getShadowMapFramebuffer()) ? 1 : 0;
-            lightData.numDirLights = std::max(0, std::min(4, (int)context.environmentLight.directionalLights.size() - 1));
+            if (lightData.enableShadows)
+                queue.submitUniformData(context.shadowUBO.get(), &shadowRenderer->getShadowData(), sizeof(ShadowData));
+            lightData.numDirLights = std::max(0, std::min((int)MAX_DIR_LIGHTS, (int)context.environmentLight.directionalLights.size() - 1));
+            for (int i = 0; i < lightData.numDirLights; i++)
+            {
+                const auto& l = context.environmentLight.directionalLights[i + 1]; // Skip main light at index 0
+                lightData.dirLights[i] = {.direction = l.direction, .intensity = l.intensity, .color = l.color};
+            }
             lightData.ambientIntensity = context.ambientIntensity;
-            lightData.numPointLights = std::min(16u, (uint32_t)context.environmentLight.pointLights.size());
-            lightData.numSpotLights = std::min(16u, (uint32_t)context.environmentLight.spotLights.size());
-            queue.submit(CmdCustom{[lightUBO = context.lightUBO, lightData]() {
-                lightUBO->setData(&lightData, sizeof(LightData));
-            }});
-
-            for (const auto& cmd : drawList)
+            lightData.numPointLights = (int)context.environmentLight.pointLights.size();
+            lightData.numSpotLights = (int)context.environmentLight.spotLights.size();
+            queue.submitUniformData(context.lightUBO.get(), &lightData, sizeof(LightData));
+
+            const bool enableShadows = context.enableShadows && shadowRenderer && shadowRenderer->getShadowMapFramebuffer();
+            const Framebuffer* shadowFB = enableShadows ? shadowRenderer->getShadowMapFramebuffer().get() : nullptr;
+
+            // Opaque runs come grouped by state and front to back, transparent ones back to front
+            const auto& instances = drawList.getInstances();
+            const Material* currentMaterial = nullptr;
+            uint32_t drawCalls = 0;
+            for (const MeshDrawRun& run : drawList.getRuns(transparentOnly ? MeshDrawBucket::Transparent : MeshDrawBucket::Opaque))
             {
-                if (!cmd.visible)
-                    continue;
-                if (cmd.transparent != transparentOnly)
-                    continue;
-                if (currentPipeline != cmd.pipeline)
+                const auto& cmd = drawList.getRunCommand(run);
+
+                // IBL, shadow and surface uniforms don't depend on the draw, so they are only bound when the
+                // pipeline changes; runs sharing pipeline and material are gathered into one indirect draw
+                if (currentPipeline != cmd.pipeline.get())
                 {
-                    currentPipeline = cmd.pipeline;
-                    queue.submit(CmdCustom{[pipeline = currentPipeline]() {
-                        pipeline->bind();
-                    }});
-                }
+                    drawCalls += m_drawBatch.flush(queue);
+                    currentPipeline = cmd.pipeline.get();
+                    currentMaterial = nullptr;
+                    const bool isPbr = cmd.pipeline == m_pbrPipeline || cmd.pipeline == m_skinnedPBRPipeline;
 
-                auto shader = currentPipeline->getShader();
+                    if (isPbr && envRenderer)
+                    {
+                        // May render the IBL maps, so it runs before the pipeline is bound
+                        queue.submitCustom([envRenderer, iblSettings, &context, iblDrawCalls]() {
+                            envRenderer->ensureIBLInitialized(iblSettings, context.targetFramebuffer,
+                                                              context.viewportWidth, context.viewportHeight, iblDrawCalls);
+                        });
+                    }
 
-                // Update model uniform buffer for this draw call
-                ModelData modelData;
-                modelData.model = cmd.transform;
-                modelData.normalMatrix = glm::transpose(glm::inverse(cmd.transform));
-                modelData.objectID = cmd.objectID;
-                queue.submit(CmdCustom{[modelUBO = context.modelUBO, modelData]() {
-                    modelUBO->setData(&modelData, sizeof(ModelData));
-                }});
+                    queue.submit(CmdBindPipeline{currentPipeline});
+                    queue.submitCustom([pipeline = currentPipeline, isPbr, envRenderer, iblSettings, &context]() {
+                        const auto& shader = pipeline->getSpecification().shader;
+                        if (isPbr)
+                        {
+                            if (envRenderer)
+                                envRenderer->bindIBL(shader, iblSettings);
+                            else
+                                shader->setBool("u_UseIBL", false);
+                        }
+                        bindSurfaceUniforms(*shader, context);
+                    });
 
-                // Upload bone matrices for skinned meshes
-                if (cmd.isSkinned && cmd.boneMatrices && !cmd.boneMatrices->empty())
-                {
-                    queue.submit(CmdCustom{[boneUBO = context.boneUBO, boneMatrices = cmd.boneMatrices]() {
-                        boneUBO->setData(boneMatrices->data(),
-                            static_cast<uint32_t>(boneMatrices->size() * sizeof(glm::mat4)));
-                    }});
+                    if (shadowFB)
+                    {
+                        queue.submitCustom([pipeline = currentPipeline]() {
+                            pipeline->getSpecification().shader->setInt("u_ShadowMap", 10);
+                        });
+                        queue.submit(CmdBindDepthAttachment{shadowFB, 10});
+                    }
                 }
 
-                if (cmd.pipeline == m_pbrPipeline || cmd.pipeline == m_skinnedPBRPipeline)
+                if (cmd.isSkinned)
                 {
-                    if (envRenderer)
-                    {
-                        queue.submit(CmdCustom{[envRenderer, iblSettings, targetFB = context.targetFramebuffer,
-                                                vpW = context.viewportWidth, vpH = context.viewportHeight,
-                                                iblDrawCalls, shader]() {
-                            envRenderer->ensureIBLInitialized(iblSettings, targetFB, vpW, vpH, iblDrawCalls);
-                            envRenderer->bindIBL(shader, iblSettings);
-                        }});
-                    }
-                    else
+                    drawCalls += m_drawBatch.flush(queue);
+
+                    // Skinned shaders still read the model uniform buffer; skinned runs are always a single draw
+                    queue.submitUniformData(context.modelUBO.get(), &instances[run.first], sizeof(ModelData));
+
+                    // Upload bone matrices for skinned meshes
+                    if (cmd.boneMatrices && !cmd.boneMatrices->empty())
                     {
-                        queue.submit(CmdCustom{[shader]() {
-                            shader->setBool("u_UseIBL", false);
-                        }});
+                        queue.submitUniformData(context.boneUBO.get(), cmd.boneMatrices->data(),
+                                                static_cast<uint32_t>(cmd.boneMatrices->size() * sizeof(glm::mat4)));
                     }
                 }
 
-                // Shadow mapping - bind shadow map texture
-                bool enableShadows = context.enableShadows && shadowRenderer && shadowRenderer->getShadowMapFramebuffer();
-                if (enableShadows)
+                if (cmd.material && cmd.material.get() != currentMaterial)
                 {
-                    queue.submit(CmdCustom{[shader, shadowFB = shadowRenderer->getShadowMapFramebuffer()]() {
-                        shader->setInt("u_ShadowMap", 10);
-                        shadowFB->bindDepthAttachment(10);
-                    }});
+                    drawCalls += m_drawBatch.flush(queue);
+                    currentMaterial = cmd.material.get();
+                    queue.submit(CmdBindMaterial{currentMaterial});
                 }
 
-                // Additional directional lights (excluding the main one)
-                uint32_t maxDirLights = 4;
-                uint32_t dirLightCount = 0;
-                if (context.environmentLight.directionalLights.size() > 1)
+                if (cmd.isSkinned)
                 {
-                    dirLightCount = std::min(maxDirLights, (uint32_t)(context.environmentLight.directionalLights.size() - 1));
+                    queue.submit(CmdDrawIndexed{cmd.vao, cmd.indexCount, cmd.indexOffset, cmd.baseVertex});
+                    drawCalls++;
                 }
-
-                // Capture light data for the CmdCustom lambda
+                else
                 {
-                    auto envLight = context.environmentLight;
-                    float normalStrength = context.normalMapStrength;
-                    float toksvigStrength = context.toksvigStrength;
-                    auto material = cmd.material;
-
-                    queue.submit(CmdCustom{[shader, dirLightCount, envLight, normalStrength, toksvigStrength, material]() {
-                        shader->setInt("u_DirLightCount", dirLightCount);
-                        for (uint32_t i = 0; i < dirLightCount; i++)
-                        {
-                            const auto& l = envLight.directionalLights[i + 1]; // Skip main light at index 0
-                            std::string base = "u_DirLights[" + std::to_string(i) + "]";
-                            shader->setFloat3(base + ".direction", l.direction);
-                            shader->setFloat3(base + ".color", l.color);
-                            shader->setFloat(base + ".intensity", l.intensity);
-                        }
-
-                        // Point lights
-                        uint32_t maxLights = 16;
-                        uint32_t pointCount = std::min(maxLights, (uint32_t)envLight.pointLights.size());
-                        shader->setInt("u_PointLightCount", pointCount);
-                        for (uint32_t i = 0; i < pointCount; i++)
-                        {
-                            const auto& l = envLight.pointLights[i];
-                            std::string base = "u_PointLights[" + std::to_string(i) + "]";
-                            shader->setFloat3(base + ".position", l.position);
-                            shader->setFloat3(base + ".color", l.color);
-                            shader->setFloat(base + ".intensity", l.intensity);
-                            shader->setFloat(base + ".range", l.range);
-                        }
-
-                        // Spot lights
-                        uint32_t spotCount = std::min(maxLights, (uint32_t)envLight.spotLights.size());
-                        shader->setInt("u_SpotLightCount", spotCount);
-                        for (uint32_t i = 0; i < spotCount; i++)
-                        {
-                            const auto& l = envLight.spotLights[i];
-                            std::string base = "u_SpotLights[" + std::to_string(i) + "]";
-                            shader->setFloat3(base + ".position", l.position);
-                            shader->setFloat3(base + ".direction", glm::normalize(l.direction));
-                            shader->setFloat3(base + ".color", l.color);
-                            shader->setFloat(base + ".intensity", l.intensity);
-                            shader->setFloat(base + ".range", l.range);
-                            shader->setFloat(base + ".innerConeAngle", l.innerConeAngle);
-                            shader->setFloat(base + ".outerConeAngle", l.outerConeAngle);
-                        }
-
-                        // Normal map strength
-                        shader->setFloat("u_NormalStrength", normalStrength);
-                        shader->setFloat("u_ToksvigStrength", toksvigStrength);
-
-                        if (material)
-                            material->bind(shader);
-                    }});
+                    drawCalls += m_drawBatch.addRun(queue, drawList, run);
                 }
-
-                queue.submit(CmdDrawIndexed{cmd.vao, cmd.indexCount, cmd.indexOffset});
-                if (geometryDrawCalls)
-                    (*geometryDrawCalls)++;
             }
+            drawCalls += m_drawBatch.flush(queue);
+            if (geometryDrawCalls)
+                *geometryDrawCalls += drawCalls;
         };
-        renderGraph.addPass(pass);
+        renderGraph.addPass(std::move(pass));
     }
 
 } // namespace Fermion
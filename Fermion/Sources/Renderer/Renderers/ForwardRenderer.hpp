@@ -1,7 +1,8 @@
 #pragma once
 #include "RenderContext.hpp"
 
-#include "Renderer/RenderDrawCommand.hpp"
+#include "Renderer/IndirectDrawBatch.hpp"
+#include "Renderer/MeshDrawList.hpp"
 #include "Renderer/RenderGraphLegacy.hpp"
 #include <memory>
 #include <vector>
@@ -19,7 +20,7 @@ namespace Fermion
 
         void addPass(RenderGraphLegacy& renderGraph,
                      const RenderContext& context,
-                     const std::vector<MeshDrawCommand>& drawList,
+                     const MeshDrawList& drawList,
                      const ShadowMapRenderer* shadowRenderer,
                      EnvironmentRenderer* envRenderer,
                      ResourceHandle shadowMap,
@@ -37,6 +38,7 @@ namespace Fermion
         std::shared_ptr<Pipeline> m_phongPipeline;
         std::shared_ptr<Pipeline> m_pbrPipeline;
         std::shared_ptr<Pipeline> m_skinnedPBRPipeline;
+        IndirectDrawBatch m_drawBatch;
     };
 
 } // namespace Fermion
@@ -78,7 +78,7 @@ namespace Fermion
 
     void GBufferRenderer::addPass(RenderGraphLegacy& renderGraph,
                                    const RenderContext& context,
-                                   const std::vector<MeshDrawCommand>& drawList,
+                                   const MeshDrawList& drawList,
                                    const std::shared_ptr<Pipeline>& forwardPbrPipeline,
                                    EnvironmentRenderer* environmentRenderer,
                                    ResourceHandle gBuffer,
@@ -118,10 +118,12 @@ namespace Fermion
                                                           iblDrawCalls);
             }
 
-            for (const auto& cmd : drawList)
+            const auto& instances = drawList.getInstances();
+            const Material* currentMaterial = nullptr;
+            uint32_t drawCalls = 0;
+            for (const MeshDrawRun& run : drawList.getRuns(MeshDrawBucket::Opaque))
             {
-                if (!cmd.visible || cmd.transparent)
-                    continue;
+                const auto& cmd = drawList.getRunCommand(run);
 
                 std::shared_ptr<Pipeline> desiredPipeline;
                 bool isPbr;
@@ -142,44 +144,54 @@ namespace Fermion
 
                 if (currentPipeline != desiredPipeline)
                 {
+                    drawCalls += m_drawBatch.flush(queue);
                     currentPipeline = desiredPipeline;
-                    queue.submit(CmdCustom{[currentPipeline, isPbr, &context]() {
-                        currentPipeline->bind();
-                        auto shader = currentPipeline->getShader();
-                        // Camera UBO is already bound globally
-                        if (isPbr)
-                        {
+                    currentMaterial = nullptr;
+                    queue.submit(CmdBindPipeline{currentPipeline});
+                    // Camera UBO is already bound globally
+                    if (isPbr)
+                    {
+                        queue.submitCustom([pipeline = currentPipeline.get(), &context]() {
+                            const auto& shader = pipeline->getSpecification().shader;
                             shader->setFloat("u_NormalStrength", context.normalMapStrength);
                             shader->setFloat("u_ToksvigStrength", context.toksvigStrength);
-                        }
-                    }});
+                        });
+                    }
                 }
 
-                // Update model uniform buffer for this draw call
-                ModelData modelData;
-                modelData.model = cmd.transform;
-                modelData.normalMatrix = glm::transpose(glm::inverse(cmd.transform));
-                modelData.objectID = cmd.objectID;
-
-                // Upload bone matrices for skinned meshes
-                if (cmd.isSkinned && cmd.boneMatrices && !cmd.boneMatrices->empty())
+                if (cmd.isSkinned)
                 {
-                    queue.submit(CmdCustom{[boneUBO = context.boneUBO, boneMatrices = cmd.boneMatrices]() {
-                        boneUBO->setData(boneMatrices->data(),
-                            static_cast<uint32_t>(boneMatrices->size() * sizeof(glm::mat4)));
-                    }});
+                    drawCalls += m_drawBatch.flush(queue);
+
+                    // Upload bone matrices for skinned meshes
+                    if (cmd.boneMatrices && !cmd.boneMatrices->empty())
+                    {
+                        queue.submitUniformData(context.boneUBO.get(), cmd.boneMatrices->data(),
+                                                static_cast<uint32_t>(cmd.boneMatrices->size() * sizeof(glm::mat4)));
+                    }
+                    queue.submitUniformData(context.modelUBO.get(), &instances[run.first], sizeof(ModelData));
                 }
 
-                queue.submit(CmdCustom{[modelUBO = context.modelUBO, modelData, currentPipeline, material = cmd.material]() {
-                    modelUBO->setData(&modelData, sizeof(ModelData));
-                    if (material)
-                        material->bind(currentPipeline->getShader());
-                }});
+                if (cmd.material && cmd.material.get() != currentMaterial)
+                {
+                    drawCalls += m_drawBatch.flush(queue);
+                    currentMaterial = cmd.material.get();
+                    queue.submit(CmdBindMaterial{currentMaterial});
+                }
 
-                queue.submit(CmdDrawIndexed{cmd.vao, cmd.indexCount, cmd.indexOffset});
-                if (geometryDrawCalls)
-                    (*geometryDrawCalls)++;
+                if (cmd.isSkinned)
+                {
+                    queue.submit(CmdDrawIndexed{cmd.vao, cmd.indexCount, cmd.indexOffset, cmd.baseVertex});
+                    drawCalls++;
+                }
+                else
+                {
+                    drawCalls += m_drawBatch.addRun(queue, drawList, run);
+                }
             }
+            drawCalls += m_drawBatch.flush(queue);
+            if (geometryDrawCalls)
+                *geometryDrawCalls += drawCalls;
 
             if (context.targetFramebuffer)
             {
@@ -204,7 +216,7 @@ namespace Fermion
                     queue.submit(CmdSetViewport{0, 0, context.viewportWidth, context.viewportHeight});
             }
         };
-        renderGraph.addPass(pass);
+        renderGraph.addPass(std::move(pass));
     }
 
 } // namespace Fermion
@@ -1,7 +1,8 @@
 #pragma once
 #include "RenderContext.hpp"
 #include "Renderer/Framebuffer.hpp"
-#include "Renderer/RenderDrawCommand.hpp"
+#include "Renderer/IndirectDrawBatch.hpp"
+#include "Renderer/MeshDrawList.hpp"
 #include "Renderer/RenderGraphLegacy.hpp"
 #include <memory>
 #include <vector>
@@ -27,7 +28,7 @@ namespace Fermion
 
         void addPass(RenderGraphLegacy& renderGraph,
                      const RenderContext& context,
-                     const std::vector<MeshDrawCommand>& drawList,
+                     const MeshDrawList& drawList,
                      const std::shared_ptr<Pipeline>& pbrPipeline,
                      EnvironmentRenderer* environmentRenderer,
                      ResourceHandle gBuffer,
@@ -61,6 +62,7 @@ namespace Fermion
         std::shared_ptr<Pipeline> m_pbrPipeline;
         std::shared_ptr<Pipeline> m_skinnedGBufferPipeline;
         std::shared_ptr<Framebuffer> m_framebuffer;
+        IndirectDrawBatch m_drawBatch;
     };
 
 } // namespace Fermion
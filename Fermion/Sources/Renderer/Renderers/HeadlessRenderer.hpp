@@ -0,0 +1,16 @@
+#pragma once
+#include "SceneRenderer.hpp"
+
+namespace Fermion
+{
+    // No-op SceneRenderer for running scenes without a GL context (dedicated servers, batch simulation,
+    // tests). Scene::onUpdateRuntime still runs scripts, physics and animation, then returns before
+    // any camera lookup, culling or draw submission.
+    class HeadlessRenderer : public SceneRenderer
+    {
+    public:
+        HeadlessRenderer() : SceneRenderer(HeadlessTag{})
+        {
+        }
+    };
+} // namespace Fermion
@@ -79,7 +79,7 @@ namespace Fermion
             render(queue, context, settings);
         };
 
-        renderGraph.addPass(pass);
+        renderGraph.addPass(std::move(pass));
     }
 
     void InfiniteGridRenderer::render(RenderCommandQueue& queue, const RenderContext& context, const Settings& settings)
@@ -79,7 +79,7 @@ namespace Fermion
                 }
             }
         };
-        renderGraph.addPass(pass);
+        renderGraph.addPass(std::move(pass));
     }
 
 } // namespace Fermion
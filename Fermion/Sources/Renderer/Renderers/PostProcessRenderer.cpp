@@ -94,7 +94,7 @@ namespace Fermion
 
             queue.submit(CmdDrawIndexed{m_quadVA, m_quadVA->getIndexBuffer()->getCount()});
         };
-        renderGraph.addPass(pass);
+        renderGraph.addPass(std::move(pass));
     }
 
     void PostProcessRenderer::addGBufferDebugPass(RenderGraphLegacy& renderGraph,
@@ -153,7 +153,7 @@ namespace Fermion
 
             queue.submit(CmdDrawIndexed{m_quadVA, m_quadVA->getIndexBuffer()->getCount()});
         };
-        renderGraph.addPass(pass);
+        renderGraph.addPass(std::move(pass));
     }
 
 } // namespace Fermion
@@ -25,6 +25,7 @@ namespace Fermion
         std::shared_ptr<UniformBuffer> modelUBO;
         std::shared_ptr<UniformBuffer> lightUBO;
         std::shared_ptr<UniformBuffer> boneUBO;
+        std::shared_ptr<UniformBuffer> shadowUBO;
 
         // Scene data
         SceneRendererCamera camera;
@@ -1,6 +1,7 @@
 ﻿
 #include "Renderer/Renderers/Renderer.hpp"
 #include "Renderer/Renderers/Renderer2DCompat.hpp"
+#include "Renderer/GeometryPool.hpp"
 #include "OpenGLShader.hpp"
 namespace Fermion
 {
@@ -11,6 +12,7 @@ namespace Fermion
 
         s_rendererAPI = RendererAPI::create();
         s_rendererAPI->init();
+        Shader::setCacheDirectory(s_config.ShaderCachePath);
 
         s_shaderLibrary = std::make_unique<ShaderLibrary>();
 
@@ -52,6 +54,7 @@ namespace Fermion
     }
     void Renderer::shutdown()
     {
+        GeometryPool::shutdown();
     }
 
     void Renderer::onWindowResize(uint32_t width, uint32_t height)
@@ -597,7 +597,7 @@ namespace Fermion
                                         self->m_QuadBatch->getIndexCount()});
             self->m_Stats.drawCalls++;
         };
-        m_RenderGraph->addPass(pass);
+        m_RenderGraph->addPass(std::move(pass));
     }
 
     void Renderer2D::quadInstancePass()
@@ -617,7 +617,7 @@ namespace Fermion
                                                  6, self->m_QuadBatch->getInstanceCount()});
             self->m_Stats.drawCalls++;
         };
-        m_RenderGraph->addPass(pass);
+        m_RenderGraph->addPass(std::move(pass));
     }
 
     void Renderer2D::circlePass()
@@ -636,7 +636,7 @@ namespace Fermion
                                         self->m_CircleBatch->getIndexCount()});
             self->m_Stats.drawCalls++;
         };
-        m_RenderGraph->addPass(pass);
+        m_RenderGraph->addPass(std::move(pass));
     }
 
     void Renderer2D::linePass()
@@ -656,7 +656,7 @@ namespace Fermion
                                       self->m_LineBatch->getVertexCount()});
             self->m_Stats.drawCalls++;
         };
-        m_RenderGraph->addPass(pass);
+        m_RenderGraph->addPass(std::move(pass));
     }
 
     void Renderer2D::textPass()
@@ -676,7 +676,7 @@ namespace Fermion
                                         self->m_TextBatch->getIndexCount()});
             self->m_Stats.drawCalls++;
         };
-        m_RenderGraph->addPass(pass);
+        m_RenderGraph->addPass(std::move(pass));
     }
 
 } // namespace Fermion
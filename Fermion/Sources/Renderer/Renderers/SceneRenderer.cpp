@@ -4,6 +4,8 @@
 
 #include "Renderer/Framebuffer.hpp"
 #include "Renderer/UniformBuffer.hpp"
+#include "Renderer/StorageBuffer.hpp"
+#include "Renderer/UniformRingBuffer.hpp"
 #include "Renderer/UniformBufferLayout.hpp"
 #include "EnvironmentRenderer.hpp"
 #include "ShadowMapRenderer.hpp"
@@ -34,6 +36,24 @@ namespace Fermion
 
             return false;
         }
+
+        // Grows the buffer by doubling so it settles after a few frames, then uploads
+        void uploadStorage(StorageBuffer &buffer, const void *data, uint32_t size)
+        {
+            if (size == 0)
+                return;
+
+            if (buffer.getSize() < size)
+            {
+                uint32_t capacity = buffer.getSize();
+                while (capacity < size)
+                    capacity *= 2;
+                buffer.resize(capacity);
+            }
+
+            buffer.bind();
+            buffer.setData(data, size);
+        }
     }
 
     SceneRenderer::SceneRenderer()
@@ -45,6 +65,20 @@ namespace Fermion
         m_modelUniformBuffer = UniformBuffer::create(UniformBufferBinding::Model, ModelData::getSize());
         m_lightUniformBuffer = UniformBuffer::create(UniformBufferBinding::Lights, LightData::getSize());
         m_boneUniformBuffer = UniformBuffer::create(UniformBufferBinding::Bones, BoneData::getSize());
+        m_shadowUniformBuffer = UniformBuffer::create(UniformBufferBinding::Shadow, ShadowData::getSize());
+        m_instanceStorageBuffer = StorageBuffer::create(StorageBufferBinding::Instances, 1024 * ModelData::getSize());
+
+        // Clustered light lists; the cluster buffer has a fixed size, the others grow with the scene
+        m_lightClusterGridUniformBuffer = UniformBuffer::create(UniformBufferBinding::LightClusterGrid, LightClusterGridData::getSize());
+        m_pointLightStorageBuffer = StorageBuffer::create(StorageBufferBinding::PointLights, 256 * PointLightData::getSize());
+        m_spotLightStorageBuffer = StorageBuffer::create(StorageBufferBinding::SpotLights, 256 * SpotLightData::getSize());
+        m_lightClusterStorageBuffer = StorageBuffer::create(StorageBufferBinding::LightClusters,
+                                                            LightClusterGrid::ClusterCount * LightClusterData::getSize());
+        m_lightIndexStorageBuffer = StorageBuffer::create(StorageBufferBinding::LightIndices, 64 * 1024 * sizeof(uint32_t));
+
+        // Per-draw model, bone, light and instance batch blocks are written here instead of into the UBOs above
+        m_uniformRingBuffer = UniformRingBuffer::create(2 * 1024 * 1024);
+        m_commandQueue.setUniformRing(m_uniformRingBuffer.get());
 
         // Initialize sub-renderers
         m_gBufferRenderer = std::make_unique<GBufferRenderer>();
@@ -57,10 +91,23 @@ namespace Fermion
         m_proceduralSkyGenerator = std::make_unique<ProceduralSkyGenerator>();
         m_infiniteGridRenderer = std::make_unique<InfiniteGridRenderer>();
 
+        // Shared by every submesh without a material, so they keep one UBO and one sort key and still batch
+        m_defaultMaterial = std::make_shared<Material>();
+        m_defaultMaterial->setMaterialType(MaterialType::PBR);
+        m_defaultMaterial->setAlbedo(glm::vec3(1.0f, 1.0f, 1.0f));
+        m_defaultMaterial->setMetallic(0.0f);
+        m_defaultMaterial->setRoughness(1.0f);
+        m_defaultMaterial->setAO(1.0f);
+
         // Use procedural sky as default environment
         generateProceduralSky();
     }
 
+    SceneRenderer::SceneRenderer(HeadlessTag) : m_headless(true)
+    {
+        m_debugRenderer = std::make_shared<DebugRenderer>();
+    }
+
     SceneRenderer::~SceneRenderer() = default;
 
     void SceneRenderer::resetStatistics()
@@ -135,6 +182,10 @@ namespace Fermion
         cameraData.projection = camera.camera.getProjection();
         cameraData.position = cameraPosition;
         m_cameraUniformBuffer->setData(&cameraData, sizeof(CameraData));
+
+        m_cameraPosition = cameraPosition;
+        m_occlusionCuller.begin(viewProjection);
+        m_meshletCuller.begin(viewProjection, cameraPosition);
     }
 
     void SceneRenderer::updateRenderContext()
@@ -143,6 +194,7 @@ namespace Fermion
         m_renderContext.modelUBO = m_modelUniformBuffer;
         m_renderContext.lightUBO = m_lightUniformBuffer;
         m_renderContext.boneUBO = m_boneUniformBuffer;
+        m_renderContext.shadowUBO = m_shadowUniformBuffer;
         m_renderContext.camera = m_sceneData.sceneCamera;
         m_renderContext.environmentLight = m_sceneData.sceneEnvironmentLight;
         m_renderContext.viewportWidth = m_scene ? m_scene->getViewportWidth() : 0;
@@ -168,11 +220,17 @@ namespace Fermion
     {
         FlushDrawList();
         Renderer2DCompat::endScene();
+
+        // Objects not drawn this frame forget their LOD, so deleted entities don't pile up and a reused
+        // entity ID doesn't inherit someone else's hysteresis
+        std::erase_if(m_meshLods, [this](const auto &entry)
+                      { return entry.second.lastFrame != m_lodFrame; });
+        ++m_lodFrame;
     }
 
     void SceneRenderer::endOverlay()
     {
-        for (auto &cmd : m_meshDrawList)
+        for (const auto &cmd : m_meshDrawList.getCommands())
         {
             if (cmd.drawOutline && cmd.visible)
                 Renderer2DCompat::drawAABB(cmd.aabb, cmd.transform, m_sceneData.meshOutlineColor, cmd.objectID);
@@ -234,7 +292,8 @@ namespace Fermion
         Renderer2DCompat::drawQuadBillboard(translation, size, texture, tilingFactor, tintColor, objectId);
     }
 
-    void SceneRenderer::submitMesh(MeshComponent &meshComponent, glm::mat4 transform, int objectId, bool drawOutline)
+    void SceneRenderer::submitMesh(MeshComponent &meshComponent, glm::mat4 transform, int objectId, bool drawOutline,
+                                   std::optional<bool> visibility)
     {
         if (static_cast<uint64_t>(meshComponent.meshHandle) != 0)
         {
@@ -244,12 +303,13 @@ namespace Fermion
             {
                 auto vao = mesh->getVertexArray();
                 const auto &submeshes = mesh->getSubMeshes();
-                bool visible = true;
-                if (m_hasCameraFrustum)
+                bool visible = visibility.value_or(true);
+                if (!visibility && m_hasCameraFrustum)
                 {
                     const AABB worldAabb = AABB::TransformAABB(mesh->getBoundingBox(), transform);
                     visible = Math::IsAABBInsideFrustum(m_cameraFrustumPlanes, worldAabb);
                 }
+                const uint32_t lod = selectMeshLod(*mesh, transform, objectId);
                 for (size_t i = 0; i < submeshes.size(); i++)
                 {
                     const auto &submesh = submeshes[i];
@@ -262,14 +322,7 @@ namespace Fermion
                     }
 
                     if (!material)
-                    {
-                        material = std::make_shared<Material>();
-                        material->setMaterialType(MaterialType::PBR);
-                        material->setAlbedo(glm::vec3(1.0f, 1.0f, 1.0f));
-                        material->setMetallic(0.0f);
-                        material->setRoughness(1.0f);
-                        material->setAO(1.0f);
-                    }
+                        material = m_defaultMaterial;
 
                     // Create draw command using forward renderer pipelines
                     MaterialType matType = material->getType();
@@ -278,21 +331,74 @@ namespace Fermion
                     cmd.vao = vao;
                     cmd.material = material;
                     cmd.transform = transform;
-                    cmd.indexCount = submesh.IndexCount;
-                    cmd.indexOffset = submesh.IndexOffset;
+                    const SubMeshLod range = mesh->getSubMeshLod(i, lod);
+                    cmd.indexCount = range.IndexCount;
+                    cmd.indexOffset = mesh->getFirstIndex() + range.IndexOffset;
+                    cmd.baseVertex = mesh->getSubMeshBaseVertex(i);
                     cmd.objectID = objectId;
                     cmd.drawOutline = drawOutline;
                     cmd.visible = visible;
+                    // Occluded submeshes still cast shadows, so they stay in the list as invisible draws
+                    if (visible && m_sceneData.occlusionCulling)
+                    {
+                        const AABB worldAabb = AABB::TransformAABB(mesh->getSubMeshBounds(i), transform);
+                        cmd.visible = !m_occlusionCuller.isOccluded(worldAabb);
+                    }
+                    // Coarser levels have no meshlets. A draw that keeps every meshlet stays a single range so it
+                    // can still be instanced, and one that keeps none still casts shadows like an occluded one
+                    const auto meshlets = mesh->getSubMeshMeshlets(i);
+                    if (cmd.visible && lod == 0 && m_sceneData.meshletCulling && !meshlets.empty())
+                    {
+                        const bool backfaceCulling = cmd.pipeline->getSpecification().cull == CullMode::Back;
+                        const uint32_t kept = m_meshletCuller.cull(meshlets, transform, backfaceCulling);
+                        if (kept == 0)
+                        {
+                            cmd.visible = false;
+                        }
+                        else if (kept < cmd.indexCount)
+                        {
+                            const auto &counts = m_meshletCuller.getIndexCounts();
+                            cmd.rangeCount = static_cast<uint32_t>(counts.size());
+                            cmd.firstRange = m_meshDrawList.addRanges(counts.data(),
+                                                                      m_meshletCuller.getIndexOffsets().data(),
+                                                                      cmd.rangeCount, mesh->getFirstIndex());
+                        }
+                    }
                     cmd.transparent = IsTransparentMaterial(material);
                     cmd.aabb = mesh->getBoundingBox();
 
-                    m_meshDrawList.emplace_back(std::move(cmd));
+                    m_meshDrawList.add(std::move(cmd));
                 }
             }
         }
     }
 
-    void SceneRenderer::submitSkinnedMesh(MeshComponent &meshComponent, AnimatorComponent &animator, glm::mat4 transform, int objectId, bool drawOutline)
+    void SceneRenderer::submitOccluder(const MeshComponent &meshComponent, const glm::mat4 &transform, bool flagged)
+    {
+        if (!m_sceneData.occlusionCulling || static_cast<uint64_t>(meshComponent.meshHandle) == 0)
+            return;
+
+        auto assetManager = Project::getRuntimeAssetManager();
+        auto mesh = assetManager->getAsset<Mesh>(meshComponent.meshHandle);
+        if (!mesh)
+            return;
+
+        // Whatever shows through a see-through submesh would be culled, so only a flagged mesh may occlude with one
+        if (!flagged)
+        {
+            for (size_t i = 0; i < mesh->getSubMeshes().size(); i++)
+            {
+                AssetHandle materialHandle = meshComponent.getSubmeshMaterial(static_cast<uint32_t>(i));
+                if (static_cast<uint64_t>(materialHandle) != 0 &&
+                    IsTransparentMaterial(assetManager->getAsset<Material>(materialHandle)))
+                    return;
+            }
+        }
+        m_occlusionCuller.addOccluder(mesh, transform, flagged);
+    }
+
+    void SceneRenderer::submitSkinnedMesh(MeshComponent &meshComponent, AnimatorComponent &animator, glm::mat4 transform, int objectId, bool drawOutline,
+                                          std::optional<bool> visibility)
     {
         if (static_cast<uint64_t>(meshComponent.meshHandle) == 0)
             return;
@@ -305,7 +411,7 @@ namespace Fermion
         // If mesh is not skinned, fall back to regular mesh rendering
         if (!mesh->isSkinned())
         {
-            submitMesh(meshComponent, transform, objectId, drawOutline);
+            submitMesh(meshComponent, transform, objectId, drawOutline, visibility);
             return;
         }
 
@@ -325,7 +431,7 @@ namespace Fermion
         // If still no skeleton, fall back to regular rendering
         if (!skeleton)
         {
-            submitMesh(meshComponent, transform, objectId, drawOutline);
+            submitMesh(meshComponent, transform, objectId, drawOutline, visibility);
             return;
         }
 
@@ -386,12 +492,13 @@ namespace Fermion
 
         auto vao = mesh->getVertexArray();
         const auto &submeshes = mesh->getSubMeshes();
-        bool visible = true;
-        if (m_hasCameraFrustum)
+        bool visible = visibility.value_or(true);
+        if (!visibility && m_hasCameraFrustum)
         {
             const AABB worldAabb = AABB::TransformAABB(mesh->getBoundingBox(), transform);
             visible = Math::IsAABBInsideFrustum(m_cameraFrustumPlanes, worldAabb);
         }
+        const uint32_t lod = selectMeshLod(*mesh, transform, objectId);
 
         const std::vector<glm::mat4>* boneMatrices = &animator.runtimeAnimator->getFinalBoneMatrices();
 
@@ -407,14 +514,7 @@ namespace Fermion
             }
 
             if (!material)
-            {
-                material = std::make_shared<Material>();
-                material->setMaterialType(MaterialType::PBR);
-                material->setAlbedo(glm::vec3(1.0f, 1.0f, 1.0f));
-                material->setMetallic(0.0f);
-                material->setRoughness(1.0f);
-                material->setAO(1.0f);
-            }
+                material = m_defaultMaterial;
 
             // Create draw command using skinned pipelines
             MeshDrawCommand cmd;
@@ -422,8 +522,10 @@ namespace Fermion
             cmd.vao = vao;
             cmd.material = material;
             cmd.transform = transform;
-            cmd.indexCount = submesh.IndexCount;
-            cmd.indexOffset = submesh.IndexOffset;
+            const SubMeshLod range = mesh->getSubMeshLod(i, lod);
+            cmd.indexCount = range.IndexCount;
+            cmd.indexOffset = mesh->getFirstIndex() + range.IndexOffset;
+            cmd.baseVertex = mesh->getSubMeshBaseVertex(i);
             cmd.objectID = objectId;
             cmd.drawOutline = drawOutline;
             cmd.visible = visible;
@@ -432,10 +534,47 @@ namespace Fermion
             cmd.isSkinned = true;
             cmd.boneMatrices = boneMatrices;
 
-            m_meshDrawList.emplace_back(std::move(cmd));
+            m_meshDrawList.add(std::move(cmd));
         }
     }
 
+    uint32_t SceneRenderer::selectMeshLod(const Mesh &mesh, const glm::mat4 &transform, int objectId)
+    {
+        // LOD 0 down to a bounding sphere this tall, relative to the viewport; each level covers half the size
+        constexpr float kLodScreenSize = 0.5f;
+        // Fraction of a level the size has to pass a boundary by before an object switches
+        constexpr float kLodHysteresis = 0.15f;
+
+        const uint32_t lodCount = mesh.getLodCount();
+        if (lodCount <= 1)
+            return 0;
+
+        const AABB &bounds = mesh.getBoundingBox();
+        const glm::vec3 center = glm::vec3(transform * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.0f));
+        const float scale = std::max({glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])),
+                                      glm::length(glm::vec3(transform[2]))});
+        const float radius = glm::length(bounds.max - bounds.min) * 0.5f * scale;
+
+        const glm::mat4 &projection = m_sceneData.sceneCamera.camera.getProjection();
+        float screenSize = radius * std::abs(projection[1][1]);
+        if (projection[3][3] == 0.0f)
+            screenSize /= std::max(glm::length(center - m_cameraPosition), 1e-4f);
+
+        const float level = std::log2(kLodScreenSize / std::max(screenSize, 1e-6f)) + m_sceneData.meshLodBias;
+        const uint32_t target = static_cast<uint32_t>(std::clamp(std::floor(level), 0.0f, static_cast<float>(lodCount - 1)));
+        if (objectId < 0)
+            return target;
+
+        auto [it, inserted] = m_meshLods.try_emplace(objectId, MeshLodState{target, m_lodFrame});
+        MeshLodState &state = it->second;
+        if (!inserted && (level < static_cast<float>(state.level) - kLodHysteresis ||
+                          level > static_cast<float>(state.level + 1) + kLodHysteresis))
+            state.level = target;
+        state.level = std::min(state.level, lodCount - 1);
+        state.lastFrame = m_lodFrame;
+        return state.level;
+    }
+
     void SceneRenderer::drawInfiniteLine(const glm::vec3 &point, const glm::vec3 &direction, const glm::vec4 &color)
     {
         float big = m_sceneData.sceneCamera.farClip * 2.0f;
@@ -471,6 +610,17 @@ namespace Fermion
         updateRenderContext();
 
         m_renderer3DStatistics.meshCount += static_cast<uint32_t>(m_meshDrawList.size());
+        const OcclusionCuller::Statistics &occlusion = m_occlusionCuller.getStatistics();
+        m_renderer3DStatistics.occluderCount += occlusion.occluders;
+        m_renderer3DStatistics.occluderTriangles += occlusion.occluderTriangles;
+        m_renderer3DStatistics.occlusionTested += occlusion.tested;
+        m_renderer3DStatistics.occlusionCulled += occlusion.culled;
+        const MeshletCuller::Statistics &meshlets = m_meshletCuller.getStatistics();
+        m_renderer3DStatistics.meshletsTested += meshlets.tested;
+        m_renderer3DStatistics.meshletsCulled += meshlets.culled;
+        m_meshDrawList.sort(m_sceneData.sceneCamera.view);
+        uploadInstances();
+        uploadLightClusters();
 
         const FrameFlags flags = PrepareFrameFlags();
         const FrameResources resources = PrepareResources(flags);
@@ -484,11 +634,44 @@ namespace Fermion
         AddPostProcessingPasses(resources, flags);
 
 
+        m_uniformRingBuffer->beginFrame();
         m_renderGraph.execute(m_commandQueue, Renderer::getRendererAPI());
+        m_uniformRingBuffer->endFrame();
         m_meshDrawList.clear();
         m_outlineIDs.clear();
     }
 
+    void SceneRenderer::uploadInstances()
+    {
+        const auto &instances = m_meshDrawList.getInstances();
+        uploadStorage(*m_instanceStorageBuffer, instances.data(),
+                      static_cast<uint32_t>(instances.size()) * ModelData::getSize());
+    }
+
+    void SceneRenderer::uploadLightClusters()
+    {
+        m_lightClusterGrid.build(m_renderContext.environmentLight,
+                                 m_renderContext.camera.view,
+                                 m_renderContext.camera.camera.getProjection(),
+                                 m_renderContext.viewportWidth,
+                                 m_renderContext.viewportHeight);
+
+        m_lightClusterGridUniformBuffer->setData(&m_lightClusterGrid.getGridData(), sizeof(LightClusterGridData));
+
+        const auto &pointLights = m_lightClusterGrid.getPointLights();
+        const auto &spotLights = m_lightClusterGrid.getSpotLights();
+        const auto &clusters = m_lightClusterGrid.getClusters();
+        const auto &indices = m_lightClusterGrid.getLightIndices();
+        uploadStorage(*m_pointLightStorageBuffer, pointLights.data(),
+                      static_cast<uint32_t>(pointLights.size()) * PointLightData::getSize());
+        uploadStorage(*m_spotLightStorageBuffer, spotLights.data(),
+                      static_cast<uint32_t>(spotLights.size()) * SpotLightData::getSize());
+        uploadStorage(*m_lightClusterStorageBuffer, clusters.data(),
+                      static_cast<uint32_t>(clusters.size()) * LightClusterData::getSize());
+        uploadStorage(*m_lightIndexStorageBuffer, indices.data(),
+                      static_cast<uint32_t>(indices.size() * sizeof(uint32_t)));
+    }
+
     void SceneRenderer::setOutlineIDs(const std::vector<int> &ids)
     {
         m_outlineIDs = ids;
@@ -523,18 +706,27 @@ namespace Fermion
 
         uint32_t viewportWidth = m_scene ? m_scene->getViewportWidth() : 0;
         uint32_t viewportHeight = m_scene ? m_scene->getViewportHeight() : 0;
+        const auto &settings = m_sceneData.environmentSettings;
+        ShadowCascadeSettings cascadeSettings;
+        cascadeSettings.mapSize = settings.shadowMapSize;
+        cascadeSettings.cascadeCount = settings.shadowCascadeCount;
+        cascadeSettings.splitLambda = settings.shadowCascadeSplitLambda;
+        cascadeSettings.maxDistance = settings.shadowDistance;
+        cascadeSettings.staticCache = settings.shadowStaticCache;
+        cascadeSettings.cacheUpdateBudget = settings.shadowCacheUpdateBudget;
         m_shadowRenderer->addPass(
             m_renderGraph,
             shadowMap,
             m_meshDrawList,
             m_sceneData.sceneEnvironmentLight.directionalLights[0],
-            m_sceneData.environmentSettings.shadowMapSize,
+            m_renderContext.camera,
+            cascadeSettings,
             m_targetFramebuffer,
             viewportWidth,
             viewportHeight,
             &m_renderer3DStatistics.shadowDrawCalls,
             m_modelUniformBuffer,
-            m_lightUniformBuffer,
+            m_shadowUniformBuffer,
             m_boneUniformBuffer);
     }
 
@@ -544,16 +736,7 @@ namespace Fermion
         flags.useDeferred = m_sceneData.renderMode == RenderMode::DeferredHybrid;
         flags.showGBufferDebug = flags.useDeferred && (m_sceneData.gbufferDebug != GBufferDebugMode::None);
 
-        bool hasTransparent = false;
-        for (const auto &cmd : m_meshDrawList)
-        {
-            if (cmd.transparent)
-            {
-                hasTransparent = true;
-                break;
-            }
-        }
-        flags.hasTransparent = hasTransparent;
+        flags.hasTransparent = m_meshDrawList.hasTransparent();
 
         return flags;
     }
@@ -568,6 +751,9 @@ namespace Fermion
         resources.gBuffer = m_renderGraph.createResource();
         resources.lightingResult = m_renderGraph.createResource();
         resources.sceneDepth = m_renderGraph.createResource();
+        // The scene color is what this graph exists for; anything that doesn't feed it (directly or through
+        // a pass without outputs) is culled
+        m_renderGraph.markOutput(resources.lightingResult);
 
         const uint32_t viewportWidth = m_renderContext.viewportWidth;
         const uint32_t viewportHeight = m_renderContext.viewportHeight;
@@ -624,6 +810,8 @@ namespace Fermion
                 *m_gBufferRenderer,
                 m_shadowRenderer.get(),
                 m_environmentRenderer.get(),
+                resources.gBuffer,
+                resources.shadowMap,
                 resources.lightingResult);
 
             if (m_sceneData.environmentSettings.showSkybox)
@@ -733,7 +921,7 @@ namespace Fermion
             m_renderGraph,
             m_renderContext,
             flags.useDeferred ? m_gBufferRenderer.get() : nullptr,
-            m_meshDrawList,
+            m_meshDrawList.getCommands(),
             m_outlineIDs,
             outlineSettings,
             resources.gBuffer,
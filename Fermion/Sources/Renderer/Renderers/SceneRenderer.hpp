@@ -8,7 +8,13 @@
 #include "Renderer/Framebuffer.hpp"
 #include "Renderer/RenderGraphLegacy.hpp"
 #include "Renderer/RenderDrawCommand.hpp"
+#include "Renderer/MeshDrawList.hpp"
+#include "Renderer/LightClusterGrid.hpp"
+#include "Renderer/MeshletCuller.hpp"
+#include "Renderer/OcclusionCuller.hpp"
 #include <array>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 #include "Renderer/RenderCommandQueue.hpp"
 #include "ProceduralSkyGenerator.hpp"
@@ -25,6 +31,8 @@ namespace Fermion
     class PostProcessRenderer;
     class InfiniteGridRenderer;
     class UniformBuffer;
+    class StorageBuffer;
+    class UniformRingBuffer;
 
     class SceneRenderer
     {
@@ -68,6 +76,14 @@ namespace Fermion
             uint32_t shadowMapSize = 2048;
             float shadowBias = 0.01f;
             float shadowSoftness = 1.0f;
+            // Cascades cover the view up to shadowDistance; lambda blends uniform (0) and logarithmic (1) splits
+            uint32_t shadowCascadeCount = 4;
+            float shadowCascadeSplitLambda = 0.75f;
+            float shadowDistance = 150.0f;
+            // Casters that haven't moved for a while are kept in a cached depth layer per cascade; at most
+            // shadowCacheUpdateBudget cascades re-render that layer per frame
+            bool shadowStaticCache = true;
+            uint32_t shadowCacheUpdateBudget = 2;
             float normalMapStrength = 1.0f;
             float toksvigStrength = 1.0f;
 
@@ -87,6 +103,12 @@ namespace Fermion
 
             RenderMode renderMode = RenderMode::DeferredHybrid;
             GBufferDebugMode gbufferDebug = GBufferDebugMode::None;
+            // Hide draws behind the occluders rasterized on the CPU
+            bool occlusionCulling = true;
+            // Draw only the meshlets of full-detail meshes that are inside the frustum and facing the camera
+            bool meshletCulling = true;
+            // Added to every mesh's LOD level before rounding; positive values switch to coarser levels sooner
+            float meshLodBias = 0.0f;
 
             // IBL settings
             uint32_t irradianceMapSize = 32;
@@ -137,6 +159,13 @@ namespace Fermion
                 uint32_t skyboxDrawCalls = 0;
                 uint32_t iblDrawCalls = 0;
 
+                uint32_t occluderCount = 0;
+                uint32_t occluderTriangles = 0;
+                uint32_t occlusionTested = 0;
+                uint32_t occlusionCulled = 0;
+                uint32_t meshletsTested = 0;
+                uint32_t meshletsCulled = 0;
+
                 uint32_t getTotalDrawCalls() const
                 {
                     return geometryDrawCalls + shadowDrawCalls + skyboxDrawCalls + iblDrawCalls;
@@ -163,7 +192,13 @@ namespace Fermion
         };
 
         SceneRenderer();
-        ~SceneRenderer();
+        virtual ~SceneRenderer();
+
+        // True for sinks with no GPU state; scenes skip culling and draw submission for them
+        bool isHeadless() const
+        {
+            return m_headless;
+        }
 
         void beginScene(const Camera &camera, const glm::mat4 &transform);
 
@@ -210,12 +245,28 @@ namespace Fermion
 
         void setLineWidth(float thickness);
 
-        void submitMesh(MeshComponent &meshComponent, glm::mat4 transform, int objectId = -1, bool drawOutline = false);
+        // 'visibility' lets callers that already culled (the scene BVH) skip the per-mesh frustum test
+        void submitMesh(MeshComponent &meshComponent, glm::mat4 transform, int objectId = -1, bool drawOutline = false,
+                        std::optional<bool> visibility = std::nullopt);
 
-        void submitSkinnedMesh(MeshComponent &meshComponent, AnimatorComponent &animator, glm::mat4 transform, int objectId = -1, bool drawOutline = false);
+        void submitSkinnedMesh(MeshComponent &meshComponent, AnimatorComponent &animator, glm::mat4 transform, int objectId = -1, bool drawOutline = false,
+                               std::optional<bool> visibility = std::nullopt);
+
+        // Offers a mesh as an occluder for the meshes submitted after it; flagged occluders are always used,
+        // the others only if they are opaque, large on screen and cheap enough
+        void submitOccluder(const MeshComponent &meshComponent, const glm::mat4 &transform, bool flagged);
+
+        // Planes of the camera passed to the last beginScene/beginOverlay
+        const std::array<glm::vec4, 6> &getCameraFrustumPlanes() const
+        {
+            return m_cameraFrustumPlanes;
+        }
 
         void setScene(std::shared_ptr<Scene> scene)
         {
+            // Object IDs are entity handles, which mean something else in another scene
+            if (m_scene != scene)
+                m_meshLods.clear();
             m_scene = scene;
         }
 
@@ -250,6 +301,14 @@ namespace Fermion
 
         void bindGBufferAttachment(GBufferAttachment attachment, uint32_t slot = 0) const;
 
+    protected:
+        struct HeadlessTag
+        {
+        };
+
+        // Only the debug queue exists so gizmo code can keep pushing into it; nothing touches the GL context
+        explicit SceneRenderer(HeadlessTag);
+
     private:
         struct FrameResources
         {
@@ -279,6 +338,12 @@ namespace Fermion
 
         void SkyboxPass(ResourceHandle lightingResult);
         void ShadowPass(ResourceHandle shadowMap);
+        // Level of detail from the projected size of the mesh's bounding sphere, with hysteresis per object
+        uint32_t selectMeshLod(const Mesh &mesh, const glm::mat4 &transform, int objectId);
+        // Uploads the sorted draws' ModelData for the instanced mesh shaders
+        void uploadInstances();
+        // Assigns point and spot lights to the camera's clusters and uploads the light storage buffers
+        void uploadLightClusters();
 
     private:
         std::shared_ptr<DebugRenderer> m_debugRenderer;
@@ -295,7 +360,11 @@ namespace Fermion
 
         std::shared_ptr<Scene> m_scene;
 
-        std::vector<MeshDrawCommand> m_meshDrawList;
+        MeshDrawList m_meshDrawList;
+        std::shared_ptr<Material> m_defaultMaterial;
+        LightClusterGrid m_lightClusterGrid;
+        OcclusionCuller m_occlusionCuller;
+        MeshletCuller m_meshletCuller;
 
         RenderContext m_renderContext;
 
@@ -303,6 +372,14 @@ namespace Fermion
         std::shared_ptr<UniformBuffer> m_modelUniformBuffer;
         std::shared_ptr<UniformBuffer> m_lightUniformBuffer;
         std::shared_ptr<UniformBuffer> m_boneUniformBuffer;
+        std::shared_ptr<UniformBuffer> m_shadowUniformBuffer;
+        std::shared_ptr<StorageBuffer> m_instanceStorageBuffer;
+        std::shared_ptr<UniformBuffer> m_lightClusterGridUniformBuffer;
+        std::shared_ptr<StorageBuffer> m_pointLightStorageBuffer;
+        std::shared_ptr<StorageBuffer> m_spotLightStorageBuffer;
+        std::shared_ptr<StorageBuffer> m_lightClusterStorageBuffer;
+        std::shared_ptr<StorageBuffer> m_lightIndexStorageBuffer;
+        std::shared_ptr<UniformRingBuffer> m_uniformRingBuffer;
 
         std::shared_ptr<Framebuffer> m_targetFramebuffer;
 
@@ -313,6 +390,16 @@ namespace Fermion
         RenderStatistics::Renderer3DStatistics m_renderer3DStatistics;
         std::array<glm::vec4, 6> m_cameraFrustumPlanes{};
         bool m_hasCameraFrustum = false;
+        glm::vec3 m_cameraPosition{0.0f};
+        struct MeshLodState
+        {
+            uint32_t level = 0;
+            uint64_t lastFrame = 0;
+        };
+        // Last LOD level picked per object ID, for the objects drawn in the current frame
+        std::unordered_map<int, MeshLodState> m_meshLods;
+        uint64_t m_lodFrame = 0;
         std::vector<int> m_outlineIDs;
+        bool m_headless = false;
     };
 } // namespace Fermion
@@ -7,11 +7,68 @@
 #include "Renderer/Framebuffer.hpp"
 #include "Renderer/Pipeline.hpp"
 #include "Renderer/UniformBuffer.hpp"
+#include "Core/JobSystem.hpp"
+#include "Math/Math.hpp"
 
+#include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace Fermion
 {
+    namespace
+    {
+        constexpr uint32_t kBoundsGrainSize = 256;
+
+        // shadowBias was tuned for the old fixed 40 x 40 box with a 60 unit depth range; each cascade scales it
+        // so the bias stays the same size relative to that cascade's texels
+        constexpr float kReferenceExtent = 40.0f;
+        constexpr float kReferenceDepthRange = 59.9f;
+
+        // A caster is static after this many frames without moving; moving makes it dynamic again at once
+        constexpr uint32_t kStaticCasterFrames = 60;
+        // Cached cascades cover this much more than their fit, trading some resolution for fewer scrolls
+        constexpr float kCascadeScrollMargin = 0.2f;
+
+        glm::vec3 unproject(const glm::mat4 &inverseProjection, float ndcX, float ndcY, float ndcZ)
+        {
+            glm::vec4 p = inverseProjection * glm::vec4(ndcX, ndcY, ndcZ, 1.0f);
+            return glm::vec3(p) / p.w;
+        }
+
+        // FNV-1a over everything that ends up in the depth layer
+        uint64_t hashCaster(const MeshDrawCommand &cmd)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            auto mix = [&hash](const void *data, size_t size)
+            {
+                const auto *bytes = static_cast<const uint8_t *>(data);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    hash ^= bytes[i];
+                    hash *= 1099511628211ull;
+                }
+            };
+            const VertexArray *vao = cmd.vao.get();
+            mix(&vao, sizeof(vao));
+            mix(&cmd.indexCount, sizeof(cmd.indexCount));
+            mix(&cmd.indexOffset, sizeof(cmd.indexOffset));
+            mix(&cmd.baseVertex, sizeof(cmd.baseVertex));
+            mix(&cmd.transform, sizeof(cmd.transform));
+            return hash;
+        }
+
+        std::shared_ptr<Framebuffer> createDepthArray(uint32_t size, uint32_t layers)
+        {
+            FramebufferSpecification spec;
+            spec.width = size;
+            spec.height = size;
+            spec.layers = layers;
+            spec.attachments = {FramebufferTextureFormat::DEPTH_COMPONENT32F};
+            spec.swapChainTarget = false;
+            return Framebuffer::create(spec);
+        }
+    } // namespace
+
     ShadowMapRenderer::ShadowMapRenderer()
     {
         PipelineSpecification shadowSpec;
@@ -36,61 +93,68 @@ namespace Fermion
 
     void ShadowMapRenderer::addPass(RenderGraphLegacy &renderGraph,
                                     ResourceHandle shadowMap,
-                                    const std::vector<MeshDrawCommand> &drawList,
+                                    const MeshDrawList &drawList,
                                     const DirectionalLight &light,
-                                    uint32_t shadowMapSize,
+                                    const SceneRendererCamera &camera,
+                                    const ShadowCascadeSettings &settings,
                                     const std::shared_ptr<Framebuffer> &targetFramebuffer,
                                     uint32_t viewportWidth,
                                     uint32_t viewportHeight,
                                     uint32_t *shadowDrawCalls,
                                     const std::shared_ptr<UniformBuffer> &modelUniformBuffer,
-                                    const std::shared_ptr<UniformBuffer> &lightUniformBuffer,
+                                    const std::shared_ptr<UniformBuffer> &shadowUniformBuffer,
                                     const std::shared_ptr<UniformBuffer> &boneUniformBuffer)
     {
-        ensureFramebuffer(shadowMapSize);
-        m_lightSpaceMatrix = calculateLightSpaceMatrix(light);
+        m_cascadeCount = std::clamp(settings.cascadeCount, 1u, MAX_SHADOW_CASCADES);
+        ensureFramebuffers(settings.mapSize, m_cascadeCount, settings.staticCache);
+
+        gatherCasterBounds(drawList);
+        classifyCasters(drawList, settings.staticCache);
+        fitCascades(light, camera, settings);
+        scheduleCascadeUpdates(drawList, settings);
 
         LegacyRenderGraphPass pass;
         pass.Name = "ShadowPass";
         pass.Outputs = {shadowMap};
-        pass.Execute = [this, &drawList, targetFramebuffer, viewportWidth, viewportHeight, shadowDrawCalls, modelUniformBuffer, lightUniformBuffer, boneUniformBuffer](RenderCommandQueue& queue)
+        pass.Execute = [this, &drawList, targetFramebuffer, viewportWidth, viewportHeight, shadowDrawCalls, modelUniformBuffer, shadowUniformBuffer, boneUniformBuffer](RenderCommandQueue& queue)
         {
-            queue.submit(CmdBindFramebuffer{m_shadowMapFB});
-            queue.submit(CmdClear{});
-
-            std::shared_ptr<Pipeline> currentPipeline = nullptr;
+            for (uint32_t cascade = 0; cascade < m_cascadeCount; ++cascade)
+            {
+                ShadowData shadowData = m_shadowData;
+                shadowData.currentCascade = static_cast<int>(cascade);
+                queue.submitUniformData(shadowUniformBuffer.get(), &shadowData, sizeof(ShadowData));
 
-            for (auto &cmd : drawList) {
-                // Select appropriate pipeline
-                auto desiredPipeline = cmd.isSkinned ? m_skinnedShadowPipeline : m_shadowPipeline;
-                if (currentPipeline != desiredPipeline)
+                const CascadeDraws &draws = m_cascadeDraws[cascade];
+                CascadeState &state = m_cascades[cascade];
+                if (state.updateThisFrame)
                 {
-                    currentPipeline = desiredPipeline;
-                    queue.submit(CmdBindPipeline{currentPipeline});
+                    // Committed only once the layer is really rerendered: while the graph culls this pass
+                    // the cache keeps describing what it last held
+                    state.placement = state.pendingPlacement;
+                    state.staticSignature = draws.staticSignature;
+                    state.staleFrames = 0;
+                    state.cached = m_staticCacheFB != nullptr;
                 }
-
-                // Update model uniform buffer for this draw call
-                ModelData modelData;
-                modelData.model = cmd.transform;
-                modelData.normalMatrix = glm::transpose(glm::inverse(cmd.transform));
-                modelData.objectID = cmd.objectID;
-
-                queue.submit(CmdCustom{[modelUniformBuffer, modelData]() {
-                    modelUniformBuffer->setData(&modelData, sizeof(ModelData));
-                }});
-
-                // Upload bone matrices for skinned meshes
-                if (cmd.isSkinned && cmd.boneMatrices && !cmd.boneMatrices->empty() && boneUniformBuffer)
+                if (m_staticCacheFB)
                 {
-                    queue.submit(CmdCustom{[boneUniformBuffer, boneMatrices = cmd.boneMatrices]() {
-                        boneUniformBuffer->setData(boneMatrices->data(),
-                            static_cast<uint32_t>(boneMatrices->size() * sizeof(glm::mat4)));
-                    }});
+                    if (state.updateThisFrame)
+                    {
+                        queue.submit(CmdBindFramebufferLayer{m_staticCacheFB.get(), cascade});
+                        queue.submit(CmdClear{});
+                        drawSpans(queue, drawList, draws.staticSpans, shadowDrawCalls, modelUniformBuffer,
+                                  boneUniformBuffer);
+                    }
+                    // The copy replaces the clear; dynamic casters are depth tested against the static ones
+                    queue.submit(CmdCopyDepthLayer{m_staticCacheFB.get(), m_shadowMapFB.get(), cascade, cascade});
+                    queue.submit(CmdBindFramebufferLayer{m_shadowMapFB.get(), cascade});
                 }
-
-                queue.submit(CmdDrawIndexed{cmd.vao, cmd.indexCount, cmd.indexOffset});
-                if (shadowDrawCalls)
-                    (*shadowDrawCalls)++;
+                else
+                {
+                    queue.submit(CmdBindFramebufferLayer{m_shadowMapFB.get(), cascade});
+                    queue.submit(CmdClear{});
+                }
+                drawSpans(queue, drawList, draws.dynamicSpans, shadowDrawCalls, modelUniformBuffer,
+                          boneUniformBuffer);
             }
 
             if (targetFramebuffer) {
@@ -101,12 +165,12 @@ namespace Fermion
                     queue.submit(CmdSetViewport{0, 0, viewportWidth, viewportHeight});
             }
         };
-        renderGraph.addPass(pass);
+        renderGraph.addPass(std::move(pass));
     }
 
-    const glm::mat4 &ShadowMapRenderer::getLightSpaceMatrix() const
+    const ShadowData &ShadowMapRenderer::getShadowData() const
     {
-        return m_lightSpaceMatrix;
+        return m_shadowData;
     }
 
     std::shared_ptr<Framebuffer> ShadowMapRenderer::getShadowMapFramebuffer() const
@@ -114,41 +178,377 @@ namespace Fermion
         return m_shadowMapFB;
     }
 
-    void ShadowMapRenderer::ensureFramebuffer(uint32_t size)
+    void ShadowMapRenderer::drawSpans(RenderCommandQueue &queue, const MeshDrawList &drawList,
+                                      const std::vector<CasterSpan> &spans, uint32_t *shadowDrawCalls,
+                                      const std::shared_ptr<UniformBuffer> &modelUniformBuffer,
+                                      const std::shared_ptr<UniformBuffer> &boneUniformBuffer)
     {
-        if (!m_shadowMapFB || m_shadowMapFB->getSpecification().width != size)
+        const auto &instances = drawList.getInstances();
+        const auto runs = drawList.getRuns();
+
+        std::shared_ptr<Pipeline> currentPipeline = nullptr;
+        uint32_t drawCalls = 0;
+        for (const CasterSpan &span : spans)
         {
-            FramebufferSpecification shadowFBSpec;
-            shadowFBSpec.width = size;
-            shadowFBSpec.height = size;
-            shadowFBSpec.attachments = {FramebufferTextureFormat::DEPTH_COMPONENT32F};
-            shadowFBSpec.swapChainTarget = false;
+            const auto &cmd = drawList.getRunCommand(runs[span.run]);
+            // Select appropriate pipeline
+            auto desiredPipeline = cmd.isSkinned ? m_skinnedShadowPipeline : m_shadowPipeline;
+            if (currentPipeline != desiredPipeline)
+            {
+                drawCalls += m_drawBatch.flush(queue);
+                currentPipeline = desiredPipeline;
+                queue.submit(CmdBindPipeline{currentPipeline});
+            }
+
+            if (cmd.isSkinned)
+            {
+                queue.submitUniformData(modelUniformBuffer.get(), &instances[span.first], sizeof(ModelData));
+
+                // Upload bone matrices for skinned meshes
+                if (cmd.boneMatrices && !cmd.boneMatrices->empty() && boneUniformBuffer)
+                {
+                    queue.submitUniformData(boneUniformBuffer.get(), cmd.boneMatrices->data(),
+                                            static_cast<uint32_t>(cmd.boneMatrices->size() * sizeof(glm::mat4)));
+                }
+                queue.submit(CmdDrawIndexed{cmd.vao, cmd.indexCount, cmd.indexOffset, cmd.baseVertex});
+                drawCalls++;
+            }
+            else
+            {
+                // Depth only: neither material nor meshlet ranges matter, so every static caster of a geometry
+                // page goes into the same indirect draw
+                drawCalls += m_drawBatch.add(queue, cmd.vao.get(),
+                                             {cmd.indexCount, span.count, cmd.indexOffset, cmd.baseVertex, span.first});
+            }
+        }
+        drawCalls += m_drawBatch.flush(queue);
+        if (shadowDrawCalls)
+            *shadowDrawCalls += drawCalls;
+    }
+
+    void ShadowMapRenderer::ensureFramebuffers(uint32_t size, uint32_t cascadeCount, bool staticCache)
+    {
+        if (!m_shadowMapFB || m_shadowMapFB->getSpecification().width != size ||
+            m_shadowMapFB->getSpecification().layers != cascadeCount)
+        {
+            m_shadowMapFB = createDepthArray(size, cascadeCount);
+            m_staticCacheFB.reset();
+        }
+
+        if (staticCache && !m_staticCacheFB)
+            m_staticCacheFB = createDepthArray(size, cascadeCount);
+        else if (!staticCache)
+            m_staticCacheFB.reset();
+        else
+            return;
+
+        // A new cache or none at all: nothing cached is valid any more
+        for (CascadeState &state : m_cascades)
+            state.cached = false;
+    }
+
+    void ShadowMapRenderer::gatherCasterBounds(const MeshDrawList &drawList)
+    {
+        const uint32_t count = static_cast<uint32_t>(drawList.getInstances().size());
+        m_casterBounds.resize(count);
+        JobSystem::parallelForRange(count, kBoundsGrainSize, [this, &drawList](uint32_t begin, uint32_t end)
+                                    {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const MeshDrawCommand &cmd = drawList.getSortedCommand(i);
+                m_casterBounds[i] = AABB::TransformAABB(cmd.aabb, cmd.transform);
+            } });
+
+        m_sceneBounds = {glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+        for (const AABB &bounds : m_casterBounds)
+        {
+            m_sceneBounds.min = glm::min(m_sceneBounds.min, bounds.min);
+            m_sceneBounds.max = glm::max(m_sceneBounds.max, bounds.max);
+        }
+    }
+
+    void ShadowMapRenderer::classifyCasters(const MeshDrawList &drawList, bool staticCache)
+    {
+        const uint32_t count = static_cast<uint32_t>(drawList.getInstances().size());
+        m_casterStatic.assign(count, 0);
+        m_casterHashes.resize(count);
+        if (!staticCache)
+        {
+            m_casterHistory.clear();
+            return;
+        }
+
+        // Skinned meshes always animate, and draws without an object ID can't be tracked across frames
+        ++m_frameIndex;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const MeshDrawCommand &cmd = drawList.getSortedCommand(i);
+            if (cmd.isSkinned || cmd.objectID < 0)
+                continue;
+
+            auto [it, inserted] = m_casterHistory.try_emplace(cmd.objectID);
+            CasterHistory &history = it->second;
+            // Submeshes share the object's transform, so only its first draw of the frame updates the history
+            if (history.lastSeenFrame != m_frameIndex)
+            {
+                if (inserted || history.transform != cmd.transform)
+                {
+                    history.transform = cmd.transform;
+                    history.stillFrames = 0;
+                }
+                else if (history.stillFrames < kStaticCasterFrames)
+                {
+                    ++history.stillFrames;
+                }
+                history.lastSeenFrame = m_frameIndex;
+            }
 
-            m_shadowMapFB = Framebuffer::create(shadowFBSpec);
+            if (history.stillFrames >= kStaticCasterFrames)
+            {
+                m_casterStatic[i] = 1;
+                m_casterHashes[i] = hashCaster(cmd);
+            }
         }
+
+        std::erase_if(m_casterHistory, [this](const auto &entry)
+                      { return entry.second.lastSeenFrame != m_frameIndex; });
     }
 
-    glm::mat4 ShadowMapRenderer::calculateLightSpaceMatrix(const DirectionalLight &light, float orthoSize) const
+    void ShadowMapRenderer::fitCascades(const DirectionalLight &light, const SceneRendererCamera &camera,
+                                        const ShadowCascadeSettings &settings)
     {
-        glm::vec3 lightDir = glm::normalize(light.direction);
-        glm::vec3 lightPos = lightDir * orthoSize;
+        const glm::mat4 &projection = camera.camera.getProjection();
+        const glm::mat4 inverseProjection = glm::inverse(projection);
+        const glm::mat4 inverseView = glm::inverse(camera.view);
+        const bool perspective = projection[3][3] == 0.0f;
+
+        float nearDepth = -unproject(inverseProjection, 0.0f, 0.0f, -1.0f).z;
+        float farDepth = -unproject(inverseProjection, 0.0f, 0.0f, 1.0f).z;
+        if (perspective)
+            nearDepth = std::max(nearDepth, 1e-3f);
+        const float maxDistance = std::max(settings.maxDistance, 1e-2f);
+        if (!std::isfinite(farDepth) || farDepth <= nearDepth || farDepth > nearDepth + maxDistance)
+            farDepth = nearDepth + maxDistance;
 
+        // View-space lines through the four frustum corners, parameterized by view depth (-z)
+        glm::vec3 lineStart[4];
+        glm::vec3 lineDelta[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            const float x = (c & 1) ? 1.0f : -1.0f;
+            const float y = (c & 2) ? 1.0f : -1.0f;
+            const glm::vec3 a = unproject(inverseProjection, x, y, -1.0f);
+            const glm::vec3 b = unproject(inverseProjection, x, y, 0.0f);
+            lineDelta[c] = (b - a) / (a.z - b.z);
+            lineStart[c] = a + lineDelta[c] * a.z;
+        }
+
+        // Looks from the light towards the scene, as light.direction points at the light; rotation only, so
+        // cascades can be moved in light space by whole texels
+        const glm::vec3 lightDir = glm::normalize(light.direction);
         glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
         if (glm::abs(glm::dot(lightDir, up)) > 0.99f)
         {
             up = glm::vec3(1.0f, 0.0f, 0.0f);
         }
+        const glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), -lightDir, up);
+
+        // Casters between the light and a cascade can shadow it, so the near planes reach back to the scene bounds
+        float sceneMaxZ = -FLT_MAX;
+        if (m_sceneBounds.min.x <= m_sceneBounds.max.x)
+        {
+            const AABB lightBounds = AABB::TransformAABB(m_sceneBounds, lightView);
+            sceneMaxZ = lightBounds.max.z;
+        }
 
-        glm::mat4 lightView = glm::lookAt(
-            lightPos,
-            glm::vec3(0.0f, 0.0f, 0.0f),
-            up);
+        const float lambda = std::clamp(settings.splitLambda, 0.0f, 1.0f);
+        float splitNear = nearDepth;
+        for (uint32_t cascade = 0; cascade < m_cascadeCount; ++cascade)
+        {
+            const float t = static_cast<float>(cascade + 1) / m_cascadeCount;
+            const float uniformSplit = nearDepth + (farDepth - nearDepth) * t;
+            const float logSplit = nearDepth > 0.0f ? nearDepth * std::pow(farDepth / nearDepth, t) : uniformSplit;
+            const float splitFar = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+
+            // Measured in view space so the radius doesn't pick up rounding from the camera's pose
+            glm::vec3 corners[8];
+            glm::vec3 center(0.0f);
+            for (int c = 0; c < 8; ++c)
+            {
+                const float depth = (c < 4) ? splitNear : splitFar;
+                corners[c] = lineStart[c & 3] + lineDelta[c & 3] * depth;
+                center += corners[c];
+            }
+            center /= 8.0f;
 
-        glm::mat4 lightProjection = glm::ortho(
-            -orthoSize, orthoSize,
-            -orthoSize, orthoSize,
-            0.1f, orthoSize * 3.0f);
+            // A sphere keeps the cascade's size fixed as the camera rotates
+            float radius = 0.0f;
+            for (const glm::vec3 &corner : corners)
+                radius = std::max(radius, glm::length(corner - center));
+            radius = std::ceil(radius * 16.0f) / 16.0f;
 
-        return lightProjection * lightView;
+            CascadeFit &fit = m_cascadeFits[cascade];
+            fit.lightDirection = lightDir;
+            fit.lightView = lightView;
+            fit.center = glm::vec3(lightView * inverseView * glm::vec4(center, 1.0f));
+            fit.radius = radius;
+            fit.casterMaxZ = sceneMaxZ;
+            fit.split = splitFar;
+            splitNear = splitFar;
+        }
+    }
+
+    ShadowMapRenderer::CascadePlacement ShadowMapRenderer::placeCascade(const CascadeFit &fit, uint32_t mapSize,
+                                                                        float margin) const
+    {
+        CascadePlacement placement;
+        placement.lightDirection = fit.lightDirection;
+        placement.radius = fit.radius;
+        placement.halfExtent = fit.radius * (1.0f + margin);
+
+        const float texelSize = 2.0f * placement.halfExtent / static_cast<float>(mapSize);
+        placement.center = glm::floor(glm::vec2(fit.center) / texelSize) * texelSize;
+
+        // The view looks down -z: receivers span the sphere, casters reach back towards the light
+        const float padding = placement.halfExtent - fit.radius;
+        placement.minZ = fit.center.z - fit.radius - padding;
+        placement.maxZ = std::max(fit.center.z + fit.radius, fit.casterMaxZ) + padding;
+
+        const glm::mat4 lightProjection = glm::ortho(
+            placement.center.x - placement.halfExtent, placement.center.x + placement.halfExtent,
+            placement.center.y - placement.halfExtent, placement.center.y + placement.halfExtent,
+            -placement.maxZ, -placement.minZ);
+        placement.viewProjection = lightProjection * fit.lightView;
+        return placement;
+    }
+
+    bool ShadowMapRenderer::covers(const CascadePlacement &placement, const CascadeFit &fit)
+    {
+        if (placement.lightDirection != fit.lightDirection || placement.radius != fit.radius)
+            return false;
+
+        const glm::vec2 offset = glm::abs(glm::vec2(fit.center) - placement.center);
+        const float slack = placement.halfExtent - fit.radius;
+        return offset.x <= slack && offset.y <= slack &&
+               fit.center.z - fit.radius >= placement.minZ &&
+               std::max(fit.center.z + fit.radius, fit.casterMaxZ) <= placement.maxZ;
+    }
+
+    void ShadowMapRenderer::cullCascade(uint32_t cascade, const glm::mat4 &viewProjection, const MeshDrawList &drawList)
+    {
+        const auto planes = Math::ExtractFrustumPlanes(viewProjection);
+        const auto runs = drawList.getRuns();
+
+        // Culled runs are included: an object outside the camera frustum can still shadow what is inside it.
+        // Instances of a run are contiguous, so the casters that survive split it into contiguous spans,
+        // broken again wherever a static caster meets a dynamic one
+        CascadeDraws &draws = m_cascadeDraws[cascade];
+        draws.staticSpans.clear();
+        draws.dynamicSpans.clear();
+        draws.staticSignature = 0;
+        for (uint32_t r = 0; r < runs.size(); ++r)
+        {
+            const MeshDrawRun &run = runs[r];
+            uint32_t spanStart = run.first;
+            auto closeSpan = [&](uint32_t end)
+            {
+                if (end > spanStart)
+                {
+                    auto &spans = m_casterStatic[spanStart] ? draws.staticSpans : draws.dynamicSpans;
+                    spans.push_back({r, spanStart, end - spanStart});
+                }
+            };
+            for (uint32_t i = run.first; i < run.first + run.count; ++i)
+            {
+                if (!Math::IsAABBInsideFrustum(planes, m_casterBounds[i]))
+                {
+                    closeSpan(i);
+                    spanStart = i + 1;
+                    continue;
+                }
+                if (i > spanStart && m_casterStatic[i] != m_casterStatic[spanStart])
+                {
+                    closeSpan(i);
+                    spanStart = i;
+                }
+                // Summed so the signature doesn't depend on the camera-dependent draw order
+                if (m_casterStatic[i])
+                    draws.staticSignature += m_casterHashes[i];
+            }
+            closeSpan(run.first + run.count);
+        }
+    }
+
+    void ShadowMapRenderer::scheduleCascadeUpdates(const MeshDrawList &drawList, const ShadowCascadeSettings &settings)
+    {
+        const float margin = m_staticCacheFB ? kCascadeScrollMargin : 0.0f;
+
+        std::array<CascadePlacement, MAX_SHADOW_CASCADES> candidates;
+        for (uint32_t cascade = 0; cascade < m_cascadeCount; ++cascade)
+        {
+            const CascadeState &state = m_cascades[cascade];
+            const CascadeFit &fit = m_cascadeFits[cascade];
+            candidates[cascade] = (m_staticCacheFB && state.cached && covers(state.placement, fit))
+                                      ? state.placement
+                                      : placeCascade(fit, settings.mapSize, margin);
+        }
+        JobSystem::parallelFor(m_cascadeCount, 1, [this, &candidates, &drawList](uint32_t cascade)
+                               { cullCascade(cascade, candidates[cascade].viewProjection, drawList); });
+
+        // Cascades without a usable cache, or whose split range changed, must update; the rest wait for the
+        // budget, longest-waiting first
+        std::array<uint32_t, MAX_SHADOW_CASCADES> pending;
+        uint32_t pendingCount = 0;
+        uint32_t forcedCount = 0;
+        for (uint32_t cascade = 0; cascade < m_cascadeCount; ++cascade)
+        {
+            CascadeState &state = m_cascades[cascade];
+            const bool forced = !m_staticCacheFB || !state.cached ||
+                                state.placement.radius != m_cascadeFits[cascade].radius;
+            const bool wanted = forced || !(candidates[cascade] == state.placement) ||
+                                m_cascadeDraws[cascade].staticSignature != state.staticSignature;
+            state.updateThisFrame = forced;
+            if (forced)
+                ++forcedCount;
+            else if (wanted)
+                pending[pendingCount++] = cascade;
+            else
+                state.staleFrames = 0;
+        }
+        std::stable_sort(pending.begin(), pending.begin() + pendingCount, [this](uint32_t a, uint32_t b)
+                         { return m_cascades[a].staleFrames > m_cascades[b].staleFrames; });
+
+        const uint32_t budget = std::max(settings.cacheUpdateBudget, 1u);
+        uint32_t remaining = budget > forcedCount ? budget - forcedCount : 0;
+        for (uint32_t i = 0; i < pendingCount; ++i)
+        {
+            CascadeState &state = m_cascades[pending[i]];
+            if (remaining > 0)
+            {
+                state.updateThisFrame = true;
+                --remaining;
+                continue;
+            }
+
+            // Deferred: keep drawing with the placement the cached layer was rendered for
+            ++state.staleFrames;
+            if (!(candidates[pending[i]] == state.placement))
+                cullCascade(pending[i], state.placement.viewProjection, drawList);
+        }
+
+        m_shadowData = {};
+        m_shadowData.cascadeCount = static_cast<int>(m_cascadeCount);
+        for (uint32_t cascade = 0; cascade < m_cascadeCount; ++cascade)
+        {
+            CascadeState &state = m_cascades[cascade];
+            state.pendingPlacement = candidates[cascade];
+
+            const CascadePlacement &placement = state.updateThisFrame ? state.pendingPlacement : state.placement;
+            m_shadowData.cascadeViewProjections[cascade] = placement.viewProjection;
+            m_shadowData.cascadeSplits[cascade] = m_cascadeFits[cascade].split;
+            m_shadowData.cascadeBiasScales[cascade] =
+                (2.0f * placement.halfExtent / kReferenceExtent) *
+                (kReferenceDepthRange / (placement.maxZ - placement.minZ));
+        }
     }
 } // namespace Fermion
@@ -1,11 +1,17 @@
 #pragma once
+#include <array>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <glm/glm.hpp>
 
-#include "Renderer/RenderDrawCommand.hpp"
+#include "Math/AABB.hpp"
+#include "Renderer/IndirectDrawBatch.hpp"
+#include "Renderer/MeshDrawList.hpp"
 #include "Renderer/RenderGraphLegacy.hpp"
+#include "Renderer/UniformBufferLayout.hpp"
+#include "RenderContext.hpp"
 #include "Scene/Scene.hpp"
 
 namespace Fermion
@@ -14,6 +20,25 @@ namespace Fermion
     class Pipeline;
     class UniformBuffer;
 
+    struct ShadowCascadeSettings
+    {
+        uint32_t mapSize = 2048;
+        uint32_t cascadeCount = 4;
+        float splitLambda = 0.75f;
+        float maxDistance = 150.0f;
+        bool staticCache = true;
+        uint32_t cacheUpdateBudget = 2;
+    };
+
+    // Cascaded shadow maps for the main directional light. The view is split into up to MAX_SHADOW_CASCADES depth
+    // ranges; each is fitted with a texel-snapped bounding sphere so the cascades don't shimmer as the camera moves,
+    // and only the draws whose bounds touch a cascade's light frustum are rendered into its layer.
+    //
+    // Casters that haven't moved for a while are static: each cascade keeps them in a cached depth layer that
+    // is copied into the shadow map every frame, so only dynamic casters are drawn per frame. A cascade's cache
+    // is re-rendered when its static casters or the light change, or when the camera leaves the padded area
+    // the cascade was placed over; at most cacheUpdateBudget cascades do that per frame, the others keep their
+    // previous placement and cache for a few more frames.
     class ShadowMapRenderer
     {
     public:
@@ -21,28 +46,115 @@ namespace Fermion
 
         void addPass(RenderGraphLegacy &renderGraph,
                      ResourceHandle shadowMap,
-                     const std::vector<MeshDrawCommand> &drawList,
+                     const MeshDrawList &drawList,
                      const DirectionalLight &light,
-                     uint32_t shadowMapSize,
+                     const SceneRendererCamera &camera,
+                     const ShadowCascadeSettings &settings,
                      const std::shared_ptr<Framebuffer> &targetFramebuffer,
                      uint32_t viewportWidth,
                      uint32_t viewportHeight,
                      uint32_t *shadowDrawCalls,
                      const std::shared_ptr<UniformBuffer> &modelUniformBuffer,
-                     const std::shared_ptr<UniformBuffer> &lightUniformBuffer,
-                     const std::shared_ptr<UniformBuffer> &boneUniformBuffer = nullptr);
+                     const std::shared_ptr<UniformBuffer> &shadowUniformBuffer,
+                     const std::shared_ptr<UniformBuffer> &boneUniformBuffer);
 
-        const glm::mat4 &getLightSpaceMatrix() const;
+        // Valid after addPass(); the lighting passes upload it to the shadow uniform buffer
+        const ShadowData &getShadowData() const;
         std::shared_ptr<Framebuffer> getShadowMapFramebuffer() const;
 
     private:
-        void ensureFramebuffer(uint32_t size);
-        glm::mat4 calculateLightSpaceMatrix(const DirectionalLight &light, float orthoSize = 20.0f) const;
+        // Instances [first, first + count) of the sorted draw list, all from the same run
+        struct CasterSpan
+        {
+            uint32_t run;
+            uint32_t first;
+            uint32_t count;
+        };
+
+        // Where a cascade has to be this frame: the bounding sphere of its slice of the view, in light space
+        struct CascadeFit
+        {
+            glm::vec3 lightDirection;
+            glm::mat4 lightView;
+            glm::vec3 center;
+            float radius;
+            float casterMaxZ; // Casters up to here, towards the light, can shadow the cascade
+            float split;
+        };
+
+        // Where a cascade is rendered: a light-space box around the fit, padded so it can stay put while the
+        // camera moves a little
+        struct CascadePlacement
+        {
+            glm::vec3 lightDirection{0.0f};
+            glm::vec2 center{0.0f};
+            float radius = 0.0f;
+            float halfExtent = 0.0f;
+            float minZ = 0.0f;
+            float maxZ = 0.0f;
+            glm::mat4 viewProjection{1.0f};
+
+            bool operator==(const CascadePlacement &other) const = default;
+        };
+
+        struct CascadeState
+        {
+            CascadePlacement placement;
+            CascadePlacement pendingPlacement; // Rendered this frame when updateThisFrame; the pass commits it
+            uint64_t staticSignature = 0;      // Of the static casters in the cached layer
+            uint32_t staleFrames = 0;          // Frames an update has been deferred by the budget
+            bool cached = false;
+            bool updateThisFrame = false;
+        };
+
+        struct CascadeDraws
+        {
+            std::vector<CasterSpan> staticSpans;
+            std::vector<CasterSpan> dynamicSpans;
+            uint64_t staticSignature = 0;
+        };
+
+        struct CasterHistory
+        {
+            glm::mat4 transform;
+            uint32_t stillFrames = 0;
+            uint32_t lastSeenFrame = 0;
+        };
+
+        void ensureFramebuffers(uint32_t size, uint32_t cascadeCount, bool staticCache);
+        void gatherCasterBounds(const MeshDrawList &drawList);
+        void classifyCasters(const MeshDrawList &drawList, bool staticCache);
+        void fitCascades(const DirectionalLight &light, const SceneRendererCamera &camera,
+                         const ShadowCascadeSettings &settings);
+        CascadePlacement placeCascade(const CascadeFit &fit, uint32_t mapSize, float margin) const;
+        static bool covers(const CascadePlacement &placement, const CascadeFit &fit);
+        void cullCascade(uint32_t cascade, const glm::mat4 &viewProjection, const MeshDrawList &drawList);
+        void scheduleCascadeUpdates(const MeshDrawList &drawList, const ShadowCascadeSettings &settings);
+        void drawSpans(RenderCommandQueue &queue, const MeshDrawList &drawList, const std::vector<CasterSpan> &spans,
+                       uint32_t *shadowDrawCalls, const std::shared_ptr<UniformBuffer> &modelUniformBuffer,
+                       const std::shared_ptr<UniformBuffer> &boneUniformBuffer);
 
     private:
         std::shared_ptr<Pipeline> m_shadowPipeline;
         std::shared_ptr<Pipeline> m_skinnedShadowPipeline;
+        IndirectDrawBatch m_drawBatch;
         std::shared_ptr<Framebuffer> m_shadowMapFB;
-        glm::mat4 m_lightSpaceMatrix{1.0f};
+        std::shared_ptr<Framebuffer> m_staticCacheFB;
+        ShadowData m_shadowData{};
+        uint32_t m_cascadeCount = 0;
+
+        // Per sorted draw: world bounds, whether it is static and, for static ones, a hash of what it draws
+        std::vector<AABB> m_casterBounds;
+        std::vector<uint8_t> m_casterStatic;
+        std::vector<uint64_t> m_casterHashes;
+        AABB m_sceneBounds;
+
+        // Keyed by object ID; an object is static once its transform has been unchanged for a while
+        std::unordered_map<int, CasterHistory> m_casterHistory;
+        uint32_t m_frameIndex = 0;
+
+        std::array<CascadeFit, MAX_SHADOW_CASCADES> m_cascadeFits{};
+        std::array<CascadeState, MAX_SHADOW_CASCADES> m_cascades{};
+        std::array<CascadeDraws, MAX_SHADOW_CASCADES> m_cascadeDraws;
     };
 } // namespace Fermion
@@ -1,8 +1,32 @@
 ﻿#include "Renderer/Shader.hpp"
 #include "OpenGLShader.hpp"
+#include "OpenGLProgramCache.hpp"
 #include "Renderer/Renderers/Renderer.hpp"
+
+#include <array>
 namespace Fermion
 {
+    namespace ShaderKeyword
+    {
+        static constexpr std::array<const char *, Count> s_names = {
+            "FM_ALBEDO_MAP", "FM_NORMAL_MAP", "FM_METALLIC_MAP", "FM_ROUGHNESS_MAP", "FM_AO_MAP"};
+
+        const char *getName(uint32_t index)
+        {
+            return index < Count ? s_names[index] : nullptr;
+        }
+
+        uint32_t fromName(std::string_view name)
+        {
+            for (uint32_t i = 0; i < Count; ++i)
+            {
+                if (name == s_names[i])
+                    return 1u << i;
+            }
+            return 0;
+        }
+    } // namespace ShaderKeyword
+
     std::shared_ptr<Shader> Shader::create(const std::string &name, const std::string &vertexSrc, const std::string &fragmentSrc)
     {
         switch (Renderer::getAPI())
@@ -27,6 +51,18 @@ namespace Fermion
         return nullptr;
     }
 
+    void Shader::setCacheDirectory(const std::string &directory)
+    {
+        switch (Renderer::getAPI())
+        {
+        case RendererAPI::API::None:
+            return;
+        case RendererAPI::API::OpenGL:
+            OpenGLProgramCache::init(directory);
+            return;
+        }
+    }
+
     void ShaderLibrary::add(const std::string &name, const std::shared_ptr<Shader> &shader)
     {
         FERMION_ASSERT(!exists(name), "Shader already exists!");
@@ -60,6 +96,11 @@ namespace Fermion
         return m_Shaders.at(name);
     }
 
+    std::shared_ptr<Shader> ShaderLibrary::get(const std::string &name, uint32_t keywords) const
+    {
+        return get(name)->getVariant(keywords);
+    }
+
     bool ShaderLibrary::exists(const std::string &name) const
     {
         return m_Shaders.find(name) != m_Shaders.end();
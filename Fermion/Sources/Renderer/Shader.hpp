@@ -1,9 +1,27 @@
 ﻿#pragma once
 #include "fmpch.hpp"
 #include <string>
+#include <string_view>
 #include <glm/glm.hpp>
 namespace Fermion
 {
+    // Keywords a .glsl file can list in a '#pragma multi_compile' line above its first #type line. Each one
+    // toggles on its own, and a variant is the program compiled with '#define NAME' for the keywords in its
+    // mask. A shader only splits into variants on the keywords it lists.
+    namespace ShaderKeyword
+    {
+        constexpr uint32_t AlbedoMap = 1u << 0;    // FM_ALBEDO_MAP
+        constexpr uint32_t NormalMap = 1u << 1;    // FM_NORMAL_MAP
+        constexpr uint32_t MetallicMap = 1u << 2;  // FM_METALLIC_MAP
+        constexpr uint32_t RoughnessMap = 1u << 3; // FM_ROUGHNESS_MAP
+        constexpr uint32_t AOMap = 1u << 4;        // FM_AO_MAP
+        constexpr uint32_t Count = 5;
+
+        // Name of the keyword at bit position index, nullptr past Count
+        const char *getName(uint32_t index);
+        // Bit of the named keyword, 0 for unknown names
+        uint32_t fromName(std::string_view name);
+    } // namespace ShaderKeyword
 
     class Shader
     {
@@ -25,8 +43,18 @@ namespace Fermion
 
         virtual const std::string &getName() const = 0;
 
+        // ShaderKeyword bits the source lists; 0 for a shader without variants
+        virtual uint32_t getKeywordMask() const = 0;
+        // The program with the given keywords defined, compiled on first request and cached. Keywords the shader
+        // doesn't list are dropped, so one mask works with every shader. Values set through the setters of the
+        // shader apply to all of its variants.
+        virtual std::shared_ptr<Shader> getVariant(uint32_t keywords) = 0;
+
         static std::shared_ptr<Shader> create(const std::string &name, const std::string &vertexSrc, const std::string &fragmentSrc);
         static std::shared_ptr<Shader> create(const std::string &filepath);
+        // Shaders created afterwards load their programs from, and save them to, this directory. Needs the
+        // renderer API initialized
+        static void setCacheDirectory(const std::string &directory);
     };
     class ShaderLibrary
     {
@@ -37,6 +65,8 @@ namespace Fermion
         std::shared_ptr<Shader> load(const std::string &name, const std::string &filepath);
 
         std::shared_ptr<Shader> get(const std::string &name) const;
+        // The named shader's variant for a ShaderKeyword mask
+        std::shared_ptr<Shader> get(const std::string &name, uint32_t keywords) const;
 
         bool exists(const std::string &name) const;
 
@@ -0,0 +1,22 @@
+﻿#include "fmpch.hpp"
+#include "StorageBuffer.hpp"
+#include "OpenGLStorageBuffer.hpp"
+#include "Renderer/Renderers/Renderer.hpp"
+
+namespace Fermion
+{
+    std::shared_ptr<StorageBuffer> StorageBuffer::create(uint32_t bindingPoint, uint32_t size)
+    {
+        switch (Renderer::getAPI())
+        {
+        case RendererAPI::API::None:
+            FERMION_ASSERT(false, "RendererAPI::None is not supported!");
+            return nullptr;
+        case RendererAPI::API::OpenGL:
+            return std::make_shared<OpenGLStorageBuffer>(bindingPoint, size);
+        }
+
+        FERMION_ASSERT(false, "Unknown RendererAPI!");
+        return nullptr;
+    }
+} // namespace Fermion
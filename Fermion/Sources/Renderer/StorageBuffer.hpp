@@ -0,0 +1,35 @@
+﻿#pragma once
+#include "fmpch.hpp"
+
+namespace Fermion
+{
+    // Abstract shader storage buffer interface, for per-instance data too large or too variable for a UBO
+    class StorageBuffer
+    {
+    public:
+        virtual ~StorageBuffer() = default;
+
+        // Bind the storage buffer to its binding point
+        virtual void bind() const = 0;
+
+        // Unbind the storage buffer
+        virtual void unbind() const = 0;
+
+        // Update buffer data (offset in bytes, size in bytes)
+        virtual void setData(const void *data, uint32_t size, uint32_t offset = 0) = 0;
+
+        // Reallocate to at least 'size' bytes; previous contents are discarded
+        virtual void resize(uint32_t size) = 0;
+
+        // Get the buffer size in bytes
+        virtual uint32_t getSize() const = 0;
+
+        // Get the binding point for this SSBO
+        virtual uint32_t getBindingPoint() const = 0;
+
+        // Factory method for creating platform-specific storage buffers
+        // bindingPoint: The SSBO binding point (matches shader layout binding)
+        // size: Initial buffer size in bytes
+        static std::shared_ptr<StorageBuffer> create(uint32_t bindingPoint, uint32_t size);
+    };
+} // namespace Fermion
@@ -12,6 +12,30 @@ namespace Fermion
         constexpr uint32_t Lights = 2;      // Scene lighting data
         constexpr uint32_t Material = 3;    // Material properties
         constexpr uint32_t Bones = 4;       // Bone matrices for skeletal animation
+        constexpr uint32_t DrawParameters = 5; // Base instance of the current draw, without shader draw parameters
+        constexpr uint32_t LightClusterGrid = 6; // Froxel grid dimensions and depth slicing
+        constexpr uint32_t Shadow = 7;      // Cascaded shadow map matrices and splits
+    }
+
+    // SSBO binding points - separate namespace from the UBO bindings
+    namespace StorageBufferBinding
+    {
+        constexpr uint32_t Instances = 0;   // Per-instance ModelData for instanced mesh draws
+        constexpr uint32_t PointLights = 1; // Every point light in the scene
+        constexpr uint32_t SpotLights = 2;  // Every spot light in the scene
+        constexpr uint32_t LightClusters = 3; // Per-cluster range into the light index list
+        constexpr uint32_t LightIndices = 4; // Point then spot light indices for each cluster
+    }
+
+    // Texture units of a material's texture set - must match the samplers' layout(binding=N) declarations
+    namespace MaterialTextureSlot
+    {
+        constexpr uint32_t Albedo = 0;      // Also the Phong diffuse texture
+        constexpr uint32_t Normal = 1;
+        constexpr uint32_t Metallic = 2;
+        constexpr uint32_t Roughness = 3;
+        constexpr uint32_t AO = 4;
+        constexpr uint32_t Count = 5;
     }
 
     // Camera uniform buffer (binding = 0)
@@ -39,12 +63,38 @@ namespace Fermion
         static constexpr uint32_t getSize() { return 144; }
     };
 
+    // Draw parameters uniform buffer (binding = 5)
+    // Instanced mesh shaders read ModelData from the instance SSBO at the draw's base instance + gl_InstanceID.
+    // They take the base instance from gl_BaseInstanceARB where the driver has GL_ARB_shader_draw_parameters;
+    // otherwise the renderer API issues indirect draws one by one and writes it here before each.
+    // The SSBO uses the std430 layout, whose array stride for ModelData is also 144 bytes.
+    struct DrawParametersData
+    {
+        int baseInstance;          // 4 bytes
+        int _padding0[3];          // 12 bytes (align to 16)
+
+        static constexpr uint32_t getSize() { return 16; }
+    };
+
+    // Additional directional lights, beyond the shadowed main one
+    constexpr uint32_t MAX_DIR_LIGHTS = 4;
+
+    // One entry of LightData::dirLights, std140
+    struct DirectionalLightData
+    {
+        glm::vec3 direction;         // 12 bytes (direction the light travels, as in the scene)
+        float intensity;             // 4 bytes
+        glm::vec3 color;             // 12 bytes
+        float _padding0;             // 4 bytes
+
+        static constexpr uint32_t getSize() { return 32; }
+    };
+
     // Light uniform buffer (binding = 2)
-    // Contains scene lighting information
+    // Contains scene lighting information; uploaded once per lighting pass.
+    // Point and spot lights live in the clustered light storage buffers instead.
     struct LightData
     {
-        glm::mat4 lightSpaceMatrix;  // 64 bytes (for shadow mapping)
-
         // Main directional light (for shadow mapping)
         glm::vec3 dirLightDirection; // 12 bytes
         float dirLightIntensity;     // 4 bytes
@@ -63,26 +113,101 @@ namespace Fermion
         int numSpotLights;           // 4 bytes
         float _padding2;             // 4 bytes
 
-        static constexpr uint32_t getSize() { return 128; }
+        DirectionalLightData dirLights[MAX_DIR_LIGHTS]; // 4 * 32 = 128 bytes
+
+        static constexpr uint32_t getSize() { return 192; }
+    };
+
+    constexpr uint32_t MAX_SHADOW_CASCADES = 4;
+
+    // Shadow uniform buffer (binding = 7)
+    // Cascades of the main directional light; one layer of the shadow map array each
+    struct ShadowData
+    {
+        glm::mat4 cascadeViewProjections[MAX_SHADOW_CASCADES]; // 4 * 64 = 256 bytes
+        glm::vec4 cascadeSplits;     // 16 bytes (view depth where each cascade ends)
+        glm::vec4 cascadeBiasScales; // 16 bytes (shadowBias multiplier per cascade)
+        int cascadeCount;            // 4 bytes
+        int currentCascade;          // 4 bytes (cascade being rendered by the shadow pass)
+        float _padding0[2];          // 8 bytes
+
+        static constexpr uint32_t getSize() { return 304; }
+    };
+
+    // Point light storage buffer (SSBO binding = 1), std430
+    struct PointLightData
+    {
+        glm::vec3 position;          // 12 bytes
+        float range;                 // 4 bytes
+        glm::vec3 color;             // 12 bytes
+        float intensity;             // 4 bytes
+
+        static constexpr uint32_t getSize() { return 32; }
+    };
+
+    // Spot light storage buffer (SSBO binding = 2), std430
+    // Cone angles are stored as cosines, the way the shaders compare them
+    struct SpotLightData
+    {
+        glm::vec3 position;          // 12 bytes
+        float range;                 // 4 bytes
+        glm::vec3 direction;         // 12 bytes (normalized)
+        float innerConeAngle;        // 4 bytes
+        glm::vec3 color;             // 12 bytes
+        float intensity;             // 4 bytes
+        float outerConeAngle;        // 4 bytes
+        float _padding0[3];          // 12 bytes (std430 struct stride is 16-aligned)
+
+        static constexpr uint32_t getSize() { return 64; }
+    };
+
+    // Light cluster storage buffer (SSBO binding = 3), std430
+    // The cluster's lights are lightIndices[offset, offset + pointCount) for point lights,
+    // followed by spotCount spot light indices
+    struct LightClusterData
+    {
+        uint32_t offset;             // 4 bytes
+        uint32_t pointCount;         // 4 bytes
+        uint32_t spotCount;          // 4 bytes
+        uint32_t _padding0;          // 4 bytes
+
+        static constexpr uint32_t getSize() { return 16; }
+    };
+
+    // Light cluster grid uniform buffer (binding = 6)
+    // slice = floor(f(viewDepth) * sliceScale + sliceBias), f = log when logarithmicSlices, else identity
+    struct LightClusterGridData
+    {
+        glm::vec2 tileSize;          // 8 bytes (pixels per cluster tile)
+        float sliceScale;            // 4 bytes
+        float sliceBias;             // 4 bytes
+        glm::uvec3 gridSize;         // 12 bytes (tiles x, tiles y, depth slices)
+        int logarithmicSlices;       // 4 bytes (0 for orthographic projections)
+
+        static constexpr uint32_t getSize() { return 32; }
     };
 
     // Material uniform buffer (binding = 3)
-    // Contains material properties for PBR rendering
+    // One block per material, re-uploaded only when the material is edited. Phong materials reuse it:
+    // albedo holds Kd and ambient holds Ka
     struct MaterialData
     {
         glm::vec4 albedo;            // 16 bytes
+        glm::vec4 ambient;           // 16 bytes (Phong only)
         float metallic;              // 4 bytes
         float roughness;             // 4 bytes
         float ao;                    // 4 bytes (ambient occlusion)
         float _padding0;             // 4 bytes
 
         // Texture flags (0 = no texture, 1 = has texture)
-        int hasAlbedoMap;            // 4 bytes
+        int hasAlbedoMap;            // 4 bytes (the diffuse texture for Phong)
         int hasNormalMap;            // 4 bytes
         int hasMetallicMap;          // 4 bytes
         int hasRoughnessMap;         // 4 bytes
+        int hasAOMap;                // 4 bytes
+        int _padding1[3];            // 12 bytes
 
-        static constexpr uint32_t getSize() { return 48; }
+        static constexpr uint32_t getSize() { return 80; }
     };
 
     // Bone uniform buffer (binding = 4)
@@ -0,0 +1,22 @@
+﻿#include "fmpch.hpp"
+#include "UniformRingBuffer.hpp"
+#include "OpenGLUniformRingBuffer.hpp"
+#include "Renderer/Renderers/Renderer.hpp"
+
+namespace Fermion
+{
+    std::shared_ptr<UniformRingBuffer> UniformRingBuffer::create(uint32_t frameSize)
+    {
+        switch (Renderer::getAPI())
+        {
+        case RendererAPI::API::None:
+            FERMION_ASSERT(false, "RendererAPI::None is not supported!");
+            return nullptr;
+        case RendererAPI::API::OpenGL:
+            return std::make_shared<OpenGLUniformRingBuffer>(frameSize);
+        }
+
+        FERMION_ASSERT(false, "Unknown RendererAPI!");
+        return nullptr;
+    }
+} // namespace Fermion
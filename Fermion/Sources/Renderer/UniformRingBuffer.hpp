@@ -0,0 +1,37 @@
+﻿#pragma once
+#include "fmpch.hpp"
+
+namespace Fermion
+{
+    // Persistently mapped uniform memory split into FrameCount regions. Each frame writes its
+    // per-draw uniform blocks into its own region and binds them as ranges, so uploads never wait
+    // on a buffer the GPU is still reading; the region is only reused once its fence has signaled.
+    class UniformRingBuffer
+    {
+    public:
+        static constexpr uint32_t FrameCount = 3;
+
+        virtual ~UniformRingBuffer() = default;
+
+        // Move to the next region, waiting for the GPU to finish the frame that last used it.
+        // Grows the buffer if the previous frame ran out of space.
+        virtual void beginFrame() = 0;
+
+        // Fence the current region
+        virtual void endFrame() = 0;
+
+        // Reserve 'size' bytes in the current region, aligned for a range binding.
+        // Returns the mapped write pointer and its buffer offset, or nullptr when the region is full.
+        virtual void *allocate(uint32_t size, uint32_t &offset) = 0;
+
+        // Bind [offset, offset + size) to a uniform binding point
+        virtual void bindRange(uint32_t bindingPoint, uint32_t offset, uint32_t size) const = 0;
+
+        // Get the size of one frame region in bytes
+        virtual uint32_t getFrameSize() const = 0;
+
+        // Factory method for creating platform-specific ring buffers
+        // frameSize: Initial size of one frame region in bytes
+        static std::shared_ptr<UniformRingBuffer> create(uint32_t frameSize);
+    };
+} // namespace Fermion
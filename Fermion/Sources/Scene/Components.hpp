@@ -92,6 +92,58 @@ namespace Fermion
         }
     };
 
+    // Runtime cache of the world-space matrix, maintained by EntityManager::updateWorldTransforms.
+    // Read-only for everyone else; not serialized and not copied between scenes.
+    struct WorldTransformComponent
+    {
+        glm::mat4 transform{1.0f};
+
+        WorldTransformComponent() = default;
+
+        WorldTransformComponent(const WorldTransformComponent &) = default;
+
+        glm::vec3 getTranslation() const
+        {
+            return glm::vec3(transform[3]);
+        }
+
+        glm::vec3 getForward() const
+        {
+            return glm::normalize(glm::vec3(transform * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f)));
+        }
+    };
+
+    // Runtime link between a MeshComponent and the scene BVH, maintained by SceneSpatialIndex.
+    // Not serialized and not copied between scenes.
+    struct SpatialProxyComponent
+    {
+        int32_t proxyId = -1;
+        AssetHandle meshHandle = AssetHandle(0);
+        AABB localBounds;
+        bool hasBounds = false;
+        bool transformDirty = true;
+
+        SpatialProxyComponent() = default;
+
+        SpatialProxyComponent(const SpatialProxyComponent &) = default;
+    };
+
+    // Local pose of a dynamic rigidbody before and after the last fixed physics step, kept by Scene so
+    // rendering can blend between them. Not serialized and not copied between scenes.
+    struct PhysicsInterpolationComponent
+    {
+        glm::vec3 previousTranslation{0.0f};
+        glm::quat previousRotation{1.0f, 0.0f, 0.0f, 0.0f};
+        glm::vec3 currentTranslation{0.0f};
+        // Euler, exactly as the physics sync wrote it, so restoring it doesn't look like a transform change
+        glm::vec3 currentRotation{0.0f};
+        bool applied = false;
+
+        PhysicsInterpolationComponent() = default;
+
+        PhysicsInterpolationComponent(const PhysicsInterpolationComponent &) = default;
+    };
+
     struct SpriteRendererComponent
     {
         glm::vec4 color{1.0f, 1.0f, 1.0f, 1.0f};
@@ -115,6 +167,9 @@ namespace Fermion
         bool memoryOnly = false;
         MemoryMeshType memoryMeshType = MemoryMeshType::None;
 
+        // Always rasterized as an occluder, whatever its size or triangle count
+        bool isOccluder = false;
+
         std::vector<AssetHandle> submeshMaterials;
 
         MeshComponent() = default;
@@ -11,4 +11,10 @@ namespace Fermion
     {
         return m_scene->getEntityManager().getEntityByUUID(getParentUUID());
     }
+
+    void Entity::setParentUUID(UUID parent)
+    {
+        getComponent<RelationshipComponent>().parentHandle = parent;
+        m_scene->getEntityManager().markTransformHierarchyDirty();
+    }
 } // namespace Fermion
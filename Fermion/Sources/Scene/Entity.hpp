@@ -167,7 +167,7 @@ namespace Fermion
                     parentChildren.emplace_back(getUUID());
             }
         }
-        void setParentUUID(UUID parent) { getComponent<RelationshipComponent>().parentHandle = parent; }
+        void setParentUUID(UUID parent);
         UUID getParentUUID() const { return getComponent<RelationshipComponent>().parentHandle; }
 
         std::vector<UUID> &getChildren() { return getComponent<RelationshipComponent>().children; }
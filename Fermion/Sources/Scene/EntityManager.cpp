@@ -3,7 +3,7 @@
 
 namespace Fermion
 {
-    EntityManager::EntityManager(Scene *scene) : m_scene(scene)
+    EntityManager::EntityManager(Scene *scene) : m_scene(scene), m_spatialIndex(m_registry)
     {
     }
 
@@ -41,11 +41,38 @@ namespace Fermion
             entity.addComponent<TagComponent>(name);
 
         entity.addComponent<RelationshipComponent>();
+        entity.addComponent<WorldTransformComponent>();
         m_entityMap[uuid] = entity;
+        m_transformHierarchyDirty = true;
 
         return entity;
     }
 
+    void EntityManager::createEntitiesWithUUIDs(const UUID *uuids, const TransformComponent *transforms, size_t count,
+                                                std::vector<entt::entity> &outEntities)
+    {
+        FM_PROFILE_FUNCTION();
+
+        outEntities.resize(count);
+        if (count == 0)
+            return;
+
+        m_registry.create(outEntities.begin(), outEntities.end());
+        const std::vector<IDComponent> ids(uuids, uuids + count);
+        m_registry.insert<IDComponent>(outEntities.begin(), outEntities.end(), ids.begin());
+        if (transforms)
+            m_registry.insert<TransformComponent>(outEntities.begin(), outEntities.end(), transforms);
+        else
+            m_registry.insert<TransformComponent>(outEntities.begin(), outEntities.end());
+        m_registry.insert<RelationshipComponent>(outEntities.begin(), outEntities.end());
+        m_registry.insert<WorldTransformComponent>(outEntities.begin(), outEntities.end());
+
+        m_entityMap.reserve(m_entityMap.size() + count);
+        for (size_t i = 0; i < count; ++i)
+            m_entityMap[uuids[i]] = outEntities[i];
+        m_transformHierarchyDirty = true;
+    }
+
     void EntityManager::destroyEntity(Entity entity)
     {
         if (!entity)
@@ -64,7 +91,59 @@ namespace Fermion
         }
 
         m_entityMap.erase(entity.getUUID());
+        m_spatialIndex.removeEntity(entity);
         m_registry.destroy(entity);
+        m_transformHierarchyDirty = true;
+    }
+
+    template <typename... Component>
+    static void cloneStorages(entt::registry &dst, const entt::registry &src)
+    {
+        ([&]()
+         {
+            const auto *from = src.storage<Component>();
+            if (!from || from->empty())
+                return;
+            // Entities and components are iterated in the same packed order
+            const entt::sparse_set &entities = *from;
+            dst.storage<Component>().insert(entities.begin(), entities.end(), from->begin()); }(),
+         ...);
+    }
+
+    template <typename... Component>
+    static void cloneStorages(ComponentGroup<Component...>, entt::registry &dst, const entt::registry &src)
+    {
+        cloneStorages<Component...>(dst, src);
+    }
+
+    void EntityManager::cloneRegistry(entt::registry &dst) const
+    {
+        FM_PROFILE_FUNCTION();
+
+        for (auto entity : m_registry.view<IDComponent>())
+        {
+            [[maybe_unused]] const entt::entity created = dst.create(entity);
+            FERMION_ASSERT(created == entity, "cloneRegistry expects an empty destination registry");
+        }
+
+        cloneStorages<IDComponent, TagComponent, WorldTransformComponent>(dst, m_registry);
+        cloneStorages(AllComponents{}, dst, m_registry);
+    }
+
+    void EntityManager::restoreRegistry(entt::registry &&registry)
+    {
+        FM_PROFILE_FUNCTION();
+
+        // Proxies live in the registry being replaced
+        m_spatialIndex.clear();
+        m_registry = std::move(registry);
+
+        m_entityMap.clear();
+        for (auto [entity, id] : m_registry.view<IDComponent>().each())
+            m_entityMap[id.ID] = entity;
+
+        m_transformNodes.clear();
+        m_transformHierarchyDirty = true;
     }
 
     Entity EntityManager::duplicateEntity(Entity entity)
@@ -162,4 +241,120 @@ namespace Fermion
         glm::mat4 localTransform = glm::inverse(parentTransform) * transform.getTransform();
         transform.setTransform(localTransform);
     }
+
+    void EntityManager::updateWorldTransforms()
+    {
+        FM_PROFILE_FUNCTION();
+
+        if (m_transformHierarchyDirty)
+            rebuildTransformHierarchy();
+        FERMION_ASSERT(isTransformHierarchyValid(), "Parent changed without marking the transform hierarchy dirty");
+
+        for (TransformNode &node : m_transformNodes)
+        {
+            const auto &local = m_registry.get<TransformComponent>(node.entity);
+
+            bool changed = node.changed ||
+                           (node.parent >= 0 && m_transformNodes[node.parent].changed) ||
+                           node.translation != local.translation ||
+                           node.rotation != local.rotation ||
+                           node.scale != local.scale;
+            node.changed = changed;
+            if (!changed)
+                continue;
+
+            node.translation = local.translation;
+            node.rotation = local.rotation;
+            node.scale = local.scale;
+
+            glm::mat4 &world = m_registry.get<WorldTransformComponent>(node.entity).transform;
+            if (node.parent >= 0)
+                world = m_registry.get<WorldTransformComponent>(m_transformNodes[node.parent].entity).transform *
+                        local.getTransform();
+            else
+                world = local.getTransform();
+
+            if (auto *proxy = m_registry.try_get<SpatialProxyComponent>(node.entity))
+                proxy->transformDirty = true;
+        }
+
+        // Parents are visited first, so flags can only be cleared once the whole pass is done
+        for (TransformNode &node : m_transformNodes)
+            node.changed = false;
+
+        m_spatialIndex.update();
+    }
+
+    const glm::mat4 &EntityManager::getWorldTransform(Entity entity) const
+    {
+        return m_registry.get<WorldTransformComponent>(entity).transform;
+    }
+
+    TransformComponent EntityManager::getCachedWorldSpaceTransform(Entity entity) const
+    {
+        TransformComponent transformComponent;
+        transformComponent.setTransform(getWorldTransform(entity));
+        return transformComponent;
+    }
+
+    void EntityManager::rebuildTransformHierarchy()
+    {
+        FM_PROFILE_FUNCTION();
+
+        auto view = m_registry.view<RelationshipComponent, TransformComponent, WorldTransformComponent>();
+
+        // The child's parent handle is authoritative; children lists are only used by the editor hierarchy
+        std::unordered_map<entt::entity, std::vector<entt::entity>> childrenOf;
+        std::vector<entt::entity> roots;
+        for (auto entity : view)
+        {
+            Entity parent = tryGetEntityByUUID(view.get<RelationshipComponent>(entity).parentHandle);
+            if (parent && view.contains(parent))
+                childrenOf[parent].push_back(entity);
+            else
+                roots.push_back(entity); // missing parents are treated as roots, same as getWorldSpaceTransformMatrix
+        }
+
+        m_transformNodes.clear();
+        m_transformNodes.reserve(m_registry.view<WorldTransformComponent>().size());
+
+        std::vector<std::pair<entt::entity, int32_t>> stack;
+        for (auto root : roots)
+        {
+            stack.emplace_back(root, -1);
+            while (!stack.empty())
+            {
+                auto [entity, parentIndex] = stack.back();
+                stack.pop_back();
+
+                int32_t index = static_cast<int32_t>(m_transformNodes.size());
+                TransformNode &node = m_transformNodes.emplace_back();
+                node.entity = entity;
+                node.parent = parentIndex;
+                node.parentUUID = view.get<RelationshipComponent>(entity).parentHandle;
+                node.changed = true;
+
+                if (auto iter = childrenOf.find(entity); iter != childrenOf.end())
+                {
+                    for (auto child : iter->second)
+                        stack.emplace_back(child, index);
+                }
+            }
+        }
+
+        m_transformHierarchyDirty = false;
+    }
+
+    bool EntityManager::isTransformHierarchyValid() const
+    {
+        // Debug check that every re-parenting path went through markTransformHierarchyDirty()
+        for (const TransformNode &node : m_transformNodes)
+        {
+            if (!m_registry.valid(node.entity))
+                return false;
+            if (m_registry.get<RelationshipComponent>(node.entity).parentHandle != node.parentUUID)
+                return false;
+        }
+        return true;
+    }
 } // namespace Fermion
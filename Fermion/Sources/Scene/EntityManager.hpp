@@ -4,9 +4,11 @@
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 
 #include "Scene/Entity.hpp"
+#include "Scene/SceneSpatialIndex.hpp"
 
 namespace Fermion
 {
@@ -21,6 +23,10 @@ namespace Fermion
         Entity createEntity(std::string name = std::string());
         Entity createChildEntity(Entity parent, std::string name = std::string());
         Entity createEntityWithUUID(UUID uuid, std::string name = std::string());
+        // Bulk version of createEntityWithUUID for loaders: one registry insert per component type.
+        // 'transforms' may be null for default transforms; tags are left to the caller.
+        void createEntitiesWithUUIDs(const UUID *uuids, const TransformComponent *transforms, size_t count,
+                                     std::vector<entt::entity> &outEntities);
 
         void destroyEntity(Entity entity);
         Entity duplicateEntity(Entity entity);
@@ -29,11 +35,47 @@ namespace Fermion
         Entity getPrimaryCameraEntity();
         Entity tryGetEntityByUUID(UUID uuid);
 
+        // Storage-to-storage copy of every entity and its persistent components into an empty registry.
+        // Entity identifiers are kept, so handles into this registry stay valid in the copy.
+        void cloneRegistry(entt::registry &dst) const;
+        // Replaces the registry with 'registry' (typically filled by cloneRegistry()) and rebuilds the lookups
+        void restoreRegistry(entt::registry &&registry);
+
         glm::mat4 getWorldSpaceTransformMatrix(Entity entity);
         TransformComponent getWorldSpaceTransform(Entity entity);
         void convertToWorldSpace(Entity entity);
         void convertToLocalSpace(Entity entity);
 
+        // Refreshes WorldTransformComponent for every entity whose local transform (or an ancestor's) changed
+        // since the last call. Cheap when nothing moved: one compare per entity, no hash lookups.
+        void updateWorldTransforms();
+        // Must be called whenever a parent handle changes outside this class; Entity::setParentUUID does it
+        void markTransformHierarchyDirty() { m_transformHierarchyDirty = true; }
+        // Cached world matrix as of the last updateWorldTransforms()
+        const glm::mat4 &getWorldTransform(Entity entity) const;
+        TransformComponent getCachedWorldSpaceTransform(Entity entity) const;
+
+        // Mesh bounds BVH, refreshed by updateWorldTransforms()
+        SceneSpatialIndex &getSpatialIndex() { return m_spatialIndex; }
+        const SceneSpatialIndex &getSpatialIndex() const { return m_spatialIndex; }
+
+    private:
+        struct TransformNode
+        {
+            entt::entity entity = entt::null;
+            int32_t parent = -1; // index into m_transformNodes, always smaller than the node's own index
+            UUID parentUUID = 0;
+
+            // Local TRS the cached world matrix was built from
+            glm::vec3 translation{0.0f};
+            glm::vec3 rotation{0.0f};
+            glm::vec3 scale{1.0f};
+            bool changed = true;
+        };
+
+        void rebuildTransformHierarchy();
+        bool isTransformHierarchyValid() const;
+
     private:
         template <typename... Component>
         static void copyComponentIfExists(Entity dst, Entity src)
@@ -55,5 +97,11 @@ namespace Fermion
         Scene *m_scene = nullptr;
         entt::registry m_registry;
         std::unordered_map<UUID, entt::entity> m_entityMap;
+
+        // Flattened hierarchy, parents always before their children
+        std::vector<TransformNode> m_transformNodes;
+        bool m_transformHierarchyDirty = true;
+
+        SceneSpatialIndex m_spatialIndex;
     };
 } // namespace Fermion
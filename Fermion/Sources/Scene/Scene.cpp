@@ -8,15 +8,98 @@
 #include "Physics/Physics2D.hpp"
 #include "Physics/Physics3D.hpp"
 #include "Script/ScriptManager.hpp"
+#include "Core/JobSystem.hpp"
 #include <glm/glm.hpp>
 #include "Core/Log.hpp"
 
 namespace Fermion
 {
+    // Editor billboards are the same for every scene. Weak references share them between live scenes
+    // without keeping GPU textures alive past the last scene that drew them.
+    static std::weak_ptr<Texture2D> s_lightTexture, s_cameraTexture;
+
+    static std::shared_ptr<Texture2D> getSharedIcon(std::weak_ptr<Texture2D> &cache, const std::string &path)
+    {
+        if (auto texture = cache.lock())
+            return texture;
+        std::shared_ptr<Texture2D> texture = Texture2D::create(path);
+        cache = texture;
+        return texture;
+    }
+
+    // World bounds of every caster that can throw a shadow into the view: the view frustum up to the shadow
+    // distance (the range the cascades cover), stretched towards the light until it leaves the scene
+    static AABB getShadowCasterBounds(const SceneRendererCamera &camera, float shadowDistance, const glm::vec3 &toLight,
+                                      const AABB &sceneBounds)
+    {
+        const glm::mat4 inverseProjection = glm::inverse(camera.camera.getProjection());
+        const glm::mat4 inverseView = glm::inverse(camera.view);
+        auto unproject = [&inverseProjection](float x, float y, float z)
+        {
+            const glm::vec4 point = inverseProjection * glm::vec4(x, y, z, 1.0f);
+            return glm::vec3(point) / point.w;
+        };
+
+        // Same depth range as ShadowMapRenderer::fitCascades
+        const float nearDepth = -unproject(0.0f, 0.0f, -1.0f).z;
+        float farDepth = -unproject(0.0f, 0.0f, 1.0f).z;
+        const float maxDistance = std::max(shadowDistance, 1e-2f);
+        if (!std::isfinite(farDepth) || farDepth <= nearDepth || farDepth > nearDepth + maxDistance)
+            farDepth = nearDepth + maxDistance;
+
+        AABB bounds{glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+        for (int c = 0; c < 4; ++c)
+        {
+            // View-space line through a frustum corner, parameterized by view depth
+            const glm::vec3 a = unproject((c & 1) ? 1.0f : -1.0f, (c & 2) ? 1.0f : -1.0f, -1.0f);
+            const glm::vec3 b = unproject((c & 1) ? 1.0f : -1.0f, (c & 2) ? 1.0f : -1.0f, 0.0f);
+            const glm::vec3 delta = (b - a) / (a.z - b.z);
+            const glm::vec3 start = a + delta * a.z;
+            for (float depth : {nearDepth, farDepth})
+            {
+                const glm::vec3 corner = glm::vec3(inverseView * glm::vec4(start + delta * depth, 1.0f));
+                bounds.min = glm::min(bounds.min, corner);
+                bounds.max = glm::max(bounds.max, corner);
+            }
+        }
+
+        // The box swept along the light lies within the box and its far end together
+        const glm::vec3 sweep = glm::normalize(toLight) * glm::length(sceneBounds.max - sceneBounds.min);
+        bounds.min = glm::min(bounds.min, bounds.min + sweep);
+        bounds.max = glm::max(bounds.max, bounds.max + sweep);
+        return bounds;
+    }
+
+    template <typename Rigidbody>
+    static void recordPhysicsPoses(entt::registry &registry, bool beforeStep)
+    {
+        auto view = registry.view<TransformComponent, Rigidbody>();
+        for (auto entity : view)
+        {
+            // Kinematic bodies follow their transform, so they already render where gameplay put them
+            if (view.template get<Rigidbody>(entity).type != Rigidbody::BodyType::Dynamic)
+            {
+                registry.remove<PhysicsInterpolationComponent>(entity);
+                continue;
+            }
+
+            const auto &transform = view.template get<TransformComponent>(entity);
+            if (beforeStep)
+            {
+                auto &pose = registry.get_or_emplace<PhysicsInterpolationComponent>(entity);
+                pose.previousTranslation = transform.translation;
+                pose.previousRotation = glm::quat(transform.rotation);
+            }
+            else if (auto *pose = registry.try_get<PhysicsInterpolationComponent>(entity))
+            {
+                pose->currentTranslation = transform.translation;
+                pose->currentRotation = transform.rotation;
+            }
+        }
+    }
+
     Scene::Scene() : m_entityManager(std::make_unique<EntityManager>(this))
     {
-        m_lightTexture = Texture2D::create("../Boson/Resources/Icons/light.png");
-        m_cameraTexture = Texture2D::create("../Boson/Resources/Icons/Camera.png");
         m_physicsWorld2D = std::make_unique<Physics2DWorld>();
         m_physicsWorld3D = std::make_unique<Physics3DWorld>();
     }
@@ -49,49 +132,20 @@ namespace Fermion
         return *m_entityManager;
     }
 
-    template <typename... Component>
-    static void copyComponent(entt::registry &dst, entt::registry &src,
-                              const std::unordered_map<UUID, entt::entity> &enttMap)
-    {
-        ([&]()
-         {
-            auto view = src.view<Component>();
-            for (auto srcEntity: view) {
-                entt::entity dstEntity = enttMap.at(src.get<IDComponent>(srcEntity).ID);
-
-                auto &srcComponent = src.get<Component>(srcEntity);
-                dst.emplace_or_replace<Component>(dstEntity, srcComponent);
-            } }(), ...);
-    }
-
-    template <typename... Component>
-    static void copyComponent(ComponentGroup<Component...>, entt::registry &dst, entt::registry &src,
-                              const std::unordered_map<UUID, entt::entity> &enttMap)
-    {
-        copyComponent<Component...>(dst, src, enttMap);
-    }
-
     std::shared_ptr<Scene> Scene::copy(std::shared_ptr<Scene> other)
     {
+        FM_PROFILE_FUNCTION();
+
         std::shared_ptr<Scene> newScene = std::make_shared<Scene>();
 
         newScene->m_viewportWidth = other->m_viewportWidth;
         newScene->m_viewportHeight = other->m_viewportHeight;
+        newScene->m_environmentSettings = other->m_environmentSettings;
+        newScene->m_physicsSettings = other->m_physicsSettings;
 
-        auto &srcSceneRegistry = other->getRegistry();
-        auto &dstSceneRegistry = newScene->getRegistry();
-        std::unordered_map<UUID, entt::entity> enttMap;
-
-        auto idView = srcSceneRegistry.view<IDComponent>();
-        for (auto e : idView)
-        {
-            UUID uuid = srcSceneRegistry.get<IDComponent>(e).ID;
-            const auto &name = srcSceneRegistry.get<TagComponent>(e).tag;
-            Entity newEntity = newScene->createEntityWithUUID(uuid, name);
-            enttMap[uuid] = (entt::entity)newEntity;
-        }
-
-        copyComponent(AllComponents{}, dstSceneRegistry, srcSceneRegistry, enttMap);
+        entt::registry registry;
+        other->getEntityManager().cloneRegistry(registry);
+        newScene->getEntityManager().restoreRegistry(std::move(registry));
 
         return newScene;
     }
@@ -99,6 +153,8 @@ namespace Fermion
     void Scene::onRuntimeStart()
     {
         m_isRunning = true;
+        m_physicsClock.reset();
+        m_entityManager->updateWorldTransforms();
         if (m_physicsWorld2D)
             m_physicsWorld2D->start(this);
         if (m_physicsWorld3D)
@@ -121,11 +177,14 @@ namespace Fermion
             m_physicsWorld2D->stop();
         if (m_physicsWorld3D)
             m_physicsWorld3D->stop(this);
+        getRegistry().clear<PhysicsInterpolationComponent>();
         ScriptManager::onRuntimeStop();
     }
 
     void Scene::onSimulationStart()
     {
+        m_physicsClock.reset();
+        m_entityManager->updateWorldTransforms();
         if (m_physicsWorld2D)
             m_physicsWorld2D->start(this);
         if (m_physicsWorld3D)
@@ -147,53 +206,47 @@ namespace Fermion
             m_physicsWorld2D->stop();
         if (m_physicsWorld3D)
             m_physicsWorld3D->stop(this);
+        getRegistry().clear<PhysicsInterpolationComponent>();
         ScriptManager::onRuntimeStop();
     }
 
     void Scene::onRenderEditor(std::shared_ptr<SceneRenderer> renderer, EditorCamera &camera, bool showRenderEntities)
     {
         FM_PROFILE_FUNCTION();
+        m_entityManager->updateWorldTransforms();
+        if (renderer->isHeadless())
+        {
+            renderer->GetDebugRenderer()->ClearRenderQueue();
+            return;
+        }
+
         renderer->beginScene(camera);
         if (showRenderEntities)
         {
+            // Gizmo icons are only needed here, so scenes that never draw in the editor don't touch the GPU
+            if (!m_cameraTexture)
+            {
+                m_lightTexture = getSharedIcon(s_lightTexture, "../Boson/Resources/Icons/light.png");
+                m_cameraTexture = getSharedIcon(s_cameraTexture, "../Boson/Resources/Icons/Camera.png");
+            }
 
             {
-                auto cameraView = getRegistry().view<TransformComponent, CameraComponent>();
+                auto cameraView = getRegistry().view<WorldTransformComponent, CameraComponent>();
                 for (auto entity : cameraView)
                 {
-                    Entity sceneEntity{entity, this};
-                    TransformComponent worldTransform = m_entityManager->getWorldSpaceTransform(sceneEntity);
-                    renderer->drawQuadBillboard(worldTransform.translation, glm::vec2{1.0f, 1.0f}, m_cameraTexture, 1.0f,
+                    const auto &worldTransform = cameraView.get<WorldTransformComponent>(entity);
+                    renderer->drawQuadBillboard(worldTransform.getTranslation(), glm::vec2{1.0f, 1.0f}, m_cameraTexture, 1.0f,
                                                 glm::vec4(1.0f), (int)entity);
                 }
             }
-            {
-                auto defaultView = getRegistry().view<TransformComponent, MeshComponent>();
-                for (auto entity : defaultView)
-                {
-                    auto &mesh = defaultView.get<MeshComponent>(entity);
-                    Entity sceneEntity{entity, this};
-                    glm::mat4 worldTransform = m_entityManager->getWorldSpaceTransformMatrix(sceneEntity);
-
-                    // Check if this entity also has an AnimatorComponent
-                    if (sceneEntity.hasComponent<AnimatorComponent>())
-                    {
-                        auto &animator = sceneEntity.getComponent<AnimatorComponent>();
-                        renderer->submitSkinnedMesh(mesh, animator, worldTransform, (int)entity);
-                    }
-                    else
-                    {
-                        renderer->submitMesh(mesh, worldTransform, (int)entity);
-                    }
-                }
-            }
+            submitMeshes(renderer);
 
             // Reset lighting state so removing lights takes effect immediately
             m_environmentLight.directionalLights.clear();
 
             // Directional Lights
             {
-                auto directionalLights = getRegistry().group<DirectionalLightComponent>(entt::get<TransformComponent>);
+                auto directionalLights = getRegistry().group<DirectionalLightComponent>(entt::get<WorldTransformComponent>);
                 m_environmentLight.directionalLights.reserve(directionalLights.size());
 
                 DirectionalLight mainDirLight;
@@ -202,8 +255,7 @@ namespace Fermion
                 for (auto entity : directionalLights)
                 {
                     auto &directionalLight = directionalLights.get<DirectionalLightComponent>(entity);
-                    Entity sceneEntity{entity, this};
-                    TransformComponent worldTransform = m_entityManager->getWorldSpaceTransform(sceneEntity);
+                    const auto &worldTransform = directionalLights.get<WorldTransformComponent>(entity);
 
                     DirectionalLight light = {
                         .direction = -worldTransform.getForward(),
@@ -220,7 +272,7 @@ namespace Fermion
                         m_environmentLight.directionalLights.push_back(light);
                     }
 
-                    renderer->drawQuadBillboard(worldTransform.translation, glm::vec2{1.0f, 1.0f}, m_lightTexture, 1.0f,
+                    renderer->drawQuadBillboard(worldTransform.getTranslation(), glm::vec2{1.0f, 1.0f}, m_lightTexture, 1.0f,
                                                 glm::vec4{directionalLight.color, 1.0f}, (int)entity);
                 }
 
@@ -232,33 +284,31 @@ namespace Fermion
             }
             // Point Lights
             {
-                auto pointLights = getRegistry().group<PointLightComponent>(entt::get<TransformComponent>);
+                auto pointLights = getRegistry().group<PointLightComponent>(entt::get<WorldTransformComponent>);
                 m_environmentLight.pointLights.clear();
                 m_environmentLight.pointLights.reserve(pointLights.size());
                 for (auto entity : pointLights)
                 {
                     auto &pointLight = pointLights.get<PointLightComponent>(entity);
-                    Entity sceneEntity{entity, this};
-                    TransformComponent worldTransform = m_entityManager->getWorldSpaceTransform(sceneEntity);
+                    const auto &worldTransform = pointLights.get<WorldTransformComponent>(entity);
                     m_environmentLight.pointLights.push_back(
-                        {.position = worldTransform.translation,
+                        {.position = worldTransform.getTranslation(),
                          .color = pointLight.color,
                          .intensity = pointLight.intensity,
                          .range = pointLight.range});
-                    renderer->drawQuadBillboard(worldTransform.translation, glm::vec2{1.0f, 1.0f}, m_lightTexture, 1.0f,
+                    renderer->drawQuadBillboard(worldTransform.getTranslation(), glm::vec2{1.0f, 1.0f}, m_lightTexture, 1.0f,
                                                 glm::vec4{pointLight.color, 1.0f}, (int)entity);
                 }
             }
             // Spotlights
             {
-                auto spotLights = getRegistry().group<SpotLightComponent>(entt::get<TransformComponent>);
+                auto spotLights = getRegistry().group<SpotLightComponent>(entt::get<WorldTransformComponent>);
                 m_environmentLight.spotLights.clear();
                 m_environmentLight.spotLights.reserve(spotLights.size());
                 for (auto entity : spotLights)
                 {
                     auto &spotLight = spotLights.get<SpotLightComponent>(entity);
-                    Entity sceneEntity{entity, this};
-                    TransformComponent worldTransform = m_entityManager->getWorldSpaceTransform(sceneEntity);
+                    const auto &worldTransform = spotLights.get<WorldTransformComponent>(entity);
 
                     float outerRad = glm::radians(spotLight.angle);
                     float innerRad = outerRad * (1.0f - spotLight.softness);
@@ -266,46 +316,43 @@ namespace Fermion
                     innerRad = glm::clamp(innerRad, 0.0f, outerRad - 0.001f);
 
                     m_environmentLight.spotLights.push_back(
-                        {.position = worldTransform.translation,
+                        {.position = worldTransform.getTranslation(),
                          .direction = worldTransform.getForward(),
                          .color = spotLight.color,
                          .intensity = spotLight.intensity,
                          .range = spotLight.range,
                          .innerConeAngle = glm::cos(innerRad),
                          .outerConeAngle = glm::cos(outerRad)});
-                    renderer->drawQuadBillboard(worldTransform.translation, glm::vec2{1.0f, 1.0f}, m_lightTexture, 1.0f,
+                    renderer->drawQuadBillboard(worldTransform.getTranslation(), glm::vec2{1.0f, 1.0f}, m_lightTexture, 1.0f,
                                                 glm::vec4{spotLight.color, 1.0f}, (int)entity);
                 }
             }
 
             {
-                auto group = getRegistry().group<>(entt::get<TransformComponent, SpriteRendererComponent>);
+                auto group = getRegistry().group<>(entt::get<WorldTransformComponent, SpriteRendererComponent>);
                 for (auto entity : group)
                 {
                     auto &sprite = group.get<SpriteRendererComponent>(entity);
-                    Entity sceneEntity{entity, this};
-                    glm::mat4 worldTransform = m_entityManager->getWorldSpaceTransformMatrix(sceneEntity);
+                    const glm::mat4 &worldTransform = group.get<WorldTransformComponent>(entity).transform;
                     renderer->drawSprite(worldTransform, sprite, (int)entity);
                 }
             }
             {
-                auto group = getRegistry().group<>(entt::get<TransformComponent, CircleRendererComponent>);
+                auto group = getRegistry().group<>(entt::get<WorldTransformComponent, CircleRendererComponent>);
                 for (auto entity : group)
                 {
                     auto &circle = group.get<CircleRendererComponent>(entity);
-                    Entity sceneEntity{entity, this};
-                    glm::mat4 worldTransform = m_entityManager->getWorldSpaceTransformMatrix(sceneEntity);
+                    const glm::mat4 &worldTransform = group.get<WorldTransformComponent>(entity).transform;
                     renderer->drawCircle(worldTransform, circle.color, circle.thickness, circle.fade,
                                          (int)entity);
                 }
             }
             {
-                auto group = getRegistry().group<>(entt::get<TransformComponent, TextComponent>);
+                auto group = getRegistry().group<>(entt::get<WorldTransformComponent, TextComponent>);
                 for (auto entity : group)
                 {
                     auto &text = group.get<TextComponent>(entity);
-                    Entity sceneEntity{entity, this};
-                    glm::mat4 worldTransform = m_entityManager->getWorldSpaceTransformMatrix(sceneEntity);
+                    const glm::mat4 &worldTransform = group.get<WorldTransformComponent>(entity).transform;
                     renderer->drawString(text.textString, worldTransform, text, (int)entity);
                 }
             }
@@ -326,18 +373,7 @@ namespace Fermion
     {
         FM_PROFILE_FUNCTION();
 
-        // Update all animators
-        {
-            auto view = getRegistry().view<AnimatorComponent>();
-            for (auto e : view)
-            {
-                auto &animator = view.get<AnimatorComponent>(e);
-                if (animator.runtimeAnimator)
-                {
-                    animator.runtimeAnimator->update(ts);
-                }
-            }
-        }
+        updateAnimators(ts);
 
         onRenderEditor(renderer, camera, showRenderEntities);
     }
@@ -347,29 +383,24 @@ namespace Fermion
     {
         FM_PROFILE_FUNCTION();
 
-        if (!m_isPaused || m_stepFrames-- > 0)
+        if (!m_isPaused)
         {
             onScriptStart(ts);
-            if (m_physicsWorld2D)
-                m_physicsWorld2D->step(this, ts);
-            if (m_physicsWorld3D)
-                m_physicsWorld3D->step(this, ts);
+            stepPhysics(ts);
         }
-
-        // Update all animators
+        else if (m_stepFrames-- > 0)
         {
-            auto view = getRegistry().view<AnimatorComponent>();
-            for (auto e : view)
-            {
-                auto &animator = view.get<AnimatorComponent>(e);
-                if (animator.runtimeAnimator)
-                {
-                    animator.runtimeAnimator->update(ts);
-                }
-            }
+            // Frame stepping advances exactly one fixed step
+            onScriptStart(ts);
+            runPhysicsStep(m_physicsClock.getStepSeconds());
         }
 
+        updateAnimators(ts);
+
+        if (!m_isPaused)
+            applyPhysicsInterpolation();
         onRenderEditor(renderer, camera, showRenderEntities);
+        restorePhysicsPoses();
     }
 
     void Scene::onUpdateRuntime(std::shared_ptr<SceneRenderer> renderer, Timestep ts, bool showRenderEntities)
@@ -378,25 +409,20 @@ namespace Fermion
 
         onScriptStart(ts);
 
-        // Physics
-        if (m_physicsWorld2D)
-            m_physicsWorld2D->step(this, ts);
-        if (m_physicsWorld3D)
-            m_physicsWorld3D->step(this, ts);
+        stepPhysics(ts);
+        m_entityManager->updateWorldTransforms();
+
+        updateAnimators(ts);
 
-        // Update all animators
+        // Nothing to draw into: skip camera lookup, culling and submission entirely
+        if (renderer->isHeadless())
         {
-            auto animView = getRegistry().view<AnimatorComponent>();
-            for (auto e : animView)
-            {
-                auto &animator = animView.get<AnimatorComponent>(e);
-                if (animator.runtimeAnimator)
-                {
-                    animator.runtimeAnimator->update(ts);
-                }
-            }
+            renderer->GetDebugRenderer()->ClearRenderQueue();
+            return;
         }
 
+        applyPhysicsInterpolation();
+
         {
             Camera *mainCamera = nullptr;
             glm::mat4 cameraTransform;
@@ -409,7 +435,7 @@ namespace Fermion
                     if (camera.primary)
                     {
                         mainCamera = &camera.camera;
-                        cameraTransform = m_entityManager->getWorldSpaceTransformMatrix(Entity{entity, this});
+                        cameraTransform = m_entityManager->getWorldTransform(Entity{entity, this});
                         break;
                     }
                 }
@@ -423,30 +449,11 @@ namespace Fermion
                     // Reset lighting state so removing lights takes effect immediately
                     m_environmentLight.directionalLights.clear();
 
-                    {
-                        auto defaultView = getRegistry().view<TransformComponent, MeshComponent>();
-                        for (auto entity : defaultView)
-                        {
-                            auto &mesh = defaultView.get<MeshComponent>(entity);
-                            Entity sceneEntity{entity, this};
-                            glm::mat4 worldTransform = m_entityManager->getWorldSpaceTransformMatrix(sceneEntity);
-
-                            // Check if this entity also has an AnimatorComponent
-                            if (sceneEntity.hasComponent<AnimatorComponent>())
-                            {
-                                auto &animator = sceneEntity.getComponent<AnimatorComponent>();
-                                renderer->submitSkinnedMesh(mesh, animator, worldTransform, (int)entity);
-                            }
-                            else
-                            {
-                                renderer->submitMesh(mesh, worldTransform, (int)entity);
-                            }
-                        }
-                    }
+                    submitMeshes(renderer);
                     // Directional Lights
                     {
                         auto directionalLights = getRegistry().group<DirectionalLightComponent>(
-                            entt::get<TransformComponent>);
+                            entt::get<WorldTransformComponent>);
                         m_environmentLight.directionalLights.reserve(directionalLights.size());
 
                         DirectionalLight mainDirLight;
@@ -455,8 +462,7 @@ namespace Fermion
                         for (auto entity : directionalLights)
                         {
                             auto &directionalLight = directionalLights.get<DirectionalLightComponent>(entity);
-                            Entity sceneEntity{entity, this};
-                            TransformComponent worldTransform = m_entityManager->getWorldSpaceTransform(sceneEntity);
+                            const auto &worldTransform = directionalLights.get<WorldTransformComponent>(entity);
 
                             DirectionalLight light = {
                                 .direction = -worldTransform.getForward(),
@@ -482,16 +488,15 @@ namespace Fermion
                     }
                     // Point Lights
                     {
-                        auto pointLights = getRegistry().group<PointLightComponent>(entt::get<TransformComponent>);
+                        auto pointLights = getRegistry().group<PointLightComponent>(entt::get<WorldTransformComponent>);
                         m_environmentLight.pointLights.clear();
                         m_environmentLight.pointLights.reserve(pointLights.size());
                         for (auto entity : pointLights)
                         {
                             auto &pointLight = pointLights.get<PointLightComponent>(entity);
-                            Entity sceneEntity{entity, this};
-                            TransformComponent worldTransform = m_entityManager->getWorldSpaceTransform(sceneEntity);
+                            const auto &worldTransform = pointLights.get<WorldTransformComponent>(entity);
                             m_environmentLight.pointLights.push_back(
-                                {.position = worldTransform.translation,
+                                {.position = worldTransform.getTranslation(),
                                  .color = pointLight.color,
                                  .intensity = pointLight.intensity,
                                  .range = pointLight.range});
@@ -499,14 +504,13 @@ namespace Fermion
                     }
                     // Spotlights
                     {
-                        auto spotLights = getRegistry().group<SpotLightComponent>(entt::get<TransformComponent>);
+                        auto spotLights = getRegistry().group<SpotLightComponent>(entt::get<WorldTransformComponent>);
                         m_environmentLight.spotLights.clear();
                         m_environmentLight.spotLights.reserve(spotLights.size());
                         for (auto entity : spotLights)
                         {
                             auto &spotLight = spotLights.get<SpotLightComponent>(entity);
-                            Entity sceneEntity{entity, this};
-                            TransformComponent worldTransform = m_entityManager->getWorldSpaceTransform(sceneEntity);
+                            const auto &worldTransform = spotLights.get<WorldTransformComponent>(entity);
 
                             float outerRad = glm::radians(spotLight.angle);
                             float innerRad = outerRad * (1.0f - spotLight.softness);
@@ -514,7 +518,7 @@ namespace Fermion
                             innerRad = glm::clamp(innerRad, 0.0f, outerRad - 0.001f);
 
                             m_environmentLight.spotLights.push_back(
-                                {.position = worldTransform.translation,
+                                {.position = worldTransform.getTranslation(),
                                  .direction = worldTransform.getForward(),
                                  .color = spotLight.color,
                                  .intensity = spotLight.intensity,
@@ -527,34 +531,30 @@ namespace Fermion
             }
 
             {
-                auto group = getRegistry().group<>(entt::get<TransformComponent, SpriteRendererComponent>);
+                auto group = getRegistry().group<>(entt::get<WorldTransformComponent, SpriteRendererComponent>);
                 for (auto entity : group)
                 {
                     auto &sprite = group.get<SpriteRendererComponent>(entity);
-
-                    Entity sceneEntity{entity, this};
-                    glm::mat4 worldTransform = m_entityManager->getWorldSpaceTransformMatrix(sceneEntity);
+                    const glm::mat4 &worldTransform = group.get<WorldTransformComponent>(entity).transform;
                     renderer->drawSprite(worldTransform, sprite, (int)entity);
                 }
             }
             {
-                auto group = getRegistry().group<>(entt::get<TransformComponent, CircleRendererComponent>);
+                auto group = getRegistry().group<>(entt::get<WorldTransformComponent, CircleRendererComponent>);
                 for (auto entity : group)
                 {
                     auto &circle = group.get<CircleRendererComponent>(entity);
-                    Entity sceneEntity{entity, this};
-                    glm::mat4 worldTransform = m_entityManager->getWorldSpaceTransformMatrix(sceneEntity);
+                    const glm::mat4 &worldTransform = group.get<WorldTransformComponent>(entity).transform;
                     renderer->drawCircle(worldTransform, circle.color, circle.thickness, circle.fade,
                                          (int)entity);
                 }
             }
             {
-                auto group = getRegistry().group<>(entt::get<TransformComponent, TextComponent>);
+                auto group = getRegistry().group<>(entt::get<WorldTransformComponent, TextComponent>);
                 for (auto entity : group)
                 {
                     auto &text = group.get<TextComponent>(entity);
-                    Entity sceneEntity{entity, this};
-                    glm::mat4 worldTransform = m_entityManager->getWorldSpaceTransformMatrix(sceneEntity);
+                    const glm::mat4 &worldTransform = group.get<WorldTransformComponent>(entity).transform;
                     renderer->drawString(text.textString, worldTransform, text, (int)entity);
                 }
             }
@@ -570,6 +570,191 @@ namespace Fermion
         // renderer->DrawCube(glm::mat4(1.0f), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
 
         renderer->endScene();
+
+        restorePhysicsPoses();
+    }
+
+    void Scene::stepPhysics(Timestep ts)
+    {
+        FM_PROFILE_FUNCTION();
+
+        m_physicsClock.setStepSeconds(1.0f / std::max(m_physicsSettings.fixedUpdateRate, 1.0f));
+        m_physicsClock.setMaxSteps(m_physicsSettings.maxSubsteps);
+
+        const uint32_t steps = m_physicsClock.advance(ts);
+        for (uint32_t i = 0; i < steps; ++i)
+            runPhysicsStep(m_physicsClock.getStepSeconds());
+    }
+
+    void Scene::runPhysicsStep(float seconds)
+    {
+        auto &registry = getRegistry();
+
+        // Physics reads world transforms written by scripts and writes simulated poses back into local space
+        m_entityManager->updateWorldTransforms();
+        if (m_physicsSettings.interpolate)
+        {
+            recordPhysicsPoses<Rigidbody2DComponent>(registry, true);
+            recordPhysicsPoses<Rigidbody3DComponent>(registry, true);
+        }
+
+        if (m_physicsWorld2D)
+            m_physicsWorld2D->step(this, seconds);
+        if (m_physicsWorld3D)
+            m_physicsWorld3D->step(this, seconds);
+
+        if (m_physicsSettings.interpolate)
+        {
+            recordPhysicsPoses<Rigidbody2DComponent>(registry, false);
+            recordPhysicsPoses<Rigidbody3DComponent>(registry, false);
+        }
+    }
+
+    void Scene::applyPhysicsInterpolation()
+    {
+        if (!m_physicsSettings.interpolate)
+            return;
+
+        FM_PROFILE_FUNCTION();
+
+        const float alpha = m_physicsClock.getAlpha();
+        auto view = getRegistry().view<TransformComponent, PhysicsInterpolationComponent>();
+        for (auto entity : view)
+        {
+            auto &transform = view.get<TransformComponent>(entity);
+            auto &pose = view.get<PhysicsInterpolationComponent>(entity);
+
+            // Moved by something other than the last step (a script teleport): draw it where it is
+            if (transform.translation != pose.currentTranslation || transform.rotation != pose.currentRotation)
+                continue;
+
+            transform.translation = glm::mix(pose.previousTranslation, pose.currentTranslation, alpha);
+            transform.rotation = glm::eulerAngles(glm::slerp(pose.previousRotation, glm::quat(pose.currentRotation), alpha));
+            pose.applied = true;
+            m_physicsPosesApplied = true;
+        }
+
+        if (m_physicsPosesApplied)
+            m_entityManager->updateWorldTransforms();
+    }
+
+    void Scene::restorePhysicsPoses()
+    {
+        if (!m_physicsPosesApplied)
+            return;
+
+        // The world transform cache keeps the blended pose until the next update notices the change back
+        auto view = getRegistry().view<TransformComponent, PhysicsInterpolationComponent>();
+        for (auto entity : view)
+        {
+            auto &pose = view.get<PhysicsInterpolationComponent>(entity);
+            if (!pose.applied)
+                continue;
+
+            auto &transform = view.get<TransformComponent>(entity);
+            transform.translation = pose.currentTranslation;
+            transform.rotation = pose.currentRotation;
+            pose.applied = false;
+        }
+        m_physicsPosesApplied = false;
+    }
+
+    void Scene::submitMeshes(const std::shared_ptr<SceneRenderer> &renderer)
+    {
+        FM_PROFILE_FUNCTION();
+
+        auto &registry = getRegistry();
+        auto &spatialIndex = m_entityManager->getSpatialIndex();
+        // Meshes added or changed since the last transform update need their proxies before the queries
+        spatialIndex.update();
+
+        m_visibleMeshes.clear();
+        spatialIndex.queryFrustum(renderer->getCameraFrustumPlanes(), m_visibleMeshes);
+
+        // Occluders have to be in before the first mesh is tested against them
+        for (auto entity : m_visibleMeshes)
+        {
+            const auto &mesh = registry.get<MeshComponent>(entity);
+            if (!registry.all_of<AnimatorComponent>(entity))
+                renderer->submitOccluder(mesh, registry.get<WorldTransformComponent>(entity).transform, mesh.isOccluder);
+        }
+
+        auto submit = [&](entt::entity entity, bool visible)
+        {
+            auto &mesh = registry.get<MeshComponent>(entity);
+            const glm::mat4 &worldTransform = registry.get<WorldTransformComponent>(entity).transform;
+            if (auto *animator = registry.try_get<AnimatorComponent>(entity))
+                renderer->submitSkinnedMesh(mesh, *animator, worldTransform, (int)entity, false, visible);
+            else
+                renderer->submitMesh(mesh, worldTransform, (int)entity, false, visible);
+        };
+
+        for (auto entity : m_visibleMeshes)
+            submit(entity, true);
+
+        // Meshes outside the view can still cast shadows into it. The shadow pass uses the main directional
+        // light, or the first one when none is marked main
+        const auto &sceneInfo = renderer->getSceneInfo();
+        AABB sceneBounds;
+        if (!sceneInfo.environmentSettings.enableShadows || !spatialIndex.getTree().getRootAABB(sceneBounds))
+            return;
+
+        std::optional<glm::vec3> toLight;
+        auto directionalLights = registry.view<DirectionalLightComponent, WorldTransformComponent>();
+        for (auto entity : directionalLights)
+        {
+            const bool mainLight = directionalLights.get<DirectionalLightComponent>(entity).mainLight;
+            if (toLight && !mainLight)
+                continue;
+            toLight = -directionalLights.get<WorldTransformComponent>(entity).getForward();
+            if (mainLight)
+                break;
+        }
+        if (!toLight)
+            return;
+
+        for (auto entity : m_visibleMeshes)
+        {
+            const auto index = static_cast<size_t>(entt::to_entity(entity));
+            if (index >= m_meshVisibilityMask.size())
+                m_meshVisibilityMask.resize(index + 1, 0);
+            m_meshVisibilityMask[index] = 1;
+        }
+
+        m_shadowCasterMeshes.clear();
+        spatialIndex.queryAABB(getShadowCasterBounds(sceneInfo.sceneCamera, sceneInfo.environmentSettings.shadowDistance,
+                                                     *toLight, sceneBounds),
+                               m_shadowCasterMeshes);
+        for (auto entity : m_shadowCasterMeshes)
+        {
+            const auto index = static_cast<size_t>(entt::to_entity(entity));
+            if (index >= m_meshVisibilityMask.size() || !m_meshVisibilityMask[index])
+                submit(entity, false);
+        }
+
+        for (auto entity : m_visibleMeshes)
+            m_meshVisibilityMask[static_cast<size_t>(entt::to_entity(entity))] = 0;
+    }
+
+    void Scene::updateAnimators(Timestep ts)
+    {
+        FM_PROFILE_FUNCTION();
+
+        // Duplicated entities can share one runtime animator; update each instance exactly once
+        std::vector<Animator *> animators;
+        auto view = getRegistry().view<AnimatorComponent>();
+        animators.reserve(view.size());
+        for (auto e : view)
+        {
+            auto &animator = view.get<AnimatorComponent>(e);
+            if (animator.runtimeAnimator)
+                animators.push_back(animator.runtimeAnimator.get());
+        }
+        std::sort(animators.begin(), animators.end());
+        animators.erase(std::unique(animators.begin(), animators.end()), animators.end());
+
+        JobSystem::parallelFor(static_cast<uint32_t>(animators.size()), 8, [&animators, ts](uint32_t i)
+                               { animators[i]->update(ts); });
     }
 
     void Scene::onScriptStart(Timestep ts)
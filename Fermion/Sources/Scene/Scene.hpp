@@ -3,6 +3,7 @@
 #include <memory>
 #include <unordered_map>
 #include "Core/Timestep.hpp"
+#include "Core/FixedTimestep.hpp"
 #include "Core/UUID.hpp"
 #include "Renderer/Model/Mesh.hpp"
 #include "Renderer/Camera/EditorCamera.hpp"
@@ -25,12 +26,27 @@ namespace Fermion
         uint32_t shadowMapSize = 2048;
         float shadowBias = 0.01f;
         float shadowSoftness = 1.0f;
+        uint32_t shadowCascadeCount = 4;
+        float shadowCascadeSplitLambda = 0.75f;
+        float shadowDistance = 150.0f;
+        bool shadowStaticCache = true;
+        uint32_t shadowCacheUpdateBudget = 2;
         float normalMapStrength = 1.0f;
         float toksvigStrength = 1.0f;
 
         bool useIBL = true;
     };
 
+    struct ScenePhysicsSettings
+    {
+        // Physics steps per second, independent of the frame rate
+        float fixedUpdateRate = 60.0f;
+        // Cap on fixed steps per frame; time past it is dropped and the simulation runs slow instead
+        uint32_t maxSubsteps = 8;
+        // Draw dynamic bodies blended between their last two simulated poses
+        bool interpolate = true;
+    };
+
     struct PointLight
     {
         glm::vec3 position = {0.0f, 0.0f, 0.0f};
@@ -133,8 +149,22 @@ namespace Fermion
         SceneEnvironmentSettings &getEnvironmentSettings() { return m_environmentSettings; }
         const SceneEnvironmentSettings &getEnvironmentSettings() const { return m_environmentSettings; }
 
+        ScenePhysicsSettings &getPhysicsSettings() { return m_physicsSettings; }
+        const ScenePhysicsSettings &getPhysicsSettings() const { return m_physicsSettings; }
+
     private:
         void onScriptStart(Timestep ts);
+        void updateAnimators(Timestep ts);
+
+        // Runs as many fixed physics steps as the accumulated frame time allows
+        void stepPhysics(Timestep ts);
+        void runPhysicsStep(float seconds);
+        // Temporarily moves interpolated bodies to their render pose; restorePhysicsPoses() undoes it
+        void applyPhysicsInterpolation();
+        void restorePhysicsPoses();
+        // Submits the MeshComponents in the renderer's camera view, plus the ones that can shadow it, found
+        // with the spatial index
+        void submitMeshes(const std::shared_ptr<SceneRenderer> &renderer);
 
         void onRenderEditor(std::shared_ptr<SceneRenderer> renderer, EditorCamera &camera,
                             bool showRenderEntities = true);
@@ -150,6 +180,9 @@ namespace Fermion
 
         EnvironmentLight m_environmentLight;
         SceneEnvironmentSettings m_environmentSettings;
+        ScenePhysicsSettings m_physicsSettings;
+        FixedTimestep m_physicsClock;
+        bool m_physicsPosesApplied = false;
 
         bool m_hasDirectionalLight = false;
         std::shared_ptr<Texture2D> m_lightTexture = nullptr, m_cameraTexture = nullptr;
@@ -157,9 +190,15 @@ namespace Fermion
         std::unique_ptr<Physics2DWorld> m_physicsWorld2D;
         std::unique_ptr<Physics3DWorld> m_physicsWorld3D;
 
+        // Per-frame culling scratch, kept to avoid reallocating
+        std::vector<entt::entity> m_visibleMeshes;
+        std::vector<entt::entity> m_shadowCasterMeshes;
+        std::vector<uint8_t> m_meshVisibilityMask;
+
         friend class Entity;
         friend class SceneRenderer;
         friend class SceneSerializer;
+        friend class SceneSnapshot;
         friend class SceneHierarchyPanel;
         friend class Physics2DWorld;
         friend class Physics3DWorld;
@@ -75,6 +75,7 @@ namespace Fermion
 
                 out << YAML::Key << "MemoryOnly" << YAML::Value << mesh.memoryOnly;
                 out << YAML::Key << "MemoryMeshType" << YAML::Value << static_cast<uint16_t>(mesh.memoryMeshType);
+                out << YAML::Key << "IsOccluder" << YAML::Value << mesh.isOccluder;
 
                 if (!mesh.submeshMaterials.empty())
                 {
@@ -437,21 +438,33 @@ namespace Fermion
             out << YAML::Key << "ShadowMapSize" << YAML::Value << env.shadowMapSize;
             out << YAML::Key << "ShadowBias" << YAML::Value << env.shadowBias;
             out << YAML::Key << "ShadowSoftness" << YAML::Value << env.shadowSoftness;
+            out << YAML::Key << "ShadowCascadeCount" << YAML::Value << env.shadowCascadeCount;
+            out << YAML::Key << "ShadowCascadeSplitLambda" << YAML::Value << env.shadowCascadeSplitLambda;
+            out << YAML::Key << "ShadowDistance" << YAML::Value << env.shadowDistance;
+            out << YAML::Key << "ShadowStaticCache" << YAML::Value << env.shadowStaticCache;
+            out << YAML::Key << "ShadowCacheUpdateBudget" << YAML::Value << env.shadowCacheUpdateBudget;
             out << YAML::Key << "NormalMapStrength" << YAML::Value << env.normalMapStrength;
             out << YAML::Key << "ToksvigStrength" << YAML::Value << env.toksvigStrength;
             out << YAML::Key << "UseIBL" << YAML::Value << env.useIBL;
             out << YAML::EndMap;
         }
 
+        // Serialize PhysicsSettings
+        {
+            out << YAML::Key << "PhysicsSettings";
+            out << YAML::BeginMap;
+            auto &physics = m_scene->getPhysicsSettings();
+            out << YAML::Key << "FixedUpdateRate" << YAML::Value << physics.fixedUpdateRate;
+            out << YAML::Key << "MaxSubsteps" << YAML::Value << physics.maxSubsteps;
+            out << YAML::Key << "Interpolate" << YAML::Value << physics.interpolate;
+            out << YAML::EndMap;
+        }
+
         out << YAML::EndMap;
         std::ofstream fout(filepath);
         fout << out.c_str();
     }
 
-    void SceneSerializer::serializeRuntime(const std::filesystem::path &filepath)
-    {
-    }
-
     bool SceneSerializer::deserialize(const std::filesystem::path &filepath)
     {
         std::ifstream stream(filepath);
@@ -553,6 +566,11 @@ namespace Fermion
 
                     src.memoryOnly = memoryOnly;
 
+                    if (auto n = meshComponent["IsOccluder"]; n)
+                    {
+                        src.isOccluder = n.as<bool>();
+                    }
+
                     if (memoryOnly)
                     {
                         src.meshHandle = MeshFactory::createMemoryMesh(src.memoryMeshType);
@@ -1018,6 +1036,16 @@ namespace Fermion
                 env.shadowBias = n.as<float>();
             if (auto n = envNode["ShadowSoftness"]; n)
                 env.shadowSoftness = n.as<float>();
+            if (auto n = envNode["ShadowCascadeCount"]; n)
+                env.shadowCascadeCount = n.as<uint32_t>();
+            if (auto n = envNode["ShadowCascadeSplitLambda"]; n)
+                env.shadowCascadeSplitLambda = n.as<float>();
+            if (auto n = envNode["ShadowDistance"]; n)
+                env.shadowDistance = n.as<float>();
+            if (auto n = envNode["ShadowStaticCache"]; n)
+                env.shadowStaticCache = n.as<bool>();
+            if (auto n = envNode["ShadowCacheUpdateBudget"]; n)
+                env.shadowCacheUpdateBudget = n.as<uint32_t>();
             if (auto n = envNode["NormalMapStrength"]; n)
                 env.normalMapStrength = n.as<float>();
             if (auto n = envNode["ToksvigStrength"]; n)
@@ -1036,11 +1064,18 @@ namespace Fermion
             Log::Warn("[SceneSerializer] No EnvironmentSettings found in scene file, using defaults");
         }
 
-        return true;
-    }
+        // Deserialize PhysicsSettings; older scenes simply keep the defaults
+        if (auto physicsNode = data["PhysicsSettings"]; physicsNode && physicsNode.IsMap())
+        {
+            auto &physics = m_scene->getPhysicsSettings();
+            if (auto n = physicsNode["FixedUpdateRate"]; n)
+                physics.fixedUpdateRate = n.as<float>();
+            if (auto n = physicsNode["MaxSubsteps"]; n)
+                physics.maxSubsteps = n.as<uint32_t>();
+            if (auto n = physicsNode["Interpolate"]; n)
+                physics.interpolate = n.as<bool>();
+        }
 
-    bool SceneSerializer::deserializeRuntime(const std::filesystem::path &filepath)
-    {
-        return false;
+        return true;
     }
 } // namespace Fermion
@@ -12,6 +12,7 @@ namespace Fermion
 
         void serialize(const std::filesystem::path &filepath);
 
+        // Binary .fmrscene for the runtime, see SceneSerializer_Runtime.cpp
         void serializeRuntime(const std::filesystem::path &filepath);
 
         bool deserialize(const std::filesystem::path &filepath);
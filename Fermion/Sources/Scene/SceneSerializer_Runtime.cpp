@@ -0,0 +1,963 @@
+#include "fmpch.hpp"
+#include "SceneSerializer.hpp"
+#include "Entity.hpp"
+#include "Components.hpp"
+#include "EntityManager.hpp"
+#include "Project/Project.hpp"
+#include "Asset/AssetManager/RuntimeAssetManager.hpp"
+#include "Renderer/Model/MeshFactory.hpp"
+#include "Utils/PlatformUtils.hpp"
+
+#include <bit>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <type_traits>
+
+// Runtime scene file (.fmrscene), little-endian, written by the editor and loaded by the runtime:
+//
+//   RuntimeSceneHeader
+//   RuntimeSceneSection[sectionCount]        table of contents
+//   sections, each 16-byte aligned
+//
+// Component sections hold 'count' uint32 entity indices followed by 'count' records of 'stride' bytes.
+// Trivially copyable components are stored as the component itself (runtime pointers cleared) and go
+// straight from the mapped file into registry.insert(); the rest use small records that point into the
+// shared string table and handle table. A stride that doesn't match the running build rejects the file,
+// so a stale export falls back to the YAML scene instead of loading garbage.
+
+namespace Fermion
+{
+    namespace
+    {
+        constexpr uint32_t kRuntimeSceneMagic = 0x53524D46; // "FMRS" in ASCII
+        constexpr uint16_t kRuntimeSceneVersion = 5;
+        constexpr uint16_t kRuntimeSceneEndianTag = 0x0102;
+        constexpr uint64_t kSectionAlignment = 16;
+
+        enum class RuntimeSectionType : uint32_t
+        {
+            Entities = 0, // UUID per entity, defines the entity indices
+            Strings,      // char blob
+            Handles,      // uint64 blob: asset handles and child UUIDs
+            Environment,
+            Transform, // dense, one per entity, no index array
+            Tag,
+            Relationship,
+            SpriteRenderer,
+            Mesh,
+            DirectionalLight,
+            PointLight,
+            SpotLight,
+            CircleRenderer,
+            Text,
+            Rigidbody2D,
+            BoxCollider2D,
+            CircleCollider2D,
+            CapsuleCollider2D,
+            RevoluteJoint2D,
+            DistanceJoint2D,
+            Rigidbody3D,
+            BoxCollider3D,
+            CircleCollider3D,
+            CapsuleCollider3D,
+            MeshCollider3D,
+            HingeConstraint3D,
+            BoxSensor2D,
+            CircleSensor2D,
+            Camera,
+            Script,
+            ScriptContainer,
+            Animator,
+            PhysicsSettings
+        };
+
+        struct RuntimeSceneHeader
+        {
+            uint32_t magic = kRuntimeSceneMagic;
+            uint16_t version = kRuntimeSceneVersion;
+            uint16_t endianTag = kRuntimeSceneEndianTag;
+            uint32_t entityCount = 0;
+            uint32_t sectionCount = 0;
+            uint64_t fileSize = 0;
+        };
+
+        struct RuntimeSceneSection
+        {
+            RuntimeSectionType type;
+            uint32_t count = 0;
+            uint32_t stride = 0;
+            uint32_t reserved = 0;
+            uint64_t indexOffset = 0; // 0 for sections without an entity index array
+            uint64_t dataOffset = 0;
+        };
+
+        struct StringRef
+        {
+            uint32_t offset = 0;
+            uint32_t length = 0;
+        };
+
+        struct HandleRange
+        {
+            uint32_t offset = 0;
+            uint32_t count = 0;
+        };
+
+        struct TagRecord
+        {
+            StringRef tag;
+        };
+
+        struct RelationshipRecord
+        {
+            uint64_t parentHandle = 0;
+            HandleRange children;
+        };
+
+        struct SpriteRendererRecord
+        {
+            glm::vec4 color{1.0f};
+            uint64_t textureHandle = 0;
+        };
+
+        struct MeshRecord
+        {
+            uint64_t meshHandle = 0;
+            HandleRange submeshMaterials;
+            uint16_t memoryMeshType = 0;
+            uint8_t memoryOnly = 0;
+            uint8_t occluder = 0;
+            uint8_t padding[4] = {};
+        };
+
+        struct TextRecord
+        {
+            StringRef text;
+            glm::vec4 color{1.0f};
+            float kerning = 0.0f;
+            float lineSpacing = 0.0f;
+            uint64_t fontHandle = 0;
+        };
+
+        struct CameraRecord
+        {
+            int32_t projectionType = 0;
+            float perspectiveFOV = 0.0f;
+            float perspectiveNear = 0.0f;
+            float perspectiveFar = 0.0f;
+            float orthographicSize = 0.0f;
+            float orthographicNear = 0.0f;
+            float orthographicFar = 0.0f;
+            uint8_t primary = 0;
+            uint8_t fixedAspectRatio = 0;
+            uint8_t padding[2] = {};
+        };
+
+        struct ScriptRecord
+        {
+            StringRef className;
+        };
+
+        struct ScriptContainerRecord
+        {
+            StringRef classNames; // '\0' separated
+            uint32_t classCount = 0;
+            uint32_t padding = 0;
+        };
+
+        struct AnimatorRecord
+        {
+            uint64_t skeletonHandle = 0;
+            HandleRange animationClips;
+            uint32_t activeClipIndex = 0;
+            float speed = 1.0f;
+            uint8_t playing = 0;
+            uint8_t looping = 0;
+            uint8_t padding[6] = {};
+        };
+
+        template <typename... T>
+        constexpr bool kAllTriviallyCopyable = (std::is_trivially_copyable_v<T> && ...);
+
+        // Everything below is copied into the file byte for byte. Sections record their stride, so a size change
+        // is caught at load time, but a reordered or retyped field is not: bump kRuntimeSceneVersion whenever
+        // one of these layouts changes. Physics components keep their runtime pointer (written as null), so
+        // their stride also differs between 32- and 64-bit builds, and the loader rejects the other's files.
+        static_assert(kAllTriviallyCopyable<RuntimeSceneHeader, RuntimeSceneSection, UUID, SceneEnvironmentSettings,
+                                            ScenePhysicsSettings, TransformComponent, TagRecord, RelationshipRecord,
+                                            SpriteRendererRecord, MeshRecord, TextRecord, CameraRecord, ScriptRecord,
+                                            ScriptContainerRecord, AnimatorRecord>);
+        static_assert(kAllTriviallyCopyable<DirectionalLightComponent, PointLightComponent, SpotLightComponent,
+                                            CircleRendererComponent, Rigidbody2DComponent, BoxCollider2DComponent,
+                                            CircleCollider2DComponent, CapsuleCollider2DComponent,
+                                            RevoluteJoint2DComponent, DistanceJoint2DComponent, Rigidbody3DComponent,
+                                            BoxCollider3DComponent, CircleCollider3DComponent,
+                                            CapsuleCollider3DComponent, MeshCollider3DComponent,
+                                            HingeConstraint3DComponent, BoxSensor2DComponent,
+                                            CircleSensor2DComponent>);
+
+        template <typename T>
+        void appendBytes(std::vector<uint8_t> &buffer, const T &value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const size_t offset = buffer.size();
+            buffer.resize(offset + sizeof(T));
+            std::memcpy(buffer.data() + offset, &value, sizeof(T));
+        }
+
+        struct SectionBuilder
+        {
+            RuntimeSectionType type;
+            uint32_t stride = 0;
+            bool hasIndices = true;
+            std::vector<uint32_t> indices;
+            std::vector<uint8_t> data;
+
+            template <typename T>
+            void push(uint32_t entityIndex, const T &record)
+            {
+                FERMION_ASSERT(stride == sizeof(T), "Runtime scene record size mismatch");
+                if (hasIndices)
+                    indices.push_back(entityIndex);
+                appendBytes(data, record);
+            }
+
+            uint32_t getCount() const { return stride == 0 ? 0 : static_cast<uint32_t>(data.size() / stride); }
+        };
+
+        class RuntimeSceneWriter
+        {
+        public:
+            RuntimeSceneWriter(entt::registry &registry, const std::vector<entt::entity> &entities)
+                : m_registry(registry), m_entities(entities)
+            {
+            }
+
+            SectionBuilder &addSection(RuntimeSectionType type, uint32_t stride, bool hasIndices = true)
+            {
+                SectionBuilder &section = m_sections.emplace_back();
+                section.type = type;
+                section.stride = stride;
+                section.hasIndices = hasIndices;
+                return section;
+            }
+
+            // Stores the component as-is; 'clearRuntime' resets pointers into physics worlds and such
+            template <typename T, typename ClearRuntime>
+            void writeComponents(RuntimeSectionType type, ClearRuntime &&clearRuntime)
+            {
+                static_assert(std::is_trivially_copyable_v<T>, "Use a record type for this component");
+
+                SectionBuilder *section = nullptr;
+                for (uint32_t i = 0; i < m_entities.size(); ++i)
+                {
+                    const T *component = m_registry.try_get<T>(m_entities[i]);
+                    if (!component)
+                        continue;
+                    if (!section)
+                        section = &addSection(type, sizeof(T));
+
+                    T copy = *component;
+                    clearRuntime(copy);
+                    section->push(i, copy);
+                }
+            }
+
+            template <typename T>
+            void writeComponents(RuntimeSectionType type)
+            {
+                writeComponents<T>(type, [](T &) {});
+            }
+
+            // Builds a record per component with 'makeRecord(const T &) -> Record'
+            template <typename T, typename Record, typename MakeRecord>
+            void writeRecords(RuntimeSectionType type, MakeRecord &&makeRecord)
+            {
+                SectionBuilder *section = nullptr;
+                for (uint32_t i = 0; i < m_entities.size(); ++i)
+                {
+                    const T *component = m_registry.try_get<T>(m_entities[i]);
+                    if (!component)
+                        continue;
+                    if (!section)
+                        section = &addSection(type, sizeof(Record));
+
+                    const Record record = makeRecord(*component);
+                    section->push(i, record);
+                }
+            }
+
+            StringRef addString(const std::string &value)
+            {
+                if (auto it = m_stringLookup.find(value); it != m_stringLookup.end())
+                    return it->second;
+
+                StringRef ref{static_cast<uint32_t>(m_strings.size()), static_cast<uint32_t>(value.size())};
+                m_strings.insert(m_strings.end(), value.begin(), value.end());
+                m_stringLookup.emplace(value, ref);
+                return ref;
+            }
+
+            template <typename Handle>
+            HandleRange addHandles(const std::vector<Handle> &handles)
+            {
+                HandleRange range{static_cast<uint32_t>(m_handles.size()), static_cast<uint32_t>(handles.size())};
+                for (const auto &handle : handles)
+                    m_handles.push_back(static_cast<uint64_t>(handle));
+                return range;
+            }
+
+            bool write(const std::filesystem::path &filepath)
+            {
+                if (!m_strings.empty())
+                {
+                    SectionBuilder &strings = addSection(RuntimeSectionType::Strings, 1, false);
+                    strings.data.assign(m_strings.begin(), m_strings.end());
+                }
+                if (!m_handles.empty())
+                {
+                    SectionBuilder &handles = addSection(RuntimeSectionType::Handles, sizeof(uint64_t), false);
+                    for (uint64_t handle : m_handles)
+                        appendBytes(handles.data, handle);
+                }
+
+                RuntimeSceneHeader header;
+                header.entityCount = static_cast<uint32_t>(m_entities.size());
+                header.sectionCount = static_cast<uint32_t>(m_sections.size());
+
+                std::vector<RuntimeSceneSection> toc(m_sections.size());
+                uint64_t offset = alignOffset(sizeof(RuntimeSceneHeader) + toc.size() * sizeof(RuntimeSceneSection));
+                for (size_t i = 0; i < m_sections.size(); ++i)
+                {
+                    const SectionBuilder &section = m_sections[i];
+                    RuntimeSceneSection &entry = toc[i];
+                    entry.type = section.type;
+                    entry.count = section.getCount();
+                    entry.stride = section.stride;
+                    if (section.hasIndices)
+                    {
+                        entry.indexOffset = offset;
+                        offset = alignOffset(offset + section.indices.size() * sizeof(uint32_t));
+                    }
+                    entry.dataOffset = offset;
+                    offset = alignOffset(offset + section.data.size());
+                }
+                header.fileSize = offset;
+
+                std::ofstream file(filepath, std::ios::binary);
+                if (!file.is_open())
+                    return false;
+
+                file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char *>(toc.data()), toc.size() * sizeof(RuntimeSceneSection));
+                for (size_t i = 0; i < m_sections.size(); ++i)
+                {
+                    const SectionBuilder &section = m_sections[i];
+                    if (section.hasIndices)
+                    {
+                        padTo(file, toc[i].indexOffset);
+                        file.write(reinterpret_cast<const char *>(section.indices.data()),
+                                   section.indices.size() * sizeof(uint32_t));
+                    }
+                    padTo(file, toc[i].dataOffset);
+                    file.write(reinterpret_cast<const char *>(section.data.data()), section.data.size());
+                }
+                padTo(file, header.fileSize);
+
+                return file.good();
+            }
+
+        private:
+            static uint64_t alignOffset(uint64_t offset)
+            {
+                return (offset + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+            }
+
+            static void padTo(std::ofstream &file, uint64_t offset)
+            {
+                static const char zeros[kSectionAlignment] = {};
+                const uint64_t position = static_cast<uint64_t>(file.tellp());
+                if (offset > position)
+                    file.write(zeros, static_cast<std::streamsize>(offset - position));
+            }
+
+        private:
+            entt::registry &m_registry;
+            const std::vector<entt::entity> &m_entities;
+            std::deque<SectionBuilder> m_sections; // stable references while sections are added
+
+            std::vector<char> m_strings;
+            std::unordered_map<std::string, StringRef> m_stringLookup;
+            std::vector<uint64_t> m_handles;
+        };
+
+        // Validated view of one mapped section
+        struct SectionView
+        {
+            const RuntimeSceneSection *entry = nullptr;
+            const uint32_t *indices = nullptr;
+            const uint8_t *data = nullptr;
+
+            template <typename T>
+            const T *records() const { return reinterpret_cast<const T *>(data); }
+        };
+
+        class RuntimeSceneReader
+        {
+        public:
+            bool open(const uint8_t *data, size_t size)
+            {
+                if constexpr (std::endian::native != std::endian::little)
+                    return fail("runtime scenes are little-endian only");
+
+                if (size < sizeof(RuntimeSceneHeader))
+                    return fail("file is truncated");
+
+                m_data = data;
+                m_header = reinterpret_cast<const RuntimeSceneHeader *>(data);
+                if (m_header->magic != kRuntimeSceneMagic)
+                    return fail("not a runtime scene");
+                if (m_header->endianTag != kRuntimeSceneEndianTag)
+                    return fail("byte order mismatch");
+                if (m_header->version != kRuntimeSceneVersion)
+                    return fail(std::format("version {} (expected {})", m_header->version, kRuntimeSceneVersion));
+                if (m_header->fileSize != size)
+                    return fail("size mismatch");
+
+                const uint64_t tocEnd = sizeof(RuntimeSceneHeader) +
+                                        static_cast<uint64_t>(m_header->sectionCount) * sizeof(RuntimeSceneSection);
+                if (tocEnd > size)
+                    return fail("table of contents is truncated");
+
+                const auto *toc = reinterpret_cast<const RuntimeSceneSection *>(data + sizeof(RuntimeSceneHeader));
+                m_sections.reserve(m_header->sectionCount);
+                for (uint32_t i = 0; i < m_header->sectionCount; ++i)
+                {
+                    const RuntimeSceneSection &entry = toc[i];
+                    const uint64_t dataEnd = entry.dataOffset + static_cast<uint64_t>(entry.count) * entry.stride;
+                    if (entry.dataOffset % kSectionAlignment != 0 || dataEnd > size)
+                        return fail("section out of bounds");
+
+                    SectionView view;
+                    view.entry = &entry;
+                    view.data = data + entry.dataOffset;
+                    if (entry.indexOffset != 0)
+                    {
+                        const uint64_t indexEnd = entry.indexOffset + static_cast<uint64_t>(entry.count) * sizeof(uint32_t);
+                        if (entry.indexOffset % kSectionAlignment != 0 || indexEnd > size)
+                            return fail("section index out of bounds");
+                        view.indices = reinterpret_cast<const uint32_t *>(data + entry.indexOffset);
+                        for (uint32_t j = 0; j < entry.count; ++j)
+                        {
+                            if (view.indices[j] >= m_header->entityCount)
+                                return fail("entity index out of range");
+                        }
+                    }
+                    m_sections.push_back(view);
+
+                    if (entry.type == RuntimeSectionType::Strings)
+                    {
+                        m_strings = reinterpret_cast<const char *>(view.data);
+                        m_stringsSize = entry.count;
+                    }
+                    else if (entry.type == RuntimeSectionType::Handles)
+                    {
+                        m_handles = view.records<uint64_t>();
+                        m_handleCount = entry.count;
+                    }
+                }
+                return true;
+            }
+
+            // Null when missing or when the record layout differs from this build
+            const SectionView *find(RuntimeSectionType type, uint32_t stride) const
+            {
+                for (const SectionView &view : m_sections)
+                {
+                    if (view.entry->type != type)
+                        continue;
+                    if (view.entry->stride != stride)
+                        return nullptr;
+                    return &view;
+                }
+                return nullptr;
+            }
+
+            // Checks every section this build knows about before anything touches the scene
+            bool validateLayouts() const
+            {
+                for (const SectionView &view : m_sections)
+                {
+                    const uint32_t expected = getExpectedStride(view.entry->type);
+                    if (expected != 0 && view.entry->stride != expected)
+                        return fail(std::format("section {} has stride {} (expected {})",
+                                                static_cast<uint32_t>(view.entry->type), view.entry->stride, expected));
+                    if (view.entry->indexOffset == 0 && isComponentSection(view.entry->type))
+                        return fail("component section without entity indices");
+                }
+                if (const SectionView *transforms = find(RuntimeSectionType::Transform, sizeof(TransformComponent));
+                    transforms && transforms->entry->count != getEntityCount())
+                    return fail("transform section doesn't cover every entity");
+                return true;
+            }
+
+            std::string getString(StringRef ref) const
+            {
+                if (static_cast<uint64_t>(ref.offset) + ref.length > m_stringsSize)
+                    return {};
+                return std::string(m_strings + ref.offset, ref.length);
+            }
+
+            template <typename Handle>
+            void getHandles(HandleRange range, std::vector<Handle> &out) const
+            {
+                out.clear();
+                if (static_cast<uint64_t>(range.offset) + range.count > m_handleCount)
+                    return;
+                out.reserve(range.count);
+                for (uint32_t i = 0; i < range.count; ++i)
+                    out.emplace_back(m_handles[range.offset + i]);
+            }
+
+            uint32_t getEntityCount() const { return m_header->entityCount; }
+
+        private:
+            // Sections that carry an entity index array; tables and scene-wide settings don't
+            static bool isComponentSection(RuntimeSectionType type)
+            {
+                switch (type)
+                {
+                case RuntimeSectionType::Tag:
+                case RuntimeSectionType::Relationship:
+                case RuntimeSectionType::SpriteRenderer:
+                case RuntimeSectionType::Mesh:
+                case RuntimeSectionType::DirectionalLight:
+                case RuntimeSectionType::PointLight:
+                case RuntimeSectionType::SpotLight:
+                case RuntimeSectionType::CircleRenderer:
+                case RuntimeSectionType::Text:
+                case RuntimeSectionType::Rigidbody2D:
+                case RuntimeSectionType::BoxCollider2D:
+                case RuntimeSectionType::CircleCollider2D:
+                case RuntimeSectionType::CapsuleCollider2D:
+                case RuntimeSectionType::RevoluteJoint2D:
+                case RuntimeSectionType::DistanceJoint2D:
+                case RuntimeSectionType::Rigidbody3D:
+                case RuntimeSectionType::BoxCollider3D:
+                case RuntimeSectionType::CircleCollider3D:
+                case RuntimeSectionType::CapsuleCollider3D:
+                case RuntimeSectionType::MeshCollider3D:
+                case RuntimeSectionType::HingeConstraint3D:
+                case RuntimeSectionType::BoxSensor2D:
+                case RuntimeSectionType::CircleSensor2D:
+                case RuntimeSectionType::Camera:
+                case RuntimeSectionType::Script:
+                case RuntimeSectionType::ScriptContainer:
+                case RuntimeSectionType::Animator:
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            static uint32_t getExpectedStride(RuntimeSectionType type)
+            {
+                switch (type)
+                {
+                case RuntimeSectionType::Entities: return sizeof(UUID);
+                case RuntimeSectionType::Strings: return 1;
+                case RuntimeSectionType::Handles: return sizeof(uint64_t);
+                case RuntimeSectionType::Environment: return sizeof(SceneEnvironmentSettings);
+                case RuntimeSectionType::PhysicsSettings: return sizeof(ScenePhysicsSettings);
+                case RuntimeSectionType::Transform: return sizeof(TransformComponent);
+                case RuntimeSectionType::Tag: return sizeof(TagRecord);
+                case RuntimeSectionType::Relationship: return sizeof(RelationshipRecord);
+                case RuntimeSectionType::SpriteRenderer: return sizeof(SpriteRendererRecord);
+                case RuntimeSectionType::Mesh: return sizeof(MeshRecord);
+                case RuntimeSectionType::DirectionalLight: return sizeof(DirectionalLightComponent);
+                case RuntimeSectionType::PointLight: return sizeof(PointLightComponent);
+                case RuntimeSectionType::SpotLight: return sizeof(SpotLightComponent);
+                case RuntimeSectionType::CircleRenderer: return sizeof(CircleRendererComponent);
+                case RuntimeSectionType::Text: return sizeof(TextRecord);
+                case RuntimeSectionType::Rigidbody2D: return sizeof(Rigidbody2DComponent);
+                case RuntimeSectionType::BoxCollider2D: return sizeof(BoxCollider2DComponent);
+                case RuntimeSectionType::CircleCollider2D: return sizeof(CircleCollider2DComponent);
+                case RuntimeSectionType::CapsuleCollider2D: return sizeof(CapsuleCollider2DComponent);
+                case RuntimeSectionType::RevoluteJoint2D: return sizeof(RevoluteJoint2DComponent);
+                case RuntimeSectionType::DistanceJoint2D: return sizeof(DistanceJoint2DComponent);
+                case RuntimeSectionType::Rigidbody3D: return sizeof(Rigidbody3DComponent);
+                case RuntimeSectionType::BoxCollider3D: return sizeof(BoxCollider3DComponent);
+                case RuntimeSectionType::CircleCollider3D: return sizeof(CircleCollider3DComponent);
+                case RuntimeSectionType::CapsuleCollider3D: return sizeof(CapsuleCollider3DComponent);
+                case RuntimeSectionType::MeshCollider3D: return sizeof(MeshCollider3DComponent);
+                case RuntimeSectionType::HingeConstraint3D: return sizeof(HingeConstraint3DComponent);
+                case RuntimeSectionType::BoxSensor2D: return sizeof(BoxSensor2DComponent);
+                case RuntimeSectionType::CircleSensor2D: return sizeof(CircleSensor2DComponent);
+                case RuntimeSectionType::Camera: return sizeof(CameraRecord);
+                case RuntimeSectionType::Script: return sizeof(ScriptRecord);
+                case RuntimeSectionType::ScriptContainer: return sizeof(ScriptContainerRecord);
+                case RuntimeSectionType::Animator: return sizeof(AnimatorRecord);
+                }
+                return 0; // written by a newer build, ignored
+            }
+
+            static bool fail(const std::string &reason)
+            {
+                Log::Error(std::format("[SceneSerializer] Runtime scene rejected: {}", reason));
+                return false;
+            }
+
+        private:
+            const uint8_t *m_data = nullptr;
+            const RuntimeSceneHeader *m_header = nullptr;
+            std::vector<SectionView> m_sections;
+
+            const char *m_strings = nullptr;
+            uint32_t m_stringsSize = 0;
+            const uint64_t *m_handles = nullptr;
+            uint32_t m_handleCount = 0;
+        };
+
+        class RuntimeSceneLoader
+        {
+        public:
+            RuntimeSceneLoader(const RuntimeSceneReader &reader, entt::registry &registry,
+                               const std::vector<entt::entity> &entities)
+                : m_reader(reader), m_registry(registry), m_entities(entities)
+            {
+            }
+
+            // Mapped components go into the registry without a per-entity pass
+            template <typename T>
+            void insertComponents(RuntimeSectionType type)
+            {
+                const SectionView *section = m_reader.find(type, sizeof(T));
+                if (!section)
+                    return;
+
+                gatherTargets(*section);
+                const T *components = section->records<T>();
+                m_registry.insert<T>(m_targets.begin(), m_targets.end(), components);
+            }
+
+            // Builds components from records with 'makeComponent(const Record &, T &)', then inserts them in one go
+            template <typename T, typename Record, typename MakeComponent>
+            void insertRecords(RuntimeSectionType type, MakeComponent &&makeComponent)
+            {
+                const SectionView *section = m_reader.find(type, sizeof(Record));
+                if (!section)
+                    return;
+
+                gatherTargets(*section);
+                const Record *records = section->records<Record>();
+                std::vector<T> components(section->entry->count);
+                for (uint32_t i = 0; i < section->entry->count; ++i)
+                    makeComponent(records[i], components[i]);
+                m_registry.insert<T>(m_targets.begin(), m_targets.end(), components.begin());
+            }
+
+            // For components createEntitiesWithUUIDs() already added
+            template <typename T, typename Record, typename ApplyRecord>
+            void applyRecords(RuntimeSectionType type, ApplyRecord &&applyRecord)
+            {
+                const SectionView *section = m_reader.find(type, sizeof(Record));
+                if (!section)
+                    return;
+
+                const Record *records = section->records<Record>();
+                for (uint32_t i = 0; i < section->entry->count; ++i)
+                    applyRecord(records[i], m_registry.get<T>(m_entities[section->indices[i]]));
+            }
+
+        private:
+            void gatherTargets(const SectionView &section)
+            {
+                m_targets.resize(section.entry->count);
+                for (uint32_t i = 0; i < section.entry->count; ++i)
+                    m_targets[i] = m_entities[section.indices[i]];
+            }
+
+        private:
+            const RuntimeSceneReader &m_reader;
+            entt::registry &m_registry;
+            const std::vector<entt::entity> &m_entities;
+            std::vector<entt::entity> m_targets;
+        };
+    } // namespace
+
+    void SceneSerializer::serializeRuntime(const std::filesystem::path &filepath)
+    {
+        FM_PROFILE_FUNCTION();
+
+        auto &registry = m_scene->getRegistry();
+
+        std::vector<entt::entity> entities;
+        std::vector<UUID> uuids;
+        for (auto entity : registry.view<IDComponent, TransformComponent>())
+        {
+            entities.push_back(entity);
+            uuids.push_back(registry.get<IDComponent>(entity).ID);
+        }
+
+        RuntimeSceneWriter writer(registry, entities);
+
+        SectionBuilder &ids = writer.addSection(RuntimeSectionType::Entities, sizeof(UUID), false);
+        for (const UUID &uuid : uuids)
+            ids.push(0, uuid);
+
+        SectionBuilder &environment = writer.addSection(RuntimeSectionType::Environment, sizeof(SceneEnvironmentSettings), false);
+        environment.push(0, m_scene->getEnvironmentSettings());
+
+        SectionBuilder &physicsSettings = writer.addSection(RuntimeSectionType::PhysicsSettings, sizeof(ScenePhysicsSettings), false);
+        physicsSettings.push(0, m_scene->getPhysicsSettings());
+
+        SectionBuilder &transforms = writer.addSection(RuntimeSectionType::Transform, sizeof(TransformComponent), false);
+        for (auto entity : entities)
+            transforms.push(0, registry.get<TransformComponent>(entity));
+
+        writer.writeRecords<TagComponent, TagRecord>(RuntimeSectionType::Tag, [&](const TagComponent &tc)
+                                                     { return TagRecord{writer.addString(tc.tag)}; });
+        writer.writeRecords<RelationshipComponent, RelationshipRecord>(
+            RuntimeSectionType::Relationship, [&](const RelationshipComponent &rc)
+            { return RelationshipRecord{static_cast<uint64_t>(rc.parentHandle), writer.addHandles(rc.children)}; });
+        writer.writeRecords<SpriteRendererComponent, SpriteRendererRecord>(
+            RuntimeSectionType::SpriteRenderer, [](const SpriteRendererComponent &sprite)
+            { return SpriteRendererRecord{sprite.color, static_cast<uint64_t>(sprite.textureHandle)}; });
+        writer.writeRecords<MeshComponent, MeshRecord>(RuntimeSectionType::Mesh, [&](const MeshComponent &mesh)
+                                                       {
+            MeshRecord record;
+            record.meshHandle = static_cast<uint64_t>(mesh.meshHandle);
+            record.submeshMaterials = writer.addHandles(mesh.submeshMaterials);
+            record.memoryMeshType = static_cast<uint16_t>(mesh.memoryMeshType);
+            record.memoryOnly = mesh.memoryOnly ? 1 : 0;
+            record.occluder = mesh.isOccluder ? 1 : 0;
+            return record; });
+
+        writer.writeComponents<DirectionalLightComponent>(RuntimeSectionType::DirectionalLight);
+        writer.writeComponents<PointLightComponent>(RuntimeSectionType::PointLight);
+        writer.writeComponents<SpotLightComponent>(RuntimeSectionType::SpotLight);
+        writer.writeComponents<CircleRendererComponent>(RuntimeSectionType::CircleRenderer);
+
+        writer.writeRecords<TextComponent, TextRecord>(RuntimeSectionType::Text, [&](const TextComponent &text)
+                                                       {
+            TextRecord record;
+            record.text = writer.addString(text.textString);
+            record.color = text.color;
+            record.kerning = text.kerning;
+            record.lineSpacing = text.lineSpacing;
+            record.fontHandle = static_cast<uint64_t>(text.fontHandle);
+            return record; });
+
+        writer.writeComponents<Rigidbody2DComponent>(RuntimeSectionType::Rigidbody2D, [](auto &c)
+                                                     { c.runtimeBody = nullptr; });
+        writer.writeComponents<BoxCollider2DComponent>(RuntimeSectionType::BoxCollider2D, [](auto &c)
+                                                       { c.runtimeFixture = nullptr; });
+        writer.writeComponents<CircleCollider2DComponent>(RuntimeSectionType::CircleCollider2D, [](auto &c)
+                                                          { c.runtimeFixture = nullptr; });
+        writer.writeComponents<CapsuleCollider2DComponent>(RuntimeSectionType::CapsuleCollider2D, [](auto &c)
+                                                           { c.runtimeFixture = nullptr; });
+        writer.writeComponents<RevoluteJoint2DComponent>(RuntimeSectionType::RevoluteJoint2D, [](auto &c)
+                                                         { c.runtimeJoint = nullptr; });
+        writer.writeComponents<DistanceJoint2DComponent>(RuntimeSectionType::DistanceJoint2D, [](auto &c)
+                                                         { c.runtimeJoint = nullptr; });
+        writer.writeComponents<Rigidbody3DComponent>(RuntimeSectionType::Rigidbody3D, [](auto &c)
+                                                     { c.runtimeBody = nullptr; });
+        writer.writeComponents<BoxCollider3DComponent>(RuntimeSectionType::BoxCollider3D, [](auto &c)
+                                                       { c.runtimeShape = nullptr; });
+        writer.writeComponents<CircleCollider3DComponent>(RuntimeSectionType::CircleCollider3D, [](auto &c)
+                                                          { c.runtimeShape = nullptr; });
+        writer.writeComponents<CapsuleCollider3DComponent>(RuntimeSectionType::CapsuleCollider3D, [](auto &c)
+                                                           { c.runtimeShape = nullptr; });
+        writer.writeComponents<MeshCollider3DComponent>(RuntimeSectionType::MeshCollider3D, [](auto &c)
+                                                        { c.runtimeShape = nullptr; });
+        writer.writeComponents<HingeConstraint3DComponent>(RuntimeSectionType::HingeConstraint3D, [](auto &c)
+                                                           { c.runtimeConstraint = nullptr; });
+        writer.writeComponents<BoxSensor2DComponent>(RuntimeSectionType::BoxSensor2D, [](auto &c)
+                                                     { c.runtimeFixture = nullptr; });
+        writer.writeComponents<CircleSensor2DComponent>(RuntimeSectionType::CircleSensor2D, [](auto &c)
+                                                        { c.runtimeFixture = nullptr; });
+
+        writer.writeRecords<CameraComponent, CameraRecord>(RuntimeSectionType::Camera, [](const CameraComponent &cc)
+                                                           {
+            const auto &camera = cc.camera;
+            CameraRecord record;
+            record.projectionType = static_cast<int32_t>(camera.getProjectionType());
+            record.perspectiveFOV = camera.getPerspectiveFOV();
+            record.perspectiveNear = camera.getPerspectiveNearClip();
+            record.perspectiveFar = camera.getPerspectiveFarClip();
+            record.orthographicSize = camera.getOrthographicSize();
+            record.orthographicNear = camera.getOrthographicNearClip();
+            record.orthographicFar = camera.getOrthographicFarClip();
+            record.primary = cc.primary ? 1 : 0;
+            record.fixedAspectRatio = cc.fixedAspectRatio ? 1 : 0;
+            return record; });
+        writer.writeRecords<ScriptComponent, ScriptRecord>(RuntimeSectionType::Script, [&](const ScriptComponent &sc)
+                                                           { return ScriptRecord{writer.addString(sc.className)}; });
+        writer.writeRecords<ScriptContainerComponent, ScriptContainerRecord>(
+            RuntimeSectionType::ScriptContainer, [&](const ScriptContainerComponent &scc)
+            {
+            std::string joined;
+            for (size_t i = 0; i < scc.scriptClassNames.size(); ++i)
+            {
+                if (i > 0)
+                    joined.push_back('\0');
+                joined += scc.scriptClassNames[i];
+            }
+            ScriptContainerRecord record;
+            record.classNames = writer.addString(joined);
+            record.classCount = static_cast<uint32_t>(scc.scriptClassNames.size());
+            return record; });
+        writer.writeRecords<AnimatorComponent, AnimatorRecord>(RuntimeSectionType::Animator, [&](const AnimatorComponent &ac)
+                                                               {
+            AnimatorRecord record;
+            record.skeletonHandle = static_cast<uint64_t>(ac.skeletonHandle);
+            record.animationClips = writer.addHandles(ac.animationClipHandles);
+            record.activeClipIndex = ac.activeClipIndex;
+            record.speed = ac.speed;
+            record.playing = ac.playing ? 1 : 0;
+            record.looping = ac.looping ? 1 : 0;
+            return record; });
+
+        if (!writer.write(filepath))
+        {
+            Log::Error(std::format("[SceneSerializer] Failed to write runtime scene {}", filepath.string()));
+            return;
+        }
+        Log::Info(std::format("[SceneSerializer] Exported runtime scene {} ({} entities)", filepath.string(), entities.size()));
+    }
+
+    bool SceneSerializer::deserializeRuntime(const std::filesystem::path &filepath)
+    {
+        FM_PROFILE_FUNCTION();
+
+        MappedFile file;
+        if (!file.open(filepath))
+        {
+            Log::Error(std::format("[SceneSerializer] Failed to map runtime scene {}", filepath.string()));
+            return false;
+        }
+
+        RuntimeSceneReader reader;
+        if (!reader.open(file.getData(), file.getSize()) || !reader.validateLayouts())
+            return false;
+
+        const uint32_t entityCount = reader.getEntityCount();
+        const SectionView *ids = reader.find(RuntimeSectionType::Entities, sizeof(UUID));
+        if (!ids || ids->entry->count != entityCount)
+        {
+            Log::Error("[SceneSerializer] Runtime scene has no entity table");
+            return false;
+        }
+        const SectionView *transforms = reader.find(RuntimeSectionType::Transform, sizeof(TransformComponent));
+
+        auto &registry = m_scene->getRegistry();
+        std::vector<entt::entity> entities;
+        m_scene->getEntityManager().createEntitiesWithUUIDs(
+            ids->records<UUID>(), transforms ? transforms->records<TransformComponent>() : nullptr, entityCount, entities);
+
+        if (const SectionView *environment = reader.find(RuntimeSectionType::Environment, sizeof(SceneEnvironmentSettings)))
+            m_scene->getEnvironmentSettings() = *environment->records<SceneEnvironmentSettings>();
+        if (const SectionView *physicsSettings = reader.find(RuntimeSectionType::PhysicsSettings, sizeof(ScenePhysicsSettings)))
+            m_scene->getPhysicsSettings() = *physicsSettings->records<ScenePhysicsSettings>();
+
+        RuntimeSceneLoader loader(reader, registry, entities);
+
+        loader.insertRecords<TagComponent, TagRecord>(RuntimeSectionType::Tag, [&](const TagRecord &record, TagComponent &tc)
+                                                      { tc.tag = reader.getString(record.tag); });
+        loader.applyRecords<RelationshipComponent, RelationshipRecord>(
+            RuntimeSectionType::Relationship, [&](const RelationshipRecord &record, RelationshipComponent &rc)
+            {
+            rc.parentHandle = UUID(record.parentHandle);
+            reader.getHandles(record.children, rc.children); });
+        loader.insertRecords<SpriteRendererComponent, SpriteRendererRecord>(
+            RuntimeSectionType::SpriteRenderer, [](const SpriteRendererRecord &record, SpriteRendererComponent &src)
+            {
+            src.color = record.color;
+            src.textureHandle = AssetHandle(record.textureHandle); });
+        loader.insertRecords<MeshComponent, MeshRecord>(RuntimeSectionType::Mesh, [&](const MeshRecord &record, MeshComponent &mesh)
+                                                        {
+            mesh.memoryMeshType = static_cast<MemoryMeshType>(record.memoryMeshType);
+            mesh.memoryOnly = record.memoryOnly != 0;
+            mesh.isOccluder = record.occluder != 0;
+            if (mesh.memoryOnly)
+                mesh.meshHandle = MeshFactory::createMemoryMesh(mesh.memoryMeshType);
+            else
+                mesh.meshHandle = AssetHandle(record.meshHandle);
+            reader.getHandles(record.submeshMaterials, mesh.submeshMaterials); });
+
+        loader.insertComponents<DirectionalLightComponent>(RuntimeSectionType::DirectionalLight);
+        loader.insertComponents<PointLightComponent>(RuntimeSectionType::PointLight);
+        loader.insertComponents<SpotLightComponent>(RuntimeSectionType::SpotLight);
+        loader.insertComponents<CircleRendererComponent>(RuntimeSectionType::CircleRenderer);
+
+        auto runtimeAssets = Project::getRuntimeAssetManager();
+        loader.insertRecords<TextComponent, TextRecord>(RuntimeSectionType::Text, [&](const TextRecord &record, TextComponent &tc)
+                                                        {
+            tc.textString = reader.getString(record.text);
+            tc.color = record.color;
+            tc.kerning = record.kerning;
+            tc.lineSpacing = record.lineSpacing;
+            if (record.fontHandle != 0)
+            {
+                tc.fontHandle = AssetHandle(record.fontHandle);
+                if (runtimeAssets)
+                    tc.fontAsset = runtimeAssets->getAsset<Font>(tc.fontHandle);
+            } });
+
+        loader.insertComponents<Rigidbody2DComponent>(RuntimeSectionType::Rigidbody2D);
+        loader.insertComponents<BoxCollider2DComponent>(RuntimeSectionType::BoxCollider2D);
+        loader.insertComponents<CircleCollider2DComponent>(RuntimeSectionType::CircleCollider2D);
+        loader.insertComponents<CapsuleCollider2DComponent>(RuntimeSectionType::CapsuleCollider2D);
+        loader.insertComponents<RevoluteJoint2DComponent>(RuntimeSectionType::RevoluteJoint2D);
+        loader.insertComponents<DistanceJoint2DComponent>(RuntimeSectionType::DistanceJoint2D);
+        loader.insertComponents<Rigidbody3DComponent>(RuntimeSectionType::Rigidbody3D);
+        loader.insertComponents<BoxCollider3DComponent>(RuntimeSectionType::BoxCollider3D);
+        loader.insertComponents<CircleCollider3DComponent>(RuntimeSectionType::CircleCollider3D);
+        loader.insertComponents<CapsuleCollider3DComponent>(RuntimeSectionType::CapsuleCollider3D);
+        loader.insertComponents<MeshCollider3DComponent>(RuntimeSectionType::MeshCollider3D);
+        loader.insertComponents<HingeConstraint3DComponent>(RuntimeSectionType::HingeConstraint3D);
+        loader.insertComponents<BoxSensor2DComponent>(RuntimeSectionType::BoxSensor2D);
+        loader.insertComponents<CircleSensor2DComponent>(RuntimeSectionType::CircleSensor2D);
+
+        loader.insertRecords<CameraComponent, CameraRecord>(RuntimeSectionType::Camera, [](const CameraRecord &record, CameraComponent &cc)
+                                                            {
+            auto &camera = cc.camera;
+            camera.setProjectionType(static_cast<SceneCamera::ProjectionType>(record.projectionType));
+            camera.setPerspectiveFOV(record.perspectiveFOV);
+            camera.setPerspectiveNearClip(record.perspectiveNear);
+            camera.setPerspectiveFarClip(record.perspectiveFar);
+            camera.setOrthographicSize(record.orthographicSize);
+            camera.setOrthographicNearClip(record.orthographicNear);
+            camera.setOrthographicFarClip(record.orthographicFar);
+            cc.primary = record.primary != 0;
+            cc.fixedAspectRatio = record.fixedAspectRatio != 0; });
+        loader.insertRecords<ScriptComponent, ScriptRecord>(RuntimeSectionType::Script, [&](const ScriptRecord &record, ScriptComponent &sc)
+                                                            { sc.className = reader.getString(record.className); });
+        loader.insertRecords<ScriptContainerComponent, ScriptContainerRecord>(
+            RuntimeSectionType::ScriptContainer, [&](const ScriptContainerRecord &record, ScriptContainerComponent &scc)
+            {
+            const std::string joined = reader.getString(record.classNames);
+            scc.scriptClassNames.reserve(record.classCount);
+            size_t begin = 0;
+            for (uint32_t i = 0; i < record.classCount; ++i)
+            {
+                size_t end = joined.find('\0', begin);
+                if (end == std::string::npos)
+                    end = joined.size();
+                scc.scriptClassNames.push_back(joined.substr(begin, end - begin));
+                begin = end + 1;
+            } });
+        loader.insertRecords<AnimatorComponent, AnimatorRecord>(RuntimeSectionType::Animator, [&](const AnimatorRecord &record, AnimatorComponent &ac)
+                                                                {
+            ac.skeletonHandle = AssetHandle(record.skeletonHandle);
+            reader.getHandles(record.animationClips, ac.animationClipHandles);
+            ac.activeClipIndex = record.activeClipIndex;
+            ac.speed = record.speed;
+            ac.playing = record.playing != 0;
+            ac.looping = record.looping != 0; });
+
+        Log::Info(std::format("[SceneSerializer] Loaded runtime scene {} ({} entities)", filepath.string(), entityCount));
+        return true;
+    }
+} // namespace Fermion
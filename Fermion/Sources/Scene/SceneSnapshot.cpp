@@ -0,0 +1,32 @@
+#include "fmpch.hpp"
+#include "Scene/SceneSnapshot.hpp"
+#include "Scene/EntityManager.hpp"
+
+namespace Fermion
+{
+    void SceneSnapshot::capture(const Scene &scene)
+    {
+        FM_PROFILE_FUNCTION();
+
+        m_registry = {};
+        scene.getEntityManager().cloneRegistry(m_registry);
+        m_environmentSettings = scene.m_environmentSettings;
+        m_physicsSettings = scene.m_physicsSettings;
+        m_valid = true;
+    }
+
+    void SceneSnapshot::restore(Scene &scene)
+    {
+        FM_PROFILE_FUNCTION();
+        FERMION_ASSERT(m_valid, "Restoring a scene snapshot that was never captured");
+
+        scene.getEntityManager().restoreRegistry(std::move(m_registry));
+        scene.m_environmentSettings = m_environmentSettings;
+        scene.m_physicsSettings = m_physicsSettings;
+        scene.m_isPaused = false;
+        scene.m_stepFrames = 0;
+
+        m_registry = {};
+        m_valid = false;
+    }
+} // namespace Fermion
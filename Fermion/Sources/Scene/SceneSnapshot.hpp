@@ -0,0 +1,26 @@
+#pragma once
+#include <entt/entt.hpp>
+
+#include "Scene/Scene.hpp"
+
+namespace Fermion
+{
+    // Edit-mode state put aside while a scene plays in place. capture() clones the component pools into a
+    // private registry; restore() moves that registry back, so stopping costs no more than tearing down
+    // the played one. Entity handles survive the round trip.
+    class SceneSnapshot
+    {
+    public:
+        void capture(const Scene &scene);
+        // Puts the captured state back into 'scene' and leaves the snapshot empty
+        void restore(Scene &scene);
+
+        bool isValid() const { return m_valid; }
+
+    private:
+        entt::registry m_registry;
+        SceneEnvironmentSettings m_environmentSettings;
+        ScenePhysicsSettings m_physicsSettings;
+        bool m_valid = false;
+    };
+} // namespace Fermion
@@ -0,0 +1,163 @@
+#include "fmpch.hpp"
+#include "Scene/SceneSpatialIndex.hpp"
+#include "Scene/Components.hpp"
+#include "Project/Project.hpp"
+
+namespace Fermion
+{
+    SceneSpatialIndex::SceneSpatialIndex(entt::registry &registry) : m_registry(registry)
+    {
+    }
+
+    void SceneSpatialIndex::update()
+    {
+        FM_PROFILE_FUNCTION();
+
+        // MeshComponent was removed since the last update
+        std::vector<entt::entity> orphaned;
+        for (auto entity : m_registry.view<SpatialProxyComponent>(entt::exclude<MeshComponent>))
+            orphaned.push_back(entity);
+        for (auto entity : orphaned)
+            removeEntity(entity);
+
+        auto assetManager = Project::getRuntimeAssetManager();
+        auto view = m_registry.view<MeshComponent, WorldTransformComponent>();
+        for (auto entity : view)
+        {
+            const auto &mesh = view.get<MeshComponent>(entity);
+            auto *proxy = m_registry.try_get<SpatialProxyComponent>(entity);
+            if (!proxy)
+                proxy = &m_registry.emplace<SpatialProxyComponent>(entity);
+
+            // Bounds come from the mesh asset; retried every update until the asset is available
+            if (proxy->meshHandle != mesh.meshHandle || !proxy->hasBounds)
+            {
+                proxy->meshHandle = mesh.meshHandle;
+                proxy->hasBounds = false;
+                if (static_cast<uint64_t>(mesh.meshHandle) != 0 && assetManager)
+                {
+                    if (auto meshAsset = assetManager->getAsset<Mesh>(mesh.meshHandle))
+                    {
+                        proxy->localBounds = meshAsset->getBoundingBox();
+                        proxy->hasBounds = true;
+                        proxy->transformDirty = true;
+                    }
+                }
+
+                if (!proxy->hasBounds)
+                {
+                    if (proxy->proxyId != DynamicBVH::NullNode)
+                    {
+                        m_tree.destroyProxy(proxy->proxyId);
+                        proxy->proxyId = DynamicBVH::NullNode;
+                    }
+                    continue;
+                }
+            }
+
+            if (!proxy->transformDirty && proxy->proxyId != DynamicBVH::NullNode)
+                continue;
+
+            const AABB worldBounds = AABB::TransformAABB(proxy->localBounds, view.get<WorldTransformComponent>(entity).transform);
+            if (proxy->proxyId == DynamicBVH::NullNode)
+                proxy->proxyId = m_tree.createProxy(worldBounds, static_cast<uint32_t>(entity));
+            else
+                m_tree.moveProxy(proxy->proxyId, worldBounds);
+
+            if (proxy->proxyId >= static_cast<int32_t>(m_worldBounds.size()))
+                m_worldBounds.resize(proxy->proxyId + 1);
+            m_worldBounds[proxy->proxyId] = worldBounds;
+            proxy->transformDirty = false;
+        }
+    }
+
+    void SceneSpatialIndex::removeEntity(entt::entity entity)
+    {
+        auto *proxy = m_registry.try_get<SpatialProxyComponent>(entity);
+        if (!proxy)
+            return;
+
+        if (proxy->proxyId != DynamicBVH::NullNode)
+            m_tree.destroyProxy(proxy->proxyId);
+        m_registry.remove<SpatialProxyComponent>(entity);
+    }
+
+    void SceneSpatialIndex::clear()
+    {
+        m_registry.clear<SpatialProxyComponent>();
+        m_tree.clear();
+        m_worldBounds.clear();
+    }
+
+    void SceneSpatialIndex::queryFrustum(const std::array<glm::vec4, 6> &planes,
+                                         std::vector<entt::entity> &outEntities) const
+    {
+        FM_PROFILE_FUNCTION();
+
+        m_tree.queryFrustum(planes, [&](uint32_t userData, bool fullyInside)
+                            {
+            entt::entity entity = static_cast<entt::entity>(userData);
+            if (!fullyInside)
+            {
+                // The tree stores enlarged bounds; recheck the tight ones at the boundary
+                const int32_t proxyId = m_registry.get<SpatialProxyComponent>(entity).proxyId;
+                if (!Math::IsAABBInsideFrustum(planes, m_worldBounds[proxyId]))
+                    return;
+            }
+            outEntities.push_back(entity); });
+    }
+
+    void SceneSpatialIndex::queryAABB(const AABB &aabb, std::vector<entt::entity> &outEntities) const
+    {
+        m_tree.queryAABB(aabb, [&](uint32_t userData)
+                         {
+            entt::entity entity = static_cast<entt::entity>(userData);
+            const int32_t proxyId = m_registry.get<SpatialProxyComponent>(entity).proxyId;
+            if (DynamicBVH::overlaps(m_worldBounds[proxyId], aabb))
+                outEntities.push_back(entity); });
+    }
+
+    void SceneSpatialIndex::querySphere(const glm::vec3 &center, float radius,
+                                        std::vector<entt::entity> &outEntities) const
+    {
+        m_tree.querySphere(center, radius, [&](uint32_t userData)
+                           {
+            entt::entity entity = static_cast<entt::entity>(userData);
+            const int32_t proxyId = m_registry.get<SpatialProxyComponent>(entity).proxyId;
+            if (DynamicBVH::distanceSquared(m_worldBounds[proxyId], center) <= radius * radius)
+                outEntities.push_back(entity); });
+    }
+
+    bool SceneSpatialIndex::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance,
+                                    SpatialRaycastHit &outHit) const
+    {
+        const float directionLength = glm::length(direction);
+        if (directionLength <= 0.0f)
+            return false;
+        const glm::vec3 unitDirection = direction / directionLength;
+
+        bool hit = false;
+        m_tree.raycast(origin, unitDirection, maxDistance, [&](uint32_t userData, float)
+                       {
+            entt::entity entity = static_cast<entt::entity>(userData);
+            const auto &proxy = m_registry.get<SpatialProxyComponent>(entity);
+
+            // Same ray parameter in local space as long as the direction isn't renormalized
+            const glm::mat4 inverseWorld = glm::inverse(m_registry.get<WorldTransformComponent>(entity).transform);
+            const glm::vec3 localOrigin = glm::vec3(inverseWorld * glm::vec4(origin, 1.0f));
+            const glm::vec3 localDirection = glm::vec3(inverseWorld * glm::vec4(unitDirection, 0.0f));
+
+            float distance = 0.0f;
+            if (DynamicBVH::intersectRay(proxy.localBounds, localOrigin, 1.0f / localDirection, maxDistance, distance))
+            {
+                hit = true;
+                maxDistance = distance;
+                outHit.entity = entity;
+                outHit.distance = distance;
+                outHit.point = origin + unitDirection * distance;
+            }
+            return maxDistance; });
+
+        return hit;
+    }
+} // namespace Fermion
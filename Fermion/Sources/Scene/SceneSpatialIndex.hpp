@@ -0,0 +1,48 @@
+#pragma once
+#include <entt/entt.hpp>
+
+#include <array>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Math/DynamicBVH.hpp"
+
+namespace Fermion
+{
+    struct SpatialRaycastHit
+    {
+        entt::entity entity = entt::null;
+        float distance = 0.0f;
+        glm::vec3 point{0.0f};
+    };
+
+    // Dynamic BVH over the world bounds of every entity with a MeshComponent.
+    // Owned by EntityManager and fed from the world transform cache, so it is as fresh as the
+    // last EntityManager::updateWorldTransforms().
+    class SceneSpatialIndex
+    {
+    public:
+        explicit SceneSpatialIndex(entt::registry &registry);
+
+        // Adds, refits and removes proxies for mesh entities whose mesh or world transform changed
+        void update();
+        void removeEntity(entt::entity entity);
+        void clear();
+
+        // Entities whose world bounds intersect the frustum
+        void queryFrustum(const std::array<glm::vec4, 6> &planes, std::vector<entt::entity> &outEntities) const;
+        void queryAABB(const AABB &aabb, std::vector<entt::entity> &outEntities) const;
+        void querySphere(const glm::vec3 &center, float radius, std::vector<entt::entity> &outEntities) const;
+        // Closest hit against the mesh bounds in each mesh's local space, so rotated meshes pick tightly
+        bool raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance,
+                     SpatialRaycastHit &outHit) const;
+
+        const DynamicBVH &getTree() const { return m_tree; }
+
+    private:
+        entt::registry &m_registry;
+        DynamicBVH m_tree;
+        // Tight world bounds, indexed by proxy id
+        std::vector<AABB> m_worldBounds;
+    };
+} // namespace Fermion
@@ -20,6 +20,7 @@
 #include "Physics/Physics3D.hpp"
 #include "ImGui/ConsolePanel.hpp"
 
+#include "mono/metadata/appdomain.h"
 #include "mono/metadata/object.h"
 #include "mono/metadata/reflection.h"
 #include <box2d/box2d.h>
@@ -159,6 +160,55 @@ namespace Fermion
     }
 #pragma endregion
 
+#pragma region SceneQuery
+    static MonoArray *entitiesToUUIDArray(Scene *scene, const std::vector<entt::entity> &entities)
+    {
+        MonoArray *array = mono_array_new(mono_domain_get(), mono_get_uint64_class(), entities.size());
+        for (size_t i = 0; i < entities.size(); i++)
+            mono_array_set(array, uint64_t, i, static_cast<uint64_t>(Entity{entities[i], scene}.getUUID()));
+        return array;
+    }
+
+    extern "C" bool Scene_Raycast(glm::vec3 *origin, glm::vec3 *direction, float maxDistance, uint64_t *outEntityID,
+                                  float *outDistance)
+    {
+        Scene *scene = ScriptManager::getSceneContext();
+        FERMION_ASSERT(scene, "Scene is null!");
+
+        SpatialRaycastHit hit;
+        if (!scene->getEntityManager().getSpatialIndex().raycast(*origin, *direction, maxDistance, hit))
+        {
+            *outEntityID = 0;
+            *outDistance = 0.0f;
+            return false;
+        }
+
+        *outEntityID = Entity{hit.entity, scene}.getUUID();
+        *outDistance = hit.distance;
+        return true;
+    }
+
+    extern "C" MonoArray *Scene_OverlapSphere(glm::vec3 *center, float radius)
+    {
+        Scene *scene = ScriptManager::getSceneContext();
+        FERMION_ASSERT(scene, "Scene is null!");
+
+        std::vector<entt::entity> entities;
+        scene->getEntityManager().getSpatialIndex().querySphere(*center, radius, entities);
+        return entitiesToUUIDArray(scene, entities);
+    }
+
+    extern "C" MonoArray *Scene_OverlapBox(glm::vec3 *center, glm::vec3 *halfExtents)
+    {
+        Scene *scene = ScriptManager::getSceneContext();
+        FERMION_ASSERT(scene, "Scene is null!");
+
+        std::vector<entt::entity> entities;
+        scene->getEntityManager().getSpatialIndex().queryAABB({*center - *halfExtents, *center + *halfExtents}, entities);
+        return entitiesToUUIDArray(scene, entities);
+    }
+#pragma endregion
+
 #pragma region Log
     extern "C" void NativeLog(MonoString *string, int parameter)
     {
@@ -283,6 +333,16 @@ namespace Fermion
 
         entity.getComponent<TransformComponent>().scale = *scale;
     }
+
+    extern "C" void TransformComponent_GetWorldTranslation(UUID entityID, glm::vec3 *outTranslation)
+    {
+        Scene *scene = ScriptManager::getSceneContext();
+        FERMION_ASSERT(scene, "Scene is null!");
+        Entity entity = scene->getEntityManager().getEntityByUUID(entityID);
+        FERMION_ASSERT(entity, "Entity is null!");
+
+        *outTranslation = entity.getComponent<WorldTransformComponent>().getTranslation();
+    }
 #pragma endregion
 
 #pragma region SpriteRendererComponent
@@ -1202,6 +1262,9 @@ namespace Fermion
         FM_ADD_INTERNAL_CALL(Scene_CreateEntity);
         FM_ADD_INTERNAL_CALL(Scene_DestroyEntity);
         FM_ADD_INTERNAL_CALL(Scene_InitPhysics3DEntity);
+        FM_ADD_INTERNAL_CALL(Scene_Raycast);
+        FM_ADD_INTERNAL_CALL(Scene_OverlapSphere);
+        FM_ADD_INTERNAL_CALL(Scene_OverlapBox);
 
         FM_ADD_INTERNAL_CALL(NativeLog);
         FM_ADD_INTERNAL_CALL(ConsoleLog);
@@ -1217,6 +1280,7 @@ namespace Fermion
         FM_ADD_INTERNAL_CALL(TransformComponent_SetRotation);
         FM_ADD_INTERNAL_CALL(TransformComponent_GetScale);
         FM_ADD_INTERNAL_CALL(TransformComponent_SetScale);
+        FM_ADD_INTERNAL_CALL(TransformComponent_GetWorldTranslation);
 
         FM_ADD_INTERNAL_CALL(SpriteRendererComponent_SetColor);
         FM_ADD_INTERNAL_CALL(SpriteRendererComponent_SetTexture);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <filesystem>
 #include <vector>
@@ -23,4 +25,27 @@ public:
     static bool launchDetached(const std::filesystem::path &executablePath, const std::vector<std::string> &arguments);
 };
 
+// Read-only view of a whole file mapped into the address space
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::filesystem::path &path);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const uint8_t *getData() const { return m_data; }
+    size_t getSize() const { return m_size; }
+
+private:
+    const uint8_t *m_data = nullptr;
+    size_t m_size = 0;
+    void *m_fileHandle = nullptr;
+    void *m_mappingHandle = nullptr;
+};
+
 } // namespace Fermion
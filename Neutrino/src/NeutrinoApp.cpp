@@ -21,6 +21,7 @@ Application *createApplication(int argc, char **argv) {
     spec.windowWidth = 1920;
     spec.windowHeight = 1080;
     spec.rendererConfig.ShaderPath = "../Resources/shaders/";
+    spec.rendererConfig.ShaderCachePath = "ShaderCache/";
     Log::Info("start preparing to create the Neutrino Application");
     return new Fermion::Neutrino(spec);
 }
@@ -119,7 +119,23 @@ void NeutrinoLayer::loadScene(const std::string_view &filepath)
     m_runtimeScene = std::make_shared<Fermion::Scene>();
 
     Fermion::SceneSerializer serializer(m_runtimeScene);
-    FERMION_ASSERT(serializer.deserialize(filepath), "Failed to deserialize runtime scene!");
+
+    // Prefer the binary export from Boson unless the YAML scene was saved after it
+    std::filesystem::path scenePath(filepath);
+    std::filesystem::path runtimePath = scenePath;
+    runtimePath.replace_extension(".fmrscene");
+    std::error_code ec;
+    bool loaded = false;
+    if (runtimePath != scenePath && std::filesystem::exists(runtimePath, ec) &&
+        (!std::filesystem::exists(scenePath, ec) ||
+         std::filesystem::last_write_time(runtimePath, ec) >= std::filesystem::last_write_time(scenePath, ec)))
+    {
+        // Rejected files are detected before the scene is touched, so falling back is safe
+        loaded = serializer.deserializeRuntime(runtimePath);
+    }
+    if (!loaded)
+        loaded = serializer.deserialize(scenePath);
+    FERMION_ASSERT(loaded, "Failed to deserialize runtime scene!");
 
     const auto &window = Fermion::Application::get().getWindow();
     const uint32_t windowWidth = window.getWidth();
@@ -151,6 +167,11 @@ void NeutrinoLayer::loadScene(const std::string_view &filepath)
         rendererEnv.shadowMapSize = sceneEnv.shadowMapSize;
         rendererEnv.shadowBias = sceneEnv.shadowBias;
         rendererEnv.shadowSoftness = sceneEnv.shadowSoftness;
+        rendererEnv.shadowCascadeCount = sceneEnv.shadowCascadeCount;
+        rendererEnv.shadowCascadeSplitLambda = sceneEnv.shadowCascadeSplitLambda;
+        rendererEnv.shadowDistance = sceneEnv.shadowDistance;
+        rendererEnv.shadowStaticCache = sceneEnv.shadowStaticCache;
+        rendererEnv.shadowCacheUpdateBudget = sceneEnv.shadowCacheUpdateBudget;
         rendererEnv.normalMapStrength = sceneEnv.normalMapStrength;
         rendererEnv.toksvigStrength = sceneEnv.toksvigStrength;
         rendererEnv.useIBL = sceneEnv.useIBL;
@@ -15,6 +15,15 @@ namespace Fermion
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal static extern void Scene_InitPhysics3DEntity(ulong entityID);
 
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal static extern bool Scene_Raycast(ref Vector3 origin, ref Vector3 direction, float maxDistance, out ulong entityID, out float distance);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal static extern ulong[] Scene_OverlapSphere(ref Vector3 center, float radius);
+
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal static extern ulong[] Scene_OverlapBox(ref Vector3 center, ref Vector3 halfExtents);
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal static extern void NativeLog(string s, int parameter);
 
@@ -47,6 +56,8 @@ namespace Fermion
         internal static extern void TransformComponent_GetScale(ulong entityID, out Vector3 scale);
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal static extern void TransformComponent_SetScale(ulong entityID, ref Vector3 scale);
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        internal static extern void TransformComponent_GetWorldTranslation(ulong entityID, out Vector3 translation);
 
         [MethodImpl(MethodImplOptions.InternalCall)]
         internal static extern void SpriteRendererComponent_SetColor(ulong entityID, ref Vector4 translation);
@@ -51,6 +51,15 @@ namespace Fermion
 				InternalCalls.TransformComponent_SetScale(Entity.ID, ref value);
 			}
 		}
+
+		public Vector3 WorldTranslation
+		{
+			get
+			{
+				InternalCalls.TransformComponent_GetWorldTranslation(Entity.ID, out Vector3 translation);
+				return translation;
+			}
+		}
 	}
 
 	public class SpriteRendererComponent : Component
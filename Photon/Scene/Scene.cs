@@ -19,6 +19,32 @@ namespace Fermion
         {
             InternalCalls.Scene_InitPhysics3DEntity(entity.ID);
         }
+
+        // Queries run against the bounds of mesh entities
+        public static bool Raycast(Vector3 origin, Vector3 direction, float maxDistance, out Entity hitEntity, out float distance)
+        {
+            bool hit = InternalCalls.Scene_Raycast(ref origin, ref direction, maxDistance, out ulong entityID, out distance);
+            hitEntity = hit ? new Entity(entityID) : null;
+            return hit;
+        }
+
+        public static Entity[] OverlapSphere(Vector3 center, float radius)
+        {
+            return ToEntities(InternalCalls.Scene_OverlapSphere(ref center, radius));
+        }
+
+        public static Entity[] OverlapBox(Vector3 center, Vector3 halfExtents)
+        {
+            return ToEntities(InternalCalls.Scene_OverlapBox(ref center, ref halfExtents));
+        }
+
+        private static Entity[] ToEntities(ulong[] entityIDs)
+        {
+            Entity[] entities = new Entity[entityIDs.Length];
+            for (int i = 0; i < entityIDs.Length; i++)
+                entities[i] = new Entity(entityIDs[i]);
+            return entities;
+        }
     }
 
 
@@ -0,0 +1,128 @@
+#include "fmpch.hpp"
+#include "Scene/Scene.hpp"
+#include "Scene/SceneSerializer.hpp"
+#include "Scene/Entity.hpp"
+#include "Scene/EntityManager.hpp"
+#include "Scene/Components.hpp"
+
+#include <filesystem>
+#include <iostream>
+
+// Saves a scene as .fmrscene, loads it into a fresh scene and compares what came back.
+// Returns non-zero on the first mismatch so CTest reports it.
+
+using namespace Fermion;
+
+namespace
+{
+    int s_failures = 0;
+
+    void check(bool condition, const char *what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++s_failures;
+        }
+    }
+} // namespace
+
+int main()
+{
+    auto scene = std::make_shared<Scene>();
+
+    SceneEnvironmentSettings &environment = scene->getEnvironmentSettings();
+    environment.showSkybox = false;
+    environment.shadowMapSize = 1024;
+    environment.shadowCascadeCount = 3;
+    environment.useIBL = false;
+
+    ScenePhysicsSettings &physics = scene->getPhysicsSettings();
+    physics.fixedUpdateRate = 120.0f;
+    physics.maxSubsteps = 6;
+    physics.interpolate = false;
+
+    Entity parent = scene->createEntity("Parent");
+    parent.getComponent<TransformComponent>().translation = {1.0f, 2.0f, 3.0f};
+    PointLightComponent &light = parent.addComponent<PointLightComponent>();
+    light.intensity = 4.0f;
+    light.range = 25.0f;
+
+    Entity child = scene->createChildEntity(parent, "Child");
+    child.getComponent<TransformComponent>().scale = {2.0f, 2.0f, 2.0f};
+    MeshComponent &mesh = child.addComponent<MeshComponent>();
+    mesh.meshHandle = AssetHandle(1234);
+    mesh.setSubmeshMaterial(1, AssetHandle(5678));
+    mesh.isOccluder = true;
+    BoxCollider2DComponent &box = child.addComponent<BoxCollider2DComponent>();
+    box.size = {3.0f, 4.0f};
+    box.friction = 0.25f;
+
+    const UUID parentID = parent.getUUID();
+    const UUID childID = child.getUUID();
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "SceneSerializerRuntimeTest.fmrscene";
+    SceneSerializer(scene).serializeRuntime(path);
+
+    auto loaded = std::make_shared<Scene>();
+    check(SceneSerializer(loaded).deserializeRuntime(path), "runtime scene loads");
+    std::filesystem::remove(path);
+    if (s_failures != 0)
+        return 1;
+
+    const SceneEnvironmentSettings &loadedEnvironment = loaded->getEnvironmentSettings();
+    check(!loadedEnvironment.showSkybox, "environment showSkybox");
+    check(loadedEnvironment.shadowMapSize == 1024, "environment shadowMapSize");
+    check(loadedEnvironment.shadowCascadeCount == 3, "environment shadowCascadeCount");
+    check(!loadedEnvironment.useIBL, "environment useIBL");
+
+    const ScenePhysicsSettings &loadedPhysics = loaded->getPhysicsSettings();
+    check(loadedPhysics.fixedUpdateRate == 120.0f, "physics fixedUpdateRate");
+    check(loadedPhysics.maxSubsteps == 6, "physics maxSubsteps");
+    check(!loadedPhysics.interpolate, "physics interpolate");
+
+    EntityManager &entities = loaded->getEntityManager();
+    Entity loadedParent = entities.tryGetEntityByUUID(parentID);
+    Entity loadedChild = entities.tryGetEntityByUUID(childID);
+    check(static_cast<bool>(loadedParent), "parent entity exists");
+    check(static_cast<bool>(loadedChild), "child entity exists");
+    if (s_failures != 0)
+        return 1;
+
+    check(loadedParent.getComponent<TagComponent>().tag == "Parent", "parent tag");
+    check(loadedParent.getComponent<TransformComponent>().translation == glm::vec3(1.0f, 2.0f, 3.0f), "parent translation");
+    check(loadedParent.hasComponent<PointLightComponent>(), "parent point light");
+    if (loadedParent.hasComponent<PointLightComponent>())
+    {
+        const PointLightComponent &loadedLight = loadedParent.getComponent<PointLightComponent>();
+        check(loadedLight.intensity == 4.0f && loadedLight.range == 25.0f, "point light values");
+    }
+
+    check(loadedChild.getComponent<TagComponent>().tag == "Child", "child tag");
+    check(loadedChild.getComponent<TransformComponent>().scale == glm::vec3(2.0f), "child scale");
+    check(loadedChild.getComponent<RelationshipComponent>().parentHandle == parentID, "child parent");
+    const auto &children = loadedParent.getComponent<RelationshipComponent>().children;
+    check(children.size() == 1 && children[0] == childID, "parent children");
+
+    check(loadedChild.hasComponent<MeshComponent>(), "child mesh");
+    if (loadedChild.hasComponent<MeshComponent>())
+    {
+        const MeshComponent &loadedMesh = loadedChild.getComponent<MeshComponent>();
+        check(loadedMesh.meshHandle == AssetHandle(1234), "mesh handle");
+        check(loadedMesh.getSubmeshMaterialCount() == 2, "mesh submesh material count");
+        check(loadedMesh.getSubmeshMaterial(1) == AssetHandle(5678), "mesh submesh material");
+        check(loadedMesh.isOccluder, "mesh occluder flag");
+    }
+
+    check(loadedChild.hasComponent<BoxCollider2DComponent>(), "child box collider");
+    if (loadedChild.hasComponent<BoxCollider2DComponent>())
+    {
+        const BoxCollider2DComponent &loadedBox = loadedChild.getComponent<BoxCollider2DComponent>();
+        check(loadedBox.size == glm::vec2(3.0f, 4.0f) && loadedBox.friction == 0.25f, "box collider values");
+        check(loadedBox.runtimeFixture == nullptr, "box collider runtime pointer cleared");
+    }
+
+    if (s_failures == 0)
+        std::cout << "SceneSerializerRuntimeTest passed" << std::endl;
+    return s_failures == 0 ? 0 : 1;
+}